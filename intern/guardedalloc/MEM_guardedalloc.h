@@ -247,6 +247,20 @@ void MEM_use_lockfree_allocator(void);
  * NOTE: The switch between allocator types can only happen before any allocation did happen. */
 void MEM_use_guarded_allocator(void);
 
+/* Use thread-local caches for small allocations of the lock-free allocator.
+ *
+ * Small blocks are taken from per-thread free lists of fixed size classes, carved out of larger
+ * pages, which avoids going through the system allocator and contention between threads. Memory of
+ * freed small blocks is kept for reuse instead of being returned to the system. Memory usage
+ * accounting and leak detection are not affected.
+ *
+ * Enabled with the `--debug-memory-thread-cache` command line argument.
+ *
+ * NOTE: Must be called before other threads start allocating, the setting is read without any
+ * synchronization. Blocks are always freed the same way they were allocated, so unlike the
+ * allocator type it may be set after allocations have been made. */
+void MEM_use_lockfree_thread_cache(bool enabled);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -92,6 +92,12 @@ void aligned_free(void *ptr);
 extern bool leak_detector_has_run;
 extern char free_after_leak_detection_message[];
 
+/* Maximum size of blocks (including their #MemHead) allocated from the thread caches. */
+#define MEM_THREAD_CACHE_MAX_SIZE 512
+
+void *mem_thread_cache_alloc(size_t size);
+void mem_thread_cache_free(void *ptr, size_t size);
+
 void memory_usage_init(void);
 void memory_usage_block_alloc(size_t size);
 void memory_usage_block_free(size_t size);
@@ -31,18 +31,24 @@ typedef struct MemHeadAligned {
 } MemHeadAligned;
 
 static bool malloc_debug_memset = false;
+/* Only set on startup, before other threads allocate. */
+static bool use_thread_cache = false;
 
 static void (*error_callback)(const char *) = NULL;
 
 enum {
   MEMHEAD_ALIGN_FLAG = 1,
+  /* Block is allocated from the thread caches, see #MEM_use_lockfree_thread_cache. */
+  MEMHEAD_THREAD_CACHE_FLAG = 2,
 };
 
 #define MEMHEAD_FROM_PTR(ptr) (((MemHead *)ptr) - 1)
 #define PTR_FROM_MEMHEAD(memhead) (memhead + 1)
 #define MEMHEAD_ALIGNED_FROM_PTR(ptr) (((MemHeadAligned *)ptr) - 1)
 #define MEMHEAD_IS_ALIGNED(memhead) ((memhead)->len & (size_t)MEMHEAD_ALIGN_FLAG)
-#define MEMHEAD_LEN(memhead) ((memhead)->len & ~((size_t)(MEMHEAD_ALIGN_FLAG)))
+#define MEMHEAD_IS_THREAD_CACHED(memhead) ((memhead)->len & (size_t)MEMHEAD_THREAD_CACHE_FLAG)
+#define MEMHEAD_LEN(memhead) \
+  ((memhead)->len & ~((size_t)(MEMHEAD_ALIGN_FLAG | MEMHEAD_THREAD_CACHE_FLAG)))
 
 #ifdef __GNUC__
 __attribute__((format(printf, 1, 2)))
@@ -63,6 +69,31 @@ print_error(const char *str, ...)
   }
 }
 
+/**
+ * Allocate a block for a #MemHead followed by `len` bytes, from the thread caches for small
+ * blocks when they are enabled.
+ */
+MEM_INLINE MemHead *memhead_alloc(size_t len, bool zero)
+{
+  MemHead *memh;
+  if (use_thread_cache && len <= MEM_THREAD_CACHE_MAX_SIZE - sizeof(MemHead)) {
+    memh = (MemHead *)mem_thread_cache_alloc(len + sizeof(MemHead));
+    if (LIKELY(memh)) {
+      if (zero) {
+        memset(memh + 1, 0, len);
+      }
+      memh->len = len | (size_t)MEMHEAD_THREAD_CACHE_FLAG;
+    }
+    return memh;
+  }
+
+  memh = (MemHead *)(zero ? calloc(1, len + sizeof(MemHead)) : malloc(len + sizeof(MemHead)));
+  if (LIKELY(memh)) {
+    memh->len = len;
+  }
+  return memh;
+}
+
 size_t MEM_lockfree_allocN_len(const void *vmemh)
 {
   if (LIKELY(vmemh)) {
@@ -98,6 +129,9 @@ void MEM_lockfree_freeN(void *vmemh)
     MemHeadAligned *memh_aligned = MEMHEAD_ALIGNED_FROM_PTR(vmemh);
     aligned_free(MEMHEAD_REAL_PTR(memh_aligned));
   }
+  else if (MEMHEAD_IS_THREAD_CACHED(memh)) {
+    mem_thread_cache_free(memh, len + sizeof(MemHead));
+  }
   else {
     free(memh);
   }
@@ -205,10 +239,9 @@ void *MEM_lockfree_callocN(size_t len, const char *str)
 
   len = SIZET_ALIGN_4(len);
 
-  memh = (MemHead *)calloc(1, len + sizeof(MemHead));
+  memh = memhead_alloc(len, true);
 
   if (LIKELY(memh)) {
-    memh->len = len;
     memory_usage_block_alloc(len);
 
     return PTR_FROM_MEMHEAD(memh);
@@ -244,14 +277,13 @@ void *MEM_lockfree_mallocN(size_t len, const char *str)
 
   len = SIZET_ALIGN_4(len);
 
-  memh = (MemHead *)malloc(len + sizeof(MemHead));
+  memh = memhead_alloc(len, false);
 
   if (LIKELY(memh)) {
     if (UNLIKELY(malloc_debug_memset && len)) {
       memset(memh + 1, 255, len);
     }
 
-    memh->len = len;
     memory_usage_block_alloc(len);
 
     return PTR_FROM_MEMHEAD(memh);
@@ -375,6 +407,11 @@ void MEM_lockfree_set_memory_debug(void)
   malloc_debug_memset = true;
 }
 
+void MEM_use_lockfree_thread_cache(bool enabled)
+{
+  use_thread_cache = enabled;
+}
+
 size_t MEM_lockfree_get_memory_in_use(void)
 {
   return memory_usage_current();
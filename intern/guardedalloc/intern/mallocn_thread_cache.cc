@@ -0,0 +1,235 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup intern_mem
+ *
+ * Thread-local caches for small memory blocks, used by the lock-free allocator.
+ *
+ * Small blocks are grouped in size classes. Each thread keeps a list of free blocks per size
+ * class, so that most allocations and frees don't need any synchronization. Blocks are carved out
+ * of larger pages allocated from the system, and move between the thread caches and a global pool
+ * in batches. When a thread exits, the blocks in its cache are returned to the global pool.
+ *
+ * Pages are never returned to the system, freed blocks are only reused for new small allocations.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+
+#include "MEM_guardedalloc.h"
+#include "mallocn_intern.h"
+
+#include "../../source/blender/blenlib/BLI_strict_flags.h"
+
+namespace {
+
+constexpr size_t size_class_step = 16;
+constexpr int size_classes_num = int(MEM_THREAD_CACHE_MAX_SIZE / size_class_step);
+constexpr size_t page_size = 64 * 1024;
+
+struct FreeBlock {
+  FreeBlock *next;
+};
+
+struct FreeList {
+  FreeBlock *first = nullptr;
+  size_t num = 0;
+
+  void push(FreeBlock *block)
+  {
+    block->next = first;
+    first = block;
+    num++;
+  }
+
+  FreeBlock *pop()
+  {
+    FreeBlock *block = first;
+    first = block->next;
+    num--;
+    return block;
+  }
+};
+
+struct GlobalSizeClass {
+  std::mutex mutex;
+  FreeList free_list;
+};
+
+struct GlobalPool {
+  GlobalSizeClass size_classes[size_classes_num];
+};
+
+struct ThreadCache {
+  FreeList free_lists[size_classes_num];
+};
+
+enum class ThreadCacheState {
+  None,
+  Active,
+  /** The thread is exiting, the global pool has to be used directly. */
+  Destructed,
+};
+
+/** Returns the cached blocks to the global pool when the thread exits. */
+struct ThreadCacheFlusher {
+  ~ThreadCacheFlusher();
+};
+
+}  // namespace
+
+/* Both are trivially destructible, so they can still be accessed after #tls_cache_flusher has been
+ * destructed, while other thread-local variables are destructed. */
+static thread_local ThreadCacheState tls_cache_state = ThreadCacheState::None;
+static thread_local ThreadCache tls_cache;
+static thread_local ThreadCacheFlusher tls_cache_flusher;
+
+static GlobalPool &get_global_pool()
+{
+  /* Never destructed: blocks can still be freed while static variables are destructed on exit. It
+   * also can't be allocated with `new`, which may be overridden to use this allocator. */
+  alignas(GlobalPool) static char pool_buffer[sizeof(GlobalPool)];
+  static GlobalPool *pool = new (pool_buffer) GlobalPool();
+  return *pool;
+}
+
+static size_t size_class_block_size(const int size_class)
+{
+  return size_t(size_class + 1) * size_class_step;
+}
+
+/** Number of blocks moved at once between a thread cache and the global pool. */
+static size_t size_class_batch_num(const int size_class)
+{
+  return std::max<size_t>(page_size / 16 / size_class_block_size(size_class), 8);
+}
+
+/**
+ * Move up to `num` free blocks from the global pool to `r_list`. When the global pool has no free
+ * blocks, a new page is allocated and all its blocks are added to `r_list`.
+ */
+static void global_pool_take(const int size_class, const size_t num, FreeList &r_list)
+{
+  GlobalSizeClass &global = get_global_pool().size_classes[size_class];
+  {
+    std::lock_guard lock{global.mutex};
+    while (r_list.num < num && global.free_list.first != nullptr) {
+      r_list.push(global.free_list.pop());
+    }
+  }
+  if (r_list.num != 0) {
+    return;
+  }
+
+  char *page = static_cast<char *>(malloc(page_size));
+  if (page == nullptr) {
+    return;
+  }
+  const size_t block_size = size_class_block_size(size_class);
+  /* Push in reverse order, so that consecutive allocations are consecutive in memory. */
+  for (size_t offset = page_size - page_size % block_size; offset != 0; offset -= block_size) {
+    r_list.push(reinterpret_cast<FreeBlock *>(page + offset - block_size));
+  }
+}
+
+/** Move up to `num` free blocks from `list` to the global pool. */
+static void global_pool_put(const int size_class, const size_t num, FreeList &list)
+{
+  if (list.first == nullptr) {
+    return;
+  }
+  FreeBlock *first = list.first;
+  FreeBlock *last = first;
+  size_t moved_num = 1;
+  while (moved_num < num && last->next != nullptr) {
+    last = last->next;
+    moved_num++;
+  }
+  list.first = last->next;
+  list.num -= moved_num;
+
+  GlobalSizeClass &global = get_global_pool().size_classes[size_class];
+  std::lock_guard lock{global.mutex};
+  last->next = global.free_list.first;
+  global.free_list.first = first;
+  global.free_list.num += moved_num;
+}
+
+ThreadCacheFlusher::~ThreadCacheFlusher()
+{
+  for (int size_class = 0; size_class < size_classes_num; size_class++) {
+    FreeList &list = tls_cache.free_lists[size_class];
+    global_pool_put(size_class, list.num, list);
+  }
+  tls_cache_state = ThreadCacheState::Destructed;
+}
+
+static bool thread_cache_ensure()
+{
+  if (LIKELY(tls_cache_state == ThreadCacheState::Active)) {
+    return true;
+  }
+  if (tls_cache_state == ThreadCacheState::Destructed) {
+    return false;
+  }
+  /* Make sure the flusher is constructed, so that it is destructed on thread exit. */
+  (void)&tls_cache_flusher;
+  tls_cache_state = ThreadCacheState::Active;
+  return true;
+}
+
+static int size_class_from_size(const size_t size)
+{
+  assert(size != 0 && size <= MEM_THREAD_CACHE_MAX_SIZE);
+  return int((size - 1) / size_class_step);
+}
+
+void *mem_thread_cache_alloc(const size_t size)
+{
+  const int size_class = size_class_from_size(size);
+
+  if (UNLIKELY(!thread_cache_ensure())) {
+    FreeList list;
+    global_pool_take(size_class, 1, list);
+    if (list.first == nullptr) {
+      return nullptr;
+    }
+    FreeBlock *block = list.pop();
+    global_pool_put(size_class, list.num, list);
+    return block;
+  }
+
+  FreeList &list = tls_cache.free_lists[size_class];
+  if (UNLIKELY(list.first == nullptr)) {
+    global_pool_take(size_class, size_class_batch_num(size_class), list);
+    if (list.first == nullptr) {
+      return nullptr;
+    }
+  }
+  return list.pop();
+}
+
+void mem_thread_cache_free(void *ptr, const size_t size)
+{
+  const int size_class = size_class_from_size(size);
+  FreeBlock *block = static_cast<FreeBlock *>(ptr);
+
+  if (UNLIKELY(!thread_cache_ensure())) {
+    FreeList list;
+    list.push(block);
+    global_pool_put(size_class, 1, list);
+    return;
+  }
+
+  FreeList &list = tls_cache.free_lists[size_class];
+  list.push(block);
+  /* Avoid keeping too many blocks in a single thread, e.g. when one thread frees all the blocks
+   * allocated by other threads. */
+  const size_t batch_num = size_class_batch_num(size_class);
+  if (UNLIKELY(list.num > batch_num * 2)) {
+    global_pool_put(size_class, batch_num, list);
+  }
+}
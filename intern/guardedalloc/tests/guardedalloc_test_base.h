@@ -15,6 +15,19 @@ class LockFreeAllocatorTest : public ::testing::Test {
   }
 };
 
+class LockFreeThreadCacheAllocatorTest : public ::testing::Test {
+ protected:
+  virtual void SetUp()
+  {
+    MEM_use_lockfree_allocator();
+    MEM_use_lockfree_thread_cache(true);
+  }
+  virtual void TearDown()
+  {
+    MEM_use_lockfree_thread_cache(false);
+  }
+};
+
 class GuardedAllocatorTest : public ::testing::Test {
  protected:
   virtual void SetUp()
@@ -0,0 +1,102 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "MEM_guardedalloc.h"
+
+#include "guardedalloc_test_base.h"
+
+TEST_F(LockFreeThreadCacheAllocatorTest, SmallAndLargeBlocks)
+{
+  const size_t mem_in_use = MEM_get_memory_in_use();
+  const unsigned int blocks_in_use = MEM_get_memory_blocks_in_use();
+
+  std::vector<char *> blocks;
+  for (size_t len = 1; len < 1024; len++) {
+    char *mem = static_cast<char *>(MEM_mallocN(len, __func__));
+    EXPECT_GE(MEM_allocN_len(mem), len);
+    memset(mem, int(len & 255), len);
+    blocks.push_back(mem);
+  }
+  EXPECT_EQ(MEM_get_memory_blocks_in_use(), blocks_in_use + blocks.size());
+
+  for (size_t i = 0; i < blocks.size(); i++) {
+    const size_t len = i + 1;
+    EXPECT_EQ(blocks[i][len - 1], char(len & 255));
+    blocks[i] = static_cast<char *>(MEM_reallocN(blocks[i], len * 2));
+    EXPECT_EQ(blocks[i][len - 1], char(len & 255));
+  }
+  for (char *mem : blocks) {
+    MEM_freeN(mem);
+  }
+
+  EXPECT_EQ(MEM_get_memory_in_use(), mem_in_use);
+  EXPECT_EQ(MEM_get_memory_blocks_in_use(), blocks_in_use);
+}
+
+TEST_F(LockFreeThreadCacheAllocatorTest, Calloc)
+{
+  for (int iter = 0; iter < 2; iter++) {
+    std::vector<char *> blocks;
+    for (size_t len = 1; len < 512; len += 7) {
+      char *mem = static_cast<char *>(MEM_callocN(len, __func__));
+      for (size_t i = 0; i < len; i++) {
+        EXPECT_EQ(mem[i], 0);
+      }
+      /* Dirty the memory, to check that reused blocks are cleared again. */
+      memset(mem, 255, len);
+      blocks.push_back(mem);
+    }
+    for (char *mem : blocks) {
+      MEM_freeN(mem);
+    }
+  }
+}
+
+TEST_F(LockFreeThreadCacheAllocatorTest, SwitchWithBlocksInUse)
+{
+  MEM_use_lockfree_thread_cache(false);
+  void *mem_a = MEM_mallocN(32, __func__);
+  MEM_use_lockfree_thread_cache(true);
+  void *mem_b = MEM_mallocN(32, __func__);
+  MEM_use_lockfree_thread_cache(false);
+  MEM_freeN(mem_a);
+  MEM_freeN(mem_b);
+  MEM_use_lockfree_thread_cache(true);
+}
+
+TEST_F(LockFreeThreadCacheAllocatorTest, FreeFromOtherThread)
+{
+  const size_t mem_in_use = MEM_get_memory_in_use();
+  const unsigned int blocks_in_use = MEM_get_memory_blocks_in_use();
+
+  std::vector<void *> blocks(10000);
+  std::thread thread_alloc([&]() {
+    for (size_t i = 0; i < blocks.size(); i++) {
+      blocks[i] = MEM_mallocN(i % 300 + 1, __func__);
+    }
+  });
+  thread_alloc.join();
+
+  std::thread thread_free([&]() {
+    for (void *mem : blocks) {
+      MEM_freeN(mem);
+    }
+  });
+  thread_free.join();
+
+  EXPECT_EQ(MEM_get_memory_in_use(), mem_in_use);
+  EXPECT_EQ(MEM_get_memory_blocks_in_use(), blocks_in_use);
+
+  /* Blocks returned to the global pool on thread exit are reused. */
+  for (size_t i = 0; i < blocks.size(); i++) {
+    blocks[i] = MEM_mallocN(i % 300 + 1, __func__);
+  }
+  for (void *mem : blocks) {
+    MEM_freeN(mem);
+  }
+}
@@ -0,0 +1,114 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "MEM_guardedalloc.h"
+
+/* Compare small allocations with and without #MEM_use_lockfree_thread_cache. Every benchmark runs
+ * twice per mode, the second run reuses memory freed by the first one. */
+
+static double time_now()
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+template<typename Fn> static void thread_cache_compare(const char *id, const Fn &fn)
+{
+  printf("\n========== STARTING %s ==========\n", id);
+
+  MEM_use_lockfree_allocator();
+  const unsigned int blocks_in_use = MEM_get_memory_blocks_in_use();
+
+  for (const bool use_thread_cache : {false, true}) {
+    MEM_use_lockfree_thread_cache(use_thread_cache);
+    for (int run = 0; run < 2; run++) {
+      const double time_start = time_now();
+      fn();
+      printf("%s, run %d: %.4fs\n",
+             use_thread_cache ? "Thread cache" : "System",
+             run,
+             time_now() - time_start);
+    }
+  }
+  MEM_use_lockfree_thread_cache(false);
+
+  EXPECT_EQ(MEM_get_memory_blocks_in_use(), blocks_in_use);
+
+  printf("========== ENDED %s ==========\n\n", id);
+}
+
+/**
+ * Every thread allocates a few thousand blocks of varying size and frees them again, like
+ * temporary arrays and nodes created by the tasks of a parallel loop.
+ */
+static void alloc_then_free(const int threads_num, const int iterations_num)
+{
+  const int blocks_num = 2000;
+  std::vector<std::thread> threads;
+  for (int thread_index = 0; thread_index < threads_num; thread_index++) {
+    threads.emplace_back([&]() {
+      std::vector<void *> blocks(blocks_num);
+      for (int iter = 0; iter < iterations_num; iter++) {
+        for (int i = 0; i < blocks_num; i++) {
+          blocks[i] = MEM_mallocN(size_t((i * 13 + iter) % 256 + 8), __func__);
+        }
+        for (void *mem : blocks) {
+          MEM_freeN(mem);
+        }
+      }
+    });
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+}
+
+TEST(guardedalloc_thread_cache, AllocThenFreeSingleThread)
+{
+  thread_cache_compare("Alloc then free - 1 thread", []() { alloc_then_free(1, 400); });
+}
+
+TEST(guardedalloc_thread_cache, AllocThenFreeMultiThread)
+{
+  const int threads_num = std::max(int(std::thread::hardware_concurrency()), 2);
+  thread_cache_compare("Alloc then free - all threads",
+                       [&]() { alloc_then_free(threads_num, 400); });
+}
+
+/** Short lived allocations, every block is freed right after it was allocated. */
+TEST(guardedalloc_thread_cache, AllocFreePairs)
+{
+  thread_cache_compare("Alloc free pairs", []() {
+    for (int i = 0; i < 4000000; i++) {
+      void *mem_a = MEM_mallocN(size_t(i % 200 + 8), __func__);
+      void *mem_b = MEM_mallocN(64, __func__);
+      MEM_freeN(mem_a);
+      MEM_freeN(mem_b);
+    }
+  });
+}
+
+/**
+ * Millions of small blocks freed in random order. With both allocators the second run is slower,
+ * as it reuses blocks that are scattered in memory.
+ */
+TEST(guardedalloc_thread_cache, ManyBlocksRandomFree)
+{
+  thread_cache_compare("Many blocks, random free", []() {
+    const int64_t blocks_num = 4000000;
+    std::vector<void *> blocks(blocks_num);
+    for (void *&mem : blocks) {
+      mem = MEM_callocN(48, __func__);
+    }
+    for (int64_t i = 0; i < blocks_num; i++) {
+      MEM_freeN(blocks[(i * 7919) % blocks_num]);
+    }
+  });
+}
@@ -25,20 +25,202 @@
 #include <opensubdiv/osd/cpuPatchTable.h>
 #include <opensubdiv/osd/cpuVertexBuffer.h>
 
+#ifdef WITH_TBB
+#  include <tbb/blocked_range.h>
+#  include <tbb/parallel_for.h>
+#endif
+
 using OpenSubdiv::Far::StencilTable;
 using OpenSubdiv::Osd::CpuEvaluator;
 using OpenSubdiv::Osd::CpuVertexBuffer;
+using OpenSubdiv::Osd::PatchArray;
+using OpenSubdiv::Osd::PatchParam;
 
 namespace blender {
 namespace opensubdiv {
 
+// CPU evaluator which splits stencil and patch evaluation into blocks which are evaluated on
+// all available cores.
+//
+// Stencils are generated with factorized intermediate levels, so every stencil only refers to
+// the coarse control vertices and blocks of stencils can be evaluated independently.
+// Small batches of patch coordinates (the common case of a single-point limit evaluation done
+// from an already threaded subdivision loop) stay on the calling thread.
+class ThreadedCpuEvaluator : public CpuEvaluator {
+ public:
+  // Number of stencils evaluated by a single task.
+  static constexpr int kStencilsGrainSize = 1024;
+  // Number of patch coordinates evaluated by a single task.
+  static constexpr int kPatchCoordsGrainSize = 256;
+
+  template<typename SRC_BUFFER, typename DST_BUFFER, typename STENCIL_TABLE>
+  static bool EvalStencils(SRC_BUFFER *srcBuffer,
+                           BufferDescriptor const &srcDesc,
+                           DST_BUFFER *dstBuffer,
+                           BufferDescriptor const &dstDesc,
+                           STENCIL_TABLE const *stencilTable,
+                           const ThreadedCpuEvaluator * /*instance*/ = NULL,
+                           void * /*deviceContext*/ = NULL)
+  {
+    const int num_stencils = stencilTable->GetNumStencils();
+    if (num_stencils == 0) {
+      return false;
+    }
+    return evalStencilsBlocked(srcBuffer->BindCpuBuffer(),
+                               srcDesc,
+                               dstBuffer->BindCpuBuffer(),
+                               dstDesc,
+                               &stencilTable->GetSizes()[0],
+                               &stencilTable->GetOffsets()[0],
+                               &stencilTable->GetControlIndices()[0],
+                               &stencilTable->GetWeights()[0],
+                               num_stencils);
+  }
+
+  template<typename SRC_BUFFER,
+           typename DST_BUFFER,
+           typename PATCHCOORD_BUFFER,
+           typename PATCH_TABLE>
+  static bool EvalPatches(SRC_BUFFER *srcBuffer,
+                          BufferDescriptor const &srcDesc,
+                          DST_BUFFER *dstBuffer,
+                          BufferDescriptor const &dstDesc,
+                          int numPatchCoords,
+                          PATCHCOORD_BUFFER *patchCoords,
+                          PATCH_TABLE *patchTable,
+                          const ThreadedCpuEvaluator * /*instance*/ = NULL,
+                          void * /*deviceContext*/ = NULL)
+  {
+    const float *src = srcBuffer->BindCpuBuffer();
+    float *dst = dstBuffer->BindCpuBuffer();
+    const PatchCoord *patch_coords = (const PatchCoord *)patchCoords->BindCpuBuffer();
+    const PatchArray *patch_arrays = patchTable->GetPatchArrayBuffer();
+    const int *patch_index_buffer = patchTable->GetPatchIndexBuffer();
+    const PatchParam *patch_param_buffer = patchTable->GetPatchParamBuffer();
+    return parallelForPatchCoords(numPatchCoords, [&](const int start, const int end) {
+      BufferDescriptor block_dst_desc = dstDesc;
+      block_dst_desc.offset += start * dstDesc.stride;
+      return CpuEvaluator::EvalPatches(src,
+                                       srcDesc,
+                                       dst,
+                                       block_dst_desc,
+                                       end - start,
+                                       patch_coords + start,
+                                       patch_arrays,
+                                       patch_index_buffer,
+                                       patch_param_buffer);
+    });
+  }
+
+  template<typename SRC_BUFFER,
+           typename DST_BUFFER,
+           typename PATCHCOORD_BUFFER,
+           typename PATCH_TABLE>
+  static bool EvalPatches(SRC_BUFFER *srcBuffer,
+                          BufferDescriptor const &srcDesc,
+                          DST_BUFFER *dstBuffer,
+                          BufferDescriptor const &dstDesc,
+                          DST_BUFFER *duBuffer,
+                          BufferDescriptor const &duDesc,
+                          DST_BUFFER *dvBuffer,
+                          BufferDescriptor const &dvDesc,
+                          int numPatchCoords,
+                          PATCHCOORD_BUFFER *patchCoords,
+                          PATCH_TABLE *patchTable,
+                          const ThreadedCpuEvaluator * /*instance*/ = NULL,
+                          void * /*deviceContext*/ = NULL)
+  {
+    const float *src = srcBuffer->BindCpuBuffer();
+    float *dst = dstBuffer->BindCpuBuffer();
+    float *du = duBuffer->BindCpuBuffer();
+    float *dv = dvBuffer->BindCpuBuffer();
+    const PatchCoord *patch_coords = (const PatchCoord *)patchCoords->BindCpuBuffer();
+    const PatchArray *patch_arrays = patchTable->GetPatchArrayBuffer();
+    const int *patch_index_buffer = patchTable->GetPatchIndexBuffer();
+    const PatchParam *patch_param_buffer = patchTable->GetPatchParamBuffer();
+    return parallelForPatchCoords(numPatchCoords, [&](const int start, const int end) {
+      BufferDescriptor block_dst_desc = dstDesc;
+      BufferDescriptor block_du_desc = duDesc;
+      BufferDescriptor block_dv_desc = dvDesc;
+      block_dst_desc.offset += start * dstDesc.stride;
+      block_du_desc.offset += start * duDesc.stride;
+      block_dv_desc.offset += start * dvDesc.stride;
+      return CpuEvaluator::EvalPatches(src,
+                                       srcDesc,
+                                       dst,
+                                       block_dst_desc,
+                                       du,
+                                       block_du_desc,
+                                       dv,
+                                       block_dv_desc,
+                                       end - start,
+                                       patch_coords + start,
+                                       patch_arrays,
+                                       patch_index_buffer,
+                                       patch_param_buffer);
+    });
+  }
+
+ protected:
+  static bool evalStencilsBlocked(const float *src,
+                                  BufferDescriptor const &srcDesc,
+                                  float *dst,
+                                  BufferDescriptor const &dstDesc,
+                                  const int *sizes,
+                                  const int *offsets,
+                                  const int *indices,
+                                  const float *weights,
+                                  const int num_stencils)
+  {
+#ifdef WITH_TBB
+    if (num_stencils > kStencilsGrainSize) {
+      tbb::parallel_for(tbb::blocked_range<int>(0, num_stencils, kStencilsGrainSize),
+                        [&](const tbb::blocked_range<int> &range) {
+                          // The CPU kernel writes the first stencil of the range at the
+                          // beginning of the destination descriptor.
+                          BufferDescriptor block_dst_desc = dstDesc;
+                          block_dst_desc.offset += range.begin() * dstDesc.stride;
+                          CpuEvaluator::EvalStencils(src,
+                                                     srcDesc,
+                                                     dst,
+                                                     block_dst_desc,
+                                                     sizes,
+                                                     offsets,
+                                                     indices,
+                                                     weights,
+                                                     range.begin(),
+                                                     range.end());
+                        });
+      return true;
+    }
+#endif
+    return CpuEvaluator::EvalStencils(
+        src, srcDesc, dst, dstDesc, sizes, offsets, indices, weights, 0, num_stencils);
+  }
+
+  template<typename Function>
+  static bool parallelForPatchCoords(const int num_patch_coords, const Function &function)
+  {
+#ifdef WITH_TBB
+    if (num_patch_coords > kPatchCoordsGrainSize) {
+      tbb::parallel_for(tbb::blocked_range<int>(0, num_patch_coords, kPatchCoordsGrainSize),
+                        [&](const tbb::blocked_range<int> &range) {
+                          function(range.begin(), range.end());
+                        });
+      return true;
+    }
+#endif
+    return function(0, num_patch_coords);
+  }
+};
+
 // NOTE: Define as a class instead of typedef to make it possible
 // to have anonymous class in opensubdiv_evaluator_internal.h
 class CpuEvalOutput : public VolatileEvalOutput<CpuVertexBuffer,
                                                 CpuVertexBuffer,
                                                 StencilTable,
                                                 CpuPatchTable,
-                                                CpuEvaluator> {
+                                                ThreadedCpuEvaluator> {
  public:
   CpuEvalOutput(const StencilTable *vertex_stencils,
                 const StencilTable *varying_stencils,
@@ -50,7 +232,7 @@ class CpuEvalOutput : public VolatileEvalOutput<CpuVertexBuffer,
                            CpuVertexBuffer,
                            StencilTable,
                            CpuPatchTable,
-                           CpuEvaluator>(vertex_stencils,
+                           ThreadedCpuEvaluator>(vertex_stencils,
                                          varying_stencils,
                                          all_face_varying_stencils,
                                          face_varying_width,
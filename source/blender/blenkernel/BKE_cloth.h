@@ -30,6 +30,10 @@ struct Scene;
  * represented by a float, given its precision. */
 #define ALMOST_ZERO FLT_EPSILON
 
+/* Self collision pairs are found with bounds inflated by this factor of the self collision
+ * distance, so they can be reused while no vertex moved more than half of that margin. */
+#define CLOTH_SELFCOLL_MARGIN_FAC 1.0f
+
 /* Bits to or into the #ClothVertex.flags. */
 typedef enum eClothVertexFlag {
   CLOTH_VERT_FLAG_PINNED = (1 << 0),
@@ -81,6 +85,12 @@ typedef struct Cloth {
   float average_acceleration[3];  /* Moving average of overall acceleration. */
   const struct MEdge *edges;      /* Used for hair collisions. */
   struct EdgeSet *sew_edge_graph; /* Sewing edges represented using a GHash */
+
+  /* Self collision pairs cached across collision steps, see #cloth_bvh_collision. */
+  struct BVHTreeOverlap *selfcoll_overlap;
+  unsigned int selfcoll_overlap_num;
+  bool selfcoll_overlap_valid;
+  float (*selfcoll_overlap_co)[3]; /* Vertex positions when the pairs were found. */
 } Cloth;
 
 /**
@@ -215,6 +225,10 @@ int cloth_bvh_collision(struct Depsgraph *depsgraph,
                         float step,
                         float dt);
 
+/** Force the cached self collision pairs to be found again on the next collision step. */
+void cloth_bvh_selfcollision_cache_invalidate(struct Cloth *cloth);
+void cloth_bvh_selfcollision_cache_free(struct Cloth *cloth);
+
 /* -------------------------------------------------------------------- */
 /* cloth.cc */
 
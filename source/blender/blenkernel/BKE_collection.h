@@ -128,6 +128,19 @@ bool BKE_collection_viewlayer_object_add(struct Main *bmain,
                                          struct Collection *collection,
                                          struct Object *ob);
 
+/**
+ * Add several objects to given collection, similar to #BKE_collection_object_add.
+ *
+ * View layers are only re-synced, and the collection only tagged for depsgraph update, once for
+ * all objects. NULL objects and objects already in the collection are skipped.
+ *
+ * \return The number of objects added to the collection.
+ */
+int BKE_collection_object_add_multiple(struct Main *bmain,
+                                       struct Collection *collection,
+                                       struct Object **objects,
+                                       int objects_len);
+
 /**
  * Same as #BKE_collection_object_add, but unconditionally adds the object to the given collection.
  *
@@ -223,6 +223,19 @@ void CustomData_free(struct CustomData *data, int totelem);
  */
 void CustomData_free_typemask(struct CustomData *data, int totelem, eCustomDataMask mask);
 
+/**
+ * Keep the array of a layer allocated while it's used outside of Blender, such as a buffer
+ * exported to Python. Freeing or reallocating the layer leaves the array to the last
+ * #CustomData_layer_data_unpin call. Only for types without allocated elements.
+ */
+void CustomData_layer_data_pin(const void *data);
+void CustomData_layer_data_unpin(const void *data);
+/**
+ * \return true when the layer of a pinned array has been freed or reallocated since,
+ * so the array isn't used by Blender anymore.
+ */
+bool CustomData_layer_data_is_orphan(const void *data);
+
 /**
  * Frees all layers with #CD_FLAG_TEMPORARY.
  */
@@ -22,7 +22,9 @@ struct BMPartialUpdate;
 struct BMesh;
 struct BMeshCalcTessellation_Params;
 struct BoundBox;
+struct CustomData_MeshMasks;
 struct Depsgraph;
+struct EditMeshConvertCache;
 struct Mesh;
 struct Object;
 struct Scene;
@@ -67,6 +69,12 @@ typedef struct BMEditMesh {
    */
   char needs_flush_to_id;
 
+  /**
+   * Mesh converted for evaluation, kept while only parts of the edit-mesh change,
+   * see #BKE_editmesh_convert_cache_begin. Shared with shallow copies, owned by the original.
+   */
+  struct EditMeshConvertCache *convert_cache;
+
 } BMEditMesh;
 
 /* editmesh.cc */
@@ -125,6 +133,29 @@ void BKE_editmesh_lnorspace_update(BMEditMesh *em, struct Mesh *me);
 void BKE_editmesh_ensure_autosmooth(BMEditMesh *em, struct Mesh *me);
 struct BoundBox *BKE_editmesh_cage_boundbox_get(struct Object *object, BMEditMesh *em);
 
+/**
+ * Keep the result of converting the edit-mesh to a #Mesh for evaluation, so that following
+ * conversions only update the vertices tagged with #BKE_editmesh_convert_cache_tag_verts and the
+ * faces around them. Only use this while nothing else changes, like while transforming.
+ */
+void BKE_editmesh_convert_cache_begin(BMEditMesh *em);
+/**
+ * Tag vertices whose positions or custom data changed, along with the custom data of the faces
+ * and face corners around them.
+ */
+void BKE_editmesh_convert_cache_tag_verts(BMEditMesh *em, struct BMVert **verts, int verts_num);
+/**
+ * Stop keeping the converted mesh, following conversions convert the whole edit-mesh again.
+ */
+void BKE_editmesh_convert_cache_end(BMEditMesh *em);
+/**
+ * Same as #BM_mesh_bm_to_me_for_eval, but only updates the tagged elements of the cached
+ * conversion when #BKE_editmesh_convert_cache_begin was called.
+ */
+void BKE_editmesh_bm_to_me_for_eval(BMEditMesh *em,
+                                    struct Mesh *me,
+                                    const struct CustomData_MeshMasks *cd_mask_extra);
+
 #ifdef __cplusplus
 }
 #endif
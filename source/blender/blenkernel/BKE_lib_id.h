@@ -324,6 +324,16 @@ size_t BKE_id_multi_tagged_delete(struct Main *bmain) ATTR_NONNULL();
  * Add a 'NO_MAIN' data-block to given main (also sets user-counts of its IDs if needed).
  */
 void BKE_libblock_management_main_add(struct Main *bmain, void *idv);
+/**
+ * Add several 'NO_MAIN' data-blocks to given main at once.
+ *
+ * Same as calling #BKE_libblock_management_main_add for each of them, but new local IDs are
+ * sorted in their listbases in a single pass, instead of looking for the sorted position of each
+ * ID on insertion.
+ */
+void BKE_libblock_management_main_add_multiple(struct Main *bmain,
+                                               struct ID **ids,
+                                               int ids_len) ATTR_NONNULL();
 /** Remove a data-block from given main (set it to 'NO_MAIN' status). */
 void BKE_libblock_management_main_remove(struct Main *bmain, void *idv);
 
@@ -55,6 +55,19 @@ bool BKE_main_namemap_get_name(struct Main *bmain, struct ID *id, char *name) AT
 void BKE_main_namemap_remove_name(struct Main *bmain, struct ID *id, const char *name)
     ATTR_NONNULL();
 
+/**
+ * Find the ID of given type using given name, using the name maps as index.
+ *
+ * Local IDs are searched first, then linked ones, matching the order of IDs in Main listbases.
+ *
+ * \return false if the name maps cannot be used to answer the query (e.g. when they have not been
+ * created yet), in which case a regular search in the ID listbase is needed.
+ */
+bool BKE_main_namemap_find_id(struct Main *bmain,
+                              short id_type,
+                              const char *name,
+                              struct ID **r_id) ATTR_NONNULL();
+
 /**
  * Check that all ID names in given `bmain` are unique (per ID type and library), and that existing
  * name maps are consistent with existing relevant IDs.
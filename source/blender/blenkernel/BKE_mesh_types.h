@@ -182,9 +182,17 @@ struct MeshRuntime {
    */
   BitVector<> subsurf_optimal_display_edges;
 
+  /**
+   * Unique across all meshes and changed when the topology is tagged as changed. Copies with the
+   * same topology keep the value, so data derived from the topology can be cached with it.
+   */
+  uint64_t topology_version = next_topology_version();
+
   MeshRuntime() = default;
   ~MeshRuntime();
 
+  static uint64_t next_topology_version();
+
   MEM_CXX_CLASS_ALLOC_FUNCS("MeshRuntime")
 };
 
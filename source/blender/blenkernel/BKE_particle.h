@@ -94,6 +94,9 @@ typedef struct SPHData {
   /* Temporary thread-local buffer for springs created during this step. */
   BLI_Buffer new_springs;
 
+  /* Neighbor search grid for the particles of `psys[0]`, only valid during dynamics_step(). */
+  struct SPHGrid *grid;
+
   /* Integrator callbacks. This allows different SPH implementations. */
   void (*force_cb)(void *sphdata_v, ParticleKey *state, float *force, float *impulse);
   void (*density_cb)(void *rangedata_v, int index, const float co[3], float squared_dist);
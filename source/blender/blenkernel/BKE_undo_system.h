@@ -68,7 +68,10 @@ typedef struct UndoStep {
   struct UndoStep *next, *prev;
   char name[64];
   const struct UndoType *type;
-  /** Size in bytes of all data in step (not including the step). */
+  /**
+   * Size in bytes of all data in step (not including the step).
+   * May be updated from a background thread, read with #atomic_load_z.
+   */
   size_t data_size;
   /** Users should never see this step (only use for internal consistency). */
   bool skip;
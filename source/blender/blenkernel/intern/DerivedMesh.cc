@@ -27,6 +27,7 @@
 #include "BLI_math_vector_types.hh"
 #include "BLI_task.h"
 #include "BLI_task.hh"
+#include "BLI_task_trace.hh"
 #include "BLI_utildefines.h"
 #include "BLI_vector.hh"
 
@@ -625,7 +626,10 @@ static Mesh *modifier_modify_mesh_and_geometry_set(ModifierData *md,
     mesh_component.replace(input_mesh, GeometryOwnershipType::Editable);
 
     /* Let the modifier change the geometry set. */
-    mti->modifyGeometrySet(md, &mectx, &geometry_set);
+    {
+      blender::threading::trace::TraceRegion trace_region(mti->name);
+      mti->modifyGeometrySet(md, &mectx, &geometry_set);
+    }
 
     /* Release the mesh from the geometry set again. */
     if (geometry_set.has<MeshComponent>()) {
@@ -287,6 +287,9 @@ static int do_step_cloth(
   /* Support for dynamic vertex groups, changing from frame to frame */
   cloth_apply_vgroup(clmd, result);
 
+  /* Vertex flags affect which self collision pairs are found. */
+  cloth_bvh_selfcollision_cache_invalidate(cloth);
+
   if ((clmd->sim_parms->flags & CLOTH_SIMSETTINGS_FLAG_DYNAMIC_BASEMESH) ||
       (clmd->sim_parms->vgroup_shrink > 0) || (clmd->sim_parms->shrink_min != 0.0f)) {
     cloth_update_spring_lengths(clmd, result);
@@ -465,6 +468,8 @@ void cloth_free_modifier(ClothModifierData *clmd)
       BLI_bvhtree_free(cloth->bvhselftree);
     }
 
+    cloth_bvh_selfcollision_cache_free(cloth);
+
     /* we save our faces for collision objects */
     if (cloth->tri) {
       MEM_freeN(cloth->tri);
@@ -542,6 +547,8 @@ void cloth_free_modifier_extern(ClothModifierData *clmd)
       BLI_bvhtree_free(cloth->bvhselftree);
     }
 
+    cloth_bvh_selfcollision_cache_free(cloth);
+
     /* we save our faces for collision objects */
     if (cloth->tri) {
       MEM_freeN(cloth->tri);
@@ -822,12 +829,15 @@ static bool cloth_from_object(
 
   clmd->clothObject->bvhtree = bvhtree_build_from_cloth(clmd, clmd->coll_parms->epsilon);
 
-  if (compare_ff(clmd->coll_parms->selfepsilon, clmd->coll_parms->epsilon, 1e-6f)) {
+  /* Self collision pairs are cached across steps, using a tree with inflated bounds. */
+  const float self_epsilon = clmd->coll_parms->selfepsilon * (1.0f + CLOTH_SELFCOLL_MARGIN_FAC);
+
+  if (compare_ff(self_epsilon, clmd->coll_parms->epsilon, 1e-6f)) {
     /* Share the BVH tree if the epsilon is the same. */
     clmd->clothObject->bvhselftree = clmd->clothObject->bvhtree;
   }
   else {
-    clmd->clothObject->bvhselftree = bvhtree_build_from_cloth(clmd, clmd->coll_parms->selfepsilon);
+    clmd->clothObject->bvhselftree = bvhtree_build_from_cloth(clmd, self_epsilon);
   }
 
   return true;
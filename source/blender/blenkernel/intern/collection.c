@@ -64,8 +64,12 @@ static bool collection_child_add(Collection *parent,
                                  const int flag,
                                  const bool add_us);
 static bool collection_child_remove(Collection *parent, Collection *collection);
-static bool collection_object_add(
-    Main *bmain, Collection *collection, Object *ob, int flag, const bool add_us);
+static bool collection_object_add(Main *bmain,
+                                  Collection *collection,
+                                  Object *ob,
+                                  int flag,
+                                  const bool add_us,
+                                  const bool do_tag);
 
 static void collection_object_remove_no_gobject_hash(Main *bmain,
                                                      Collection *collection,
@@ -140,7 +144,7 @@ static void collection_copy_data(Main *bmain, ID *id_dst, const ID *id_src, cons
     collection_child_add(collection_dst, child->collection, flag, false);
   }
   LISTBASE_FOREACH (CollectionObject *, cob, &collection_src->gobject) {
-    collection_object_add(bmain, collection_dst, cob->ob, flag, false);
+    collection_object_add(bmain, collection_dst, cob->ob, flag, false, true);
   }
 }
 
@@ -593,7 +597,7 @@ bool BKE_collection_delete(Main *bmain, Collection *collection, bool hierarchy)
       /* Link child object into parent collections. */
       LISTBASE_FOREACH (CollectionParent *, cparent, &collection->runtime.parents) {
         Collection *parent = cparent->collection;
-        collection_object_add(bmain, parent, cob->ob, 0, true);
+        collection_object_add(bmain, parent, cob->ob, 0, true, true);
       }
 
       /* Remove child object. */
@@ -696,7 +700,7 @@ static Collection *collection_duplicate_recursive(Main *bmain,
         continue;
       }
 
-      collection_object_add(bmain, collection_new, ob_new, 0, true);
+      collection_object_add(bmain, collection_new, ob_new, 0, true, true);
       collection_object_remove(bmain, collection_new, ob_old, false);
     }
   }
@@ -1272,8 +1276,16 @@ static Collection *collection_parent_editable_find_recursive(const ViewLayer *vi
   return NULL;
 }
 
-static bool collection_object_add(
-    Main *bmain, Collection *collection, Object *ob, int flag, const bool add_us)
+/**
+ * \param do_tag: Tag the collection and its parents for a copy-on-write update,
+ * false when the caller tags them once after adding several objects.
+ */
+static bool collection_object_add(Main *bmain,
+                                  Collection *collection,
+                                  Object *ob,
+                                  int flag,
+                                  const bool add_us,
+                                  const bool do_tag)
 {
   if (ob->instance_collection) {
     /* Cyclic dependency check. */
@@ -1299,7 +1311,7 @@ static bool collection_object_add(
     id_us_plus(&ob->id);
   }
 
-  if ((flag & LIB_ID_CREATE_NO_MAIN) == 0) {
+  if (do_tag && (flag & LIB_ID_CREATE_NO_MAIN) == 0) {
     collection_tag_update_parent_recursive(bmain, collection, ID_RECALC_COPY_ON_WRITE);
   }
 
@@ -1361,7 +1373,7 @@ bool BKE_collection_object_add_notest(Main *bmain, Collection *collection, Objec
     return false;
   }
 
-  if (!collection_object_add(bmain, collection, ob, 0, true)) {
+  if (!collection_object_add(bmain, collection, ob, 0, true, true)) {
     return false;
   }
 
@@ -1397,6 +1409,49 @@ bool BKE_collection_viewlayer_object_add(Main *bmain,
   return BKE_collection_object_add_notest(bmain, collection, ob);
 }
 
+int BKE_collection_object_add_multiple(Main *bmain,
+                                       Collection *collection,
+                                       Object **objects,
+                                       const int objects_len)
+{
+  if (collection == NULL) {
+    return 0;
+  }
+
+  collection = collection_parent_editable_find_recursive(NULL, collection);
+
+  if (collection == NULL) {
+    return 0;
+  }
+
+  int added_len = 0;
+  for (int i = 0; i < objects_len; i++) {
+    Object *ob = objects[i];
+    if (ob == NULL) {
+      continue;
+    }
+    /* Skip the depsgraph tagging done for every object, it is done once below. */
+    if (!collection_object_add(bmain, collection, ob, 0, true, false)) {
+      continue;
+    }
+    added_len++;
+  }
+
+  if (added_len == 0) {
+    return 0;
+  }
+
+  collection_tag_update_parent_recursive(bmain, collection, ID_RECALC_COPY_ON_WRITE);
+
+  if (BKE_collection_is_in_scene(collection)) {
+    BKE_main_collection_sync(bmain);
+  }
+
+  DEG_id_tag_update(&collection->id, ID_RECALC_GEOMETRY);
+
+  return added_len;
+}
+
 void BKE_collection_object_add_from(Main *bmain, Scene *scene, Object *ob_src, Object *ob_dst)
 {
   bool is_instantiated = false;
@@ -1404,7 +1459,7 @@ void BKE_collection_object_add_from(Main *bmain, Scene *scene, Object *ob_src, O
   FOREACH_SCENE_COLLECTION_BEGIN (scene, collection) {
     if (!ID_IS_LINKED(collection) && !ID_IS_OVERRIDE_LIBRARY(collection) &&
         BKE_collection_has_object(collection, ob_src)) {
-      collection_object_add(bmain, collection, ob_dst, 0, true);
+      collection_object_add(bmain, collection, ob_dst, 0, true, true);
       is_instantiated = true;
     }
   }
@@ -1413,7 +1468,7 @@ void BKE_collection_object_add_from(Main *bmain, Scene *scene, Object *ob_src, O
   if (!is_instantiated) {
     /* In case we could not find any non-linked collections in which instantiate our ob_dst,
      * fallback to scene's master collection... */
-    collection_object_add(bmain, scene->master_collection, ob_dst, 0, true);
+    collection_object_add(bmain, scene->master_collection, ob_dst, 0, true, true);
   }
 
   BKE_main_collection_sync(bmain);
@@ -26,6 +26,7 @@
 #include "BKE_cloth.h"
 #include "BKE_collection.h"
 #include "BKE_effect.h"
+#include "BKE_global.h"
 #include "BKE_layer.h"
 #include "BKE_modifier.h"
 #include "BKE_scene.h"
@@ -37,6 +38,8 @@
 #include "DEG_depsgraph_physics.h"
 #include "DEG_depsgraph_query.h"
 
+#include "PIL_time.h"
+
 #ifdef WITH_ELTOPO
 #  include "eltopo-capi.h"
 #endif
@@ -1111,6 +1114,24 @@ static void cloth_selfcollision(void *__restrict userdata,
 
   BLI_assert(cloth_bvh_selfcollision_is_active(clmd, clmd->clothObject, tri_a, tri_b));
 
+  /* The pairs are found with inflated bounds and reused across steps, so many of them are
+   * further apart than the collision distance. The distance between the bounds of the
+   * triangles is a lower bound of their distance, which rejects those cheaply. */
+  float min_a[3], max_a[3], min_b[3], max_b[3];
+  INIT_MINMAX(min_a, max_a);
+  INIT_MINMAX(min_b, max_b);
+  for (int i = 0; i < 3; i++) {
+    minmax_v3v3_v3(min_a, max_a, verts1[tri_a->tri[i]].tx);
+    minmax_v3v3_v3(min_b, max_b, verts1[tri_b->tri[i]].tx);
+  }
+  const float max_distance = epsilon * 2.0f + ALMOST_ZERO;
+  for (int i = 0; i < 3; i++) {
+    if (min_a[i] - max_b[i] > max_distance || min_b[i] - max_a[i] > max_distance) {
+      collpair[index].flag = COLLISION_INACTIVE;
+      return;
+    }
+  }
+
   /* Compute distance and normal. */
   distance = compute_collision_point_tri_tri(verts1[tri_a->tri[0]].tx,
                                              verts1[tri_a->tri[1]].tx,
@@ -1557,6 +1578,69 @@ static bool cloth_bvh_self_overlap_cb(void *userdata, int index_a, int index_b,
   return false;
 }
 
+void cloth_bvh_selfcollision_cache_invalidate(Cloth *cloth)
+{
+  cloth->selfcoll_overlap_valid = false;
+}
+
+void cloth_bvh_selfcollision_cache_free(Cloth *cloth)
+{
+  MEM_SAFE_FREE(cloth->selfcoll_overlap);
+  MEM_SAFE_FREE(cloth->selfcoll_overlap_co);
+  cloth->selfcoll_overlap_num = 0;
+  cloth->selfcoll_overlap_valid = false;
+}
+
+/**
+ * The self collision tree is built with bounds inflated by a margin. Pairs found with it
+ * contain all pairs that would be found without the margin, as long as no vertex moved by
+ * more than half of the margin since then.
+ */
+static bool cloth_bvh_selfcollision_cache_is_valid(const ClothModifierData *clmd)
+{
+  const Cloth *cloth = clmd->clothObject;
+
+  if (!cloth->selfcoll_overlap_valid) {
+    return false;
+  }
+
+  /* The margin is derived from the tree, in case the settings changed since it was built. */
+  const float margin = BLI_bvhtree_get_epsilon(cloth->bvhselftree) -
+                       clmd->coll_parms->selfepsilon;
+  if (margin <= 0.0f) {
+    return false;
+  }
+
+  const float max_dist_sq = square_f(margin * 0.5f);
+  const ClothVertex *verts = cloth->verts;
+  for (uint i = 0; i < cloth->mvert_num; i++) {
+    if (len_squared_v3v3(verts[i].tx, cloth->selfcoll_overlap_co[i]) > max_dist_sq) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static void cloth_bvh_selfcollision_cache_update(ClothModifierData *clmd)
+{
+  Cloth *cloth = clmd->clothObject;
+
+  MEM_SAFE_FREE(cloth->selfcoll_overlap);
+  cloth->selfcoll_overlap = BLI_bvhtree_overlap_self(
+      cloth->bvhselftree, &cloth->selfcoll_overlap_num, cloth_bvh_self_overlap_cb, clmd);
+
+  if (cloth->selfcoll_overlap_co == nullptr) {
+    cloth->selfcoll_overlap_co = static_cast<float(*)[3]>(
+        MEM_malloc_arrayN(cloth->mvert_num, sizeof(float[3]), __func__));
+  }
+  for (uint i = 0; i < cloth->mvert_num; i++) {
+    copy_v3_v3(cloth->selfcoll_overlap_co[i], cloth->verts[i].tx);
+  }
+
+  cloth->selfcoll_overlap_valid = true;
+}
+
 int cloth_bvh_collision(
     Depsgraph *depsgraph, Object *ob, ClothModifierData *clmd, float step, float dt)
 {
@@ -1573,11 +1657,14 @@ int cloth_bvh_collision(
   uint coll_count_self = 0;
   BVHTreeOverlap *overlap_self = nullptr;
   bool bvh_updated = false;
+  bool selfcoll_cache_used = false;
 
   if ((clmd->sim_parms->flags & CLOTH_SIMSETTINGS_FLAG_COLLOBJ) || cloth_bvh == nullptr) {
     return 0;
   }
 
+  const double time_start = (G.debug & G_DEBUG_SIMDATA) ? PIL_check_seconds_timer() : 0.0;
+
   verts = cloth->verts;
   mvert_num = cloth->mvert_num;
 
@@ -1619,13 +1706,20 @@ int cloth_bvh_collision(
     }
   }
 
-  if (clmd->coll_parms->flags & CLOTH_COLLSETTINGS_FLAG_SELF) {
-    if (cloth->bvhselftree != cloth->bvhtree || !bvh_updated) {
-      bvhtree_update_from_cloth(clmd, false, true);
+  if ((clmd->coll_parms->flags & CLOTH_COLLSETTINGS_FLAG_SELF) && cloth->bvhselftree) {
+    selfcoll_cache_used = cloth_bvh_selfcollision_cache_is_valid(clmd);
+
+    if (!selfcoll_cache_used) {
+      if (cloth->bvhselftree != cloth->bvhtree || !bvh_updated) {
+        bvhtree_update_from_cloth(clmd, false, true);
+      }
+
+      cloth_bvh_selfcollision_cache_update(clmd);
     }
 
-    overlap_self = BLI_bvhtree_overlap_self(
-        cloth->bvhselftree, &coll_count_self, cloth_bvh_self_overlap_cb, clmd);
+    /* Owned by the cache. */
+    overlap_self = cloth->selfcoll_overlap;
+    coll_count_self = cloth->selfcoll_overlap_num;
   }
 
   do {
@@ -1720,9 +1814,20 @@ int cloth_bvh_collision(
     MEM_freeN(overlap_obj);
   }
 
-  MEM_SAFE_FREE(coll_counts_obj);
+  if (G.debug & G_DEBUG_SIMDATA) {
+    uint coll_count_obj = 0;
+    for (i = 0; coll_counts_obj && i < numcollobj; i++) {
+      coll_count_obj += coll_counts_obj[i];
+    }
+    printf("cloth_bvh_collision: %u object pairs, %u self pairs (%s), %d rounds, %.3f ms\n",
+           coll_count_obj,
+           coll_count_self,
+           selfcoll_cache_used ? "cached" : "updated",
+           rounds,
+           (PIL_check_seconds_timer() - time_start) * 1000.0);
+  }
 
-  MEM_SAFE_FREE(overlap_self);
+  MEM_SAFE_FREE(coll_counts_obj);
 
   BKE_collision_objects_free(collobjs);
 
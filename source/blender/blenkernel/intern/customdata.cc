@@ -8,6 +8,9 @@
  * BKE_customdata.h contains the function prototypes for this file.
  */
 
+#include <atomic>
+#include <mutex>
+
 #include "MEM_guardedalloc.h"
 
 /* Since we have versioning code here (CustomData_verify_versions()). */
@@ -23,6 +26,7 @@
 #include "BLI_index_range.hh"
 #include "BLI_math.h"
 #include "BLI_math_color_blend.h"
+#include "BLI_map.hh"
 #include "BLI_math_vector.hh"
 #include "BLI_mempool.h"
 #include "BLI_path_util.h"
@@ -60,6 +64,7 @@
 
 using blender::float2;
 using blender::IndexRange;
+using blender::Map;
 using blender::Set;
 using blender::Span;
 using blender::StringRef;
@@ -2153,6 +2158,83 @@ void customData_mask_layers__print(const CustomData_MeshMasks *mask)
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Pinned Layer Arrays
+ *
+ * Arrays exported outside of Blender stay allocated while they are pinned. Freeing or
+ * reallocating their layer leaves them "orphan", they are freed by the last unpin instead.
+ * \{ */
+
+struct PinnedLayerData {
+  int users;
+  /** The layer doesn't own the array anymore. */
+  bool is_orphan;
+};
+
+static std::mutex pinned_layer_data_mutex;
+/** Number of pins, avoids locking when freeing layers while nothing is pinned. */
+static std::atomic<int> pinned_layer_data_num = 0;
+
+static Map<const void *, PinnedLayerData> &pinned_layer_data_map()
+{
+  static Map<const void *, PinnedLayerData> map;
+  return map;
+}
+
+void CustomData_layer_data_pin(const void *data)
+{
+  BLI_assert(data != nullptr);
+  std::lock_guard lock{pinned_layer_data_mutex};
+  PinnedLayerData &pinned = pinned_layer_data_map().lookup_or_add(data, {0, false});
+  pinned.users++;
+  pinned_layer_data_num++;
+}
+
+void CustomData_layer_data_unpin(const void *data)
+{
+  std::lock_guard lock{pinned_layer_data_mutex};
+  PinnedLayerData *pinned = pinned_layer_data_map().lookup_ptr(data);
+  BLI_assert(pinned != nullptr);
+  pinned_layer_data_num--;
+  if (--pinned->users > 0) {
+    return;
+  }
+  if (pinned->is_orphan) {
+    MEM_freeN(const_cast<void *>(data));
+  }
+  pinned_layer_data_map().remove(data);
+}
+
+bool CustomData_layer_data_is_orphan(const void *data)
+{
+  std::lock_guard lock{pinned_layer_data_mutex};
+  const PinnedLayerData *pinned = pinned_layer_data_map().lookup_ptr(data);
+  BLI_assert(pinned != nullptr);
+  return pinned->is_orphan;
+}
+
+/**
+ * Call instead of freeing the array of a layer.
+ * \return true when the array is pinned and must not be freed.
+ */
+static bool customData_layer_data_orphan_if_pinned(const CustomDataLayer *layer)
+{
+  if (pinned_layer_data_num.load(std::memory_order_relaxed) == 0 || layer->data == nullptr) {
+    return false;
+  }
+  std::lock_guard lock{pinned_layer_data_mutex};
+  PinnedLayerData *pinned = pinned_layer_data_map().lookup_ptr(layer->data);
+  if (pinned == nullptr) {
+    return false;
+  }
+  /* Only arrays without allocated elements can be pinned. */
+  BLI_assert(layerType_getInfo(layer->type)->free == nullptr);
+  pinned->is_orphan = true;
+  return true;
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name CustomData Functions
  * \{ */
@@ -2321,7 +2403,7 @@ void CustomData_realloc(CustomData *data, const int old_size, const int new_size
 
     const int64_t old_size_in_bytes = int64_t(old_size) * typeInfo->size;
     const int64_t new_size_in_bytes = int64_t(new_size) * typeInfo->size;
-    if (layer->flag & CD_FLAG_NOFREE) {
+    if ((layer->flag & CD_FLAG_NOFREE) || customData_layer_data_orphan_if_pinned(layer)) {
       const void *old_data = layer->data;
       layer->data = MEM_malloc_arrayN(new_size, typeInfo->size, __func__);
       if (typeInfo->copy) {
@@ -2369,7 +2451,8 @@ static void customData_free_layer__internal(CustomDataLayer *layer, const int to
     layer->anonymous_id->user_remove();
     layer->anonymous_id = nullptr;
   }
-  if (!(layer->flag & CD_FLAG_NOFREE) && layer->data) {
+  if (!(layer->flag & CD_FLAG_NOFREE) && layer->data &&
+      !customData_layer_data_orphan_if_pinned(layer)) {
     typeInfo = layerType_getInfo(layer->type);
 
     if (typeInfo->free) {
@@ -11,8 +11,11 @@
 #include "DNA_mesh_types.h"
 #include "DNA_object_types.h"
 
+#include <mutex>
+
 #include "BLI_bitmap.h"
 #include "BLI_math.h"
+#include "BLI_vector_set.hh"
 
 #include "BKE_DerivedMesh.h"
 #include "BKE_customdata.h"
@@ -21,6 +24,7 @@
 #include "BKE_lib_id.h"
 #include "BKE_mesh.hh"
 #include "BKE_mesh_iterators.h"
+#include "BKE_mesh_runtime.h"
 #include "BKE_mesh_wrapper.h"
 #include "BKE_object.h"
 
@@ -47,6 +51,7 @@ BMEditMesh *BKE_editmesh_copy(BMEditMesh *em)
    * in that case it makes more sense to do the
    * tessellation only when/if that copy ends up getting used. */
   em_copy->looptris = nullptr;
+  em_copy->convert_cache = nullptr;
 
   /* Copy various settings. */
   em_copy->selectmode = em->selectmode;
@@ -168,6 +173,140 @@ void BKE_editmesh_looptri_and_normals_calc_with_partial(BMEditMesh *em, BMPartia
   BM_mesh_normals_update_with_partial_ex(em->bm, bmpinfo, &normals_params);
 }
 
+struct EditMeshConvertCache {
+  std::mutex mutex;
+  /** False when the cache isn't used, see #BKE_editmesh_convert_cache_begin. */
+  bool is_enabled = false;
+  /** The edit-mesh converted with #mask, null until the first conversion. */
+  Mesh *mesh = nullptr;
+  CustomData_MeshMasks mask;
+  /** Vertices changed since #mesh was converted. */
+  blender::VectorSet<BMVert *> tagged_verts;
+};
+
+static void editmesh_convert_cache_clear(EditMeshConvertCache &cache)
+{
+  if (cache.mesh) {
+    BKE_id_free(nullptr, cache.mesh);
+    cache.mesh = nullptr;
+  }
+  cache.tagged_verts.clear_and_shrink();
+}
+
+void BKE_editmesh_convert_cache_begin(BMEditMesh *em)
+{
+  BLI_assert(!em->is_shallow_copy);
+  /* Allocated once and kept until the edit-mesh is freed, shallow copies of the edit-mesh used
+   * by evaluated meshes may still point to it. */
+  if (em->convert_cache == nullptr) {
+    em->convert_cache = MEM_new<EditMeshConvertCache>(__func__);
+  }
+  EditMeshConvertCache &cache = *em->convert_cache;
+  std::lock_guard lock{cache.mutex};
+  editmesh_convert_cache_clear(cache);
+  cache.is_enabled = true;
+}
+
+void BKE_editmesh_convert_cache_tag_verts(BMEditMesh *em, BMVert **verts, const int verts_num)
+{
+  if (em->convert_cache == nullptr) {
+    return;
+  }
+  EditMeshConvertCache &cache = *em->convert_cache;
+  std::lock_guard lock{cache.mutex};
+  if (cache.mesh == nullptr) {
+    /* Everything is converted the next time anyway. */
+    return;
+  }
+  cache.tagged_verts.add_multiple(blender::Span<BMVert *>(verts, verts_num));
+}
+
+void BKE_editmesh_convert_cache_end(BMEditMesh *em)
+{
+  if (em->convert_cache == nullptr) {
+    return;
+  }
+  EditMeshConvertCache &cache = *em->convert_cache;
+  std::lock_guard lock{cache.mutex};
+  editmesh_convert_cache_clear(cache);
+  cache.is_enabled = false;
+}
+
+/** Update the cached conversion, converting everything when it can't be updated. */
+static void editmesh_convert_cache_update(BMEditMesh *em,
+                                          EditMeshConvertCache &cache,
+                                          const CustomData_MeshMasks *cd_mask_extra)
+{
+  using namespace blender;
+  BMesh *bm = em->bm;
+
+  CustomData_MeshMasks mask{};
+  if (cd_mask_extra) {
+    mask = *cd_mask_extra;
+  }
+
+  if (cache.mesh == nullptr || !CustomData_MeshMasks_are_matching(&cache.mask, &mask) ||
+      !CustomData_MeshMasks_are_matching(&mask, &cache.mask)) {
+    editmesh_convert_cache_clear(cache);
+    cache.mesh = BKE_mesh_new_nomain(0, 0, 0, 0);
+    BM_mesh_bm_to_me_for_eval(bm, cache.mesh, &mask);
+    cache.mask = mask;
+    return;
+  }
+
+  if (cache.tagged_verts.is_empty()) {
+    return;
+  }
+
+  /* Corner data is changed along with the vertices (UV correction while transforming for
+   * example), so all faces around the tagged vertices are updated too. */
+  VectorSet<BMFace *> faces;
+  for (BMVert *v : cache.tagged_verts) {
+    BMIter iter;
+    BMFace *f;
+    BM_ITER_ELEM (f, &iter, v, BM_FACES_OF_VERT) {
+      faces.add(f);
+    }
+  }
+
+  BM_mesh_bm_to_me_partial(bm, cache.mesh, cache.tagged_verts, faces);
+  cache.tagged_verts.clear();
+}
+
+void BKE_editmesh_bm_to_me_for_eval(BMEditMesh *em,
+                                    Mesh *me,
+                                    const CustomData_MeshMasks *cd_mask_extra)
+{
+  EditMeshConvertCache *cache = em->convert_cache;
+  if (cache == nullptr) {
+    BM_mesh_bm_to_me_for_eval(em->bm, me, cd_mask_extra);
+    return;
+  }
+
+  std::lock_guard lock{cache->mutex};
+  if (!cache->is_enabled) {
+    BM_mesh_bm_to_me_for_eval(em->bm, me, cd_mask_extra);
+    return;
+  }
+
+  editmesh_convert_cache_update(em, *cache, cd_mask_extra);
+
+  /* Copying the arrays is much cheaper than converting all elements again. */
+  const Mesh *src = cache->mesh;
+  BLI_assert(me->totvert == 0);
+  BKE_mesh_runtime_clear_geometry(me);
+  me->totvert = src->totvert;
+  me->totedge = src->totedge;
+  me->totface = 0;
+  me->totloop = src->totloop;
+  me->totpoly = src->totpoly;
+  CustomData_copy(&src->vdata, &me->vdata, CD_MASK_ALL, CD_DUPLICATE, me->totvert);
+  CustomData_copy(&src->edata, &me->edata, CD_MASK_ALL, CD_DUPLICATE, me->totedge);
+  CustomData_copy(&src->ldata, &me->ldata, CD_MASK_ALL, CD_DUPLICATE, me->totloop);
+  CustomData_copy(&src->pdata, &me->pdata, CD_MASK_ALL, CD_DUPLICATE, me->totpoly);
+  me->runtime->deformed_only = true;
+}
+
 void BKE_editmesh_free_data(BMEditMesh *em)
 {
 
@@ -175,6 +314,12 @@ void BKE_editmesh_free_data(BMEditMesh *em)
     MEM_freeN(em->looptris);
   }
 
+  if (em->convert_cache) {
+    editmesh_convert_cache_clear(*em->convert_cache);
+    MEM_delete(em->convert_cache);
+    em->convert_cache = nullptr;
+  }
+
   if (em->bm) {
     BM_mesh_free(em->bm);
   }
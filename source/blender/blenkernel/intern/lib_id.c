@@ -913,6 +913,85 @@ void BKE_libblock_management_main_add(Main *bmain, void *idv)
   BKE_lib_libblock_session_uuid_ensure(id);
 }
 
+static bool id_new_name_validate_no_sort(struct Main *bmain, ID *id, const char *tname);
+
+static int id_cmp_by_type_and_name(const void *a, const void *b)
+{
+  const ID *id_a = *(const ID **)a;
+  const ID *id_b = *(const ID **)b;
+  if (GS(id_a->name) != GS(id_b->name)) {
+    return GS(id_a->name) < GS(id_b->name) ? -1 : 1;
+  }
+  return BLI_strcasecmp(id_a->name, id_b->name);
+}
+
+void BKE_libblock_management_main_add_multiple(Main *bmain, ID **ids, const int ids_len)
+{
+  BLI_assert(bmain != NULL);
+
+  ID **ids_local = MEM_malloc_arrayN((size_t)ids_len, sizeof(*ids_local), __func__);
+  int ids_local_len = 0;
+
+  for (int i = 0; i < ids_len; i++) {
+    ID *id = ids[i];
+    /* Same as in #BKE_libblock_management_main_add, invalid IDs are skipped. */
+    if ((id->tag & LIB_TAG_NO_MAIN) == 0 || (id->tag & LIB_TAG_NOT_ALLOCATED) != 0) {
+      continue;
+    }
+    /* We cannot allow non-userrefcounting IDs in Main database! */
+    if ((id->tag & LIB_TAG_NO_USER_REFCOUNT) != 0) {
+      BKE_library_foreach_ID_link(bmain, id, libblock_management_us_plus, NULL, IDWALK_NOP);
+    }
+  }
+
+  BKE_main_lock(bmain);
+  for (int i = 0; i < ids_len; i++) {
+    ID *id = ids[i];
+    if ((id->tag & LIB_TAG_NO_MAIN) == 0 || (id->tag & LIB_TAG_NOT_ALLOCATED) != 0) {
+      continue;
+    }
+    if (ID_IS_LINKED(id)) {
+      /* Rare case, no need to optimize it. */
+      ListBase *lb = which_libbase(bmain, GS(id->name));
+      BLI_addtail(lb, id);
+      BKE_id_new_name_validate(bmain, lb, id, NULL, true);
+    }
+    else {
+      /* Only ensure unique names for now, local IDs are inserted in their listbases below. */
+      id_new_name_validate_no_sort(bmain, id, NULL);
+      ids_local[ids_local_len++] = id;
+    }
+    id->tag &= ~(LIB_TAG_NO_MAIN | LIB_TAG_NO_USER_REFCOUNT);
+    BKE_lib_libblock_session_uuid_ensure(id);
+  }
+
+  /* Sort all new local IDs once, and merge them in a single pass with the (already sorted) local
+   * IDs of their listbase, instead of looking for the insertion point of each ID. */
+  qsort(ids_local, (size_t)ids_local_len, sizeof(*ids_local), id_cmp_by_type_and_name);
+  for (int i = 0; i < ids_local_len;) {
+    const short id_type = GS(ids_local[i]->name);
+    ListBase *lb = which_libbase(bmain, id_type);
+    ID *id_iter = lb->first;
+    for (; i < ids_local_len && GS(ids_local[i]->name) == id_type; i++) {
+      ID *id = ids_local[i];
+      while (id_iter != NULL && !ID_IS_LINKED(id_iter) &&
+             BLI_strcasecmp(id_iter->name, id->name) <= 0) {
+        id_iter = id_iter->next;
+      }
+      if (id_iter != NULL) {
+        BLI_insertlinkbefore(lb, id_iter, id);
+      }
+      else {
+        BLI_addtail(lb, id);
+      }
+    }
+  }
+  bmain->is_memfile_undo_written = false;
+  BKE_main_unlock(bmain);
+
+  MEM_freeN(ids_local);
+}
+
 void BKE_libblock_management_main_remove(Main *bmain, void *idv)
 {
   ID *id = idv;
@@ -1353,6 +1432,11 @@ void *BKE_libblock_copy(Main *bmain, const ID *id)
 
 ID *BKE_libblock_find_name(struct Main *bmain, const short type, const char *name)
 {
+  ID *id;
+  if (BKE_main_namemap_find_id(bmain, type, name, &id)) {
+    return id;
+  }
+
   ListBase *lb = which_libbase(bmain, type);
   BLI_assert(lb != NULL);
   return BLI_findstring(lb, name, offsetof(ID, name) + 2);
@@ -1406,6 +1490,15 @@ void id_sort_by_name(ListBase *lb, ID *id, ID *id_sorting_hint)
     }
   }
 
+  /* Check if we can simply append the ID at the end of the list. This is the typical case when
+   * creating many IDs at once using increasing extension numbers, and avoids walking over a whole
+   * chunk of items for each of them. */
+  ID *id_last = lb->last;
+  if (id_last->lib == id->lib && BLI_strcasecmp(id_last->name, id->name) < 0) {
+    BLI_addtail(lb, id);
+    return;
+  }
+
   void *item_array[ID_SORT_STEP_SIZE];
   int item_array_index;
 
@@ -1481,19 +1574,16 @@ void id_sort_by_name(ListBase *lb, ID *id, ID *id_sorting_hint)
 #undef ID_SORT_STEP_SIZE
 }
 
-bool BKE_id_new_name_validate(
-    struct Main *bmain, ListBase *lb, ID *id, const char *tname, const bool do_linked_data)
+/**
+ * Ensure given ID has a unique name, without sorting it in its listbase.
+ *
+ * \return true if a new name had to be created.
+ */
+static bool id_new_name_validate_no_sort(struct Main *bmain, ID *id, const char *tname)
 {
   bool result = false;
   char name[MAX_ID_NAME - 2];
 
-  /* If library, don't rename (unless explicitly required), but do ensure proper sorting. */
-  if (!do_linked_data && ID_IS_LINKED(id)) {
-    id_sort_by_name(lb, id, NULL);
-
-    return result;
-  }
-
   /* if no name given, use name of current ID
    * else make a copy (tname args can be const) */
   if (tname == NULL) {
@@ -1515,6 +1605,20 @@ bool BKE_id_new_name_validate(
   result = BKE_main_namemap_get_name(bmain, id, name);
 
   strcpy(id->name + 2, name);
+  return result;
+}
+
+bool BKE_id_new_name_validate(
+    struct Main *bmain, ListBase *lb, ID *id, const char *tname, const bool do_linked_data)
+{
+  /* If library, don't rename (unless explicitly required), but do ensure proper sorting. */
+  if (!do_linked_data && ID_IS_LINKED(id)) {
+    id_sort_by_name(lb, id, NULL);
+
+    return false;
+  }
+
+  const bool result = id_new_name_validate_no_sort(bmain, id, tname);
   id_sort_by_name(lb, id, NULL);
   return result;
 }
@@ -1878,7 +1982,7 @@ void BLI_libblock_ensure_unique_name(Main *bmain, const char *name)
   }
 
   /* search for id */
-  idtest = BLI_findstring(lb, name + 2, offsetof(ID, name) + 2);
+  idtest = BKE_libblock_find_name(bmain, GS(name), name + 2);
   if (idtest != NULL && !ID_IS_LINKED(idtest)) {
     /* BKE_id_new_name_validate also takes care of sorting. */
     BKE_id_new_name_validate(bmain, lb, idtest, NULL, false);
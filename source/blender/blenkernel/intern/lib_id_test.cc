@@ -455,4 +455,66 @@ TEST(lib_id_main_unique_name, name_huge_number_suffix)
   EXPECT_TRUE(BKE_main_namemap_validate(ctx.bmain));
 }
 
+TEST(lib_id_main_find_name, local_ids_1)
+{
+  LibIDMainSortTestContext ctx;
+
+  ID *id_a = static_cast<ID *>(BKE_id_new(ctx.bmain, ID_OB, "OB_A"));
+  ID *id_b = static_cast<ID *>(BKE_id_new(ctx.bmain, ID_OB, "OB_B"));
+  ID *id_ca = static_cast<ID *>(BKE_id_new(ctx.bmain, ID_CA, "OB_A"));
+
+  EXPECT_EQ(BKE_libblock_find_name(ctx.bmain, ID_OB, "OB_A"), id_a);
+  EXPECT_EQ(BKE_libblock_find_name(ctx.bmain, ID_OB, "OB_B"), id_b);
+  EXPECT_EQ(BKE_libblock_find_name(ctx.bmain, ID_CA, "OB_A"), id_ca);
+  EXPECT_EQ(BKE_libblock_find_name(ctx.bmain, ID_OB, "OB_C"), nullptr);
+
+  BKE_libblock_rename(ctx.bmain, id_b, "OB_C");
+  EXPECT_EQ(BKE_libblock_find_name(ctx.bmain, ID_OB, "OB_B"), nullptr);
+  EXPECT_EQ(BKE_libblock_find_name(ctx.bmain, ID_OB, "OB_C"), id_b);
+
+  BKE_id_free(ctx.bmain, id_a);
+  EXPECT_EQ(BKE_libblock_find_name(ctx.bmain, ID_OB, "OB_A"), nullptr);
+
+  EXPECT_TRUE(BKE_main_namemap_validate(ctx.bmain));
+}
+
+TEST(lib_id_main_find_name, linked_ids_1)
+{
+  LibIDMainSortTestContext ctx;
+
+  Library *lib_a = static_cast<Library *>(BKE_id_new(ctx.bmain, ID_LI, "LI_A"));
+  ID *id_a = static_cast<ID *>(BKE_id_new(ctx.bmain, ID_OB, "OB_A"));
+  ID *id_b = static_cast<ID *>(BKE_id_new(ctx.bmain, ID_OB, "OB_B"));
+
+  change_lib(ctx.bmain, id_b, lib_a);
+  id_sort_by_name(&ctx.bmain->objects, id_b, nullptr);
+  EXPECT_EQ(BKE_libblock_find_name(ctx.bmain, ID_OB, "OB_B"), id_b);
+
+  /* Local IDs are found before linked ones. */
+  ID *id_b_local = static_cast<ID *>(BKE_id_new(ctx.bmain, ID_OB, "OB_B"));
+  EXPECT_STREQ(id_b_local->name + 2, "OB_B");
+  EXPECT_EQ(BKE_libblock_find_name(ctx.bmain, ID_OB, "OB_B"), id_b_local);
+  EXPECT_EQ(BKE_libblock_find_name(ctx.bmain, ID_OB, "OB_A"), id_a);
+
+  EXPECT_TRUE(BKE_main_namemap_validate(ctx.bmain));
+}
+
+TEST(lib_id_main_sort, append_many)
+{
+  LibIDMainSortTestContext ctx;
+
+  ID *id_prev = nullptr;
+  for (int i = 0; i < 1000; i++) {
+    ID *id = static_cast<ID *>(BKE_id_new(ctx.bmain, ID_OB, "OB"));
+    if (id_prev != nullptr) {
+      EXPECT_EQ(id_prev->next, id);
+    }
+    id_prev = id;
+  }
+  EXPECT_TRUE(ctx.bmain->objects.last == id_prev);
+  EXPECT_EQ(BKE_libblock_find_name(ctx.bmain, ID_OB, "OB.999"), id_prev);
+
+  EXPECT_TRUE(BKE_main_namemap_validate(ctx.bmain));
+}
+
 }  // namespace blender::bke::tests
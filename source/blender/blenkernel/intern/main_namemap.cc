@@ -156,8 +156,9 @@ struct UniqueName_Value {
 
 /* Tracking of names for a single ID type. */
 struct UniqueName_TypeMap {
-  /* Set of full names that are in use. */
-  Set<UniqueName_Key> full_names;
+  /* Full names that are in use, and the ID using them. This also serves as a name index for
+   * #BKE_main_namemap_find_id, to avoid linear searches in the ID listbases. */
+  Map<UniqueName_Key, ID *> full_names;
   /* For each base name (i.e. without numeric suffix), track the
    * numeric suffixes that are in use. */
   Map<UniqueName_Key, UniqueName_Value> base_name_to_num_suffix;
@@ -226,10 +227,11 @@ static void main_namemap_populate(UniqueName_Map *name_map, struct Main *bmain,
     UniqueName_TypeMap *type_map = name_map->find_by_type(GS(id->name));
     BLI_assert(type_map != nullptr);
 
-    /* Insert the full name into the set. */
+    /* Insert the full name into the map. In case of (invalid) duplicate names, the first ID in
+     * the listbase is kept, matching the behavior of a linear search. */
     UniqueName_Key key;
     BLI_strncpy(key.name, id->name + 2, MAX_NAME);
-    type_map->full_names.add(key);
+    type_map->full_names.add(key, id);
 
     /* Get the name and number parts ("name.number"). */
     int number = MIN_NUMBER;
@@ -299,7 +301,7 @@ bool BKE_main_namemap_get_name(struct Main *bmain, struct ID *id, char *name)
 
       if (!has_dup) {
         BLI_strncpy(key.name, name, MAX_NAME);
-        type_map->full_names.add(key);
+        type_map->full_names.add(key, id);
       }
       return is_name_changed;
     }
@@ -332,9 +334,9 @@ bool BKE_main_namemap_get_name(struct Main *bmain, struct ID *id, char *name)
      * in which case it will shorten the base name, and we'll start again. */
     BLI_assert(number_to_use >= MIN_NUMBER);
     if (id_name_final_build(name, key.name, base_name_len, number_to_use)) {
-      /* All good, add final name to the set. */
+      /* All good, add final name to the map. */
       BLI_strncpy(key.name, name, MAX_NAME);
-      type_map->full_names.add(key);
+      type_map->full_names.add(key, id);
       break;
     }
 
@@ -367,8 +369,14 @@ void BKE_main_namemap_remove_name(struct Main *bmain, struct ID *id, const char
   BLI_assert(type_map != nullptr);
 
   UniqueName_Key key;
-  /* Remove full name from the set. */
   BLI_strncpy(key.name, name, MAX_NAME);
+  ID **id_used_p = type_map->full_names.lookup_ptr(key);
+  if (id_used_p != nullptr && !ELEM(*id_used_p, id, nullptr)) {
+    /* The name is still used by another ID (only happens with invalid duplicate names), keep it
+     * registered for that one. */
+    return;
+  }
+  /* Remove full name from the map. */
   type_map->full_names.remove(key);
 
   int number = MIN_NUMBER;
@@ -385,6 +393,59 @@ void BKE_main_namemap_remove_name(struct Main *bmain, struct ID *id, const char
   val->mark_unused(number);
 }
 
+/* Find the ID using given name in the name map, if any. */
+static ID *main_namemap_find_id(UniqueName_Map *name_map,
+                                const short id_type,
+                                const UniqueName_Key &key)
+{
+  UniqueName_TypeMap *type_map = name_map->find_by_type(id_type);
+  BLI_assert(type_map != nullptr);
+  return type_map->full_names.lookup_default(key, nullptr);
+}
+
+bool BKE_main_namemap_find_id(struct Main *bmain,
+                              const short id_type,
+                              const char *name,
+                              struct ID **r_id)
+{
+  *r_id = nullptr;
+
+  /* Only use existing name maps, creating them here could happen while Main is still being
+   * filled (e.g. during file reading), leaving them out of sync. */
+  if (bmain->name_map == nullptr) {
+    return false;
+  }
+  if (strlen(name) >= MAX_NAME) {
+    /* No ID can use such a name. */
+    return true;
+  }
+
+  UniqueName_Key key;
+  BLI_strncpy(key.name, name, MAX_NAME);
+
+  /* Local IDs are sorted before linked ones in Main listbases. */
+  ID *id = main_namemap_find_id(bmain->name_map, id_type, key);
+  if (id == nullptr) {
+    LISTBASE_FOREACH (Library *, lib, &bmain->libraries) {
+      if (lib->runtime.name_map == nullptr) {
+        return false;
+      }
+      id = main_namemap_find_id(lib->runtime.name_map, id_type, key);
+      if (id != nullptr) {
+        break;
+      }
+    }
+  }
+
+  if (id != nullptr && (GS(id->name) != id_type || !STREQ(id->name + 2, name))) {
+    /* ID was renamed without updating the name map, let the caller do a regular search. */
+    return false;
+  }
+
+  *r_id = id;
+  return true;
+}
+
 struct Uniqueness_Key {
   char name[MAX_ID_NAME];
   Library *lib;
@@ -440,9 +501,9 @@ static bool main_namemap_validate_and_fix(Main *bmain, const bool do_fix)
       BLI_assert(type_map != nullptr);
 
       UniqueName_Key key_namemap;
-      /* Remove full name from the set. */
       BLI_strncpy(key_namemap.name, id_iter->name + 2, MAX_NAME);
-      if (!type_map->full_names.contains(key_namemap)) {
+      ID **id_namemap_p = type_map->full_names.lookup_ptr(key_namemap);
+      if (id_namemap_p == nullptr) {
         is_valid = false;
         CLOG_ERROR(&LOG,
                    "ID name '%s' (from library '%s') exists in current Main, but is not listed in "
@@ -450,6 +511,13 @@ static bool main_namemap_validate_and_fix(Main *bmain, const bool do_fix)
                    id_iter->name,
                    id_iter->lib != nullptr ? id_iter->lib->filepath : "<None>");
       }
+      else if (*id_namemap_p != id_iter) {
+        is_valid = false;
+        CLOG_ERROR(&LOG,
+                   "ID name '%s' (from library '%s') is listed in the namemap for another ID",
+                   id_iter->name,
+                   id_iter->lib != nullptr ? id_iter->lib->filepath : "<None>");
+      }
     }
   }
   FOREACH_MAIN_LISTBASE_END;
@@ -463,7 +531,7 @@ static bool main_namemap_validate_and_fix(Main *bmain, const bool do_fix)
            idcode = BKE_idtype_idcode_iter_step(&i)) {
         UniqueName_TypeMap *type_map = name_map->find_by_type(idcode);
         if (type_map != nullptr) {
-          for (const UniqueName_Key &id_name : type_map->full_names) {
+          for (const UniqueName_Key &id_name : type_map->full_names.keys()) {
             Uniqueness_Key key;
             *(reinterpret_cast<short *>(key.name)) = idcode;
             BLI_strncpy(key.name + 2, id_name.name, MAX_NAME);
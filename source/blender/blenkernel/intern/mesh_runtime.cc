@@ -94,6 +94,12 @@ static void free_batch_cache(MeshRuntime &mesh_runtime)
   }
 }
 
+uint64_t MeshRuntime::next_topology_version()
+{
+  static uint64_t version = 0;
+  return atomic_add_and_fetch_uint64(&version, 1);
+}
+
 MeshRuntime::~MeshRuntime()
 {
   free_mesh_eval(*this);
@@ -225,6 +231,7 @@ void BKE_mesh_runtime_clear_geometry(Mesh *mesh)
   if (mesh->runtime->shrinkwrap_data) {
     BKE_shrinkwrap_boundary_data_free(mesh->runtime->shrinkwrap_data);
   }
+  mesh->runtime->topology_version = MeshRuntime::next_topology_version();
 }
 
 void BKE_mesh_tag_edges_split(struct Mesh *mesh)
@@ -241,6 +248,7 @@ void BKE_mesh_tag_edges_split(struct Mesh *mesh)
   if (mesh->runtime->shrinkwrap_data) {
     BKE_shrinkwrap_boundary_data_free(mesh->runtime->shrinkwrap_data);
   }
+  mesh->runtime->topology_version = MeshRuntime::next_topology_version();
 }
 
 void BKE_mesh_tag_positions_changed(Mesh *mesh)
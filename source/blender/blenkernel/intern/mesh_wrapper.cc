@@ -118,7 +118,7 @@ void BKE_mesh_wrapper_ensure_mdata(Mesh *me)
         BLI_assert(me->runtime->edit_data != nullptr);
 
         BMEditMesh *em = me->edit_mesh;
-        BM_mesh_bm_to_me_for_eval(em->bm, me, &me->runtime->cd_mask_extra);
+        BKE_editmesh_bm_to_me_for_eval(em, me, &me->runtime->cd_mask_extra);
 
         /* Adding original index layers assumes that all BMesh mesh wrappers are created from
          * original edit mode meshes (the only case where adding original indices makes sense).
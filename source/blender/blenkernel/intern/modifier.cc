@@ -38,6 +38,7 @@
 #include "BLI_session_uuid.h"
 #include "BLI_string.h"
 #include "BLI_string_utils.h"
+#include "BLI_task_trace.hh"
 #include "BLI_utildefines.h"
 
 #include "BLT_translation.h"
@@ -993,6 +994,7 @@ struct Mesh *BKE_modifier_modify_mesh(ModifierData *md,
                                       struct Mesh *me)
 {
   const ModifierTypeInfo *mti = BKE_modifier_get_info(ModifierType(md->type));
+  blender::threading::trace::TraceRegion trace_region(mti->name);
 
   if (me->runtime->wrapper_type == ME_WRAPPER_TYPE_BMESH) {
     if ((mti->flags & eModifierTypeFlag_AcceptsBMesh) == 0) {
@@ -1013,6 +1015,7 @@ void BKE_modifier_deform_verts(ModifierData *md,
                                int numVerts)
 {
   const ModifierTypeInfo *mti = BKE_modifier_get_info(ModifierType(md->type));
+  blender::threading::trace::TraceRegion trace_region(mti->name);
   if (me && mti->dependsOnNormals && mti->dependsOnNormals(md)) {
     modwrap_dependsOnNormals(me);
   }
@@ -8,6 +8,7 @@
 
 #include <stddef.h>
 
+#include <limits.h>
 #include <math.h>
 #include <stdlib.h>
 #include <string.h>
@@ -1680,7 +1681,178 @@ typedef struct SPHRangeData {
   int use_size;
 } SPHRangeData;
 
+/* Neighbor search of the system's own particles uses a uniform grid over the positions at the
+ * start of the step, rebuilt every step. Cells are hashed into a table sized by the particle
+ * count, so memory stays bounded however far the particles spread out. Points are stored sorted
+ * by bucket, so the points of one cell are contiguous in memory. */
+typedef struct SPHGrid {
+  float inv_cell_size;
+  uint bucket_mask;
+  /** Start of every bucket in the arrays below, `bucket_mask + 2` items. */
+  int *bucket_start;
+  /** Particle index, position and cell of every point, sorted by bucket. */
+  int *index;
+  float (*co)[3];
+  int (*cell)[3];
+} SPHGrid;
+
+typedef struct SPHGridBuildData {
+  ParticleSystem *psys;
+  float cfra;
+  float inv_cell_size;
+  uint bucket_mask;
+  uint *point_bucket;
+  int (*point_cell)[3];
+} SPHGridBuildData;
+
+#define SPH_GRID_BUCKET_NONE UINT_MAX
+
+BLI_INLINE void sph_grid_cell(const float co[3], const float inv_cell_size, int r_cell[3])
+{
+  for (int i = 0; i < 3; i++) {
+    /* Clamp to keep the float to int conversion defined for far away particles. */
+    r_cell[i] = (int)floorf(clamp_f(co[i] * inv_cell_size, -1e9f, 1e9f));
+  }
+}
+
+BLI_INLINE uint sph_grid_bucket(const int cell[3], const uint bucket_mask)
+{
+  return (((uint)cell[0] * 73856093u) ^ ((uint)cell[1] * 19349663u) ^
+          ((uint)cell[2] * 83492791u)) &
+         bucket_mask;
+}
+
+/* Same particles and positions as #psys_update_particle_bvhtree. */
+static const float *sph_grid_point_co(const ParticleData *pa, const float cfra)
+{
+  if (pa->flag & (PARS_UNEXIST | PARS_NO_DISP) || pa->alive != PARS_ALIVE) {
+    return NULL;
+  }
+  return (pa->state.time == cfra) ? pa->prev_state.co : pa->state.co;
+}
+
+static void sph_grid_build_bucket_task_cb(void *__restrict userdata,
+                                          const int p,
+                                          const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  SPHGridBuildData *data = userdata;
+  const float *co = sph_grid_point_co(&data->psys->particles[p], data->cfra);
+
+  if (co == NULL) {
+    data->point_bucket[p] = SPH_GRID_BUCKET_NONE;
+    return;
+  }
+
+  sph_grid_cell(co, data->inv_cell_size, data->point_cell[p]);
+  data->point_bucket[p] = sph_grid_bucket(data->point_cell[p], data->bucket_mask);
+}
+
+static SPHGrid *sph_grid_build(ParticleSystem *psys, const float cfra, const float cell_size)
+{
+  const int totpart = psys->totpart;
+  SPHGrid *grid = MEM_callocN(sizeof(*grid), __func__);
+
+  /* Roughly two buckets per particle keeps unrelated cells from sharing buckets. */
+  grid->inv_cell_size = 1.0f / max_ff(cell_size, 1e-5f);
+  grid->bucket_mask = power_of_2_max_u((uint)max_ii(totpart, 1) * 2) - 1;
+  grid->bucket_start = MEM_calloc_arrayN(grid->bucket_mask + 2, sizeof(int), __func__);
+
+  SPHGridBuildData data = {
+      .psys = psys,
+      .cfra = cfra,
+      .inv_cell_size = grid->inv_cell_size,
+      .bucket_mask = grid->bucket_mask,
+      .point_bucket = MEM_malloc_arrayN(totpart, sizeof(uint), __func__),
+      .point_cell = MEM_malloc_arrayN(totpart, sizeof(int[3]), __func__),
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (totpart > 1024);
+  settings.min_iter_per_thread = 1024;
+  BLI_task_parallel_range(0, totpart, &data, sph_grid_build_bucket_task_cb, &settings);
+
+  /* Counting sort by bucket. This is kept serial so the points of a bucket stay in index order,
+   * which keeps the neighbor order (and with it the result) independent of threading. */
+  int totpoint = 0;
+  for (int p = 0; p < totpart; p++) {
+    if (data.point_bucket[p] != SPH_GRID_BUCKET_NONE) {
+      grid->bucket_start[data.point_bucket[p] + 1]++;
+      totpoint++;
+    }
+  }
+  for (uint b = 0; b <= grid->bucket_mask; b++) {
+    grid->bucket_start[b + 1] += grid->bucket_start[b];
+  }
+
+  grid->index = MEM_malloc_arrayN(max_ii(totpoint, 1), sizeof(int), __func__);
+  grid->co = MEM_malloc_arrayN(max_ii(totpoint, 1), sizeof(float[3]), __func__);
+  grid->cell = MEM_malloc_arrayN(max_ii(totpoint, 1), sizeof(int[3]), __func__);
+
+  int *bucket_fill = MEM_dupallocN(grid->bucket_start);
+  for (int p = 0; p < totpart; p++) {
+    const uint b = data.point_bucket[p];
+    if (b != SPH_GRID_BUCKET_NONE) {
+      const int i = bucket_fill[b]++;
+      grid->index[i] = p;
+      copy_v3_v3(grid->co[i], sph_grid_point_co(&psys->particles[p], cfra));
+      copy_v3_v3_int(grid->cell[i], data.point_cell[p]);
+    }
+  }
+
+  MEM_freeN(bucket_fill);
+  MEM_freeN(data.point_bucket);
+  MEM_freeN(data.point_cell);
+
+  return grid;
+}
+
+static void sph_grid_free(SPHGrid *grid)
+{
+  MEM_freeN(grid->bucket_start);
+  MEM_freeN(grid->index);
+  MEM_freeN(grid->co);
+  MEM_freeN(grid->cell);
+  MEM_freeN(grid);
+}
+
+/* Same callback arguments and distance test as #BLI_bvhtree_range_query. */
+static void sph_grid_range_query(const SPHGrid *grid,
+                                 const float co[3],
+                                 const float radius,
+                                 BVHTree_RangeQuery callback,
+                                 void *userdata)
+{
+  const float radius_sq = radius * radius;
+  float co_min[3], co_max[3];
+  int cell_min[3], cell_max[3], cell[3];
+
+  add_v3_v3v3(co_max, co, (const float[3]){radius, radius, radius});
+  sub_v3_v3v3(co_min, co, (const float[3]){radius, radius, radius});
+  sph_grid_cell(co_min, grid->inv_cell_size, cell_min);
+  sph_grid_cell(co_max, grid->inv_cell_size, cell_max);
+
+  for (cell[0] = cell_min[0]; cell[0] <= cell_max[0]; cell[0]++) {
+    for (cell[1] = cell_min[1]; cell[1] <= cell_max[1]; cell[1]++) {
+      for (cell[2] = cell_min[2]; cell[2] <= cell_max[2]; cell[2]++) {
+        const uint b = sph_grid_bucket(cell, grid->bucket_mask);
+        for (int i = grid->bucket_start[b]; i < grid->bucket_start[b + 1]; i++) {
+          /* Skip points of other cells that hash to the same bucket. */
+          if (!equals_v3v3_int(grid->cell[i], cell)) {
+            continue;
+          }
+          const float dist_sq = len_squared_v3v3(co, grid->co[i]);
+          if (dist_sq < radius_sq) {
+            callback(userdata, grid->index[i], co, dist_sq);
+          }
+        }
+      }
+    }
+  }
+}
+
 static void sph_evaluate_func(BVHTree *tree,
+                              const SPHGrid *grid,
                               ParticleSystem **psys,
                               const float co[3],
                               SPHRangeData *pfr,
@@ -1701,6 +1873,11 @@ static void sph_evaluate_func(BVHTree *tree,
       break;
     }
 
+    if (i == 0 && grid) {
+      sph_grid_range_query(grid, co, interaction_radius, callback, pfr);
+      continue;
+    }
+
     BLI_rw_mutex_lock(&psys_bvhtree_rwlock, THREAD_LOCK_READ);
 
     BLI_bvhtree_range_query(psys[i]->bvhtree, co, interaction_radius, callback, pfr);
@@ -1825,7 +2002,8 @@ static void sph_force_cb(void *sphdata_v, ParticleKey *state, float *force, floa
   pfr.pa = pa;
   pfr.mass = sphdata->mass;
 
-  sph_evaluate_func(NULL, psys, state->co, &pfr, interaction_radius, sph_density_accum_cb);
+  sph_evaluate_func(
+      NULL, sphdata->grid, psys, state->co, &pfr, interaction_radius, sph_density_accum_cb);
 
   density = data[0];
   near_density = data[1];
@@ -2017,8 +2195,13 @@ static void sphclassical_force_cb(void *sphdata_v,
   pfr.h = h;
   pfr.pa = pa;
 
-  sph_evaluate_func(
-      NULL, psys, state->co, &pfr, interaction_radius, sphclassical_neighbor_accum_cb);
+  sph_evaluate_func(NULL,
+                    sphdata->grid,
+                    psys,
+                    state->co,
+                    &pfr,
+                    interaction_radius,
+                    sphclassical_neighbor_accum_cb);
   pressure = stiffness * (pow7f(pa->sphdensity / rest_density) - 1.0f);
 
   /* Multiply by mass so that we return a force, not acceleration. */
@@ -2101,8 +2284,13 @@ static void sphclassical_calc_dens(ParticleData *pa, float UNUSED(dfra), SPHData
   pfr.pa = pa;
   pfr.mass = sphdata->mass;
 
-  sph_evaluate_func(
-      NULL, psys, pa->state.co, &pfr, interaction_radius, sphclassical_density_accum_cb);
+  sph_evaluate_func(NULL,
+                    sphdata->grid,
+                    psys,
+                    pa->state.co,
+                    &pfr,
+                    interaction_radius,
+                    sphclassical_density_accum_cb);
   pa->sphdensity = min_ff(max_ff(data[0], fluid->rest_density * 0.9f), fluid->rest_density * 1.1f);
 }
 
@@ -2131,6 +2319,7 @@ void psys_sph_init(ParticleSimulationData *sim, SPHData *sphdata)
    * completeness we give them default values now. */
   sphdata->pa = NULL;
   sphdata->mass = 1.0f;
+  sphdata->grid = NULL;
 
   if (sim->psys->part->fluid->solver == SPH_SOLVER_DDR) {
     sphdata->force_cb = sph_force_cb;
@@ -2163,6 +2352,10 @@ void psys_sph_finalize(SPHData *sphdata)
     BLI_edgehash_free(sphdata->eh, NULL);
     sphdata->eh = NULL;
   }
+  if (sphdata->grid) {
+    sph_grid_free(sphdata->grid);
+    sphdata->grid = NULL;
+  }
 }
 
 void psys_sph_density(BVHTree *tree, SPHData *sphdata, float co[3], float vars[2])
@@ -2180,7 +2373,8 @@ void psys_sph_density(BVHTree *tree, SPHData *sphdata, float co[3], float vars[2
   pfr.h = interaction_radius * sphdata->hfac;
   pfr.mass = sphdata->mass;
 
-  sph_evaluate_func(tree, psys, co, &pfr, interaction_radius, sphdata->density_cb);
+  sph_evaluate_func(
+      tree, sphdata->grid, psys, co, &pfr, interaction_radius, sphdata->density_cb);
 
   vars[0] = pfr.data[0];
   vars[1] = pfr.data[1];
@@ -2383,6 +2577,8 @@ static void basic_rotate(ParticleSettings *part, ParticleData *pa, float dfra, f
 #define COLLISION_MIN_DISTANCE 0.0001f
 #define COLLISION_ZERO 0.00001f
 #define COLLISION_INIT_STEP 0.00008f
+/* Number of particles tested against one collider at a time, see #collision_check_batch. */
+#define PARTICLE_COLLISION_BATCH_SIZE 64
 typedef float (*NRDistanceFunc)(float *p, float radius, ParticleCollisionElement *pce, float *nor);
 static float nr_signed_distance_to_plane(float *p,
                                          float radius,
@@ -2813,22 +3009,12 @@ void BKE_psys_collision_neartest_cb(void *userdata,
     col->hit = col->current;
   }
 }
-static int collision_detect(ParticleData *pa,
-                            ParticleCollision *col,
-                            BVHTreeRayHit *hit,
-                            ListBase *colliders)
+/* Start a new collision query along the particle path from `co1` to `co2`. */
+static void collision_detect_begin(ParticleCollision *col, BVHTreeRayHit *hit, float r_ray_dir[3])
 {
-  const int raycast_flag = BVH_RAYCAST_DEFAULT & ~(BVH_RAYCAST_WATERTIGHT);
-  ColliderCache *coll;
-  float ray_dir[3];
-
-  if (BLI_listbase_is_empty(colliders)) {
-    return 0;
-  }
-
-  sub_v3_v3v3(ray_dir, col->co2, col->co1);
+  sub_v3_v3v3(r_ray_dir, col->co2, col->co1);
   hit->index = -1;
-  hit->dist = col->original_ray_length = normalize_v3(ray_dir);
+  hit->dist = col->original_ray_length = normalize_v3(r_ray_dir);
   col->pce.inside = 0;
 
   /* even if particle is stationary we want to check for moving colliders */
@@ -2836,48 +3022,75 @@ static int collision_detect(ParticleData *pa,
   if (hit->dist == 0.0f) {
     hit->dist = col->original_ray_length = 0.000001f;
   }
+}
 
-  for (coll = colliders->first; coll; coll = coll->next) {
-    /* for boids: don't check with current ground object; also skip if permeated */
-    bool skip = false;
+/* Test the particle path against a single collider, `hit` keeps the nearest collision. */
+static void collision_detect_collider(ParticleData *pa,
+                                      ParticleCollision *col,
+                                      BVHTreeRayHit *hit,
+                                      ColliderCache *coll,
+                                      const float ray_dir[3])
+{
+  const int raycast_flag = BVH_RAYCAST_DEFAULT & ~(BVH_RAYCAST_WATERTIGHT);
 
-    for (int i = 0; i < col->skip_count; i++) {
-      if (coll->ob == col->skip[i]) {
-        skip = true;
-        break;
-      }
+  /* for boids: don't check with current ground object; also skip if permeated */
+  for (int i = 0; i < col->skip_count; i++) {
+    if (coll->ob == col->skip[i]) {
+      return;
     }
+  }
 
-    if (skip) {
-      continue;
-    }
+  /* particles should not collide with emitter at birth */
+  if (coll->ob == col->emitter && pa->time < col->cfra && pa->time >= col->old_cfra) {
+    return;
+  }
 
-    /* particles should not collide with emitter at birth */
-    if (coll->ob == col->emitter && pa->time < col->cfra && pa->time >= col->old_cfra) {
-      continue;
-    }
+  col->current = coll->ob;
+  col->md = coll->collmd;
+  col->fac1 = (col->old_cfra - coll->collmd->time_x) /
+              (coll->collmd->time_xnew - coll->collmd->time_x);
+  col->fac2 = (col->cfra - coll->collmd->time_x) /
+              (coll->collmd->time_xnew - coll->collmd->time_x);
 
-    col->current = coll->ob;
-    col->md = coll->collmd;
-    col->fac1 = (col->old_cfra - coll->collmd->time_x) /
-                (coll->collmd->time_xnew - coll->collmd->time_x);
-    col->fac2 = (col->cfra - coll->collmd->time_x) /
-                (coll->collmd->time_xnew - coll->collmd->time_x);
+  if (col->md && col->md->bvhtree) {
+    BLI_bvhtree_ray_cast_ex(col->md->bvhtree,
+                            col->co1,
+                            ray_dir,
+                            col->radius,
+                            hit,
+                            BKE_psys_collision_neartest_cb,
+                            col,
+                            raycast_flag);
+  }
+}
 
-    if (col->md && col->md->bvhtree) {
-      BLI_bvhtree_ray_cast_ex(col->md->bvhtree,
-                              col->co1,
-                              ray_dir,
-                              col->radius,
-                              hit,
-                              BKE_psys_collision_neartest_cb,
-                              col,
-                              raycast_flag);
-    }
+static int collision_detect(ParticleData *pa,
+                            ParticleCollision *col,
+                            BVHTreeRayHit *hit,
+                            ListBase *colliders)
+{
+  ColliderCache *coll;
+  float ray_dir[3];
+
+  if (BLI_listbase_is_empty(colliders)) {
+    return 0;
+  }
+
+  collision_detect_begin(col, hit, ray_dir);
+
+  for (coll = colliders->first; coll; coll = coll->next) {
+    collision_detect_collider(pa, col, hit, coll, ray_dir);
   }
 
   return hit->index >= 0;
 }
+/* The random number generator is NULL when particles are stepped multi-threaded, none of the
+ * colliders use randomized settings in that case. */
+BLI_INLINE float collision_rng_get_float(RNG *rng)
+{
+  return rng ? BLI_rng_get_float(rng) : 0.5f;
+}
+
 static int collision_response(ParticleSimulationData *sim,
                               ParticleData *pa,
                               ParticleCollision *col,
@@ -2899,7 +3112,7 @@ static int collision_response(ParticleSimulationData *sim,
   /* time left after collision (in seconds) */
   float dt2 = (1.0f - f) * col->total_time;
   /* did particle pass through the collision surface? */
-  int through = (BLI_rng_get_float(rng) < pd->pdef_perm) ? 1 : 0;
+  int through = (collision_rng_get_float(rng) < pd->pdef_perm) ? 1 : 0;
 
   /* calculate exact collision location */
   interp_v3_v3v3(co, col->co1, col->co2, x);
@@ -2928,8 +3141,8 @@ static int collision_response(ParticleSimulationData *sim,
   /* tangential component of collision surface velocity */
   float vc_tan[3];
   float v0_dot, vc_dot;
-  float damp = pd->pdef_damp + pd->pdef_rdamp * 2 * (BLI_rng_get_float(rng) - 0.5f);
-  float frict = pd->pdef_frict + pd->pdef_rfrict * 2 * (BLI_rng_get_float(rng) - 0.5f);
+  float damp = pd->pdef_damp + pd->pdef_rdamp * 2 * (collision_rng_get_float(rng) - 0.5f);
+  float frict = pd->pdef_frict + pd->pdef_rfrict * 2 * (collision_rng_get_float(rng) - 0.5f);
   float distance, nor[3], dot;
 
   CLAMP(damp, 0.0f, 1.0f);
@@ -3094,74 +3307,127 @@ static void collision_fail(ParticleData *pa, ParticleCollision *col)
   // printf("max iterations\n");
 }
 
-/* Particle - Mesh collision detection and response
- * Features:
- * -friction and damping
- * -angular momentum <-> linear momentum
- * -high accuracy by re-applying particle acceleration after collision
- * -handles moving, rotating and deforming meshes
- * -uses Newton-Rhapson iteration to find the collisions
- * -handles spherical particles and (nearly) point like particles
- */
-static void collision_check(ParticleSimulationData *sim, int p, float dfra, float cfra)
+static void collision_check_init(
+    ParticleSimulationData *sim, int p, float dfra, float cfra, ParticleCollision *col)
 {
   ParticleSettings *part = sim->psys->part;
   ParticleData *pa = sim->psys->particles + p;
-  ParticleCollision col;
-  BVHTreeRayHit hit;
-  int collision_count = 0;
 
   float timestep = psys_get_timestep(sim);
 
-  memset(&col, 0, sizeof(ParticleCollision));
+  memset(col, 0, sizeof(ParticleCollision));
 
-  col.total_time = timestep * dfra;
-  col.inv_total_time = 1.0f / col.total_time;
-  col.inv_timestep = 1.0f / timestep;
+  col->total_time = timestep * dfra;
+  col->inv_total_time = 1.0f / col->total_time;
+  col->inv_timestep = 1.0f / timestep;
 
-  col.cfra = cfra;
-  col.old_cfra = sim->psys->cfra;
+  col->cfra = cfra;
+  col->old_cfra = sim->psys->cfra;
 
   /* Get acceleration (from gravity, force-fields etc. to be re-applied in collision response). */
-  sub_v3_v3v3(col.acc, pa->state.vel, pa->prev_state.vel);
-  mul_v3_fl(col.acc, 1.0f / col.total_time);
+  sub_v3_v3v3(col->acc, pa->state.vel, pa->prev_state.vel);
+  mul_v3_fl(col->acc, 1.0f / col->total_time);
 
   /* set values for first iteration */
-  copy_v3_v3(col.co1, pa->prev_state.co);
-  copy_v3_v3(col.co2, pa->state.co);
-  copy_v3_v3(col.ve1, pa->prev_state.vel);
-  copy_v3_v3(col.ve2, pa->state.vel);
-  col.f = 0.0f;
+  copy_v3_v3(col->co1, pa->prev_state.co);
+  copy_v3_v3(col->co2, pa->state.co);
+  copy_v3_v3(col->ve1, pa->prev_state.vel);
+  copy_v3_v3(col->ve2, pa->state.vel);
+  col->f = 0.0f;
 
-  col.radius = ((part->flag & PART_SIZE_DEFL) || (part->phystype == PART_PHYS_BOIDS)) ?
-                   pa->size :
-                   COLLISION_MIN_RADIUS;
+  col->radius = ((part->flag & PART_SIZE_DEFL) || (part->phystype == PART_PHYS_BOIDS)) ?
+                    pa->size :
+                    COLLISION_MIN_RADIUS;
 
   /* override for boids */
   if (part->phystype == PART_PHYS_BOIDS && part->boids->options & BOID_ALLOW_LAND) {
-    col.boid = 1;
-    col.boid_z = pa->state.co[2];
-    col.skip[col.skip_count++] = pa->boid->ground;
+    col->boid = 1;
+    col->boid_z = pa->state.co[2];
+    col->skip[col->skip_count++] = pa->boid->ground;
   }
+}
 
-  /* 10 iterations to catch multiple collisions */
-  while (collision_count < PARTICLE_COLLISION_MAX_COLLISIONS) {
-    if (collision_detect(pa, &col, &hit, sim->colliders)) {
+/* Respond to the collision found by the first query and keep checking for further collisions. */
+static void collision_check_resolve(ParticleSimulationData *sim,
+                                    int p,
+                                    ParticleCollision *col,
+                                    BVHTreeRayHit *hit,
+                                    bool is_hit)
+{
+  ParticleSettings *part = sim->psys->part;
+  ParticleData *pa = sim->psys->particles + p;
+  int collision_count = 0;
 
-      collision_count++;
+  /* 10 iterations to catch multiple collisions */
+  while (is_hit) {
+    collision_count++;
 
-      if (collision_count == PARTICLE_COLLISION_MAX_COLLISIONS) {
-        collision_fail(pa, &col);
-      }
-      else if (collision_response(
-                   sim, pa, &col, &hit, part->flag & PART_DIE_ON_COL, part->flag & PART_ROT_DYN) ==
-               0) {
-        return;
-      }
+    if (collision_count == PARTICLE_COLLISION_MAX_COLLISIONS) {
+      collision_fail(pa, col);
+      return;
     }
-    else {
+
+    if (collision_response(
+            sim, pa, col, hit, part->flag & PART_DIE_ON_COL, part->flag & PART_ROT_DYN) == 0) {
       return;
     }
+
+    is_hit = collision_detect(pa, col, hit, sim->colliders);
+  }
+}
+
+/* Particle - Mesh collision detection and response
+ * Features:
+ * -friction and damping
+ * -angular momentum <-> linear momentum
+ * -high accuracy by re-applying particle acceleration after collision
+ * -handles moving, rotating and deforming meshes
+ * -uses Newton-Rhapson iteration to find the collisions
+ * -handles spherical particles and (nearly) point like particles
+ */
+static void collision_check(ParticleSimulationData *sim, int p, float dfra, float cfra)
+{
+  ParticleData *pa = sim->psys->particles + p;
+  ParticleCollision col;
+  BVHTreeRayHit hit;
+
+  collision_check_init(sim, p, dfra, cfra, &col);
+  collision_check_resolve(sim, p, &col, &hit, collision_detect(pa, &col, &hit, sim->colliders));
+}
+
+/**
+ * Same as #collision_check for each of the given particles, but the first (and for most
+ * particles only) collision query is done one collider at a time for the whole batch. This keeps
+ * the BVH tree of a collider in cache while all particles are tested against it, instead of
+ * going through the trees of all colliders for every particle. Each particle still tests the
+ * colliders in the same order, so the result is the same.
+ */
+static void collision_check_batch(ParticleSimulationData *sim,
+                                  const int *particles,
+                                  const int particles_num,
+                                  float cfra)
+{
+  ParticleCollision cols[PARTICLE_COLLISION_BATCH_SIZE];
+  BVHTreeRayHit hits[PARTICLE_COLLISION_BATCH_SIZE];
+  float ray_dirs[PARTICLE_COLLISION_BATCH_SIZE][3];
+
+  BLI_assert(particles_num <= PARTICLE_COLLISION_BATCH_SIZE);
+
+  for (int i = 0; i < particles_num; i++) {
+    ParticleData *pa = sim->psys->particles + particles[i];
+    collision_check_init(sim, particles[i], pa->state.time, cfra, &cols[i]);
+    collision_detect_begin(&cols[i], &hits[i], ray_dirs[i]);
+  }
+
+  LISTBASE_FOREACH (ColliderCache *, coll, sim->colliders) {
+    for (int i = 0; i < particles_num; i++) {
+      collision_detect_collider(
+          sim->psys->particles + particles[i], &cols[i], &hits[i], coll, ray_dirs[i]);
+    }
+  }
+
+  for (int i = 0; i < particles_num; i++) {
+    collision_check_resolve(sim, particles[i], &cols[i], &hits[i], hits[i].index >= 0);
   }
 }
 
@@ -3708,6 +3974,79 @@ static void dynamics_step_sphdata_reduce(const void *__restrict UNUSED(userdata)
   BLI_buffer_field_free(&sphdata_from->new_springs);
 }
 
+/* Steps a batch of #PARTICLE_COLLISION_BATCH_SIZE particles, so that their collision queries can
+ * be done together. */
+static void dynamics_step_newton_task_cb_ex(void *__restrict userdata,
+                                            const int batch,
+                                            const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  DynamicStepSolverTaskData *data = userdata;
+  ParticleSimulationData *sim = data->sim;
+  ParticleSystem *psys = sim->psys;
+
+  const int start = batch * PARTICLE_COLLISION_BATCH_SIZE;
+  const int end = min_ii(start + PARTICLE_COLLISION_BATCH_SIZE, psys->totpart);
+  int particles[PARTICLE_COLLISION_BATCH_SIZE];
+  int particles_num = 0;
+
+  for (int p = start; p < end; p++) {
+    ParticleData *pa = psys->particles + p;
+
+    if (pa->state.time <= 0.0f) {
+      continue;
+    }
+
+    /* do global forces & effectors */
+    basic_integrate(sim, p, pa->state.time, data->cfra);
+
+    particles[particles_num++] = p;
+  }
+
+  /* deflection */
+  if (sim->colliders) {
+    collision_check_batch(sim, particles, particles_num, data->cfra);
+  }
+
+  /* rotations */
+  for (int i = 0; i < particles_num; i++) {
+    ParticleData *pa = psys->particles + particles[i];
+    basic_rotate(psys->part, pa, pa->state.time, data->timestep);
+  }
+}
+
+/**
+ * Newtonian particles only depend on their own state, so they can be stepped in parallel as long
+ * as nothing draws from the shared random number generators. Those would make the result depend
+ * on the order in which particles are evaluated.
+ */
+static bool dynamics_step_newton_use_threading(ParticleSimulationData *sim)
+{
+  ParticleSystem *psys = sim->psys;
+
+  if (psys->totpart <= 100 || psys->part->brownfac != 0.0f) {
+    return false;
+  }
+
+  if (psys->effectors) {
+    LISTBASE_FOREACH (EffectorCache *, eff, psys->effectors) {
+      if (eff->pd && eff->pd->f_noise > 0.0f) {
+        return false;
+      }
+    }
+  }
+
+  if (sim->colliders) {
+    LISTBASE_FOREACH (ColliderCache *, coll, sim->colliders) {
+      const PartDeflect *pd = coll->ob->pd;
+      if (pd && (pd->pdef_perm != 0.0f || pd->pdef_rdamp != 0.0f || pd->pdef_rfrict != 0.0f)) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
 static void dynamics_step_sph_ddr_task_cb_ex(void *__restrict userdata,
                                              const int p,
                                              const TaskParallelTLS *__restrict tls)
@@ -3823,6 +4162,7 @@ static void dynamics_step(ParticleSimulationData *sim, float cfra)
   /* frame & time changes */
   float dfra, dtime;
   float birthtime, dietime;
+  SPHGrid *sph_grid = NULL;
 
   /* where have we gone in time since last time */
   dfra = cfra - psys->cfra;
@@ -3878,7 +4218,11 @@ static void dynamics_step(ParticleSimulationData *sim, float cfra)
     }
     case PART_PHYS_FLUID: {
       ParticleTarget *pt = psys->targets.first;
-      psys_update_particle_bvhtree(psys, cfra);
+      SPHFluidSettings *fluid = part->fluid;
+      /* The grid replaces the BVH tree for the system's own particles, other systems that
+       * interact with this one rebuild its tree when they need it. */
+      sph_grid = sph_grid_build(
+          psys, cfra, fluid->radius * (fluid->flag & SPH_FAC_RADIUS ? 4.0f * part->size : 1.0f));
 
       for (; pt;
            pt = pt->next) { /* Updating others systems particle tree for fluid-fluid interaction */
@@ -3939,6 +4283,31 @@ static void dynamics_step(ParticleSimulationData *sim, float cfra)
 
   switch (part->phystype) {
     case PART_PHYS_NEWTON: {
+      if (dynamics_step_newton_use_threading(sim)) {
+        DynamicStepSolverTaskData task_data = {
+            .sim = sim,
+            .cfra = cfra,
+            .timestep = timestep,
+            .dtime = dtime,
+        };
+
+        /* Nothing uses random numbers, see #dynamics_step_newton_use_threading. */
+        RNG *rng = sim->rng;
+        sim->rng = NULL;
+
+        TaskParallelSettings settings;
+        BLI_parallel_range_settings_defaults(&settings);
+        settings.min_iter_per_thread = 256 / PARTICLE_COLLISION_BATCH_SIZE;
+        BLI_task_parallel_range(0,
+                                divide_ceil_u(psys->totpart, PARTICLE_COLLISION_BATCH_SIZE),
+                                &task_data,
+                                dynamics_step_newton_task_cb_ex,
+                                &settings);
+
+        sim->rng = rng;
+        break;
+      }
+
       LOOP_DYNAMIC_PARTICLES
       {
         /* do global forces & effectors */
@@ -3975,6 +4344,7 @@ static void dynamics_step(ParticleSimulationData *sim, float cfra)
     case PART_PHYS_FLUID: {
       SPHData sphdata;
       psys_sph_init(sim, &sphdata);
+      sphdata.grid = sph_grid;
 
       DynamicStepSolverTaskData task_data = {
           .sim = sim,
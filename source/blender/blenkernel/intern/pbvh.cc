@@ -6,14 +6,19 @@
 
 #include "MEM_guardedalloc.h"
 
+#include <algorithm>
 #include <climits>
+#include <memory>
 
+#include "BLI_array.hh"
 #include "BLI_bitmap.h"
 #include "BLI_ghash.h"
 #include "BLI_math.h"
 #include "BLI_rand.h"
 #include "BLI_task.h"
+#include "BLI_task.hh"
 #include "BLI_utildefines.h"
+#include "BLI_vector.hh"
 
 #include "DNA_mesh_types.h"
 #include "DNA_meshdata_types.h"
@@ -38,6 +43,9 @@
 
 #define LEAF_LIMIT 10000
 
+/* Minimum number of primitives in a node for its two children to be built as separate tasks. */
+#define BUILD_TASK_LIMIT (LEAF_LIMIT * 4)
+
 /* Uncomment to test if triangles of the same face are
  * properly clustered into single nodes.
  */
@@ -175,7 +183,9 @@ static bool grid_materials_match(const DMFlagMat *f1, const DMFlagMat *f2)
 }
 
 /* Adapted from BLI_kdopbvh.c */
-/* Returns the index of the first element on the right of the partition */
+/* Returns the index of the first element on the right of the partition.
+ * The scratch array is indexed like the primitive indices, so disjoint ranges
+ * can be partitioned concurrently. */
 static int partition_indices_faces(int *prim_indices,
                                    int *prim_scratch,
                                    int lo,
@@ -186,11 +196,11 @@ static int partition_indices_faces(int *prim_indices,
                                    const MLoopTri *looptri)
 {
   for (int i = lo; i < hi; i++) {
-    prim_scratch[i - lo] = prim_indices[i];
+    prim_scratch[i] = prim_indices[i];
   }
 
   int lo2 = lo, hi2 = hi - 1;
-  int i1 = lo, i2 = 0;
+  int i1 = lo, i2 = lo;
 
   while (i1 < hi) {
     int poly = looptri[prim_scratch[i2]].poly;
@@ -216,11 +226,11 @@ static int partition_indices_grids(int *prim_indices,
                                    SubdivCCG *subdiv_ccg)
 {
   for (int i = lo; i < hi; i++) {
-    prim_scratch[i - lo] = prim_indices[i];
+    prim_scratch[i] = prim_indices[i];
   }
 
   int lo2 = lo, hi2 = hi - 1;
-  int i1 = lo, i2 = 0;
+  int i1 = lo, i2 = lo;
 
   while (i1 < hi) {
     int poly = BKE_subdiv_ccg_grid_to_face_index(subdiv_ccg, prim_scratch[i2]);
@@ -287,106 +297,104 @@ void pbvh_grow_nodes(PBVH *pbvh, int totnode)
   pbvh->totnode = totnode;
 }
 
-/* Add a vertex to the map, with a positive value for unique vertices and
- * a negative value for additional vertices */
-static int map_insert_vert(PBVH *pbvh, GHash *map, uint *face_verts, uint *uniq_verts, int vertex)
-{
-  void *key, **value_p;
-
-  key = POINTER_FROM_INT(vertex);
-  if (!BLI_ghash_ensure_p(map, key, &value_p)) {
-    int value_i;
-    if (!pbvh->vert_bitmap[vertex]) {
-      pbvh->vert_bitmap[vertex] = true;
-      value_i = *uniq_verts;
-      (*uniq_verts)++;
-    }
-    else {
-      value_i = ~(*face_verts);
-      (*face_verts)++;
+/* Find vertices used by the faces in the leaf nodes and update the draw buffers.
+ *
+ * Each vertex is owned ("unique") by the first leaf in build order that uses it,
+ * further leaves only reference it. The vertex lists of the leaves are gathered in
+ * parallel, only the cheap ownership pass has to run in order. */
+static void build_mesh_leaf_nodes(PBVH *pbvh, const blender::Span<int> leaves)
+{
+  using namespace blender;
+
+  /* Sorted vertices used by each leaf. */
+  Array<Vector<int>> leaf_verts(leaves.size());
+  threading::parallel_for(leaves.index_range(), 1, [&](const IndexRange range) {
+    for (const int i : range) {
+      const PBVHNode *node = &pbvh->nodes[leaves[i]];
+      Vector<int> &verts = leaf_verts[i];
+      verts.reserve(node->totprim * 3);
+      for (int j = 0; j < node->totprim; j++) {
+        const MLoopTri *lt = &pbvh->looptri[node->prim_indices[j]];
+        for (int k = 0; k < 3; k++) {
+          verts.append_unchecked(int(pbvh->mloop[lt->tri[k]].v));
+        }
+      }
+      std::sort(verts.begin(), verts.end());
+      verts.resize(std::unique(verts.begin(), verts.end()) - verts.begin());
     }
-    *value_p = POINTER_FROM_INT(value_i);
-    return value_i;
-  }
-
-  return POINTER_AS_INT(*value_p);
-}
-
-/* Find vertices used by the faces in this node and update the draw buffers */
-static void build_mesh_leaf_node(PBVH *pbvh, PBVHNode *node)
-{
-  bool has_visible = false;
-
-  node->uniq_verts = node->face_verts = 0;
-  const int totface = node->totprim;
-
-  /* reserve size is rough guess */
-  GHash *map = BLI_ghash_int_new_ex("build_mesh_leaf_node gh", 2 * totface);
-
-  int(*face_vert_indices)[3] = static_cast<int(*)[3]>(
-      MEM_mallocN(sizeof(int[3]) * totface, __func__));
+  });
 
-  node->face_vert_indices = (const int(*)[3])face_vert_indices;
+  /* Index of each vertex in the final vertex list of the leaf, with a positive value
+   * for unique vertices and a negative value for additional vertices. */
+  Array<Vector<int>> leaf_vert_indices(leaves.size());
+  for (const int i : leaves.index_range()) {
+    PBVHNode *node = &pbvh->nodes[leaves[i]];
+    node->uniq_verts = node->face_verts = 0;
 
-  if (pbvh->respect_hide == false) {
-    has_visible = true;
-  }
-
-  for (int i = 0; i < totface; i++) {
-    const MLoopTri *lt = &pbvh->looptri[node->prim_indices[i]];
-    for (int j = 0; j < 3; j++) {
-      face_vert_indices[i][j] = map_insert_vert(
-          pbvh, map, &node->face_verts, &node->uniq_verts, pbvh->mloop[lt->tri[j]].v);
-    }
-
-    if (has_visible == false) {
-      if (!paint_is_face_hidden(lt, pbvh->hide_poly)) {
-        has_visible = true;
+    Vector<int> &indices = leaf_vert_indices[i];
+    indices.reserve(leaf_verts[i].size());
+    for (const int vertex : leaf_verts[i]) {
+      if (!pbvh->vert_bitmap[vertex]) {
+        pbvh->vert_bitmap[vertex] = true;
+        indices.append_unchecked(node->uniq_verts++);
+      }
+      else {
+        indices.append_unchecked(~(node->face_verts++));
       }
     }
   }
 
-  int *vert_indices = static_cast<int *>(
-      MEM_callocN(sizeof(int) * (node->uniq_verts + node->face_verts), __func__));
-  node->vert_indices = vert_indices;
-
-  /* Build the vertex list, unique verts first */
-  GHashIterator gh_iter;
-  GHASH_ITER (gh_iter, map) {
-    void *value = BLI_ghashIterator_getValue(&gh_iter);
-    int ndx = POINTER_AS_INT(value);
-
-    if (ndx < 0) {
-      ndx = -ndx + node->uniq_verts - 1;
-    }
+  threading::parallel_for(leaves.index_range(), 1, [&](const IndexRange range) {
+    for (const int i : range) {
+      PBVHNode *node = &pbvh->nodes[leaves[i]];
+      const Span<int> verts = leaf_verts[i];
+      MutableSpan<int> indices = leaf_vert_indices[i];
 
-    vert_indices[ndx] = POINTER_AS_INT(BLI_ghashIterator_getKey(&gh_iter));
-  }
-
-  for (int i = 0; i < totface; i++) {
-    const int sides = 3;
+      /* Build the vertex list, unique verts first */
+      int *vert_indices = static_cast<int *>(
+          MEM_mallocN(sizeof(int) * (node->uniq_verts + node->face_verts), __func__));
+      for (const int j : verts.index_range()) {
+        if (indices[j] < 0) {
+          indices[j] = ~indices[j] + node->uniq_verts;
+        }
+        vert_indices[indices[j]] = verts[j];
+      }
+      node->vert_indices = vert_indices;
+
+      const int totface = node->totprim;
+      int(*face_vert_indices)[3] = static_cast<int(*)[3]>(
+          MEM_mallocN(sizeof(int[3]) * totface, __func__));
+      node->face_vert_indices = (const int(*)[3])face_vert_indices;
+
+      bool has_visible = !pbvh->respect_hide;
+      for (int j = 0; j < totface; j++) {
+        const MLoopTri *lt = &pbvh->looptri[node->prim_indices[j]];
+        for (int k = 0; k < 3; k++) {
+          const int vertex = int(pbvh->mloop[lt->tri[k]].v);
+          const int index = std::lower_bound(verts.begin(), verts.end(), vertex) - verts.begin();
+          face_vert_indices[j][k] = indices[index];
+        }
 
-    for (int j = 0; j < sides; j++) {
-      if (face_vert_indices[i][j] < 0) {
-        face_vert_indices[i][j] = -face_vert_indices[i][j] + node->uniq_verts - 1;
+        if (has_visible == false) {
+          if (!paint_is_face_hidden(lt, pbvh->hide_poly)) {
+            has_visible = true;
+          }
+        }
       }
-    }
-  }
-
-  BKE_pbvh_node_mark_rebuild_draw(node);
 
-  BKE_pbvh_node_fully_hidden_set(node, !has_visible);
+      BKE_pbvh_node_mark_rebuild_draw(node);
 
-  BLI_ghash_free(map, nullptr, nullptr);
+      BKE_pbvh_node_fully_hidden_set(node, !has_visible);
+    }
+  });
 }
 
-static void update_vb(PBVH *pbvh, PBVHNode *node, BBC *prim_bbc, int offset, int count)
+static void update_vb(PBVH *pbvh, BB *vb, BBC *prim_bbc, int offset, int count)
 {
-  BB_reset(&node->vb);
+  BB_reset(vb);
   for (int i = offset + count - 1; i >= offset; i--) {
-    BB_expand_with_bb(&node->vb, (BB *)(&prim_bbc[pbvh->prim_indices[i]]));
+    BB_expand_with_bb(vb, (BB *)(&prim_bbc[pbvh->prim_indices[i]]));
   }
-  node->orig_vb = node->vb;
 }
 
 int BKE_pbvh_count_grid_quads(BLI_bitmap **grid_hidden,
@@ -438,21 +446,19 @@ static void build_grid_leaf_node(PBVH *pbvh, PBVHNode *node)
   BKE_pbvh_node_mark_rebuild_draw(node);
 }
 
-static void build_leaf(PBVH *pbvh, int node_index, BBC *prim_bbc, int offset, int count)
+static void build_leaves(PBVH *pbvh, const blender::Span<int> leaves)
 {
-  pbvh->nodes[node_index].flag |= PBVH_Leaf;
-
-  pbvh->nodes[node_index].prim_indices = pbvh->prim_indices + offset;
-  pbvh->nodes[node_index].totprim = count;
-
-  /* Still need vb for searches */
-  update_vb(pbvh, &pbvh->nodes[node_index], prim_bbc, offset, count);
+  using namespace blender;
 
   if (pbvh->looptri) {
-    build_mesh_leaf_node(pbvh, pbvh->nodes + node_index);
+    build_mesh_leaf_nodes(pbvh, leaves);
   }
   else {
-    build_grid_leaf_node(pbvh, pbvh->nodes + node_index);
+    threading::parallel_for(leaves.index_range(), 16, [&](const IndexRange range) {
+      for (const int i : range) {
+        build_grid_leaf_node(pbvh, &pbvh->nodes[leaves[i]]);
+      }
+    });
   }
 }
 
@@ -535,6 +541,17 @@ static void test_face_boundaries(PBVH *pbvh)
 }
 #endif
 
+/* Node of the tree while it is being built, before it is stored in the node array of the PBVH.
+ * Separate sub-trees are built in parallel, so their nodes can't be allocated in build order. */
+struct PBVHBuildNode {
+  /* Range in the array of primitive indices. */
+  int offset;
+  int count;
+  BB vb;
+  /* Both children are null for leaf nodes. */
+  std::unique_ptr<PBVHBuildNode> children[2];
+};
+
 /* Recursively build a node in the tree
  *
  * vb is the voxel box around all of the primitives contained in
@@ -548,7 +565,7 @@ static void test_face_boundaries(PBVH *pbvh)
 
 static void build_sub(PBVH *pbvh,
                       const bool *sharp_faces,
-                      int node_index,
+                      PBVHBuildNode *build_node,
                       BB *cb,
                       BBC *prim_bbc,
                       int offset,
@@ -559,31 +576,19 @@ static void build_sub(PBVH *pbvh,
   int end;
   BB cb_backing;
 
-  if (!prim_scratch) {
-    prim_scratch = static_cast<int *>(MEM_malloc_arrayN(pbvh->totprim, sizeof(int), __func__));
-  }
+  build_node->offset = offset;
+  build_node->count = count;
 
   /* Decide whether this is a leaf or not */
   const bool below_leaf_limit = count <= pbvh->leaf_limit || depth >= STACK_FIXED_DEPTH - 1;
   if (below_leaf_limit) {
     if (!leaf_needs_material_split(pbvh, sharp_faces, offset, count)) {
-      build_leaf(pbvh, node_index, prim_bbc, offset, count);
-
-      if (node_index == 0) {
-        MEM_SAFE_FREE(prim_scratch);
-      }
-
+      /* Still need vb for searches */
+      update_vb(pbvh, &build_node->vb, prim_bbc, offset, count);
       return;
     }
   }
 
-  /* Add two child nodes */
-  pbvh->nodes[node_index].children_offset = pbvh->totnode;
-  pbvh_grow_nodes(pbvh, pbvh->totnode + 2);
-
-  /* Update parent node bounding box */
-  update_vb(pbvh, &pbvh->nodes[node_index], prim_bbc, offset, count);
-
   if (!below_leaf_limit) {
     /* Find axis with widest range of primitive centroids */
     if (!cb) {
@@ -622,29 +627,67 @@ static void build_sub(PBVH *pbvh,
     end = partition_indices_material(pbvh, sharp_faces, offset, offset + count - 1);
   }
 
-  /* Build children */
-  build_sub(pbvh,
-            sharp_faces,
-            pbvh->nodes[node_index].children_offset,
-            nullptr,
-            prim_bbc,
-            offset,
-            end - offset,
-            prim_scratch,
-            depth + 1);
-  build_sub(pbvh,
-            sharp_faces,
-            pbvh->nodes[node_index].children_offset + 1,
-            nullptr,
-            prim_bbc,
-            end,
-            offset + count - end,
-            prim_scratch,
-            depth + 1);
+  /* Build children, they work on disjoint ranges of the primitive indices. */
+  build_node->children[0] = std::make_unique<PBVHBuildNode>();
+  build_node->children[1] = std::make_unique<PBVHBuildNode>();
+  blender::threading::parallel_invoke(
+      count >= BUILD_TASK_LIMIT,
+      [&]() {
+        build_sub(pbvh,
+                  sharp_faces,
+                  build_node->children[0].get(),
+                  nullptr,
+                  prim_bbc,
+                  offset,
+                  end - offset,
+                  prim_scratch,
+                  depth + 1);
+      },
+      [&]() {
+        build_sub(pbvh,
+                  sharp_faces,
+                  build_node->children[1].get(),
+                  nullptr,
+                  prim_bbc,
+                  end,
+                  offset + count - end,
+                  prim_scratch,
+                  depth + 1);
+      });
 
-  if (node_index == 0) {
-    MEM_SAFE_FREE(prim_scratch);
+  /* Update parent node bounding box */
+  BB_reset(&build_node->vb);
+  BB_expand_with_bb(&build_node->vb, &build_node->children[0]->vb);
+  BB_expand_with_bb(&build_node->vb, &build_node->children[1]->vb);
+}
+
+/* Store the built tree in the node array, in the same depth-first order as the recursion.
+ * Leaf node indices are gathered in that order too. */
+static void flatten_build_node(PBVH *pbvh,
+                               const PBVHBuildNode *build_node,
+                               int node_index,
+                               blender::Vector<int> &r_leaves)
+{
+  if (!build_node->children[0]) {
+    PBVHNode *node = &pbvh->nodes[node_index];
+    node->flag |= PBVH_Leaf;
+    node->prim_indices = pbvh->prim_indices + build_node->offset;
+    node->totprim = build_node->count;
+    node->vb = node->orig_vb = build_node->vb;
+    r_leaves.append(node_index);
+    return;
   }
+
+  /* Add two child nodes */
+  const int children_offset = pbvh->totnode;
+  pbvh->nodes[node_index].children_offset = children_offset;
+  pbvh_grow_nodes(pbvh, pbvh->totnode + 2);
+
+  PBVHNode *node = &pbvh->nodes[node_index];
+  node->vb = node->orig_vb = build_node->vb;
+
+  flatten_build_node(pbvh, build_node->children[0].get(), children_offset, r_leaves);
+  flatten_build_node(pbvh, build_node->children[1].get(), children_offset + 1, r_leaves);
 }
 
 static void pbvh_build(PBVH *pbvh, const bool *sharp_faces, BB *cb, BBC *prim_bbc, int totprim)
@@ -669,8 +712,40 @@ static void pbvh_build(PBVH *pbvh, const bool *sharp_faces, BB *cb, BBC *prim_bb
     }
   }
 
+  int *prim_scratch = static_cast<int *>(MEM_malloc_arrayN(totprim, sizeof(int), __func__));
+  PBVHBuildNode root;
+  build_sub(pbvh, sharp_faces, &root, cb, prim_bbc, 0, totprim, prim_scratch, 0);
+  MEM_freeN(prim_scratch);
+
   pbvh->totnode = 1;
-  build_sub(pbvh, sharp_faces, 0, cb, prim_bbc, 0, totprim, nullptr, 0);
+  blender::Vector<int> leaves;
+  flatten_build_node(pbvh, &root, 0, leaves);
+
+  build_leaves(pbvh, leaves);
+}
+
+/* Compute the bounds of the centroids of all primitives. */
+static BB calc_prim_centroid_bounds(const BBC *prim_bbc, const int totprim)
+{
+  using namespace blender;
+
+  BB init;
+  BB_reset(&init);
+  return threading::parallel_reduce(
+      IndexRange(totprim),
+      4096,
+      init,
+      [&](const IndexRange range, const BB &init) {
+        BB cb = init;
+        for (const int i : range) {
+          BB_expand(&cb, prim_bbc[i].bcentroid);
+        }
+        return cb;
+      },
+      [](BB a, BB b) {
+        BB_expand_with_bb(&a, &b);
+        return a;
+      });
 }
 
 static void pbvh_draw_args_init(PBVH *pbvh, PBVH_GPU_Args *args, PBVHNode *node)
@@ -871,26 +946,31 @@ void BKE_pbvh_build_mesh(PBVH *pbvh,
   pbvh->face_sets_color_seed = mesh->face_sets_color_seed;
   pbvh->face_sets_color_default = mesh->face_sets_color_default;
 
-  BB_reset(&cb);
+#ifdef PERFCNTRS
+  const double time_start = PIL_check_seconds_timer();
+#endif
 
   /* For each face, store the AABB and the AABB centroid */
   prim_bbc = static_cast<BBC *>(MEM_mallocN(sizeof(BBC) * looptri_num, __func__));
 
-  for (int i = 0; i < looptri_num; i++) {
-    const MLoopTri *lt = &looptri[i];
-    const int sides = 3;
-    BBC *bbc = prim_bbc + i;
+  blender::threading::parallel_for(
+      blender::IndexRange(looptri_num), 4096, [&](const blender::IndexRange range) {
+        for (const int i : range) {
+          const MLoopTri *lt = &looptri[i];
+          const int sides = 3;
+          BBC *bbc = prim_bbc + i;
 
-    BB_reset((BB *)bbc);
+          BB_reset((BB *)bbc);
 
-    for (int j = 0; j < sides; j++) {
-      BB_expand((BB *)bbc, vert_positions[pbvh->mloop[lt->tri[j]].v]);
-    }
+          for (int j = 0; j < sides; j++) {
+            BB_expand((BB *)bbc, vert_positions[pbvh->mloop[lt->tri[j]].v]);
+          }
 
-    BBC_update_centroid(bbc);
+          BBC_update_centroid(bbc);
+        }
+      });
 
-    BB_expand(&cb, bbc->bcentroid);
-  }
+  cb = calc_prim_centroid_bounds(prim_bbc, looptri_num);
 
   if (looptri_num) {
     const bool *sharp_faces = (const bool *)CustomData_get_layer_named(
@@ -909,6 +989,14 @@ void BKE_pbvh_build_mesh(PBVH *pbvh,
 
   BKE_pbvh_update_active_vcol(pbvh, mesh);
 
+#ifdef PERFCNTRS
+  printf("%s: %d triangles, %d nodes, %.3f seconds\n",
+         __func__,
+         looptri_num,
+         pbvh->totnode,
+         PIL_check_seconds_timer() - time_start);
+#endif
+
 #ifdef VALIDATE_UNIQUE_NODE_FACES
   pbvh_validate_node_prims(pbvh);
 #endif
@@ -960,26 +1048,30 @@ void BKE_pbvh_build_grids(PBVH *pbvh,
   /* We also need the base mesh for PBVH draw. */
   pbvh->mesh = me;
 
-  BB cb;
-  BB_reset(&cb);
+#ifdef PERFCNTRS
+  const double time_start = PIL_check_seconds_timer();
+#endif
 
   /* For each grid, store the AABB and the AABB centroid */
   BBC *prim_bbc = static_cast<BBC *>(MEM_mallocN(sizeof(BBC) * totgrid, __func__));
 
-  for (int i = 0; i < totgrid; i++) {
-    CCGElem *grid = grids[i];
-    BBC *bbc = prim_bbc + i;
+  blender::threading::parallel_for(
+      blender::IndexRange(totgrid), 64, [&](const blender::IndexRange range) {
+        for (const int i : range) {
+          CCGElem *grid = grids[i];
+          BBC *bbc = prim_bbc + i;
 
-    BB_reset((BB *)bbc);
+          BB_reset((BB *)bbc);
 
-    for (int j = 0; j < gridsize * gridsize; j++) {
-      BB_expand((BB *)bbc, CCG_elem_offset_co(key, grid, j));
-    }
+          for (int j = 0; j < gridsize * gridsize; j++) {
+            BB_expand((BB *)bbc, CCG_elem_offset_co(key, grid, j));
+          }
 
-    BBC_update_centroid(bbc);
+          BBC_update_centroid(bbc);
+        }
+      });
 
-    BB_expand(&cb, bbc->bcentroid);
-  }
+  BB cb = calc_prim_centroid_bounds(prim_bbc, totgrid);
 
   if (totgrid) {
     const bool *sharp_faces = (const bool *)CustomData_get_layer_named(
@@ -992,6 +1084,15 @@ void BKE_pbvh_build_grids(PBVH *pbvh,
   }
 
   MEM_freeN(prim_bbc);
+
+#ifdef PERFCNTRS
+  printf("%s: %d grids, %d nodes, %.3f seconds\n",
+         __func__,
+         totgrid,
+         pbvh->totnode,
+         PIL_check_seconds_timer() - time_start);
+#endif
+
 #ifdef VALIDATE_UNIQUE_NODE_FACES
   pbvh_validate_node_prims(pbvh);
 #endif
@@ -31,6 +31,8 @@
 #include "BLI_endian_switch.h"
 #include "BLI_math.h"
 #include "BLI_string.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
 #include "BLI_utildefines.h"
 
 #include "BLT_translation.h"
@@ -76,6 +78,13 @@
 #  include "LzmaLib.h"
 #endif
 
+#include <zstd.h>
+
+/* Same trade-off between speed and size as used for compressed blend files. */
+#define PTCACHE_ZSTD_LEVEL 3
+/* Smaller buffers don't gain from being split between multiple compression threads. */
+#define PTCACHE_ZSTD_MT_MIN_SIZE (1 << 20)
+
 /* needed for directory lookup */
 #ifndef WIN32
 #  include <dirent.h>
@@ -1440,29 +1449,106 @@ static int ptcache_filepath(
   return len; /* make sure the above string is always 16 chars */
 }
 
-/**
- * Caller must close after!
- */
-static PTCacheFile *ptcache_file_open(PTCacheID *pid, int mode, int cfra)
-{
-  PTCacheFile *pf;
-  FILE *fp = NULL;
-  char filepath[MAX_PTCACHE_FILE];
+/* Asynchronous disk writes.
+ *
+ * While baking, frames written to a disk cache are handed over to a single background thread
+ * so the simulation can continue with the next frame while the previous one is compressed and
+ * written. Frames that are still queued count as existing, anything that opens or deletes one
+ * of their files waits for the write to finish first. */
 
-#ifndef DURIAN_POINTCACHE_LIB_OK
-  /* don't allow writing for linked objects */
-  if (pid->owner_id->lib && mode == PTCACHE_FILE_WRITE) {
-    return NULL;
+typedef struct PTCacheAsyncWrite {
+  struct PTCacheAsyncWrite *next, *prev;
+  char filepath[MAX_PTCACHE_FILE];
+  PTCacheMem *pm;
+  int type;
+  int compression;
+  int (*write_header)(PTCacheFile *pf);
+} PTCacheAsyncWrite;
+
+/* Limit the memory held by frames waiting to be written when the disk can't keep up. */
+#define PTCACHE_ASYNC_WRITE_MAX_PENDING 8
+
+static struct {
+  ThreadMutex mutex;
+  ThreadCondition cond;
+  TaskPool *pool;
+  int users;
+  /* PTCacheAsyncWrite, queued or being written. */
+  ListBase pending;
+  int pending_num;
+} ptcache_async = {BLI_MUTEX_INITIALIZER};
+
+/* Call with the mutex locked. */
+static PTCacheAsyncWrite *ptcache_async_write_find(const char *filepath)
+{
+  if (filepath == NULL) {
+    return ptcache_async.pending.first;
   }
-#endif
-  if ((pid->cache->flag & PTCACHE_EXTERNAL) == 0) {
-    const char *blendfile_path = BKE_main_blendfile_path_from_global();
-    if (blendfile_path[0] == '\0') {
-      return NULL; /* save blend file before using disk pointcache */
+  LISTBASE_FOREACH (PTCacheAsyncWrite *, aw, &ptcache_async.pending) {
+    if (STREQ(aw->filepath, filepath)) {
+      return aw;
     }
   }
+  return NULL;
+}
 
-  ptcache_filepath(pid, filepath, cfra, true, true);
+static bool ptcache_async_write_is_pending(const char *filepath)
+{
+  BLI_mutex_lock(&ptcache_async.mutex);
+  const bool pending = ptcache_async.pool && ptcache_async_write_find(filepath) != NULL;
+  BLI_mutex_unlock(&ptcache_async.mutex);
+  return pending;
+}
+
+/* Wait until the file is written, or all files when `filepath` is NULL. */
+static void ptcache_async_write_wait(const char *filepath)
+{
+  BLI_mutex_lock(&ptcache_async.mutex);
+  while (ptcache_async.pool && ptcache_async_write_find(filepath)) {
+    BLI_condition_wait(&ptcache_async.cond, &ptcache_async.mutex);
+  }
+  BLI_mutex_unlock(&ptcache_async.mutex);
+}
+
+static void ptcache_async_write_begin(void)
+{
+  BLI_mutex_lock(&ptcache_async.mutex);
+  if (ptcache_async.users++ == 0) {
+    BLI_condition_init(&ptcache_async.cond);
+    /* A dedicated thread, writes must not wait on tasks of the depsgraph evaluation. */
+    ptcache_async.pool = BLI_task_pool_create_background_serial(NULL, TASK_PRIORITY_LOW);
+  }
+  BLI_mutex_unlock(&ptcache_async.mutex);
+}
+
+static void ptcache_async_write_end(void)
+{
+  TaskPool *pool = NULL;
+
+  ptcache_async_write_wait(NULL);
+
+  BLI_mutex_lock(&ptcache_async.mutex);
+  if (--ptcache_async.users == 0) {
+    pool = ptcache_async.pool;
+    ptcache_async.pool = NULL;
+  }
+  BLI_mutex_unlock(&ptcache_async.mutex);
+
+  if (pool) {
+    BLI_task_pool_work_and_wait(pool);
+    BLI_task_pool_free(pool);
+    BLI_condition_end(&ptcache_async.cond);
+  }
+}
+
+static PTCacheFile *ptcache_file_open_path(const char *filepath, int mode, int cfra)
+{
+  PTCacheFile *pf;
+  FILE *fp = NULL;
+
+  if (mode != PTCACHE_FILE_WRITE) {
+    ptcache_async_write_wait(filepath);
+  }
 
   if (mode == PTCACHE_FILE_READ) {
     fp = BLI_fopen(filepath, "rb");
@@ -1489,6 +1575,41 @@ static PTCacheFile *ptcache_file_open(PTCacheID *pid, int mode, int cfra)
 
   return pf;
 }
+
+static bool ptcache_file_open_allowed(PTCacheID *pid, int mode)
+{
+#ifndef DURIAN_POINTCACHE_LIB_OK
+  /* don't allow writing for linked objects */
+  if (pid->owner_id->lib && mode == PTCACHE_FILE_WRITE) {
+    return false;
+  }
+#else
+  UNUSED_VARS(mode);
+#endif
+  if ((pid->cache->flag & PTCACHE_EXTERNAL) == 0) {
+    const char *blendfile_path = BKE_main_blendfile_path_from_global();
+    if (blendfile_path[0] == '\0') {
+      return false; /* save blend file before using disk pointcache */
+    }
+  }
+  return true;
+}
+
+/**
+ * Caller must close after!
+ */
+static PTCacheFile *ptcache_file_open(PTCacheID *pid, int mode, int cfra)
+{
+  char filepath[MAX_PTCACHE_FILE];
+
+  if (!ptcache_file_open_allowed(pid, mode)) {
+    return NULL;
+  }
+
+  ptcache_filepath(pid, filepath, cfra, true, true);
+
+  return ptcache_file_open_path(filepath, mode, cfra);
+}
 static void ptcache_file_close(PTCacheFile *pf)
 {
   if (pf) {
@@ -1534,6 +1655,10 @@ static int ptcache_file_compressed_read(PTCacheFile *pf, uchar *result, uint len
         r = LzmaUncompress(result, &leno, in, &leni, props, sizeOfIt);
       }
 #endif
+      if (compressed == PTCACHE_COMPRESS_ZSTD) {
+        const size_t result_len = ZSTD_decompress(result, len, in, in_len);
+        r = (ZSTD_isError(result_len) || result_len != len) ? -1 : 0;
+      }
       MEM_freeN(in);
     }
   }
@@ -1554,8 +1679,6 @@ static int ptcache_file_compressed_write(
   uchar *props = MEM_callocN(sizeof(char[16]), "tmp");
   size_t sizeOfIt = 5;
 
-  (void)mode; /* unused when building w/o compression */
-
 #ifdef WITH_LZO
   out_len = LZO_OUT_LEN(in_len);
   if (mode == 1) {
@@ -1595,6 +1718,26 @@ static int ptcache_file_compressed_write(
     }
   }
 #endif
+  if (mode == PTCACHE_COMPRESS_ZSTD) {
+    ZSTD_CCtx *ctx = ZSTD_createCCtx();
+    ZSTD_CCtx_setParameter(ctx, ZSTD_c_compressionLevel, PTCACHE_ZSTD_LEVEL);
+    if (in_len >= PTCACHE_ZSTD_MT_MIN_SIZE) {
+      /* Has no effect when zstd is built without multi-threading support. */
+      ZSTD_CCtx_setParameter(ctx, ZSTD_c_nbWorkers, BLI_system_thread_count());
+    }
+
+    /* Callers allocate #LZO_OUT_LEN, which is always larger than #ZSTD_compressBound. */
+    BLI_assert(LZO_OUT_LEN(in_len) >= ZSTD_compressBound(in_len));
+    out_len = ZSTD_compress2(ctx, out, ZSTD_compressBound(in_len), in, in_len);
+    ZSTD_freeCCtx(ctx);
+
+    if (ZSTD_isError(out_len) || (out_len >= in_len)) {
+      compressed = 0;
+    }
+    else {
+      compressed = PTCACHE_COMPRESS_ZSTD;
+    }
+  }
 
   ptcache_file_write(pf, &compressed, 1, sizeof(uchar));
   if (compressed) {
@@ -2012,47 +2155,42 @@ static PTCacheMem *ptcache_disk_frame_to_mem(PTCacheID *pid, int cfra)
 
   return pm;
 }
-static int ptcache_mem_frame_to_disk(PTCacheID *pid, PTCacheMem *pm)
+/**
+ * Write the frame to an open file. Doesn't access the #PTCacheID so this can run on
+ * the asynchronous writing thread.
+ */
+static int ptcache_mem_frame_to_file(PTCacheFile *pf,
+                                     PTCacheMem *pm,
+                                     int type,
+                                     int compression,
+                                     int (*write_header)(PTCacheFile *pf))
 {
-  PTCacheFile *pf = NULL;
   uint i, error = 0;
 
-  BKE_ptcache_id_clear(pid, PTCACHE_CLEAR_FRAME, pm->frame);
-
-  pf = ptcache_file_open(pid, PTCACHE_FILE_WRITE, pm->frame);
-
-  if (pf == NULL) {
-    if (G.debug & G_DEBUG) {
-      printf("Error opening disk cache file for writing\n");
-    }
-    return 0;
-  }
-
   pf->data_types = pm->data_types;
   pf->totpoint = pm->totpoint;
-  pf->type = pid->type;
+  pf->type = type;
   pf->flag = 0;
 
   if (pm->extradata.first) {
     pf->flag |= PTCACHE_TYPEFLAG_EXTRADATA;
   }
 
-  if (pid->cache->compression) {
+  if (compression) {
     pf->flag |= PTCACHE_TYPEFLAG_COMPRESS;
   }
 
-  if (!ptcache_file_header_begin_write(pf) || !pid->write_header(pf)) {
+  if (!ptcache_file_header_begin_write(pf) || !write_header(pf)) {
     error = 1;
   }
 
   if (!error) {
-    if (pid->cache->compression) {
+    if (compression) {
       for (i = 0; i < BPHYS_TOT_DATA; i++) {
         if (pm->data[i]) {
           uint in_len = pm->totpoint * ptcache_data_size[i];
           uchar *out = (uchar *)MEM_callocN(LZO_OUT_LEN(in_len) * 4, "pointcache_lzo_buffer");
-          ptcache_file_compressed_write(
-              pf, (uchar *)(pm->data[i]), in_len, out, pid->cache->compression);
+          ptcache_file_compressed_write(pf, (uchar *)(pm->data[i]), in_len, out, compression);
           MEM_freeN(out);
         }
       }
@@ -2084,11 +2222,10 @@ static int ptcache_mem_frame_to_disk(PTCacheID *pid, PTCacheMem *pm)
       ptcache_file_write(pf, &extra->type, 1, sizeof(uint));
       ptcache_file_write(pf, &extra->totdata, 1, sizeof(uint));
 
-      if (pid->cache->compression) {
+      if (compression) {
         uint in_len = extra->totdata * ptcache_extra_datasize[extra->type];
         uchar *out = (uchar *)MEM_callocN(LZO_OUT_LEN(in_len) * 4, "pointcache_lzo_buffer");
-        ptcache_file_compressed_write(
-            pf, (uchar *)(extra->data), in_len, out, pid->cache->compression);
+        ptcache_file_compressed_write(pf, (uchar *)(extra->data), in_len, out, compression);
         MEM_freeN(out);
       }
       else {
@@ -2106,6 +2243,99 @@ static int ptcache_mem_frame_to_disk(PTCacheID *pid, PTCacheMem *pm)
   return error == 0;
 }
 
+static int ptcache_mem_frame_to_disk(PTCacheID *pid, PTCacheMem *pm)
+{
+  PTCacheFile *pf = NULL;
+
+  BKE_ptcache_id_clear(pid, PTCACHE_CLEAR_FRAME, pm->frame);
+
+  pf = ptcache_file_open(pid, PTCACHE_FILE_WRITE, pm->frame);
+
+  if (pf == NULL) {
+    if (G.debug & G_DEBUG) {
+      printf("Error opening disk cache file for writing\n");
+    }
+    return 0;
+  }
+
+  return ptcache_mem_frame_to_file(
+      pf, pm, pid->type, pid->cache->compression, pid->write_header);
+}
+
+static void ptcache_async_write_run(TaskPool *__restrict UNUSED(pool), void *taskdata)
+{
+  PTCacheAsyncWrite *aw = (PTCacheAsyncWrite *)taskdata;
+
+  PTCacheFile *pf = ptcache_file_open_path(aw->filepath, PTCACHE_FILE_WRITE, aw->pm->frame);
+  if (pf) {
+    ptcache_mem_frame_to_file(pf, aw->pm, aw->type, aw->compression, aw->write_header);
+  }
+  else if (G.debug & G_DEBUG) {
+    printf("Error opening disk cache file for writing\n");
+  }
+
+  ptcache_mem_clear(aw->pm);
+  MEM_freeN(aw->pm);
+
+  BLI_mutex_lock(&ptcache_async.mutex);
+  BLI_remlink(&ptcache_async.pending, aw);
+  ptcache_async.pending_num--;
+  BLI_condition_notify_all(&ptcache_async.cond);
+  BLI_mutex_unlock(&ptcache_async.mutex);
+
+  MEM_freeN(aw);
+}
+
+static int ptcache_mem_frame_to_disk_and_free(PTCacheID *pid, PTCacheMem *pm)
+{
+  const int success = ptcache_mem_frame_to_disk(pid, pm);
+  ptcache_mem_clear(pm);
+  MEM_freeN(pm);
+  return success;
+}
+
+/**
+ * Like #ptcache_mem_frame_to_disk but takes ownership of `pm`. While baking, the frame is
+ * written on a background thread and errors are only reported in debug mode.
+ */
+static int ptcache_mem_frame_to_disk_async(PTCacheID *pid, PTCacheMem *pm)
+{
+  BLI_mutex_lock(&ptcache_async.mutex);
+  const bool use_async = ptcache_async.pool != NULL;
+  BLI_mutex_unlock(&ptcache_async.mutex);
+
+  /* Writes refused by #ptcache_file_open fail the same way as without a background thread. */
+  if (!use_async || !ptcache_file_open_allowed(pid, PTCACHE_FILE_WRITE)) {
+    return ptcache_mem_frame_to_disk_and_free(pid, pm);
+  }
+
+  BKE_ptcache_id_clear(pid, PTCACHE_CLEAR_FRAME, pm->frame);
+
+  PTCacheAsyncWrite *aw = MEM_callocN(sizeof(PTCacheAsyncWrite), "PTCacheAsyncWrite");
+  ptcache_filepath(pid, aw->filepath, pm->frame, true, true);
+  aw->pm = pm;
+  aw->type = pid->type;
+  aw->compression = pid->cache->compression;
+  aw->write_header = pid->write_header;
+
+  BLI_mutex_lock(&ptcache_async.mutex);
+  if (ptcache_async.pool == NULL) {
+    /* Flushed in the meantime. */
+    BLI_mutex_unlock(&ptcache_async.mutex);
+    MEM_freeN(aw);
+    return ptcache_mem_frame_to_disk_and_free(pid, pm);
+  }
+  while (ptcache_async.pending_num >= PTCACHE_ASYNC_WRITE_MAX_PENDING) {
+    BLI_condition_wait(&ptcache_async.cond, &ptcache_async.mutex);
+  }
+  BLI_addtail(&ptcache_async.pending, aw);
+  ptcache_async.pending_num++;
+  BLI_task_pool_push(ptcache_async.pool, ptcache_async_write_run, aw, false, NULL);
+  BLI_mutex_unlock(&ptcache_async.mutex);
+
+  return 1;
+}
+
 static int ptcache_read_stream(PTCacheID *pid, int cfra)
 {
   PTCacheFile *pf = ptcache_file_open(pid, PTCACHE_FILE_READ, cfra);
@@ -2454,18 +2684,10 @@ static int ptcache_write(PTCacheID *pid, int cfra, int overwrite)
   pm->frame = cfra;
 
   if (cache->flag & PTCACHE_DISK_CACHE) {
-    error += !ptcache_mem_frame_to_disk(pid, pm);
-
-    // if (pm) /* pm is always set */
-    {
-      ptcache_mem_clear(pm);
-      MEM_freeN(pm);
-    }
+    error += !ptcache_mem_frame_to_disk_async(pid, pm);
 
     if (pm2) {
-      error += !ptcache_mem_frame_to_disk(pid, pm2);
-      ptcache_mem_clear(pm2);
-      MEM_freeN(pm2);
+      error += !ptcache_mem_frame_to_disk_async(pid, pm2);
     }
   }
   else {
@@ -2617,6 +2839,7 @@ void BKE_ptcache_id_clear(PTCacheID *pid, int mode, uint cfra)
     case PTCACHE_CLEAR_BEFORE:
     case PTCACHE_CLEAR_AFTER:
       if (pid->cache->flag & PTCACHE_DISK_CACHE) {
+        ptcache_async_write_wait(NULL);
         ptcache_path(pid, path);
 
         dir = opendir(path);
@@ -2707,6 +2930,7 @@ void BKE_ptcache_id_clear(PTCacheID *pid, int mode, uint cfra)
       if (pid->cache->flag & PTCACHE_DISK_CACHE) {
         if (BKE_ptcache_id_exist(pid, cfra)) {
           ptcache_filepath(pid, filepath, cfra, true, true); /* no path */
+          ptcache_async_write_wait(filepath);
           BLI_delete(filepath, false, false);
         }
       }
@@ -2749,7 +2973,7 @@ bool BKE_ptcache_id_exist(PTCacheID *pid, int cfra)
 
     ptcache_filepath(pid, filepath, cfra, true, true);
 
-    return BLI_exists(filepath);
+    return BLI_exists(filepath) || ptcache_async_write_is_pending(filepath);
   }
 
   PTCacheMem *pm = pid->cache->mem_cache.first;
@@ -3275,6 +3499,8 @@ void BKE_ptcache_bake(PTCacheBaker *baker)
 
   stime = ptime = PIL_check_seconds_timer();
 
+  ptcache_async_write_begin();
+
   for (int fr = scene->r.cfra; fr <= endframe; fr += baker->quick_step, scene->r.cfra = fr) {
     BKE_scene_graph_update_for_newframe(depsgraph);
 
@@ -3317,6 +3543,8 @@ void BKE_ptcache_bake(PTCacheBaker *baker)
     scene->r.cfra += 1;
   }
 
+  ptcache_async_write_end();
+
   if (use_timer) {
     /* start with newline because of \r above */
     ptcache_dt_to_str(run, PIL_check_seconds_timer() - stime);
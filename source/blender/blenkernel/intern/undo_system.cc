@@ -31,6 +31,8 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "atomic_ops.h"
+
 #define undo_stack _wm_undo_stack_disallow /* pass in as a variable always. */
 
 /** Odd requirement of Blender that we always keep a memfile undo in the stack. */
@@ -398,7 +400,8 @@ void BKE_undosys_stack_limit_steps_and_memory(UndoStack *ustack, int steps, size
   size_t us_count = 0;
   for (us = static_cast<UndoStep *>(ustack->steps.last); us && us->prev; us = us->prev) {
     if (memory_limit) {
-      data_size_all += us->data_size;
+      /* Sculpt steps update their size when compacting in a background thread. */
+      data_size_all += atomic_load_z(&us->data_size);
       if (data_size_all > memory_limit) {
         break;
       }
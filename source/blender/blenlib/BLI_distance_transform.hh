@@ -0,0 +1,31 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#pragma once
+
+/** \file
+ * \ingroup bli
+ *
+ * Exact euclidean distance transform of 2D pixel grids, based on "Distance Transforms of Sampled
+ * Functions" by Felzenszwalb and Huttenlocher. Instead of the distance, the index of the closest
+ * source pixel is computed, which allows filling pixels with values from the closest source.
+ */
+
+#include "BLI_function_ref.hh"
+#include "BLI_math_vector_types.hh"
+#include "BLI_span.hh"
+
+namespace blender::distance_transform {
+
+/**
+ * For every pixel in a grid of the given size, find the closest pixel for which `is_source`
+ * returns true. Pixels are indexed row by row, i.e. `y * size.x + x`.
+ *
+ * \param is_source: Called exactly once for every pixel, possibly from multiple threads.
+ * \param r_nearest: Receives the index of the closest source pixel for every pixel, source
+ * pixels map to themselves. When there are no source pixels, all elements are -1.
+ */
+void nearest_pixels(int2 size,
+                    FunctionRef<bool(int64_t index)> is_source,
+                    MutableSpan<int> r_nearest);
+
+}  // namespace blender::distance_transform
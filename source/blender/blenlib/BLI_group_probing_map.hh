@@ -0,0 +1,520 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#pragma once
+
+/** \file
+ * \ingroup bli
+ *
+ * A `blender::GroupProbingMap<Key, Value>` has the same interface as `blender::Map<Key, Value>`
+ * for its core operations, but uses a different hash table layout: slots are probed in groups of
+ * 16 using SIMD compares of per-slot control bytes. See BLI_group_probing_table.hh for details.
+ *
+ * It tends to be faster than #Map for lookups in large maps, especially when many lookups fail or
+ * comparing keys is expensive (e.g. strings), and uses less memory because of its higher max load
+ * factor. For small maps and cheap keys #Map is usually just as fast, so it remains the default
+ * choice. The benchmarks in BLI_ghash_performance_test.cc compare both implementations.
+ *
+ * Differences with #Map:
+ * - There is no small buffer optimization.
+ * - The probing strategy and slot type can't be customized.
+ */
+
+#include "BLI_group_probing_table.hh"
+
+namespace blender {
+
+template<
+    /** Type of the keys stored in the map. Keys have to be movable. */
+    typename Key,
+    /** Type of the value that is stored per key. It has to be movable as well. */
+    typename Value,
+    /** The hash function used to hash the keys. See BLI_hash.hh. */
+    typename Hash = DefaultHash<Key>,
+    /** The equality operator used to compare keys. */
+    typename IsEqual = DefaultEquality<Key>,
+    /** The allocator used by this map. */
+    typename Allocator = GuardedAllocator>
+class GroupProbingMap {
+ private:
+  using Table = group_probing::Table<Key, Value, Hash, IsEqual, Allocator>;
+  using Entry = typename Table::Entry;
+
+  Table table_;
+
+ public:
+  struct Item {
+    const Key &key;
+    const Value &value;
+  };
+
+  struct MutableItem {
+    const Key &key;
+    Value &value;
+
+    operator Item() const
+    {
+      return Item{key, value};
+    }
+  };
+
+ private:
+  struct GetKey {
+    const Key &operator()(const Entry &entry) const
+    {
+      return entry.key;
+    }
+  };
+  struct GetValue {
+    const Value &operator()(const Entry &entry) const
+    {
+      return entry.value;
+    }
+  };
+  struct GetMutableValue {
+    Value &operator()(Entry &entry) const
+    {
+      return entry.value;
+    }
+  };
+  struct GetItem {
+    Item operator()(const Entry &entry) const
+    {
+      return Item{entry.key, entry.value};
+    }
+  };
+  struct GetMutableItem {
+    MutableItem operator()(Entry &entry) const
+    {
+      return MutableItem{entry.key, entry.value};
+    }
+  };
+
+  template<typename Getter>
+  using ConstRange =
+      group_probing::IteratorRange<group_probing::OccupiedSlotIterator<const Table, Getter>>;
+  template<typename Getter>
+  using MutableRange =
+      group_probing::IteratorRange<group_probing::OccupiedSlotIterator<Table, Getter>>;
+
+ public:
+  using size_type = int64_t;
+
+  GroupProbingMap(Allocator allocator = {}) noexcept : table_(allocator)
+  {
+  }
+
+  GroupProbingMap(NoExceptConstructor, Allocator allocator = {}) noexcept
+      : GroupProbingMap(allocator)
+  {
+  }
+
+  /**
+   * Insert a new key-value-pair into the map. This invokes undefined behavior when the key is in
+   * the map already.
+   */
+  void add_new(const Key &key, const Value &value)
+  {
+    this->add_new_as(key, value);
+  }
+  void add_new(const Key &key, Value &&value)
+  {
+    this->add_new_as(key, std::move(value));
+  }
+  void add_new(Key &&key, const Value &value)
+  {
+    this->add_new_as(std::move(key), value);
+  }
+  void add_new(Key &&key, Value &&value)
+  {
+    this->add_new_as(std::move(key), std::move(value));
+  }
+  template<typename ForwardKey, typename... ForwardValue>
+  void add_new_as(ForwardKey &&key, ForwardValue &&...value)
+  {
+    BLI_assert(!this->contains_as(key));
+    const uint64_t hash = table_.hash(key);
+    table_.add_new(std::forward<ForwardKey>(key), hash, std::forward<ForwardValue>(value)...);
+  }
+
+  /**
+   * Add a key-value-pair to the map. If the map contains the key already, nothing is changed.
+   * If you want to replace the currently stored value, use `add_overwrite`.
+   * Returns true when the key has been newly added.
+   */
+  bool add(const Key &key, const Value &value)
+  {
+    return this->add_as(key, value);
+  }
+  bool add(const Key &key, Value &&value)
+  {
+    return this->add_as(key, std::move(value));
+  }
+  bool add(Key &&key, const Value &value)
+  {
+    return this->add_as(std::move(key), value);
+  }
+  bool add(Key &&key, Value &&value)
+  {
+    return this->add_as(std::move(key), std::move(value));
+  }
+  template<typename ForwardKey, typename... ForwardValue>
+  bool add_as(ForwardKey &&key, ForwardValue &&...value)
+  {
+    const uint64_t hash = table_.hash(key);
+    return table_.add(std::forward<ForwardKey>(key), hash, std::forward<ForwardValue>(value)...)
+        .first;
+  }
+
+  /**
+   * Adds a key-value-pair to the map. If the map contained the key already, the corresponding
+   * value will be replaced. Returns true when the key has been newly added.
+   */
+  bool add_overwrite(const Key &key, const Value &value)
+  {
+    return this->add_overwrite_as(key, value);
+  }
+  bool add_overwrite(const Key &key, Value &&value)
+  {
+    return this->add_overwrite_as(key, std::move(value));
+  }
+  bool add_overwrite(Key &&key, const Value &value)
+  {
+    return this->add_overwrite_as(std::move(key), value);
+  }
+  bool add_overwrite(Key &&key, Value &&value)
+  {
+    return this->add_overwrite_as(std::move(key), std::move(value));
+  }
+  template<typename ForwardKey, typename... ForwardValue>
+  bool add_overwrite_as(ForwardKey &&key, ForwardValue &&...value)
+  {
+    const uint64_t hash = table_.hash(key);
+    const int64_t slot = table_.find_slot(key, hash);
+    if (slot != -1) {
+      table_.entry(slot).value = Value(std::forward<ForwardValue>(value)...);
+      return false;
+    }
+    table_.add_new(std::forward<ForwardKey>(key), hash, std::forward<ForwardValue>(value)...);
+    return true;
+  }
+
+  /**
+   * Returns true if there is a key in the map that compares equal to the given key.
+   */
+  bool contains(const Key &key) const
+  {
+    return this->contains_as(key);
+  }
+  template<typename ForwardKey> bool contains_as(const ForwardKey &key) const
+  {
+    return table_.find_slot(key, table_.hash(key)) != -1;
+  }
+
+  /**
+   * If the key is stored in the map, it will be removed and true is returned.
+   * Otherwise, false is returned and the map remains unchanged.
+   */
+  bool remove(const Key &key)
+  {
+    return this->remove_as(key);
+  }
+  template<typename ForwardKey> bool remove_as(const ForwardKey &key)
+  {
+    const int64_t slot = table_.find_slot(key, table_.hash(key));
+    if (slot == -1) {
+      return false;
+    }
+    table_.remove_slot(slot);
+    return true;
+  }
+
+  /**
+   * Deletes the key-value-pair with the given key. This invokes undefined behavior when the key is
+   * not in the map.
+   */
+  void remove_contained(const Key &key)
+  {
+    this->remove_contained_as(key);
+  }
+  template<typename ForwardKey> void remove_contained_as(const ForwardKey &key)
+  {
+    const int64_t slot = table_.find_slot(key, table_.hash(key));
+    BLI_assert(slot != -1);
+    table_.remove_slot(slot);
+  }
+
+  /**
+   * Get the value that is stored for the given key and remove it from the map. This invokes
+   * undefined behavior when the key is not in the map.
+   */
+  Value pop(const Key &key)
+  {
+    return this->pop_as(key);
+  }
+  template<typename ForwardKey> Value pop_as(const ForwardKey &key)
+  {
+    const int64_t slot = table_.find_slot(key, table_.hash(key));
+    BLI_assert(slot != -1);
+    Value value = std::move(table_.entry(slot).value);
+    table_.remove_slot(slot);
+    return value;
+  }
+
+  /**
+   * Returns a pointer to the value that corresponds to the given key.
+   * If the key is not in the map, null is returned.
+   */
+  const Value *lookup_ptr(const Key &key) const
+  {
+    return this->lookup_ptr_as(key);
+  }
+  Value *lookup_ptr(const Key &key)
+  {
+    return this->lookup_ptr_as(key);
+  }
+  template<typename ForwardKey> const Value *lookup_ptr_as(const ForwardKey &key) const
+  {
+    const int64_t slot = table_.find_slot(key, table_.hash(key));
+    return slot == -1 ? nullptr : &table_.entry(slot).value;
+  }
+  template<typename ForwardKey> Value *lookup_ptr_as(const ForwardKey &key)
+  {
+    const int64_t slot = table_.find_slot(key, table_.hash(key));
+    return slot == -1 ? nullptr : &table_.entry(slot).value;
+  }
+
+  /**
+   * Returns a reference to the value that corresponds to the given key. This invokes undefined
+   * behavior when the key is not in the map.
+   */
+  const Value &lookup(const Key &key) const
+  {
+    return this->lookup_as(key);
+  }
+  Value &lookup(const Key &key)
+  {
+    return this->lookup_as(key);
+  }
+  template<typename ForwardKey> const Value &lookup_as(const ForwardKey &key) const
+  {
+    const Value *ptr = this->lookup_ptr_as(key);
+    BLI_assert(ptr != nullptr);
+    return *ptr;
+  }
+  template<typename ForwardKey> Value &lookup_as(const ForwardKey &key)
+  {
+    Value *ptr = this->lookup_ptr_as(key);
+    BLI_assert(ptr != nullptr);
+    return *ptr;
+  }
+
+  /**
+   * Returns a copy of the value that corresponds to the given key. If the key is not in the
+   * map, the provided default_value is returned.
+   */
+  Value lookup_default(const Key &key, const Value &default_value) const
+  {
+    return this->lookup_default_as(key, default_value);
+  }
+  template<typename ForwardKey, typename... ForwardValue>
+  Value lookup_default_as(const ForwardKey &key, ForwardValue &&...default_value) const
+  {
+    const Value *ptr = this->lookup_ptr_as(key);
+    if (ptr != nullptr) {
+      return *ptr;
+    }
+    return Value(std::forward<ForwardValue>(default_value)...);
+  }
+
+  /**
+   * Returns a reference to the value that corresponds to the given key. If the key is not yet in
+   * the map, it will be newly added with the given value.
+   */
+  Value &lookup_or_add(const Key &key, const Value &value)
+  {
+    return this->lookup_or_add_as(key, value);
+  }
+  Value &lookup_or_add(const Key &key, Value &&value)
+  {
+    return this->lookup_or_add_as(key, std::move(value));
+  }
+  Value &lookup_or_add(Key &&key, const Value &value)
+  {
+    return this->lookup_or_add_as(std::move(key), value);
+  }
+  Value &lookup_or_add(Key &&key, Value &&value)
+  {
+    return this->lookup_or_add_as(std::move(key), std::move(value));
+  }
+  template<typename ForwardKey, typename... ForwardValue>
+  Value &lookup_or_add_as(ForwardKey &&key, ForwardValue &&...value)
+  {
+    const uint64_t hash = table_.hash(key);
+    const int64_t slot =
+        table_.add(std::forward<ForwardKey>(key), hash, std::forward<ForwardValue>(value)...)
+            .second;
+    return table_.entry(slot).value;
+  }
+
+  /**
+   * Returns a reference to the value that corresponds to the given key. If the key is not yet in
+   * the map, it will be newly added. The value is created using the given callback, which is only
+   * called when the key is added.
+   */
+  template<typename CreateValueF>
+  Value &lookup_or_add_cb(const Key &key, const CreateValueF &create_value)
+  {
+    return this->lookup_or_add_cb_as(key, create_value);
+  }
+  template<typename CreateValueF>
+  Value &lookup_or_add_cb(Key &&key, const CreateValueF &create_value)
+  {
+    return this->lookup_or_add_cb_as(std::move(key), create_value);
+  }
+  template<typename ForwardKey, typename CreateValueF>
+  Value &lookup_or_add_cb_as(ForwardKey &&key, const CreateValueF &create_value)
+  {
+    const uint64_t hash = table_.hash(key);
+    int64_t slot = table_.find_slot(key, hash);
+    if (slot == -1) {
+      slot = table_.add_new(std::forward<ForwardKey>(key), hash, create_value());
+    }
+    return table_.entry(slot).value;
+  }
+
+  /**
+   * Returns a reference to the value that corresponds to the given key. If the key is not yet in
+   * the map, it will be newly added with a default constructed value.
+   */
+  Value &lookup_or_add_default(const Key &key)
+  {
+    return this->lookup_or_add_default_as(key);
+  }
+  Value &lookup_or_add_default(Key &&key)
+  {
+    return this->lookup_or_add_default_as(std::move(key));
+  }
+  template<typename ForwardKey> Value &lookup_or_add_default_as(ForwardKey &&key)
+  {
+    return this->lookup_or_add_cb_as(std::forward<ForwardKey>(key), []() { return Value(); });
+  }
+
+  /**
+   * Calls the provided callback for every key-value-pair in the map. The callback is expected
+   * to take a `const Key &` as first and a `const Value &` as second parameter.
+   */
+  template<typename FuncT> void foreach_item(const FuncT &func) const
+  {
+    for (const Item item : this->items()) {
+      func(item.key, item.value);
+    }
+  }
+
+  /**
+   * Allows writing a range-for loop that iterates over all keys. The iterator is invalidated, when
+   * the map is changed.
+   */
+  ConstRange<GetKey> keys() const
+  {
+    return this->range<GetKey>();
+  }
+
+  /**
+   * Returns an iterator over all values in the map. The iterator is invalidated, when the map is
+   * changed.
+   */
+  ConstRange<GetValue> values() const
+  {
+    return this->range<GetValue>();
+  }
+  MutableRange<GetMutableValue> values()
+  {
+    return this->range<GetMutableValue>();
+  }
+
+  /**
+   * Returns an iterator over all key-value-pairs in the map. The key-value-pairs are stored in a
+   * #Item or #MutableItem struct with the corresponding name. The iterator is invalidated, when
+   * the map is changed.
+   */
+  ConstRange<GetItem> items() const
+  {
+    return this->range<GetItem>();
+  }
+  MutableRange<GetMutableItem> items()
+  {
+    return this->range<GetMutableItem>();
+  }
+
+  /**
+   * Return the number of key-value-pairs that are stored in the map.
+   */
+  int64_t size() const
+  {
+    return table_.size();
+  }
+
+  /**
+   * Returns true if there are no elements in the map.
+   */
+  bool is_empty() const
+  {
+    return table_.size() == 0;
+  }
+
+  /**
+   * Returns the number of available slots. This is mostly for debugging purposes.
+   */
+  int64_t capacity() const
+  {
+    return table_.capacity();
+  }
+
+  /**
+   * Returns the amount of removed slots in the set. This is mostly for debugging purposes.
+   */
+  int64_t removed_amount() const
+  {
+    return table_.removed_amount();
+  }
+
+  /**
+   * Returns the approximate memory requirements of the map in bytes.
+   */
+  int64_t size_in_bytes() const
+  {
+    return table_.size_in_bytes();
+  }
+
+  /**
+   * Potentially resize the map such that the specified number of elements can be added without
+   * another grow operation.
+   */
+  void reserve(const int64_t n)
+  {
+    table_.reserve(n);
+  }
+
+  /**
+   * Removes all key-value-pairs from the map and frees any allocated memory.
+   */
+  void clear()
+  {
+    table_.clear();
+  }
+
+ private:
+  template<typename Getter> ConstRange<Getter> range() const
+  {
+    using Iterator = group_probing::OccupiedSlotIterator<const Table, Getter>;
+    return ConstRange<Getter>(Iterator(table_, 0), Iterator(table_, table_.capacity()));
+  }
+
+  template<typename Getter> MutableRange<Getter> range()
+  {
+    using Iterator = group_probing::OccupiedSlotIterator<Table, Getter>;
+    return MutableRange<Getter>(Iterator(table_, 0), Iterator(table_, table_.capacity()));
+  }
+};
+
+}  // namespace blender
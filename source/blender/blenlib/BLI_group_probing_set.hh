@@ -0,0 +1,253 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#pragma once
+
+/** \file
+ * \ingroup bli
+ *
+ * A `blender::GroupProbingSet<Key>` has the same interface as `blender::Set<Key>` for its core
+ * operations, but uses a different hash table layout: slots are probed in groups of 16 using SIMD
+ * compares of per-slot control bytes. See BLI_group_probing_table.hh for details.
+ *
+ * It tends to be faster than #Set for lookups in large sets, especially when many lookups fail or
+ * comparing keys is expensive (e.g. strings), and uses less memory because of its higher max load
+ * factor. For small sets and cheap keys #Set is usually just as fast, so it remains the default
+ * choice. The benchmarks in BLI_ghash_performance_test.cc compare both implementations.
+ *
+ * Differences with #Set:
+ * - There is no small buffer optimization.
+ * - The probing strategy and slot type can't be customized.
+ */
+
+#include "BLI_group_probing_table.hh"
+
+namespace blender {
+
+template<
+    /** Type of the elements that are stored in this set. It has to be movable. */
+    typename Key,
+    /** The hash function used to hash the keys. See BLI_hash.hh. */
+    typename Hash = DefaultHash<Key>,
+    /** The equality operator used to compare keys. */
+    typename IsEqual = DefaultEquality<Key>,
+    /** The allocator used by this set. */
+    typename Allocator = GuardedAllocator>
+class GroupProbingSet {
+ private:
+  using Table = group_probing::Table<Key, group_probing::NoValue, Hash, IsEqual, Allocator>;
+  using Entry = typename Table::Entry;
+
+  struct GetKey {
+    const Key &operator()(const Entry &entry) const
+    {
+      return entry.key;
+    }
+  };
+
+  Table table_;
+
+ public:
+  using Iterator = group_probing::OccupiedSlotIterator<const Table, GetKey>;
+  using value_type = Key;
+  using iterator = Iterator;
+  using size_type = int64_t;
+
+  GroupProbingSet(Allocator allocator = {}) noexcept : table_(allocator)
+  {
+  }
+
+  GroupProbingSet(NoExceptConstructor, Allocator allocator = {}) noexcept
+      : GroupProbingSet(allocator)
+  {
+  }
+
+  GroupProbingSet(Span<Key> values, Allocator allocator = {}) : GroupProbingSet(allocator)
+  {
+    this->add_multiple(values);
+  }
+
+  GroupProbingSet(const std::initializer_list<Key> &values) : GroupProbingSet(Span<Key>(values))
+  {
+  }
+
+  /**
+   * Add a new key to the set. This invokes undefined behavior when the key is in the set already.
+   */
+  void add_new(const Key &key)
+  {
+    this->add_new_as(key);
+  }
+  void add_new(Key &&key)
+  {
+    this->add_new_as(std::move(key));
+  }
+  template<typename ForwardKey> void add_new_as(ForwardKey &&key)
+  {
+    BLI_assert(!this->contains_as(key));
+    const uint64_t hash = table_.hash(key);
+    table_.add_new(std::forward<ForwardKey>(key), hash);
+  }
+
+  /**
+   * Add a key to the set. If the key exists in the set already, nothing is done. The return value
+   * is true if the key was newly added.
+   */
+  bool add(const Key &key)
+  {
+    return this->add_as(key);
+  }
+  bool add(Key &&key)
+  {
+    return this->add_as(std::move(key));
+  }
+  template<typename ForwardKey> bool add_as(ForwardKey &&key)
+  {
+    const uint64_t hash = table_.hash(key);
+    return table_.add(std::forward<ForwardKey>(key), hash).first;
+  }
+
+  void add_multiple(Span<Key> keys)
+  {
+    for (const Key &key : keys) {
+      this->add(key);
+    }
+  }
+
+  /**
+   * Returns true if the key is in the set.
+   */
+  bool contains(const Key &key) const
+  {
+    return this->contains_as(key);
+  }
+  template<typename ForwardKey> bool contains_as(const ForwardKey &key) const
+  {
+    return table_.find_slot(key, table_.hash(key)) != -1;
+  }
+
+  /**
+   * Returns the key that is stored in the set that compares equal to the given key. This invokes
+   * undefined behavior when the key is not in the set.
+   */
+  const Key &lookup_key(const Key &key) const
+  {
+    return this->lookup_key_as(key);
+  }
+  template<typename ForwardKey> const Key &lookup_key_as(const ForwardKey &key) const
+  {
+    const int64_t slot = table_.find_slot(key, table_.hash(key));
+    BLI_assert(slot != -1);
+    return table_.entry(slot).key;
+  }
+
+  /**
+   * Returns a pointer to the key that is stored in the set that compares equal to the given key.
+   * If the key is not in the set, null is returned.
+   */
+  const Key *lookup_key_ptr(const Key &key) const
+  {
+    return this->lookup_key_ptr_as(key);
+  }
+  template<typename ForwardKey> const Key *lookup_key_ptr_as(const ForwardKey &key) const
+  {
+    const int64_t slot = table_.find_slot(key, table_.hash(key));
+    return slot == -1 ? nullptr : &table_.entry(slot).key;
+  }
+
+  /**
+   * Deletes the key from the set. Returns true if the key existed in the set before.
+   */
+  bool remove(const Key &key)
+  {
+    return this->remove_as(key);
+  }
+  template<typename ForwardKey> bool remove_as(const ForwardKey &key)
+  {
+    const int64_t slot = table_.find_slot(key, table_.hash(key));
+    if (slot == -1) {
+      return false;
+    }
+    table_.remove_slot(slot);
+    return true;
+  }
+
+  /**
+   * Deletes the key from the set. This invokes undefined behavior when the key is not in the set.
+   */
+  void remove_contained(const Key &key)
+  {
+    this->remove_contained_as(key);
+  }
+  template<typename ForwardKey> void remove_contained_as(const ForwardKey &key)
+  {
+    const int64_t slot = table_.find_slot(key, table_.hash(key));
+    BLI_assert(slot != -1);
+    table_.remove_slot(slot);
+  }
+
+  Iterator begin() const
+  {
+    return Iterator(table_, 0);
+  }
+
+  Iterator end() const
+  {
+    return Iterator(table_, table_.capacity());
+  }
+
+  /**
+   * Returns the number of keys stored in the set.
+   */
+  int64_t size() const
+  {
+    return table_.size();
+  }
+
+  bool is_empty() const
+  {
+    return table_.size() == 0;
+  }
+
+  /**
+   * Returns the number of available slots. This is mostly for debugging purposes.
+   */
+  int64_t capacity() const
+  {
+    return table_.capacity();
+  }
+
+  /**
+   * Returns the amount of removed slots in the set. This is mostly for debugging purposes.
+   */
+  int64_t removed_amount() const
+  {
+    return table_.removed_amount();
+  }
+
+  /**
+   * Returns the approximate memory requirements of the set in bytes.
+   */
+  int64_t size_in_bytes() const
+  {
+    return table_.size_in_bytes();
+  }
+
+  /**
+   * Potentially resize the set such that it can hold the specified number of keys without another
+   * grow operation.
+   */
+  void reserve(const int64_t n)
+  {
+    table_.reserve(n);
+  }
+
+  /**
+   * Removes all keys from the set and frees any allocated memory.
+   */
+  void clear()
+  {
+    table_.clear();
+  }
+};
+
+}  // namespace blender
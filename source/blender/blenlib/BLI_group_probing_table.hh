@@ -0,0 +1,513 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#pragma once
+
+/** \file
+ * \ingroup bli
+ *
+ * Hash table core shared by #GroupProbingSet and #GroupProbingMap.
+ *
+ * Unlike #Set and #Map, which store the state of a slot inline and compare one slot at a time,
+ * this table stores one control byte per slot in a separate array. The control byte is either
+ * empty, removed, or contains 7 bits of the hash of the key stored in the slot. Slots are probed in
+ * groups of 16, whose control bytes are compared to the hash bits of the searched key with a few
+ * SIMD instructions. Only slots whose hash bits match have to be compared with the key, so most
+ * lookups touch a single cache line of control bytes and compare the key at most once, even with
+ * a high load factor.
+ *
+ * Groups are probed using triangular probing over the group indices, which visits every group
+ * when the number of groups is a power of two.
+ */
+
+#include "BLI_allocator.hh"
+#include "BLI_array.hh"
+#include "BLI_hash.hh"
+#include "BLI_hash_tables.hh"
+#include "BLI_math_bits.h"
+#include "BLI_memory_utils.hh"
+#include "BLI_simd.h"
+#include "BLI_utildefines.h"
+
+namespace blender::group_probing {
+
+/** Number of slots whose control bytes are compared at once. */
+constexpr int64_t group_size = 16;
+
+/** Control byte of empty slots. Occupied slots store 7 bits of the hash, so they are >= 0. */
+constexpr int8_t control_empty = -128;
+/** Control byte of slots whose key has been removed. */
+constexpr int8_t control_removed = -2;
+
+/** Only 7/8 of the slots can be used before the table grows. */
+constexpr int64_t max_load_factor_numerator = 7;
+constexpr int64_t max_load_factor_denominator = 8;
+
+/** Has one bit set for every slot in a group that matched a query. */
+class GroupBitMask {
+ private:
+  uint32_t bits_;
+
+ public:
+  explicit GroupBitMask(const uint32_t bits) : bits_(bits)
+  {
+  }
+
+  bool has_any() const
+  {
+    return bits_ != 0;
+  }
+
+  /** Index of the first matching slot in the group. */
+  int64_t first() const
+  {
+    return int64_t(bitscan_forward_uint(bits_));
+  }
+
+  void clear_first()
+  {
+    bits_ &= bits_ - 1;
+  }
+};
+
+/** The control bytes of a group of slots. */
+class ControlGroup {
+ private:
+#ifdef BLI_HAVE_SSE2
+  __m128i controls_;
+#else
+  const int8_t *controls_;
+#endif
+
+ public:
+  explicit ControlGroup(const int8_t *controls)
+#ifdef BLI_HAVE_SSE2
+      : controls_(_mm_loadu_si128(reinterpret_cast<const __m128i *>(controls)))
+#else
+      : controls_(controls)
+#endif
+  {
+  }
+
+  /** Slots whose control byte is equal to the given value. */
+  GroupBitMask match(const int8_t control) const
+  {
+#ifdef BLI_HAVE_SSE2
+    return GroupBitMask(
+        uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(control), controls_))));
+#else
+    uint32_t bits = 0;
+    for (int64_t i = 0; i < group_size; i++) {
+      bits |= uint32_t(controls_[i] == control) << i;
+    }
+    return GroupBitMask(bits);
+#endif
+  }
+
+  GroupBitMask match_empty() const
+  {
+    return this->match(control_empty);
+  }
+
+  /** Both control values of unoccupied slots have the sign bit set. */
+  GroupBitMask match_empty_or_removed() const
+  {
+#ifdef BLI_HAVE_SSE2
+    return GroupBitMask(uint32_t(_mm_movemask_epi8(controls_)));
+#else
+    uint32_t bits = 0;
+    for (int64_t i = 0; i < group_size; i++) {
+      bits |= uint32_t(controls_[i] < 0) << i;
+    }
+    return GroupBitMask(bits);
+#endif
+  }
+};
+
+/**
+ * Many hash functions in Blender (e.g. for integers and pointers) don't mix their bits. Mix them,
+ * so that keys spread over the groups and the 7 control bits differ for keys in the same group.
+ *
+ * The low bits of a product only depend on the low bits of its factors, so keys that only differ
+ * in their high bits (e.g. multiples of a power of two) would all start probing in the same few
+ * groups. Folding the high half of the product into the low half makes the group index depend on
+ * all bits of the hash.
+ */
+inline uint64_t mix_hash(const uint64_t hash)
+{
+  const uint64_t product = (hash ^ (hash >> 32)) * uint64_t(0x9E3779B97F4A7C15);
+  return product ^ (product >> 32);
+}
+
+/** The top bits of the mixed hash, stored in the control byte of occupied slots. */
+inline int8_t hash_control(const uint64_t mixed_hash)
+{
+  return int8_t(mixed_hash >> 57);
+}
+
+/** Used as value type by #GroupProbingSet, it does not take up space in the entries. */
+struct NoValue {
+};
+
+/**
+ * Stores the keys and values of #GroupProbingSet and #GroupProbingMap. All lookup functions take
+ * the hash of the key, that has been computed with the hash function of the container.
+ */
+template<typename Key, typename Value, typename Hash, typename IsEqual, typename Allocator>
+class Table {
+ public:
+  struct Entry {
+    Key key;
+    BLI_NO_UNIQUE_ADDRESS Value value;
+  };
+
+ private:
+  /**
+   * One control byte per slot. When the table is empty, a single group of empty slots is stored
+   * inline, so that lookups don't need a special case.
+   */
+  Array<int8_t, group_size, Allocator> controls_;
+  Array<TypedBuffer<Entry>, 0, Allocator> entries_;
+
+  int64_t occupied_slots_ = 0;
+  int64_t removed_slots_ = 0;
+  /** Maximum number of occupied and removed slots before the table has to grow. */
+  int64_t usable_slots_ = 0;
+  /** The number of groups minus one. */
+  uint64_t group_mask_ = 0;
+
+  BLI_NO_UNIQUE_ADDRESS Hash hash_;
+  BLI_NO_UNIQUE_ADDRESS IsEqual is_equal_;
+
+ public:
+  Table(Allocator allocator = {}) noexcept
+      : controls_(group_size, control_empty, allocator), entries_(allocator)
+  {
+  }
+
+  Table(const Table &other)
+      : controls_(other.controls_),
+        entries_(other.entries_.size(), NoInitialization(), other.entries_.allocator()),
+        occupied_slots_(other.occupied_slots_),
+        removed_slots_(other.removed_slots_),
+        usable_slots_(other.usable_slots_),
+        group_mask_(other.group_mask_)
+  {
+    for (const int64_t slot : entries_.index_range()) {
+      if (controls_[slot] >= 0) {
+        new (entries_[slot]) Entry(*other.entries_[slot]);
+      }
+    }
+  }
+
+  Table(Table &&other) noexcept
+      : controls_(std::move(other.controls_)),
+        entries_(std::move(other.entries_)),
+        occupied_slots_(other.occupied_slots_),
+        removed_slots_(other.removed_slots_),
+        usable_slots_(other.usable_slots_),
+        group_mask_(other.group_mask_)
+  {
+    other.noexcept_reset();
+  }
+
+  ~Table()
+  {
+    this->destruct_entries();
+  }
+
+  Table &operator=(const Table &other)
+  {
+    return copy_assign_container(*this, other);
+  }
+
+  Table &operator=(Table &&other)
+  {
+    return move_assign_container(*this, std::move(other));
+  }
+
+  int64_t size() const
+  {
+    return occupied_slots_;
+  }
+
+  int64_t capacity() const
+  {
+    return entries_.size();
+  }
+
+  int64_t removed_amount() const
+  {
+    return removed_slots_;
+  }
+
+  int64_t size_in_bytes() const
+  {
+    return int64_t(sizeof(int8_t) + sizeof(Entry)) * entries_.size();
+  }
+
+  /** Index of the slot that contains the key, or -1 when the key is not in the table. */
+  template<typename ForwardKey>
+  int64_t find_slot(const ForwardKey &key, const uint64_t hash) const
+  {
+    const uint64_t mixed_hash = mix_hash(hash);
+    const int8_t control = hash_control(mixed_hash);
+    uint64_t group_index = mixed_hash & group_mask_;
+    for (uint64_t step = 1;; step++) {
+      const int64_t group_start = int64_t(group_index) * group_size;
+      const ControlGroup group(&controls_[group_start]);
+      for (GroupBitMask mask = group.match(control); mask.has_any(); mask.clear_first()) {
+        const int64_t slot = group_start + mask.first();
+        if (is_equal_(key, (*entries_[slot]).key)) {
+          return slot;
+        }
+      }
+      if (group.match_empty().has_any()) {
+        return -1;
+      }
+      group_index = (group_index + step) & group_mask_;
+    }
+  }
+
+  /** Construct a new entry for a key that is known not to be in the table yet. */
+  template<typename ForwardKey, typename... ForwardValue>
+  int64_t add_new(ForwardKey &&key, const uint64_t hash, ForwardValue &&...value)
+  {
+    this->ensure_can_add();
+    const uint64_t mixed_hash = mix_hash(hash);
+    const int64_t slot = this->find_unoccupied_slot(mixed_hash);
+    new (entries_[slot])
+        Entry{Key(std::forward<ForwardKey>(key)), Value(std::forward<ForwardValue>(value)...)};
+    this->occupy_slot(slot, mixed_hash);
+    return slot;
+  }
+
+  /** Add an entry if the key is not in the table yet. The first value is true when it was added. */
+  template<typename ForwardKey, typename... ForwardValue>
+  std::pair<bool, int64_t> add(ForwardKey &&key, const uint64_t hash, ForwardValue &&...value)
+  {
+    const int64_t slot = this->find_slot(key, hash);
+    if (slot != -1) {
+      return {false, slot};
+    }
+    return {true,
+            this->add_new(std::forward<ForwardKey>(key),
+                          hash,
+                          std::forward<ForwardValue>(value)...)};
+  }
+
+  void remove_slot(const int64_t slot)
+  {
+    BLI_assert(controls_[slot] >= 0);
+    std::destroy_at(&*entries_[slot]);
+    occupied_slots_--;
+    /* When the group has an empty slot, no probe sequence ever continued past it, so the slot can
+     * become empty again. Otherwise keys with the same start group may be stored further on. */
+    const ControlGroup group(&controls_[slot & ~(group_size - 1)]);
+    if (group.match_empty().has_any()) {
+      controls_[slot] = control_empty;
+    }
+    else {
+      controls_[slot] = control_removed;
+      removed_slots_++;
+    }
+  }
+
+  bool is_occupied(const int64_t slot) const
+  {
+    return controls_[slot] >= 0;
+  }
+
+  Entry &entry(const int64_t slot)
+  {
+    BLI_assert(this->is_occupied(slot));
+    return *entries_[slot];
+  }
+
+  const Entry &entry(const int64_t slot) const
+  {
+    BLI_assert(this->is_occupied(slot));
+    return *entries_[slot];
+  }
+
+  /** First occupied slot starting at the given slot, or the capacity if there is none. */
+  int64_t next_occupied_slot(int64_t slot) const
+  {
+    const int64_t slots_num = entries_.size();
+    while (slot < slots_num && controls_[slot] < 0) {
+      slot++;
+    }
+    return slot;
+  }
+
+  template<typename ForwardKey> uint64_t hash(const ForwardKey &key) const
+  {
+    return hash_(key);
+  }
+
+  void reserve(const int64_t n)
+  {
+    if (usable_slots_ < n) {
+      this->realloc_and_reinsert(n);
+    }
+  }
+
+  void clear()
+  {
+    this->noexcept_reset();
+  }
+
+ private:
+  void noexcept_reset() noexcept
+  {
+    Allocator allocator = entries_.allocator();
+    this->destruct_entries();
+    std::destroy_at(this);
+    new (this) Table(allocator);
+  }
+
+  void destruct_entries()
+  {
+    if constexpr (!std::is_trivially_destructible_v<Entry>) {
+      for (const int64_t slot : entries_.index_range()) {
+        if (controls_[slot] >= 0) {
+          std::destroy_at(&*entries_[slot]);
+        }
+      }
+    }
+    /* Avoid destructing the entries a second time. */
+    controls_.fill(control_empty);
+  }
+
+  void ensure_can_add()
+  {
+    if (UNLIKELY(occupied_slots_ + removed_slots_ >= usable_slots_)) {
+      this->realloc_and_reinsert(occupied_slots_ + 1);
+    }
+  }
+
+  int64_t find_unoccupied_slot(const uint64_t mixed_hash) const
+  {
+    uint64_t group_index = mixed_hash & group_mask_;
+    for (uint64_t step = 1;; step++) {
+      const int64_t group_start = int64_t(group_index) * group_size;
+      const GroupBitMask mask = ControlGroup(&controls_[group_start]).match_empty_or_removed();
+      if (mask.has_any()) {
+        return group_start + mask.first();
+      }
+      group_index = (group_index + step) & group_mask_;
+    }
+  }
+
+  void occupy_slot(const int64_t slot, const uint64_t mixed_hash)
+  {
+    if (controls_[slot] == control_removed) {
+      removed_slots_--;
+    }
+    controls_[slot] = hash_control(mixed_hash);
+    occupied_slots_++;
+  }
+
+  BLI_NOINLINE void realloc_and_reinsert(const int64_t min_usable_slots)
+  {
+    int64_t total_slots = group_size;
+    while (total_slots * max_load_factor_numerator / max_load_factor_denominator <
+           min_usable_slots) {
+      total_slots *= 2;
+    }
+
+    Table new_table(entries_.allocator());
+    new_table.controls_ = Array<int8_t, group_size, Allocator>(
+        total_slots, control_empty, controls_.allocator());
+    new_table.entries_ = Array<TypedBuffer<Entry>, 0, Allocator>(
+        total_slots, NoInitialization(), entries_.allocator());
+    new_table.usable_slots_ = total_slots * max_load_factor_numerator /
+                              max_load_factor_denominator;
+    new_table.group_mask_ = uint64_t(total_slots / group_size - 1);
+
+    for (const int64_t slot : entries_.index_range()) {
+      if (controls_[slot] >= 0) {
+        Entry &entry = *entries_[slot];
+        const uint64_t mixed_hash = mix_hash(hash_(entry.key));
+        const int64_t new_slot = new_table.find_unoccupied_slot(mixed_hash);
+        new (new_table.entries_[new_slot]) Entry(std::move(entry));
+        std::destroy_at(&entry);
+        new_table.occupy_slot(new_slot, mixed_hash);
+      }
+    }
+    controls_.fill(control_empty);
+
+    *this = std::move(new_table);
+  }
+};
+
+/**
+ * Iterates over the occupied slots of a table. The #Getter functor turns an entry into the value
+ * that is iterated over.
+ */
+template<typename TableT, typename Getter> class OccupiedSlotIterator {
+ public:
+  using iterator_category = std::forward_iterator_tag;
+  using difference_type = std::ptrdiff_t;
+
+ private:
+  TableT *table_;
+  int64_t slot_;
+
+ public:
+  OccupiedSlotIterator(TableT &table, const int64_t slot)
+      : table_(&table), slot_(table.next_occupied_slot(slot))
+  {
+  }
+
+  OccupiedSlotIterator &operator++()
+  {
+    slot_ = table_->next_occupied_slot(slot_ + 1);
+    return *this;
+  }
+
+  OccupiedSlotIterator operator++(int)
+  {
+    OccupiedSlotIterator copied_iterator = *this;
+    ++(*this);
+    return copied_iterator;
+  }
+
+  decltype(auto) operator*() const
+  {
+    return Getter()(table_->entry(slot_));
+  }
+
+  friend bool operator!=(const OccupiedSlotIterator &a, const OccupiedSlotIterator &b)
+  {
+    BLI_assert(a.table_ == b.table_);
+    return a.slot_ != b.slot_;
+  }
+
+  friend bool operator==(const OccupiedSlotIterator &a, const OccupiedSlotIterator &b)
+  {
+    return !(a != b);
+  }
+};
+
+template<typename Iterator> class IteratorRange {
+ private:
+  Iterator begin_;
+  Iterator end_;
+
+ public:
+  IteratorRange(Iterator begin, Iterator end) : begin_(begin), end_(end)
+  {
+  }
+
+  Iterator begin() const
+  {
+    return begin_;
+  }
+
+  Iterator end() const
+  {
+    return end_;
+  }
+};
+
+}  // namespace blender::group_probing
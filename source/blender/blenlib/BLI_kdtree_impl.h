@@ -64,6 +64,20 @@ int BLI_kdtree_nd_(calc_duplicates_fast)(const KDTree *tree,
 
 int BLI_kdtree_nd_(deduplicate)(KDTree *tree);
 
+/** Batched versions of find/range search, the queries run in parallel. */
+void BLI_kdtree_nd_(find_nearest_n_batch)(const KDTree *tree,
+                                          const float (*co)[KD_DIMS],
+                                          uint co_len,
+                                          KDTreeNearest *r_nearest,
+                                          uint nearest_len_capacity,
+                                          int *r_nearest_len) ATTR_NONNULL(1);
+int BLI_kdtree_nd_(range_search_batch)(const KDTree *tree,
+                                       const float (*co)[KD_DIMS],
+                                       uint co_len,
+                                       float range,
+                                       int *r_offsets,
+                                       KDTreeNearest **r_nearest) ATTR_NONNULL(1, 5, 6);
+
 /** Versions of find/range search that take a squared distance callback to support bias. */
 int BLI_kdtree_nd_(find_nearest_n_with_len_squared_cb)(
     const KDTree *tree,
@@ -50,6 +50,11 @@ void BLI_mempool_clear(BLI_mempool *pool) ATTR_NONNULL(1);
  */
 void BLI_mempool_destroy(BLI_mempool *pool) ATTR_NONNULL(1);
 int BLI_mempool_len(const BLI_mempool *pool) ATTR_NONNULL(1);
+/**
+ * The number of elements the allocated chunks have room for.
+ * This is more than #BLI_mempool_len when elements have been freed.
+ */
+int BLI_mempool_len_alloc(const BLI_mempool *pool) ATTR_NONNULL(1);
 void *BLI_mempool_findelem(BLI_mempool *pool, unsigned int index) ATTR_WARN_UNUSED_RESULT
     ATTR_NONNULL(1);
 
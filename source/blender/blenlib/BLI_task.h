@@ -433,6 +433,28 @@ void BLI_task_isolate(void (*func)(void *userdata), void *userdata);
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Task Tracing
+ *
+ * Record the parallel loop chunks and pool tasks executed on each thread, see `BLI_task_trace.hh`
+ * for annotating code with region names.
+ *
+ * Beginning, ending and writing the trace must be done from the main thread, while no parallel
+ * work is running.
+ * \{ */
+
+/** Clear previously recorded spans and start recording. */
+void BLI_task_trace_begin(void);
+void BLI_task_trace_end(void);
+bool BLI_task_trace_is_enabled(void);
+/**
+ * Write the recorded spans in the Chrome trace event JSON format.
+ * \return false when the file could not be written.
+ */
+bool BLI_task_trace_write_json(const char *filepath);
+
+/** \} */
+
 #ifdef __cplusplus
 }
 #endif
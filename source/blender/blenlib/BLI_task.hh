@@ -32,6 +32,7 @@
 
 #include "BLI_index_range.hh"
 #include "BLI_lazy_threading.hh"
+#include "BLI_task_trace.hh"
 #include "BLI_utildefines.h"
 
 namespace blender::threading {
@@ -40,7 +41,11 @@ template<typename Range, typename Function>
 void parallel_for_each(Range &&range, const Function &function)
 {
 #ifdef WITH_TBB
-  tbb::parallel_for_each(range, function);
+  const char *trace_name = trace::parallel_name();
+  tbb::parallel_for_each(range, [&](auto &&value) {
+    trace::Span span(trace_name, trace::SpanType::ParallelChunk);
+    function(std::forward<decltype(value)>(value));
+  });
 #else
   for (auto &value : range) {
     function(value);
@@ -58,9 +63,11 @@ void parallel_for(IndexRange range, int64_t grain_size, const Function &function
   /* Invoking tbb for small workloads has a large overhead. */
   if (range.size() >= grain_size) {
     lazy_threading::send_hint();
+    const char *trace_name = trace::parallel_name();
     tbb::parallel_for(
         tbb::blocked_range<int64_t>(range.first(), range.one_after_last(), grain_size),
         [&](const tbb::blocked_range<int64_t> &subrange) {
+          trace::Span span(trace_name, trace::SpanType::ParallelChunk, int64_t(subrange.size()));
           function(IndexRange(subrange.begin(), subrange.size()));
         });
     return;
@@ -111,10 +118,12 @@ Value parallel_reduce(IndexRange range,
 #ifdef WITH_TBB
   if (range.size() >= grain_size) {
     lazy_threading::send_hint();
+    const char *trace_name = trace::parallel_name();
     return tbb::parallel_reduce(
         tbb::blocked_range<int64_t>(range.first(), range.one_after_last(), grain_size),
         identity,
         [&](const tbb::blocked_range<int64_t> &subrange, const Value &ident) {
+          trace::Span span(trace_name, trace::SpanType::ParallelChunk, int64_t(subrange.size()));
           return function(IndexRange(subrange.begin(), subrange.size()), ident);
         },
         reduction);
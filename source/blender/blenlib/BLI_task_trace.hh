@@ -0,0 +1,99 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#pragma once
+
+/** \file
+ * \ingroup bli
+ *
+ * Opt-in tracing of parallel work, to find out which code is serializing, oversubscribing or
+ * running with poor grain sizes.
+ *
+ * Code is annotated with #TraceRegion, using a static name. While tracing is enabled, the region
+ * itself, the chunks of parallel loops and the task pool tasks started inside of it are recorded
+ * per thread under that name. The trace is written in the Chrome trace event format, which can be
+ * opened in Perfetto or `chrome://tracing`. See #BLI_task_trace_begin for the C API.
+ *
+ * When tracing is disabled, the overhead is a single check per region and per parallel loop.
+ */
+
+#include <cstdint>
+
+#include "BLI_utildefines.h"
+#include "BLI_utility_mixins.hh"
+
+namespace blender::threading::trace {
+
+enum class SpanType : int8_t {
+  Region,
+  ParallelChunk,
+  PoolTask,
+};
+
+/** Whether spans are currently recorded. */
+bool is_enabled();
+
+/**
+ * Name to record parallel work started by the calling thread under, or null when tracing is
+ * disabled. This is the name of the innermost region, or of the chunk or task being executed.
+ */
+const char *parallel_name();
+
+namespace detail {
+
+struct SpanState {
+  const char *name;
+  const char *parent_name;
+  int64_t start_time;
+  int64_t size;
+  SpanType type;
+};
+
+void span_begin(SpanState &state);
+void span_end(const SpanState &state);
+
+}  // namespace detail
+
+/**
+ * Record the execution of a chunk of parallel work, for the duration of its scope. Chunks are
+ * created with the name returned by #parallel_name when the work was started, nothing is recorded
+ * when that is null.
+ */
+class Span : NonCopyable, NonMovable {
+ private:
+  detail::SpanState state_;
+
+ public:
+  Span(const char *name, const SpanType type, const int64_t size = 1)
+  {
+    state_.name = name;
+    if (UNLIKELY(name != nullptr)) {
+      state_.type = type;
+      state_.size = size;
+      detail::span_begin(state_);
+    }
+  }
+
+  ~Span()
+  {
+    if (UNLIKELY(state_.name != nullptr)) {
+      detail::span_end(state_);
+    }
+  }
+};
+
+/**
+ * Annotate the scope with a name, that is used for the parallel work started inside of it.
+ * The name must be a static string, it is only stored as a pointer.
+ */
+class TraceRegion : NonCopyable, NonMovable {
+ private:
+  Span span_;
+
+ public:
+  explicit TraceRegion(const char *name)
+      : span_(is_enabled() ? name : nullptr, SpanType::Region, 0)
+  {
+  }
+};
+
+}  // namespace blender::threading::trace
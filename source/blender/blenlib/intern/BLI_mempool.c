@@ -436,6 +436,15 @@ int BLI_mempool_len(const BLI_mempool *pool)
   return (int)pool->totused;
 }
 
+int BLI_mempool_len_alloc(const BLI_mempool *pool)
+{
+  uint chunks_len = 0;
+  for (const BLI_mempool_chunk *mpchunk = pool->chunks; mpchunk; mpchunk = mpchunk->next) {
+    chunks_len++;
+  }
+  return (int)(chunks_len * pool->pchunk);
+}
+
 void *BLI_mempool_findelem(BLI_mempool *pool, uint index)
 {
   BLI_assert(pool->flag & BLI_MEMPOOL_ALLOW_ITER);
@@ -90,6 +90,7 @@
 
 #include "BLI_listbase.h"
 #include "BLI_mempool.h"
+#include "BLI_task.h"
 
 #include "BLI_strict_flags.h"
 
@@ -160,6 +161,17 @@
  * representing 4,194,303 different combinations.
  */
 #  define BCHUNK_HASH_TABLE_ACCUMULATE_STEPS_8BITS 6
+
+/**
+ * Calculate the hashes of large arrays using multiple threads.
+ * The result is identical to calculating them on a single thread.
+ */
+#  define USE_HASH_ARRAY_PARALLEL
+
+#  ifdef USE_HASH_ARRAY_PARALLEL
+/** The number of hashes each task calculates, smaller arrays use a single thread. */
+#    define HASH_ARRAY_PARALLEL_BLOCK_LEN (1 << 14)
+#  endif
 #else
 /**
  * How many items to hash (multiplied by stride).
@@ -858,6 +870,134 @@ static void hash_accum(hash_key *hash_array, const size_t hash_array_len, size_t
   }
 }
 
+#  ifdef USE_HASH_ARRAY_PARALLEL
+
+typedef struct HashArrayParallelData {
+  const BArrayInfo *info;
+  const uchar *data_slice;
+  /** Input of #hash_accum_parallel_fn. */
+  const hash_key *hash_array_src;
+  hash_key *hash_array;
+  size_t hash_array_len;
+  size_t hash_array_search_len;
+  size_t hash_offset;
+} HashArrayParallelData;
+
+static void hash_array_from_data_parallel_fn(void *__restrict userdata,
+                                             const int block,
+                                             const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const HashArrayParallelData *data = userdata;
+  const size_t i_start = (size_t)block * HASH_ARRAY_PARALLEL_BLOCK_LEN;
+  const size_t i_end = MIN2(i_start + HASH_ARRAY_PARALLEL_BLOCK_LEN, data->hash_array_len);
+  const size_t stride = data->info->chunk_stride;
+  hash_array_from_data(data->info,
+                       &data->data_slice[i_start * stride],
+                       (i_end - i_start) * stride,
+                       &data->hash_array[i_start]);
+}
+
+/**
+ * A single step of #hash_accum, reading from a copy of the hashes
+ * so blocks don't depend on values written by other blocks.
+ */
+static void hash_accum_parallel_fn(void *__restrict userdata,
+                                   const int block,
+                                   const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const HashArrayParallelData *data = userdata;
+  const hash_key *hash_array_src = data->hash_array_src;
+  hash_key *hash_array = data->hash_array;
+  const size_t i_start = (size_t)block * HASH_ARRAY_PARALLEL_BLOCK_LEN;
+  const size_t i_end = MIN2(i_start + HASH_ARRAY_PARALLEL_BLOCK_LEN, data->hash_array_len);
+  /* The last hashes aren't accumulated, they are copied. */
+  size_t i_search_end = MIN2(i_end, data->hash_array_search_len);
+  if (i_search_end < i_start) {
+    i_search_end = i_start;
+  }
+
+  size_t i = i_start;
+  for (; i < i_search_end; i++) {
+    /* Same as #hash_accum_impl. */
+    hash_array[i] = hash_array_src[i] + ((hash_array_src[i + data->hash_offset] << 3) ^
+                                         (hash_array_src[i] >> 1));
+  }
+  for (; i < i_end; i++) {
+    hash_array[i] = hash_array_src[i];
+  }
+}
+
+/**
+ * Multi-threaded version of #hash_array_from_data followed by #hash_accum.
+ * Each accumulation step swaps the hashes with a second array, which is returned
+ * when it ends up holding the result (\a hash_array is freed in that case).
+ */
+static hash_key *hash_array_from_data_accum_parallel(const BArrayInfo *info,
+                                                     const uchar *data_slice,
+                                                     hash_key *hash_array,
+                                                     const size_t hash_array_len)
+{
+  HashArrayParallelData data = {
+      .info = info,
+      .data_slice = data_slice,
+      .hash_array = hash_array,
+      .hash_array_len = hash_array_len,
+  };
+  const int blocks_len = (int)((hash_array_len + HASH_ARRAY_PARALLEL_BLOCK_LEN - 1) /
+                               HASH_ARRAY_PARALLEL_BLOCK_LEN);
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1;
+  BLI_task_parallel_range(0, blocks_len, &data, hash_array_from_data_parallel_fn, &settings);
+
+  size_t iter_steps = info->accum_steps;
+  /* _very_ unlikely, can happen if you select a chunk-size of 1 for example. */
+  if (UNLIKELY(iter_steps > hash_array_len)) {
+    iter_steps = hash_array_len;
+  }
+  data.hash_array_search_len = hash_array_len - iter_steps;
+
+  hash_key *hash_array_other = MEM_mallocN(sizeof(*hash_array_other) * hash_array_len, __func__);
+  while (iter_steps != 0) {
+    data.hash_offset = iter_steps;
+    data.hash_array_src = hash_array;
+    data.hash_array = hash_array_other;
+    BLI_task_parallel_range(0, blocks_len, &data, hash_accum_parallel_fn, &settings);
+    SWAP(hash_key *, hash_array, hash_array_other);
+    iter_steps -= 1;
+  }
+  MEM_freeN(hash_array_other);
+
+  return hash_array;
+}
+
+#  endif /* USE_HASH_ARRAY_PARALLEL */
+
+/**
+ * Calculate accumulated hashes for every element in \a data_slice,
+ * see #hash_array_from_data & #hash_accum.
+ *
+ * \return An allocated array of `data_slice_len / chunk_stride` hashes.
+ */
+static hash_key *hash_array_from_data_accum(const BArrayInfo *info,
+                                            const uchar *data_slice,
+                                            const size_t data_slice_len)
+{
+  const size_t hash_array_len = data_slice_len / info->chunk_stride;
+  hash_key *hash_array = MEM_mallocN(sizeof(*hash_array) * hash_array_len, __func__);
+
+#  ifdef USE_HASH_ARRAY_PARALLEL
+  if (hash_array_len >= 2 * HASH_ARRAY_PARALLEL_BLOCK_LEN) {
+    return hash_array_from_data_accum_parallel(info, data_slice, hash_array, hash_array_len);
+  }
+#  endif
+
+  hash_array_from_data(info, data_slice, data_slice_len, hash_array);
+  hash_accum(hash_array, hash_array_len, info->accum_steps);
+  return hash_array;
+}
+
 /**
  * When we only need a single value, can use a small optimization.
  * we can avoid accumulating the tail of the array a little, each iteration.
@@ -1227,12 +1367,8 @@ static BChunkList *bchunk_list_from_data_merge(const BArrayInfo *info,
 
 #ifdef USE_HASH_TABLE_ACCUMULATE
     size_t i_table_start = i_prev;
-    const size_t table_hash_array_len = (data_len - i_prev) / info->chunk_stride;
-    hash_key *table_hash_array = MEM_mallocN(sizeof(*table_hash_array) * table_hash_array_len,
-                                             __func__);
-    hash_array_from_data(info, &data[i_prev], data_len - i_prev, table_hash_array);
-
-    hash_accum(table_hash_array, table_hash_array_len, info->accum_steps);
+    hash_key *table_hash_array = hash_array_from_data_accum(
+        info, &data[i_prev], data_len - i_prev);
 #else
     /* dummy vars */
     uint i_table_start = 0;
@@ -0,0 +1,128 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup bli
+ */
+
+#include <limits>
+
+#include "BLI_array.hh"
+#include "BLI_distance_transform.hh"
+#include "BLI_task.hh"
+
+namespace blender::distance_transform {
+
+/**
+ * First pass: find the closest source pixel within every column. The columns are processed in
+ * tiles that are swept row by row, so that memory is accessed contiguously. The row of the closest
+ * source is stored in `r_nearest_y`, or -1 if the column has no source pixels.
+ */
+static void nearest_in_columns(const int2 size,
+                               const FunctionRef<bool(int64_t index)> is_source,
+                               MutableSpan<int> r_nearest_y)
+{
+  threading::parallel_for(IndexRange(size.x), 64, [&](const IndexRange columns) {
+    Array<int> source_y(columns.size());
+
+    /* Closest source with a lower or equal row. */
+    source_y.fill(-1);
+    for (const int y : IndexRange(size.y)) {
+      const int64_t row_start = int64_t(y) * size.x;
+      for (const int64_t i : IndexRange(columns.size())) {
+        const int64_t index = row_start + columns[i];
+        if (is_source(index)) {
+          source_y[i] = y;
+        }
+        r_nearest_y[index] = source_y[i];
+      }
+    }
+
+    /* Closest source with a higher row, keep the one found above when it is as close. */
+    source_y.fill(-1);
+    for (int y = size.y - 1; y >= 0; y--) {
+      const int64_t row_start = int64_t(y) * size.x;
+      for (const int64_t i : IndexRange(columns.size())) {
+        const int64_t index = row_start + columns[i];
+        const int nearest_y = r_nearest_y[index];
+        if (nearest_y == y) {
+          source_y[i] = y;
+          continue;
+        }
+        if (source_y[i] != -1 && (nearest_y == -1 || source_y[i] - y < y - nearest_y)) {
+          r_nearest_y[index] = source_y[i];
+        }
+      }
+    }
+  });
+}
+
+/**
+ * Second pass: within every row, find the column whose closest source is closest, by computing
+ * the lower envelope of the parabolas `(x - q)^2 + column_dist_sq(q)` rooted at every column `q`.
+ */
+static void nearest_in_rows(const int2 size, MutableSpan<int> r_nearest)
+{
+  constexpr double inf = std::numeric_limits<double>::infinity();
+
+  threading::parallel_for(IndexRange(size.y), 16, [&](const IndexRange rows) {
+    Array<int> nearest_y(size.x);
+    Array<double> column_dist_sq(size.x);
+    /* Columns of the parabolas in the lower envelope, and the boundaries between them. */
+    Array<int> envelope(size.x);
+    Array<double> bounds(size.x + 1);
+
+    for (const int y : rows) {
+      MutableSpan<int> row = r_nearest.slice(int64_t(y) * size.x, size.x);
+      nearest_y.as_mutable_span().copy_from(row);
+
+      int k = -1;
+      for (const int q : IndexRange(size.x)) {
+        if (nearest_y[q] == -1) {
+          continue;
+        }
+        const double dy = double(nearest_y[q] - y);
+        column_dist_sq[q] = dy * dy;
+
+        double s = -inf;
+        while (k >= 0) {
+          const int p = envelope[k];
+          s = ((column_dist_sq[q] + double(q) * q) - (column_dist_sq[p] + double(p) * p)) /
+              (2.0 * (q - p));
+          if (s > bounds[k]) {
+            break;
+          }
+          k--;
+        }
+        k++;
+        envelope[k] = q;
+        bounds[k] = k == 0 ? -inf : s;
+        bounds[k + 1] = inf;
+      }
+
+      if (k == -1) {
+        row.fill(-1);
+        continue;
+      }
+
+      k = 0;
+      for (const int x : IndexRange(size.x)) {
+        while (bounds[k + 1] < x) {
+          k++;
+        }
+        const int q = envelope[k];
+        row[x] = nearest_y[q] * size.x + q;
+      }
+    }
+  });
+}
+
+void nearest_pixels(const int2 size,
+                    const FunctionRef<bool(int64_t index)> is_source,
+                    MutableSpan<int> r_nearest)
+{
+  BLI_assert(r_nearest.size() == int64_t(size.x) * size.y);
+  nearest_in_columns(size, is_source, r_nearest);
+  nearest_in_rows(size, r_nearest);
+}
+
+}  // namespace blender::distance_transform
@@ -8,6 +8,7 @@
 
 #include "BLI_kdtree_impl.h"
 #include "BLI_math.h"
+#include "BLI_task.h"
 #include "BLI_strict_flags.h"
 #include "BLI_utildefines.h"
 
@@ -131,20 +132,15 @@ void BLI_kdtree_nd_(insert)(KDTree *tree, int index, const float co[KD_DIMS])
 #endif
 }
 
-static uint kdtree_balance(KDTreeNode *nodes, uint nodes_len, uint axis, const uint ofs)
+/**
+ * Quick-sort style partitioning of the nodes around the median on \a axis,
+ * returns the index of the median.
+ */
+static uint kdtree_balance_partition(KDTreeNode *nodes, const uint nodes_len, const uint axis)
 {
-  KDTreeNode *node;
   float co;
   uint left, right, median, i, j;
 
-  if (nodes_len <= 0) {
-    return KD_NODE_UNSET;
-  }
-  else if (nodes_len == 1) {
-    return 0 + ofs;
-  }
-
-  /* Quick-sort style sorting around median. */
   left = 0;
   right = nodes_len - 1;
   median = nodes_len / 2;
@@ -176,6 +172,35 @@ static uint kdtree_balance(KDTreeNode *nodes, uint nodes_len, uint axis, const u
     }
   }
 
+  return median;
+}
+
+/**
+ * The index of the root of a balanced (sub-)tree only depends on its size,
+ * see #kdtree_balance.
+ */
+static uint kdtree_balance_root(const uint nodes_len, const uint ofs)
+{
+  if (nodes_len == 0) {
+    return KD_NODE_UNSET;
+  }
+  return nodes_len / 2 + ofs;
+}
+
+static uint kdtree_balance(KDTreeNode *nodes, uint nodes_len, uint axis, const uint ofs)
+{
+  KDTreeNode *node;
+  uint median;
+
+  if (nodes_len <= 0) {
+    return KD_NODE_UNSET;
+  }
+  else if (nodes_len == 1) {
+    return 0 + ofs;
+  }
+
+  median = kdtree_balance_partition(nodes, nodes_len, axis);
+
   /* Set node and sort sub-nodes. */
   node = &nodes[median];
   node->d = axis;
@@ -187,6 +212,61 @@ static uint kdtree_balance(KDTreeNode *nodes, uint nodes_len, uint axis, const u
   return median + ofs;
 }
 
+/**
+ * Sub-trees with fewer nodes are balanced on a single thread,
+ * for larger ones the two halves are balanced in parallel.
+ */
+#define KD_BALANCE_PARALLEL_THRESHOLD 8192
+
+typedef struct KDTreeBalanceTaskData {
+  KDTreeNode *nodes;
+  uint nodes_len;
+  uint axis;
+  uint ofs;
+} KDTreeBalanceTaskData;
+
+static void kdtree_balance_parallel(
+    TaskPool *pool, KDTreeNode *nodes, uint nodes_len, uint axis, uint ofs);
+
+static void kdtree_balance_task(TaskPool *__restrict pool, void *taskdata)
+{
+  const KDTreeBalanceTaskData *data = taskdata;
+  kdtree_balance_parallel(pool, data->nodes, data->nodes_len, data->axis, data->ofs);
+}
+
+/**
+ * Same as #kdtree_balance, but the left halves of large sub-trees are balanced in separate tasks.
+ * Since the sub-trees roots are known in advance (see #kdtree_balance_root), nodes can be linked
+ * without waiting for their children, and the result is identical to #kdtree_balance.
+ */
+static void kdtree_balance_parallel(
+    TaskPool *pool, KDTreeNode *nodes, uint nodes_len, uint axis, uint ofs)
+{
+  while (nodes_len >= KD_BALANCE_PARALLEL_THRESHOLD) {
+    const uint median = kdtree_balance_partition(nodes, nodes_len, axis);
+
+    KDTreeNode *node = &nodes[median];
+    node->d = axis;
+    axis = (axis + 1) % KD_DIMS;
+    node->left = kdtree_balance_root(median, ofs);
+    node->right = kdtree_balance_root(nodes_len - (median + 1), (median + 1) + ofs);
+
+    KDTreeBalanceTaskData *data = MEM_mallocN(sizeof(*data), __func__);
+    data->nodes = nodes;
+    data->nodes_len = median;
+    data->axis = axis;
+    data->ofs = ofs;
+    BLI_task_pool_push(pool, kdtree_balance_task, data, true, NULL);
+
+    /* Continue with the right half on this thread. */
+    nodes += median + 1;
+    nodes_len -= median + 1;
+    ofs += median + 1;
+  }
+
+  kdtree_balance(nodes, nodes_len, axis, ofs);
+}
+
 void BLI_kdtree_nd_(balance)(KDTree *tree)
 {
   if (tree->root != KD_NODE_ROOT_IS_INIT) {
@@ -196,7 +276,16 @@ void BLI_kdtree_nd_(balance)(KDTree *tree)
     }
   }
 
-  tree->root = kdtree_balance(tree->nodes, tree->nodes_len, 0, 0);
+  if (tree->nodes_len >= KD_BALANCE_PARALLEL_THRESHOLD) {
+    TaskPool *pool = BLI_task_pool_create(NULL, TASK_PRIORITY_HIGH);
+    kdtree_balance_parallel(pool, tree->nodes, tree->nodes_len, 0, 0);
+    BLI_task_pool_work_and_wait(pool);
+    BLI_task_pool_free(pool);
+    tree->root = kdtree_balance_root(tree->nodes_len, 0);
+  }
+  else {
+    tree->root = kdtree_balance(tree->nodes, tree->nodes_len, 0, 0);
+  }
 
 #ifdef DEBUG
   tree->is_balanced = true;
@@ -623,27 +712,25 @@ static void nearest_add_in_range(KDTreeNearest **r_nearest,
 }
 
 /**
- * Range search returns number of points nearest_len, with results in nearest
- *
- * \param r_nearest: Allocated array of nearest nearest_len (caller is responsible for freeing).
+ * Collects all points in \a range into \a nearest_buffer (unsorted), growing it as needed.
+ * Returns the number of points found, only counts them when \a nearest_buffer is null.
  */
-int BLI_kdtree_nd_(range_search_with_len_squared_cb)(
-    const KDTree *tree,
-    const float co[KD_DIMS],
-    KDTreeNearest **r_nearest,
-    const float range,
-    float (*len_sq_fn)(const float co_search[KD_DIMS],
-                       const float co_test[KD_DIMS],
-                       const void *user_data),
-    const void *user_data)
+static uint kdtree_range_search(const KDTree *tree,
+                                const float co[KD_DIMS],
+                                const float range,
+                                float (*len_sq_fn)(const float co_search[KD_DIMS],
+                                                   const float co_test[KD_DIMS],
+                                                   const void *user_data),
+                                const void *user_data,
+                                KDTreeNearest **nearest_buffer,
+                                uint *nearest_buffer_len_capacity)
 {
   const KDTreeNode *nodes = tree->nodes;
   uint *stack, stack_default[KD_STACK_INIT];
-  KDTreeNearest *nearest = NULL;
   const float range_sq = range * range;
   float dist_sq;
   uint stack_len_capacity, cur = 0;
-  uint nearest_len = 0, nearest_len_capacity = 0;
+  uint nearest_len = 0;
 
 #ifdef DEBUG
   BLI_assert(tree->is_balanced == true);
@@ -679,8 +766,15 @@ int BLI_kdtree_nd_(range_search_with_len_squared_cb)(
     else {
       dist_sq = len_sq_fn(co, node->co, user_data);
       if (dist_sq <= range_sq) {
-        nearest_add_in_range(
-            &nearest, nearest_len++, &nearest_len_capacity, node->index, dist_sq, node->co);
+        if (nearest_buffer) {
+          nearest_add_in_range(nearest_buffer,
+                               nearest_len,
+                               nearest_buffer_len_capacity,
+                               node->index,
+                               dist_sq,
+                               node->co);
+        }
+        nearest_len++;
       }
 
       if (node->left != KD_NODE_UNSET) {
@@ -700,6 +794,30 @@ int BLI_kdtree_nd_(range_search_with_len_squared_cb)(
     MEM_freeN(stack);
   }
 
+  return nearest_len;
+}
+
+/**
+ * Range search returns number of points nearest_len, with results in nearest
+ *
+ * \param r_nearest: Allocated array of nearest nearest_len (caller is responsible for freeing).
+ */
+int BLI_kdtree_nd_(range_search_with_len_squared_cb)(
+    const KDTree *tree,
+    const float co[KD_DIMS],
+    KDTreeNearest **r_nearest,
+    const float range,
+    float (*len_sq_fn)(const float co_search[KD_DIMS],
+                       const float co_test[KD_DIMS],
+                       const void *user_data),
+    const void *user_data)
+{
+  KDTreeNearest *nearest = NULL;
+  uint nearest_len_capacity = 0;
+
+  const uint nearest_len = kdtree_range_search(
+      tree, co, range, len_sq_fn, user_data, &nearest, &nearest_len_capacity);
+
   if (nearest_len) {
     qsort(nearest, nearest_len, sizeof(KDTreeNearest), nearest_cmp_dist);
   }
@@ -792,6 +910,157 @@ finally:
   }
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Batched Queries
+ *
+ * Run many queries in parallel, writing the results into flat arrays.
+ * \{ */
+
+/** Minimum number of queries handled by a single task. */
+#define KD_BATCH_QUERIES_PER_TASK 128
+
+typedef struct KDTreeFindNearestNBatchData {
+  const KDTree *tree;
+  const float (*co)[KD_DIMS];
+  KDTreeNearest *r_nearest;
+  uint nearest_len_capacity;
+  int *r_nearest_len;
+} KDTreeFindNearestNBatchData;
+
+static void kdtree_find_nearest_n_batch_fn(void *__restrict userdata,
+                                           const int iter,
+                                           const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const KDTreeFindNearestNBatchData *data = userdata;
+  const int nearest_len = BLI_kdtree_nd_(find_nearest_n)(
+      data->tree,
+      data->co[iter],
+      &data->r_nearest[(size_t)iter * data->nearest_len_capacity],
+      data->nearest_len_capacity);
+  if (data->r_nearest_len) {
+    data->r_nearest_len[iter] = nearest_len;
+  }
+}
+
+/**
+ * Batched version of #BLI_kdtree_3d_find_nearest_n, the queries run in parallel.
+ *
+ * \param r_nearest: An array sized at least `co_len * nearest_len_capacity`,
+ * the results of query `i` start at `r_nearest[i * nearest_len_capacity]`.
+ * \param r_nearest_len: Optional array of size \a co_len, the number of points found per query.
+ */
+void BLI_kdtree_nd_(find_nearest_n_batch)(const KDTree *tree,
+                                          const float (*co)[KD_DIMS],
+                                          const uint co_len,
+                                          KDTreeNearest *r_nearest,
+                                          const uint nearest_len_capacity,
+                                          int *r_nearest_len)
+{
+  KDTreeFindNearestNBatchData data = {
+      .tree = tree,
+      .co = co,
+      .r_nearest = r_nearest,
+      .nearest_len_capacity = nearest_len_capacity,
+      .r_nearest_len = r_nearest_len,
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = KD_BATCH_QUERIES_PER_TASK;
+  BLI_task_parallel_range(0, (int)co_len, &data, kdtree_find_nearest_n_batch_fn, &settings);
+}
+
+typedef struct KDTreeRangeSearchBatchData {
+  const KDTree *tree;
+  const float (*co)[KD_DIMS];
+  float range;
+  /** Holds the number of points found per query before it's accumulated into offsets. */
+  int *r_offsets;
+  KDTreeNearest *r_nearest;
+} KDTreeRangeSearchBatchData;
+
+static void kdtree_range_search_batch_count_fn(void *__restrict userdata,
+                                               const int iter,
+                                               const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const KDTreeRangeSearchBatchData *data = userdata;
+  data->r_offsets[iter] = (int)kdtree_range_search(
+      data->tree, data->co[iter], data->range, NULL, NULL, NULL, NULL);
+}
+
+static void kdtree_range_search_batch_fill_fn(void *__restrict userdata,
+                                              const int iter,
+                                              const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const KDTreeRangeSearchBatchData *data = userdata;
+  const int start = data->r_offsets[iter];
+  uint nearest_len_capacity = (uint)(data->r_offsets[iter + 1] - start);
+  if (nearest_len_capacity == 0) {
+    return;
+  }
+  /* The capacity is exactly the number of points counted before, the buffer never grows. */
+  KDTreeNearest *nearest = &data->r_nearest[start];
+  const uint nearest_len = kdtree_range_search(data->tree,
+                                               data->co[iter],
+                                               data->range,
+                                               NULL,
+                                               NULL,
+                                               &nearest,
+                                               &nearest_len_capacity);
+  BLI_assert(nearest == &data->r_nearest[start] && nearest_len == nearest_len_capacity);
+  qsort(nearest, nearest_len, sizeof(KDTreeNearest), nearest_cmp_dist);
+}
+
+/**
+ * Batched version of #BLI_kdtree_3d_range_search, the queries run in parallel.
+ * The results of all queries are stored in a single array, sorted by distance per query.
+ *
+ * \param r_offsets: An array of size `co_len + 1`, the results of query `i`
+ * are in the range `[r_offsets[i], r_offsets[i + 1])` of \a r_nearest.
+ * \param r_nearest: Allocated array of all results (caller is responsible for freeing),
+ * null when no points were found.
+ * \return The total number of points found.
+ */
+int BLI_kdtree_nd_(range_search_batch)(const KDTree *tree,
+                                       const float (*co)[KD_DIMS],
+                                       const uint co_len,
+                                       const float range,
+                                       int *r_offsets,
+                                       KDTreeNearest **r_nearest)
+{
+  KDTreeRangeSearchBatchData data = {
+      .tree = tree,
+      .co = co,
+      .range = range,
+      .r_offsets = r_offsets,
+      .r_nearest = NULL,
+  };
+
+  /* Count the points of every query first, so the results can be written in place. */
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = KD_BATCH_QUERIES_PER_TASK;
+  BLI_task_parallel_range(0, (int)co_len, &data, kdtree_range_search_batch_count_fn, &settings);
+
+  int nearest_len = 0;
+  for (uint i = 0; i < co_len; i++) {
+    const int query_nearest_len = r_offsets[i];
+    r_offsets[i] = nearest_len;
+    nearest_len += query_nearest_len;
+  }
+  r_offsets[co_len] = nearest_len;
+
+  if (nearest_len) {
+    data.r_nearest = MEM_mallocN(sizeof(KDTreeNearest) * (size_t)nearest_len, __func__);
+    BLI_task_parallel_range(0, (int)co_len, &data, kdtree_range_search_batch_fill_fn, &settings);
+  }
+
+  *r_nearest = data.r_nearest;
+  return nearest_len;
+}
+
+/** \} */
+
 /**
  * Use when we want to loop over nodes ordered by index.
  * Requires indices to be aligned with nodes.
@@ -872,6 +872,44 @@ static const Vert *find_flap_vert(const Face &tri, const Edge e, bool *r_rev)
   return flapv;
 }
 
+/**
+ * Index of the #filter_orient3d determinant, following the rules of
+ * Burnikel, Funke and Seel described in `mesh_intersect.cc`.
+ * The inputs are doubles approximating exact coordinates, so have index 1;
+ * the differences have index 2, the 2x2 minors index 6, and the final
+ * sum of products index 11.
+ */
+constexpr int index_orient3d = 11;
+
+/**
+ * Return the sign of #orient3d for the double approximations of the exact coordinates,
+ * if it can be guaranteed to match the sign of the exact calculation,
+ * or 0 if the result is uncertain (and the exact version must be used).
+ */
+static int filter_orient3d(const double3 &a, const double3 &b, const double3 &c, const double3 &d)
+{
+  const double3 ad = a - d;
+  const double3 bd = b - d;
+  const double3 cd = c - d;
+  const double det = ad.z * (bd.x * cd.y - cd.x * bd.y) + bd.z * (cd.x * ad.y - ad.x * cd.y) +
+                     cd.z * (ad.x * bd.y - bd.x * ad.y);
+  if (det == 0.0) {
+    return 0;
+  }
+  const double3 abs_d = math::abs(d);
+  const double3 sup_ad = math::abs(a) + abs_d;
+  const double3 sup_bd = math::abs(b) + abs_d;
+  const double3 sup_cd = math::abs(c) + abs_d;
+  const double supremum = sup_ad.z * (sup_bd.x * sup_cd.y + sup_cd.x * sup_bd.y) +
+                          sup_bd.z * (sup_cd.x * sup_ad.y + sup_ad.x * sup_cd.y) +
+                          sup_cd.z * (sup_ad.x * sup_bd.y + sup_bd.x * sup_ad.y);
+  const double err_bound = supremum * index_orient3d * DBL_EPSILON;
+  if (fabs(det) > err_bound) {
+    return det > 0 ? 1 : -1;
+  }
+  return 0;
+}
+
 /**
  * Triangle \a tri and tri0 share edge e.
  * Classify \a tri with respect to tri0 as described in
@@ -892,9 +930,6 @@ static int sort_tris_class(const Face &tri, const Face &tri0, const Edge e)
   if (dbg_level > 0) {
     std::cout << "classify  e = " << e << "\n";
   }
-  mpq3 a0 = tri0[0]->co_exact;
-  mpq3 a1 = tri0[1]->co_exact;
-  mpq3 a2 = tri0[2]->co_exact;
   bool rev;
   bool rev0;
   const Vert *flapv0 = find_flap_vert(tri0, e, &rev0);
@@ -906,9 +941,12 @@ static int sort_tris_class(const Face &tri, const Face &tri0, const Edge e)
     std::cout << " rev = " << rev << " flapv = " << flapv << "\n";
   }
   BLI_assert(flapv != nullptr && flapv0 != nullptr);
-  const mpq3 flap = flapv->co_exact;
-  /* orient will be positive if flap is below oriented plane of a0,a1,a2. */
-  int orient = orient3d(a0, a1, a2, flap);
+  /* orient will be positive if flap is below oriented plane of tri0.
+   * Most flaps are far from that plane, so try the floating-point filter first. */
+  int orient = filter_orient3d(tri0[0]->co, tri0[1]->co, tri0[2]->co, flapv->co);
+  if (orient == 0) {
+    orient = orient3d(tri0[0]->co_exact, tri0[1]->co_exact, tri0[2]->co_exact, flapv->co_exact);
+  }
   int ans;
   if (orient > 0) {
     ans = rev0 ? 4 : 3;
@@ -1067,27 +1105,23 @@ static Array<int> sort_tris_around_edge(
 }
 
 /**
- * Find the Cells around edge e.
+ * Find the Cells around edge e, given the triangles around e as sorted
+ * by #sort_tris_around_edge.
  * This possibly makes new cells in \a cinfo, and sets up the
  * bipartite graph edges between cells and patches.
  * Will modify \a pinfo and \a cinfo and the patches and cells they contain.
  */
 static void find_cells_from_edge(const IMesh &tm,
-                                 const TriMeshTopology &tmtopo,
                                  PatchesInfo &pinfo,
                                  CellsInfo &cinfo,
-                                 const Edge e)
+                                 const Edge e,
+                                 const Span<int> sorted_tris)
 {
   const int dbg_level = 0;
   if (dbg_level > 0) {
     std::cout << "FIND_CELLS_FROM_EDGE " << e << "\n";
   }
-  const Vector<int> *edge_tris = tmtopo.edge_tris(e);
-  BLI_assert(edge_tris != nullptr);
-  Array<int> sorted_tris = sort_tris_around_edge(
-      tm, e, Span<int>(*edge_tris), (*edge_tris)[0], nullptr);
-
-  int n_edge_tris = edge_tris->size();
+  int n_edge_tris = sorted_tris.size();
   Array<int> edge_patches(n_edge_tris);
   for (int i = 0; i < n_edge_tris; ++i) {
     edge_patches[i] = pinfo.tri_patch(sorted_tris[i]);
@@ -1188,19 +1222,32 @@ static CellsInfo find_cells(const IMesh &tm, const TriMeshTopology &tmtopo, Patc
     std::cout << "\nFIND_CELLS\n";
   }
   CellsInfo cinfo;
-  /* For each unique edge shared between patch pairs, process it. */
-  Set<Edge> processed_edges;
+  /* Gather each unique edge shared between patch pairs. */
+  VectorSet<Edge> patch_edges;
   for (const auto item : pinfo.patch_patch_edge_map().items()) {
     int p = item.key.first;
     int q = item.key.second;
     if (p < q) {
-      const Edge &e = item.value;
-      if (!processed_edges.contains(e)) {
-        processed_edges.add_new(e);
-        find_cells_from_edge(tm, tmtopo, pinfo, cinfo, e);
-      }
+      patch_edges.add(item.value);
     }
   }
+  /* Sorting the triangles around an edge only reads the mesh, and is where most of the
+   * time goes (in exact arithmetic), so do that for all edges in parallel. */
+  Array<Array<int>> edge_sorted_tris(patch_edges.size());
+  threading::parallel_for(patch_edges.index_range(), 256, [&](IndexRange range) {
+    for (int i : range) {
+      const Edge e = patch_edges[i];
+      const Vector<int> *edge_tris = tmtopo.edge_tris(e);
+      BLI_assert(edge_tris != nullptr);
+      edge_sorted_tris[i] = sort_tris_around_edge(
+          tm, e, Span<int>(*edge_tris), (*edge_tris)[0], nullptr);
+    }
+  });
+  /* Making and merging the cells has to be done in order, so that the result is
+   * the same as it would be single-threaded. */
+  for (int i : patch_edges.index_range()) {
+    find_cells_from_edge(tm, pinfo, cinfo, patch_edges[i], edge_sorted_tris[i]);
+  }
   /* Some patches may have no cells at this point. These are either:
    * (a) a closed manifold patch only incident on itself (sphere, torus, klein bottle, etc.).
    * (b) an open manifold patch only incident on itself (has non-manifold boundaries).
@@ -2094,10 +2141,15 @@ static void finish_patch_cell_graph(const IMesh &tm,
       std::cout << comp << ": " << components[comp] << "\n";
     }
   }
+  /* The searches below only read the mesh, patches and cells, and the arena is
+   * thread-safe, so the components can be handled in parallel. */
+  const int comp_grainsize = 4;
   Array<int> ambient_cell(components.size());
-  for (int comp : components.index_range()) {
-    ambient_cell[comp] = find_ambient_cell(tm, &components[comp], tmtopo, pinfo, arena);
-  }
+  threading::parallel_for(components.index_range(), comp_grainsize, [&](IndexRange comp_range) {
+    for (int comp : comp_range) {
+      ambient_cell[comp] = find_ambient_cell(tm, &components[comp], tmtopo, pinfo, arena);
+    }
+  });
   if (dbg_level > 0) {
     std::cout << "ambient cells:\n";
     for (int comp : ambient_cell.index_range()) {
@@ -2109,10 +2161,12 @@ static void finish_patch_cell_graph(const IMesh &tm,
   if (tot_components > 1) {
     Array<BoundingBox> comp_bb(tot_components);
     populate_comp_bbs(components, pinfo, tm, comp_bb);
-    for (int comp : components.index_range()) {
-      comp_cont[comp] = find_component_containers(
-          comp, components, ambient_cell, tm, pinfo, tmtopo, comp_bb, arena);
-    }
+    threading::parallel_for(components.index_range(), comp_grainsize, [&](IndexRange comp_range) {
+      for (int comp : comp_range) {
+        comp_cont[comp] = find_component_containers(
+            comp, components, ambient_cell, tm, pinfo, tmtopo, comp_bb, arena);
+      }
+    });
     if (dbg_level > 0) {
       std::cout << "component containers:\n";
       for (int comp : comp_cont.index_range()) {
@@ -17,6 +17,7 @@
 #include "BLI_math.h"
 #include "BLI_mempool.h"
 #include "BLI_task.h"
+#include "BLI_task_trace.hh"
 #include "BLI_threads.h"
 
 #ifdef WITH_TBB
@@ -36,13 +37,20 @@ class Task {
   void *taskdata;
   bool free_taskdata;
   TaskFreeFunction freedata;
+  /* Name of the region the task was created in, when tracing is enabled. */
+  const char *trace_name;
 
   Task(TaskPool *pool,
        TaskRunFunction run,
        void *taskdata,
        bool free_taskdata,
        TaskFreeFunction freedata)
-      : pool(pool), run(run), taskdata(taskdata), free_taskdata(free_taskdata), freedata(freedata)
+      : pool(pool),
+        run(run),
+        taskdata(taskdata),
+        free_taskdata(free_taskdata),
+        freedata(freedata),
+        trace_name(blender::threading::trace::parallel_name())
   {
   }
 
@@ -67,7 +75,8 @@ class Task {
         run(other.run),
         taskdata(other.taskdata),
         free_taskdata(other.free_taskdata),
-        freedata(other.freedata)
+        freedata(other.freedata),
+        trace_name(other.trace_name)
   {
     other.pool = nullptr;
     other.run = nullptr;
@@ -82,7 +91,8 @@ class Task {
         run(other.run),
         taskdata(other.taskdata),
         free_taskdata(other.free_taskdata),
-        freedata(other.freedata)
+        freedata(other.freedata),
+        trace_name(other.trace_name)
   {
     ((Task &)other).pool = nullptr;
     ((Task &)other).run = nullptr;
@@ -161,6 +171,7 @@ struct TaskPool {
 /* Execute task. */
 void Task::operator()() const
 {
+  blender::threading::trace::Span span(trace_name, blender::threading::trace::SpanType::PoolTask);
   run(pool, taskdata);
 }
 
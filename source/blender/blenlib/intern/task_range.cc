@@ -14,6 +14,7 @@
 
 #include "BLI_lazy_threading.hh"
 #include "BLI_task.h"
+#include "BLI_task_trace.hh"
 #include "BLI_threads.h"
 
 #include "atomic_ops.h"
@@ -32,26 +33,36 @@ struct RangeTask {
   TaskParallelRangeFunc func;
   void *userdata;
   const TaskParallelSettings *settings;
+  const char *trace_name;
 
   void *userdata_chunk;
 
   /* Root constructor. */
   RangeTask(TaskParallelRangeFunc func, void *userdata, const TaskParallelSettings *settings)
-      : func(func), userdata(userdata), settings(settings)
+      : func(func),
+        userdata(userdata),
+        settings(settings),
+        trace_name(blender::threading::trace::parallel_name())
   {
     init_chunk(settings->userdata_chunk);
   }
 
   /* Copy constructor. */
   RangeTask(const RangeTask &other)
-      : func(other.func), userdata(other.userdata), settings(other.settings)
+      : func(other.func),
+        userdata(other.userdata),
+        settings(other.settings),
+        trace_name(other.trace_name)
   {
     init_chunk(settings->userdata_chunk);
   }
 
   /* Splitting constructor for parallel reduce. */
   RangeTask(RangeTask &other, tbb::split /* unused */)
-      : func(other.func), userdata(other.userdata), settings(other.settings)
+      : func(other.func),
+        userdata(other.userdata),
+        settings(other.settings),
+        trace_name(other.trace_name)
   {
     init_chunk(settings->userdata_chunk);
   }
@@ -77,6 +88,8 @@ struct RangeTask {
 
   void operator()(const tbb::blocked_range<int> &r) const
   {
+    blender::threading::trace::Span span(
+        trace_name, blender::threading::trace::SpanType::ParallelChunk, int64_t(r.size()));
     TaskParallelTLS tls;
     tls.userdata_chunk = userdata_chunk;
     for (int i = r.begin(); i != r.end(); ++i) {
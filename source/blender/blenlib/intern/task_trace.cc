@@ -0,0 +1,212 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup bli
+ *
+ * Tracing of parallel loops and task pool tasks.
+ *
+ * Every thread records its spans into its own buffer, so recording does not need any locking.
+ * The buffers are owned by a global list, so that they outlive the threads that filled them.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "BLI_fileops.h"
+#include "BLI_task.h"
+#include "BLI_task_trace.hh"
+#include "BLI_threads.h"
+
+namespace blender::threading::trace {
+
+struct TraceEvent {
+  const char *name;
+  int64_t start_time;
+  int64_t end_time;
+  int64_t size;
+  SpanType type;
+};
+
+struct ThreadTrace {
+  int thread_index;
+  bool is_main_thread;
+  std::vector<TraceEvent> events;
+};
+
+static std::atomic<bool> trace_enabled = false;
+static int64_t trace_start_time = 0;
+
+static std::mutex thread_traces_mutex;
+static std::vector<std::unique_ptr<ThreadTrace>> thread_traces;
+
+static thread_local ThreadTrace *tls_thread_trace = nullptr;
+/** Name of the innermost span on this thread. */
+static thread_local const char *tls_parallel_name = nullptr;
+
+static int64_t time_now()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+static ThreadTrace &thread_trace_ensure()
+{
+  if (tls_thread_trace == nullptr) {
+    std::unique_ptr<ThreadTrace> thread_trace = std::make_unique<ThreadTrace>();
+    thread_trace->is_main_thread = BLI_thread_is_main();
+    tls_thread_trace = thread_trace.get();
+
+    std::lock_guard lock{thread_traces_mutex};
+    thread_trace->thread_index = int(thread_traces.size());
+    thread_traces.push_back(std::move(thread_trace));
+  }
+  return *tls_thread_trace;
+}
+
+bool is_enabled()
+{
+  return trace_enabled.load(std::memory_order_relaxed);
+}
+
+const char *parallel_name()
+{
+  if (!is_enabled()) {
+    return nullptr;
+  }
+  return tls_parallel_name ? tls_parallel_name : "Unnamed";
+}
+
+namespace detail {
+
+void span_begin(SpanState &state)
+{
+  state.parent_name = tls_parallel_name;
+  tls_parallel_name = state.name;
+  state.start_time = time_now();
+}
+
+void span_end(const SpanState &state)
+{
+  const int64_t end_time = time_now();
+  tls_parallel_name = state.parent_name;
+  if (!is_enabled()) {
+    return;
+  }
+  thread_trace_ensure().events.push_back(
+      {state.name, state.start_time, end_time, state.size, state.type});
+}
+
+}  // namespace detail
+
+static const char *span_type_category(const SpanType type)
+{
+  switch (type) {
+    case SpanType::Region:
+      return "region";
+    case SpanType::ParallelChunk:
+      return "parallel_chunk";
+    case SpanType::PoolTask:
+      return "pool_task";
+  }
+  return "";
+}
+
+static void write_json_string(FILE *file, const char *str)
+{
+  fputc('"', file);
+  for (const char *c = str; *c; c++) {
+    if (ELEM(*c, '"', '\\')) {
+      fputc('\\', file);
+      fputc(*c, file);
+    }
+    else if (uchar(*c) < 0x20) {
+      fprintf(file, "\\u%04x", int(*c));
+    }
+    else {
+      fputc(*c, file);
+    }
+  }
+  fputc('"', file);
+}
+
+static bool write_json(const char *filepath)
+{
+  FILE *file = BLI_fopen(filepath, "w");
+  if (file == nullptr) {
+    return false;
+  }
+
+  std::lock_guard lock{thread_traces_mutex};
+
+  fputs("{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n", file);
+  bool is_first = true;
+  for (const std::unique_ptr<ThreadTrace> &thread_trace : thread_traces) {
+    if (thread_trace->events.empty()) {
+      continue;
+    }
+    fprintf(file,
+            "%s{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %d, "
+            "\"args\": {\"name\": \"%s %d\"}}",
+            is_first ? "" : ",\n",
+            thread_trace->thread_index,
+            thread_trace->is_main_thread ? "Main" : "Worker",
+            thread_trace->thread_index);
+    is_first = false;
+
+    for (const TraceEvent &event : thread_trace->events) {
+      fputs(",\n{\"name\": ", file);
+      write_json_string(file, event.name);
+      /* Timestamps are in microseconds. */
+      fprintf(file,
+              ", \"cat\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %d, \"ts\": %.3f, "
+              "\"dur\": %.3f",
+              span_type_category(event.type),
+              thread_trace->thread_index,
+              double(event.start_time - trace_start_time) / 1000.0,
+              double(event.end_time - event.start_time) / 1000.0);
+      if (event.type == SpanType::ParallelChunk) {
+        fprintf(file, ", \"args\": {\"size\": %lld}", (long long)event.size);
+      }
+      fputs("}", file);
+    }
+  }
+  fputs("\n]}\n", file);
+
+  return fclose(file) == 0;
+}
+
+}  // namespace blender::threading::trace
+
+using namespace blender::threading::trace;
+
+void BLI_task_trace_begin()
+{
+  {
+    std::lock_guard lock{thread_traces_mutex};
+    for (std::unique_ptr<ThreadTrace> &thread_trace : thread_traces) {
+      thread_trace->events.clear();
+    }
+  }
+  trace_start_time = time_now();
+  trace_enabled.store(true);
+}
+
+void BLI_task_trace_end()
+{
+  trace_enabled.store(false);
+}
+
+bool BLI_task_trace_is_enabled()
+{
+  return is_enabled();
+}
+
+bool BLI_task_trace_write_json(const char *filepath)
+{
+  return write_json(filepath);
+}
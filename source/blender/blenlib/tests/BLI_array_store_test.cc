@@ -697,6 +697,11 @@ TEST(array_store, TestData_Stride32_Chunk64_Mutate8)
 {
   random_data_mutate_helper(0, 256, 200, 32, 64, 7117, 8);
 }
+/* Large enough for hashes to be calculated in parallel. */
+TEST(array_store, TestData_Stride12_Chunk256_Mutate8_Large)
+{
+  random_data_mutate_helper(40000, 50000, 8, 12, 256, 4221, 8);
+}
 
 /* -------------------------------------------------------------------- */
 /* Randomized Chunks Test */
@@ -0,0 +1,85 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#include "BLI_array.hh"
+#include "BLI_distance_transform.hh"
+#include "BLI_rand.hh"
+
+#include "testing/testing.h"
+
+namespace blender::tests {
+
+static int64_t dist_sq(const int2 size, const int64_t a, const int64_t b)
+{
+  const int64_t dx = a % size.x - b % size.x;
+  const int64_t dy = a / size.x - b / size.x;
+  return dx * dx + dy * dy;
+}
+
+static void test_random_sources(const int2 size, const float probability, const uint32_t seed)
+{
+  RandomNumberGenerator rng(seed);
+  Array<bool> is_source(size.x * size.y);
+  for (bool &value : is_source) {
+    value = rng.get_float() < probability;
+  }
+
+  Array<int> nearest(size.x * size.y);
+  distance_transform::nearest_pixels(
+      size, [&](const int64_t index) { return is_source[index]; }, nearest);
+
+  for (const int64_t i : nearest.index_range()) {
+    int64_t expected_dist_sq = -1;
+    for (const int64_t j : is_source.index_range()) {
+      if (is_source[j]) {
+        const int64_t d = dist_sq(size, i, j);
+        if (expected_dist_sq == -1 || d < expected_dist_sq) {
+          expected_dist_sq = d;
+        }
+      }
+    }
+    if (expected_dist_sq == -1) {
+      EXPECT_EQ(nearest[i], -1);
+      continue;
+    }
+    ASSERT_GE(nearest[i], 0);
+    EXPECT_TRUE(is_source[nearest[i]]);
+    EXPECT_EQ(dist_sq(size, i, nearest[i]), expected_dist_sq);
+  }
+}
+
+TEST(distance_transform, Empty)
+{
+  Array<int> nearest(12 * 7);
+  distance_transform::nearest_pixels(
+      {12, 7}, [](const int64_t /*index*/) { return false; }, nearest);
+  for (const int value : nearest) {
+    EXPECT_EQ(value, -1);
+  }
+}
+
+TEST(distance_transform, SingleSource)
+{
+  const int2 size(9, 5);
+  const int source = 2 * size.x + 6;
+  Array<int> nearest(size.x * size.y);
+  distance_transform::nearest_pixels(
+      size, [&](const int64_t index) { return index == source; }, nearest);
+  for (const int value : nearest) {
+    EXPECT_EQ(value, source);
+  }
+}
+
+TEST(distance_transform, RandomSparse)
+{
+  test_random_sources({37, 23}, 0.01f, 0);
+  test_random_sources({64, 1}, 0.05f, 1);
+  test_random_sources({1, 64}, 0.05f, 2);
+}
+
+TEST(distance_transform, RandomDense)
+{
+  test_random_sources({41, 29}, 0.3f, 3);
+  test_random_sources({150, 100}, 0.1f, 4);
+}
+
+}  // namespace blender::tests
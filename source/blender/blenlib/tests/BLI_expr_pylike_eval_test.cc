@@ -111,6 +111,15 @@ TEST_PARSE_FAIL(Truncated7, "1 and")
 TEST_PARSE_FAIL(Truncated8, "1 or")
 TEST_PARSE_FAIL(Truncated9, "sqrt(1")
 TEST_PARSE_FAIL(Truncated10, "fmod(1,")
+TEST_PARSE_FAIL(Truncated11, "2 **")
+
+/* The driver name-space has the contents of the `math` module, but not the module itself. */
+TEST_PARSE_FAIL(MathPi, "math.pi")
+TEST_PARSE_FAIL(MathTau, "math.tau")
+TEST_PARSE_FAIL(MathSqrt, "math.sqrt(4)")
+TEST_PARSE_FAIL(MathLog2, "math.log(4, 2)")
+
+TEST_PARSE_FAIL(BadPower, "2 ***3")
 
 /* Constant expression with working constant folding */
 #define TEST_CONST(name, str, value) \
@@ -145,6 +154,8 @@ TEST_CONST(Half, ".5", 0.5)
 TEST_CONST(Pi, "pi", M_PI)
 TEST_CONST(True, "True", TRUE_VAL)
 TEST_CONST(False, "False", FALSE_VAL)
+TEST_CONST(E, "e", M_E)
+TEST_CONST(Tau, "tau", M_PI * 2.0)
 
 TEST_CONST(Sqrt, "sqrt(4)", 2.0)
 TEST_EVAL(Sqrt, "sqrt(x)", 4.0, 2.0)
@@ -156,6 +167,14 @@ TEST_CONST(Pow, "pow(4, 0.5)", 2.0)
 TEST_EVAL(Pow, "pow(4, x)", 0.5, 2.0)
 
 TEST_CONST(Log2_1, "log(4, 2)", 2.0)
+TEST_CONST(Log2_2, "log2(8)", 3.0)
+TEST_CONST(Log10, "log10(100)", 2.0)
+
+TEST_CONST(Hypot, "hypot(3, 4)", 5.0)
+TEST_CONST(CopySign, "copysign(2, -0.5)", -2.0)
+TEST_CONST(Tanh, "tanh(0)", 0.0)
+TEST_CONST(Float, "float(-1.5)", -1.5)
+TEST_CONST(Bool, "bool(-1.5)", TRUE_VAL)
 
 TEST_CONST(Round1, "round(-0.5)", -1.0)
 TEST_CONST(Round2, "round(-0.4)", 0.0)
@@ -205,6 +224,22 @@ TEST_EVAL(BinaryMul, "x*3", 2, 6.0)
 TEST_CONST(BinaryDiv, "3/2", 1.5)
 TEST_EVAL(BinaryDiv, "3/x", 2, 1.5)
 
+TEST_CONST(FloorDiv1, "7//2", 3.0)
+TEST_CONST(FloorDiv2, "-7//2", -4.0)
+TEST_EVAL(FloorDiv, "x//2", -7, -4.0)
+
+TEST_CONST(Mod1, "7 % 3", 1.0)
+TEST_CONST(Mod2, "-7 % 3", 2.0)
+TEST_CONST(Mod3, "7 % -3", -2.0)
+TEST_EVAL(Mod, "x % 3", -7, 2.0)
+
+TEST_CONST(Power1, "2**3", 8.0)
+TEST_CONST(Power2, "2**3**2", 512.0)
+TEST_CONST(Power3, "-2**2", -4.0)
+TEST_CONST(Power4, "2**-1", 0.5)
+TEST_CONST(Power5, "2 * 3**2", 18.0)
+TEST_EVAL(Power, "x**2", -3, 9.0)
+
 TEST_CONST(Arith1, "1 + -2 * 3", -5.0)
 TEST_CONST(Arith2, "(1 + -2) * 3", -3.0)
 TEST_CONST(Arith3, "-1 + 2 * 3", 5.0)
@@ -337,6 +372,10 @@ TEST_ERROR(SqrtDomain3, "sqrt(x)", 0.0, EXPR_PYLIKE_SUCCESS)
 TEST_ERROR(PowDomain1, "pow(-1, 0.5)", 0.0, EXPR_PYLIKE_MATH_ERROR)
 TEST_ERROR(PowDomain2, "pow(-1, x)", 0.5, EXPR_PYLIKE_MATH_ERROR)
 TEST_ERROR(PowDomain3, "pow(-1, x)", 2.0, EXPR_PYLIKE_SUCCESS)
+TEST_ERROR(PowDomain4, "(-1)**x", 0.5, EXPR_PYLIKE_MATH_ERROR)
+
+TEST_ERROR(FloorDivZero, "1 // x", 0.0, EXPR_PYLIKE_DIV_BY_ZERO)
+TEST_ERROR(ModZero, "1 % x", 0.0, EXPR_PYLIKE_MATH_ERROR)
 
 TEST_ERROR(Mixed1, "sqrt(x) + 1 / max(0, x)", -1.0, EXPR_PYLIKE_MATH_ERROR)
 TEST_ERROR(Mixed2, "sqrt(x) + 1 / max(0, x)", 0.0, EXPR_PYLIKE_DIV_BY_ZERO)
@@ -0,0 +1,165 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#include <memory>
+#include <string>
+
+#include "BLI_group_probing_map.hh"
+#include "BLI_map.hh"
+#include "BLI_rand.hh"
+#include "BLI_strict_flags.h"
+#include "BLI_string_ref.hh"
+#include "testing/testing.h"
+
+namespace blender::tests {
+
+TEST(group_probing_map, DefaultConstructor)
+{
+  GroupProbingMap<int, float> map;
+  EXPECT_EQ(map.size(), 0);
+  EXPECT_TRUE(map.is_empty());
+  EXPECT_EQ(map.lookup_ptr(0), nullptr);
+}
+
+TEST(group_probing_map, AddAndLookup)
+{
+  GroupProbingMap<int, std::string> map;
+  for (int i = 0; i < 1000; i++) {
+    EXPECT_TRUE(map.add(i, std::to_string(i)));
+  }
+  EXPECT_FALSE(map.add(5, "test"));
+  EXPECT_EQ(map.size(), 1000);
+  for (int i = 0; i < 1000; i++) {
+    EXPECT_EQ(map.lookup(i), std::to_string(i));
+  }
+  EXPECT_EQ(map.lookup_ptr(1000), nullptr);
+  EXPECT_EQ(map.lookup_default(1000, "default"), "default");
+  EXPECT_EQ(map.lookup_default(10, "default"), "10");
+}
+
+TEST(group_probing_map, AddOverwrite)
+{
+  GroupProbingMap<int, int> map;
+  EXPECT_TRUE(map.add_overwrite(1, 2));
+  EXPECT_FALSE(map.add_overwrite(1, 3));
+  EXPECT_EQ(map.lookup(1), 3);
+  EXPECT_EQ(map.size(), 1);
+}
+
+TEST(group_probing_map, LookupOrAdd)
+{
+  GroupProbingMap<int, int> map;
+  map.lookup_or_add(1, 10) += 1;
+  map.lookup_or_add(1, 20) += 1;
+  EXPECT_EQ(map.lookup(1), 12);
+
+  int calls = 0;
+  auto create_value = [&]() {
+    calls++;
+    return 5;
+  };
+  EXPECT_EQ(map.lookup_or_add_cb(2, create_value), 5);
+  EXPECT_EQ(map.lookup_or_add_cb(2, create_value), 5);
+  EXPECT_EQ(calls, 1);
+
+  map.lookup_or_add_default(3)++;
+  map.lookup_or_add_default(3)++;
+  EXPECT_EQ(map.lookup(3), 2);
+}
+
+TEST(group_probing_map, RemoveAndPop)
+{
+  GroupProbingMap<int, int> map;
+  for (int i = 0; i < 100; i++) {
+    map.add_new(i, i * 2);
+  }
+  EXPECT_TRUE(map.remove(3));
+  EXPECT_FALSE(map.remove(3));
+  map.remove_contained(4);
+  EXPECT_EQ(map.pop(5), 10);
+  EXPECT_EQ(map.size(), 97);
+  EXPECT_FALSE(map.contains(3));
+  EXPECT_FALSE(map.contains(4));
+  EXPECT_FALSE(map.contains(5));
+  EXPECT_TRUE(map.contains(6));
+}
+
+TEST(group_probing_map, Iterators)
+{
+  GroupProbingMap<int, float> map;
+  map.add(1, 1.0f);
+  map.add(2, 2.0f);
+  map.add(3, 3.0f);
+
+  int key_sum = 0;
+  for (const int key : map.keys()) {
+    key_sum += key;
+  }
+  EXPECT_EQ(key_sum, 6);
+
+  for (float &value : map.values()) {
+    value *= 2.0f;
+  }
+  float value_sum = 0.0f;
+  for (const float value : const_cast<const GroupProbingMap<int, float> &>(map).values()) {
+    value_sum += value;
+  }
+  EXPECT_EQ(value_sum, 12.0f);
+
+  for (auto item : map.items()) {
+    item.value += float(item.key);
+  }
+  for (const auto item : const_cast<const GroupProbingMap<int, float> &>(map).items()) {
+    EXPECT_EQ(item.value, float(item.key) * 3.0f);
+  }
+}
+
+TEST(group_probing_map, MoveOnlyValues)
+{
+  GroupProbingMap<int, std::unique_ptr<int>> map;
+  for (int i = 0; i < 100; i++) {
+    map.add_new(i, std::make_unique<int>(i));
+  }
+  GroupProbingMap<int, std::unique_ptr<int>> map2 = std::move(map);
+  EXPECT_TRUE(map.is_empty()); /* NOLINT: bugprone-use-after-move */
+  EXPECT_EQ(map2.size(), 100);
+  EXPECT_EQ(*map2.lookup(50), 50);
+  std::unique_ptr<int> value = map2.pop(50);
+  EXPECT_EQ(*value, 50);
+}
+
+TEST(group_probing_map, StringKeysLookupAs)
+{
+  GroupProbingMap<std::string, int> map;
+  map.add("a", 1);
+  map.add_as(StringRef("b"), 2);
+  EXPECT_EQ(map.lookup_as(StringRef("a")), 1);
+  EXPECT_EQ(map.lookup_as("b"), 2);
+  EXPECT_EQ(map.lookup_ptr_as(StringRef("c")), nullptr);
+}
+
+TEST(group_probing_map, CompareWithMap)
+{
+  GroupProbingMap<int, int> map;
+  Map<int, int> reference;
+  RandomNumberGenerator rng(0);
+  for (int i = 0; i < 100000; i++) {
+    const int key = rng.get_int32(2000);
+    switch (rng.get_int32(3)) {
+      case 0:
+        EXPECT_EQ(map.add(key, i), reference.add(key, i));
+        break;
+      case 1:
+        EXPECT_EQ(map.remove(key), reference.remove(key));
+        break;
+      case 2:
+        EXPECT_EQ(map.lookup_default(key, -1), reference.lookup_default(key, -1));
+        break;
+    }
+  }
+  EXPECT_EQ(map.size(), reference.size());
+  for (const auto item : reference.items()) {
+    EXPECT_EQ(map.lookup(item.key), item.value);
+  }
+}
+
+}  // namespace blender::tests
@@ -0,0 +1,153 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#include <string>
+
+#include "BLI_group_probing_set.hh"
+#include "BLI_rand.hh"
+#include "BLI_set.hh"
+#include "BLI_strict_flags.h"
+#include "BLI_string_ref.hh"
+#include "testing/testing.h"
+
+namespace blender::tests {
+
+TEST(group_probing_set, DefaultConstructor)
+{
+  GroupProbingSet<int> set;
+  EXPECT_EQ(set.size(), 0);
+  EXPECT_TRUE(set.is_empty());
+  EXPECT_FALSE(set.contains(0));
+  EXPECT_TRUE(set.begin() == set.end());
+}
+
+TEST(group_probing_set, AddMany)
+{
+  GroupProbingSet<int> set;
+  for (int i = 0; i < 1000; i++) {
+    EXPECT_TRUE(set.add(i));
+  }
+  for (int i = 0; i < 1000; i++) {
+    EXPECT_FALSE(set.add(i));
+  }
+  EXPECT_EQ(set.size(), 1000);
+  for (int i = 0; i < 1000; i++) {
+    EXPECT_TRUE(set.contains(i));
+  }
+  for (int i = 1000; i < 2000; i++) {
+    EXPECT_FALSE(set.contains(i));
+  }
+}
+
+TEST(group_probing_set, InitializerListConstructor)
+{
+  GroupProbingSet<int> set = {4, 5, 6, 5};
+  EXPECT_EQ(set.size(), 3);
+  EXPECT_TRUE(set.contains(4));
+  EXPECT_TRUE(set.contains(5));
+  EXPECT_TRUE(set.contains(6));
+  EXPECT_FALSE(set.contains(3));
+}
+
+TEST(group_probing_set, CopyAndMove)
+{
+  GroupProbingSet<int> set = {1, 2, 3};
+  GroupProbingSet<int> set2 = set;
+  set2.add(4);
+  EXPECT_EQ(set.size(), 3);
+  EXPECT_EQ(set2.size(), 4);
+  EXPECT_FALSE(set.contains(4));
+
+  GroupProbingSet<int> set3 = std::move(set2);
+  EXPECT_EQ(set3.size(), 4);
+  EXPECT_EQ(set2.size(), 0); /* NOLINT: bugprone-use-after-move */
+  set2.add(5);
+  EXPECT_TRUE(set2.contains(5));
+
+  set = set3;
+  EXPECT_EQ(set.size(), 4);
+}
+
+TEST(group_probing_set, Remove)
+{
+  GroupProbingSet<int> set;
+  for (int i = 0; i < 1000; i++) {
+    set.add_new(i);
+  }
+  for (int i = 0; i < 1000; i += 2) {
+    set.remove_contained(i);
+  }
+  EXPECT_FALSE(set.remove(0));
+  EXPECT_TRUE(set.remove(1));
+  EXPECT_EQ(set.size(), 499);
+  for (int i = 2; i < 1000; i++) {
+    EXPECT_EQ(set.contains(i), i % 2 == 1);
+  }
+}
+
+TEST(group_probing_set, Iterator)
+{
+  GroupProbingSet<int> set = {1, 3, 2, 5, 4};
+  Set<int> found;
+  for (const int value : set) {
+    EXPECT_TRUE(found.add(value));
+  }
+  EXPECT_EQ(found.size(), 5);
+  for (const int value : {1, 2, 3, 4, 5}) {
+    EXPECT_TRUE(found.contains(value));
+  }
+}
+
+TEST(group_probing_set, StringLookupAs)
+{
+  GroupProbingSet<std::string> set;
+  set.add("hello");
+  set.add("world");
+  EXPECT_TRUE(set.contains_as(StringRef("hello")));
+  EXPECT_FALSE(set.contains_as(StringRef("test")));
+  EXPECT_EQ(set.lookup_key_as(StringRef("world")), "world");
+  EXPECT_EQ(set.lookup_key_ptr_as(StringRef("test")), nullptr);
+}
+
+TEST(group_probing_set, ReserveAndClear)
+{
+  GroupProbingSet<int> set;
+  set.reserve(1000);
+  const int64_t capacity = set.capacity();
+  EXPECT_GE(capacity, 1000);
+  for (int i = 0; i < 1000; i++) {
+    set.add_new(i);
+  }
+  EXPECT_EQ(set.capacity(), capacity);
+  set.clear();
+  EXPECT_TRUE(set.is_empty());
+  EXPECT_FALSE(set.contains(5));
+  set.add(5);
+  EXPECT_TRUE(set.contains(5));
+}
+
+/**
+ * Adding and removing keys all the time should not let the set grow indefinitely, removed slots
+ * are reused or cleaned up when the set is rebuilt.
+ */
+TEST(group_probing_set, AddRemoveRandom)
+{
+  GroupProbingSet<int> set;
+  Set<int> reference;
+  RandomNumberGenerator rng(0);
+  for (int i = 0; i < 100000; i++) {
+    const int key = rng.get_int32(1000);
+    if (rng.get_int32(2) == 0) {
+      EXPECT_EQ(set.add(key), reference.add(key));
+    }
+    else {
+      EXPECT_EQ(set.remove(key), reference.remove(key));
+    }
+  }
+  EXPECT_EQ(set.size(), reference.size());
+  for (const int key : reference) {
+    EXPECT_TRUE(set.contains(key));
+  }
+  EXPECT_LE(set.capacity(), 4096);
+}
+
+}  // namespace blender::tests
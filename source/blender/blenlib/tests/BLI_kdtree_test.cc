@@ -4,7 +4,14 @@
 
 #include "BLI_kdtree.h"
 
+#include "BLI_math_vector.h"
+#include "BLI_rand.h"
+
+#include "MEM_guardedalloc.h"
+
+#include <array>
 #include <cmath>
+#include <vector>
 
 /* -------------------------------------------------------------------- */
 /* Tests */
@@ -61,3 +68,114 @@ TEST(kdtree, Deduplicate)
 {
   deduplicate_test();
 }
+
+/** Random points, enough for the tree to be balanced in parallel. */
+static std::vector<std::array<float, 3>> random_points_3d(const int points_len, const int seed)
+{
+  std::vector<std::array<float, 3>> points(points_len);
+  RNG *rng = BLI_rng_new(seed);
+  for (std::array<float, 3> &co : points) {
+    BLI_rng_get_float_unit_v3(rng, co.data());
+    co[0] *= BLI_rng_get_float(rng);
+  }
+  BLI_rng_free(rng);
+  return points;
+}
+
+static KDTree_3d *kdtree_from_points_3d(const std::vector<std::array<float, 3>> &points)
+{
+  KDTree_3d *tree = BLI_kdtree_3d_new(points.size());
+  for (int i = 0; i < int(points.size()); i++) {
+    BLI_kdtree_3d_insert(tree, i, points[i].data());
+  }
+  BLI_kdtree_3d_balance(tree);
+  return tree;
+}
+
+TEST(kdtree, BalanceParallel)
+{
+  const std::vector<std::array<float, 3>> points = random_points_3d(100000, 0);
+  const std::vector<std::array<float, 3>> queries = random_points_3d(100, 1);
+  KDTree_3d *tree = kdtree_from_points_3d(points);
+
+  for (const std::array<float, 3> &query : queries) {
+    int nearest_index = -1;
+    float nearest_dist_sq = FLT_MAX;
+    for (int i = 0; i < int(points.size()); i++) {
+      const float dist_sq = len_squared_v3v3(query.data(), points[i].data());
+      if (dist_sq < nearest_dist_sq) {
+        nearest_dist_sq = dist_sq;
+        nearest_index = i;
+      }
+    }
+    EXPECT_EQ(BLI_kdtree_3d_find_nearest(tree, query.data(), nullptr), nearest_index);
+  }
+
+  BLI_kdtree_3d_free(tree);
+}
+
+TEST(kdtree, FindNearestNBatch)
+{
+  const std::vector<std::array<float, 3>> points = random_points_3d(20000, 0);
+  const std::vector<std::array<float, 3>> queries = random_points_3d(1000, 1);
+  KDTree_3d *tree = kdtree_from_points_3d(points);
+
+  const int nearest_len_capacity = 5;
+  std::vector<KDTreeNearest_3d> nearest(queries.size() * nearest_len_capacity);
+  std::vector<int> nearest_len(queries.size());
+  BLI_kdtree_3d_find_nearest_n_batch(tree,
+                                     reinterpret_cast<const float(*)[3]>(queries.data()),
+                                     queries.size(),
+                                     nearest.data(),
+                                     nearest_len_capacity,
+                                     nearest_len.data());
+
+  for (int i = 0; i < int(queries.size()); i++) {
+    KDTreeNearest_3d expected[nearest_len_capacity];
+    const int expected_len = BLI_kdtree_3d_find_nearest_n(
+        tree, queries[i].data(), expected, nearest_len_capacity);
+    ASSERT_EQ(nearest_len[i], expected_len);
+    for (int j = 0; j < int(expected_len); j++) {
+      EXPECT_EQ(nearest[i * nearest_len_capacity + j].index, expected[j].index);
+      EXPECT_EQ(nearest[i * nearest_len_capacity + j].dist, expected[j].dist);
+    }
+  }
+
+  BLI_kdtree_3d_free(tree);
+}
+
+TEST(kdtree, RangeSearchBatch)
+{
+  const std::vector<std::array<float, 3>> points = random_points_3d(20000, 0);
+  const std::vector<std::array<float, 3>> queries = random_points_3d(1000, 1);
+  KDTree_3d *tree = kdtree_from_points_3d(points);
+
+  const float range = 0.05f;
+  std::vector<int> offsets(queries.size() + 1);
+  KDTreeNearest_3d *nearest;
+  const int nearest_len = BLI_kdtree_3d_range_search_batch(
+      tree,
+      reinterpret_cast<const float(*)[3]>(queries.data()),
+      queries.size(),
+      range,
+      offsets.data(),
+      &nearest);
+  EXPECT_EQ(offsets.back(), nearest_len);
+
+  for (int i = 0; i < int(queries.size()); i++) {
+    KDTreeNearest_3d *expected;
+    const int expected_len = BLI_kdtree_3d_range_search(tree, queries[i].data(), &expected, range);
+    ASSERT_EQ(offsets[i + 1] - offsets[i], expected_len);
+    for (int j = 0; j < int(expected_len); j++) {
+      EXPECT_EQ(nearest[offsets[i] + j].dist, expected[j].dist);
+    }
+    if (expected) {
+      MEM_freeN(expected);
+    }
+  }
+
+  if (nearest) {
+    MEM_freeN(nearest);
+  }
+  BLI_kdtree_3d_free(tree);
+}
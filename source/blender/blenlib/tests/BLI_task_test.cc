@@ -3,6 +3,8 @@
 #include "testing/testing.h"
 #include <atomic>
 #include <cstring>
+#include <fstream>
+#include <sstream>
 
 #include "atomic_ops.h"
 
@@ -10,10 +12,12 @@
 
 #include "BLI_utildefines.h"
 
+#include "BLI_fileops.h"
 #include "BLI_listbase.h"
 #include "BLI_mempool.h"
 #include "BLI_task.h"
 #include "BLI_task.hh"
+#include "BLI_task_trace.hh"
 
 #define ITEMS_NUM 10000
 
@@ -291,3 +295,60 @@ TEST(task, ParallelInvoke)
                                       [&]() { counter++; });
   EXPECT_EQ(counter, 6);
 }
+
+static void task_trace_pool_run_func(TaskPool *__restrict /*pool*/, void *taskdata)
+{
+  std::atomic<int> *counter = static_cast<std::atomic<int> *>(taskdata);
+  (*counter)++;
+}
+
+TEST(task, Trace)
+{
+  using namespace blender;
+  EXPECT_EQ(threading::trace::parallel_name(), nullptr);
+
+  BLI_threadapi_init();
+  BLI_task_trace_begin();
+  EXPECT_TRUE(BLI_task_trace_is_enabled());
+  {
+    threading::trace::TraceRegion trace_region("Trace Test Loop");
+    EXPECT_STREQ(threading::trace::parallel_name(), "Trace Test Loop");
+    threading::parallel_for(IndexRange(ITEMS_NUM), 16, [&](const IndexRange range) {
+      EXPECT_STREQ(threading::trace::parallel_name(), "Trace Test Loop");
+      UNUSED_VARS(range);
+    });
+  }
+  {
+    threading::trace::TraceRegion trace_region("Trace Test Pool");
+    std::atomic<int> counter = 0;
+    TaskPool *pool = BLI_task_pool_create(nullptr, TASK_PRIORITY_HIGH);
+    for (int i = 0; i < 16; i++) {
+      BLI_task_pool_push(pool, task_trace_pool_run_func, &counter, false, nullptr);
+    }
+    BLI_task_pool_work_and_wait(pool);
+    BLI_task_pool_free(pool);
+    EXPECT_EQ(counter, 16);
+  }
+  BLI_task_trace_end();
+  EXPECT_FALSE(BLI_task_trace_is_enabled());
+
+  const std::string filepath = ::testing::TempDir() + "blender_task_trace_test.json";
+  EXPECT_TRUE(BLI_task_trace_write_json(filepath.c_str()));
+
+  std::ifstream file(filepath);
+  std::stringstream buffer;
+  buffer << file.rdbuf();
+  const std::string json = buffer.str();
+  EXPECT_NE(json.find("\"traceEvents\""), std::string::npos);
+  EXPECT_NE(json.find("\"name\": \"Trace Test Loop\", \"cat\": \"region\""),
+            std::string::npos);
+#ifdef WITH_TBB
+  EXPECT_NE(json.find("\"name\": \"Trace Test Loop\", \"cat\": \"parallel_chunk\""),
+            std::string::npos);
+#endif
+  EXPECT_NE(json.find("\"name\": \"Trace Test Pool\", \"cat\": \"pool_task\""),
+            std::string::npos);
+  BLI_delete(filepath.c_str(), false, false);
+
+  BLI_threadapi_exit();
+}
@@ -0,0 +1,118 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_array_store.h"
+#include "BLI_rand.h"
+#include "BLI_utildefines.h"
+
+#include "PIL_time.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+/* Run the longest tests! */
+// #define ARRAY_STORE_RUN_BIG
+
+/* Chunk size used by edit-mesh undo. */
+#define ARRAY_CHUNK_SIZE 256
+
+/* Number of states added (undo pushes) per test. */
+#define STATES_NUM 10
+
+/**
+ * Simulate undo pushes of a mesh layer: every state is a copy of the previous one with a few
+ * edits, either in place or inserting elements (which shifts all data that follows).
+ * Prints the average time to add a state and the memory used by the store.
+ */
+static void array_store_push_test(const char *id,
+                                  const int stride,
+                                  const int elems_num,
+                                  const int edits_num,
+                                  const bool use_insert)
+{
+  printf("\n========== STARTING %s ==========\n", id);
+
+  BArrayStore *bs = BLI_array_store_create(stride, ARRAY_CHUNK_SIZE);
+  RNG *rng = BLI_rng_new(0);
+
+  std::vector<char> data(size_t(elems_num) * stride);
+  BLI_rng_get_char_n(rng, data.data(), data.size());
+
+  std::vector<BArrayState *> states;
+  double time_total = 0.0;
+  double time_max = 0.0;
+
+  for (int i = 0; i < STATES_NUM; i++) {
+    for (int edit = 0; edit < edits_num; edit++) {
+      const size_t offset = size_t(BLI_rng_get_uint(rng) % uint(elems_num)) * stride;
+      if (use_insert) {
+        std::vector<char> elem(stride);
+        BLI_rng_get_char_n(rng, elem.data(), stride);
+        data.insert(data.begin() + offset, elem.begin(), elem.end());
+      }
+      else {
+        BLI_rng_get_char_n(rng, &data[offset], stride);
+      }
+    }
+
+    const double time_start = PIL_check_seconds_timer();
+    BArrayState *state = BLI_array_store_state_add(
+        bs, data.data(), data.size(), states.empty() ? nullptr : states.back());
+    const double time = PIL_check_seconds_timer() - time_start;
+    time_total += time;
+    time_max = std::max(time_max, time);
+
+    states.push_back(state);
+  }
+
+  /* Check the last state survived the round trip. */
+  size_t state_data_len;
+  void *state_data = BLI_array_store_state_data_get_alloc(states.back(), &state_data_len);
+  EXPECT_EQ(state_data_len, data.size());
+  EXPECT_EQ(memcmp(state_data, data.data(), data.size()), 0);
+  MEM_freeN(state_data);
+
+  const size_t size_expanded = BLI_array_store_calc_size_expanded_get(bs);
+  const size_t size_compacted = BLI_array_store_calc_size_compacted_get(bs);
+  printf("Add state: %.6fs on average, %.6fs max\n", time_total / STATES_NUM, time_max);
+  printf("Memory: %.2f MB expanded, %.2f MB compacted (%.2f%%)\n",
+         double(size_expanded) / (1024.0 * 1024.0),
+         double(size_compacted) / (1024.0 * 1024.0),
+         100.0 * double(size_compacted) / double(size_expanded));
+
+  BLI_rng_free(rng);
+  BLI_array_store_destroy(bs);
+
+  printf("========== ENDED %s ==========\n\n", id);
+}
+
+TEST(array_store, PushEdit_Float3_1M)
+{
+  array_store_push_test("Float3 - 1M elements - edits", 12, 1000000, 100, false);
+}
+
+TEST(array_store, PushInsert_Float3_1M)
+{
+  array_store_push_test("Float3 - 1M elements - inserts", 12, 1000000, 100, true);
+}
+
+TEST(array_store, PushInsert_Bool_1M)
+{
+  array_store_push_test("Bool - 1M elements - inserts", 1, 1000000, 100, true);
+}
+
+#ifdef ARRAY_STORE_RUN_BIG
+TEST(array_store, PushEdit_Float3_5M)
+{
+  array_store_push_test("Float3 - 5M elements - edits", 12, 5000000, 100, false);
+}
+
+TEST(array_store, PushInsert_Float3_5M)
+{
+  array_store_push_test("Float3 - 5M elements - inserts", 12, 5000000, 100, true);
+}
+#endif
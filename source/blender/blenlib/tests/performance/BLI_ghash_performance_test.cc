@@ -7,10 +7,17 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "BLI_array.hh"
 #include "BLI_ghash.h"
+#include "BLI_group_probing_map.hh"
+#include "BLI_group_probing_set.hh"
+#include "BLI_map.hh"
 #include "BLI_rand.h"
+#include "BLI_set.hh"
 #include "BLI_string.h"
+#include "BLI_string_ref.hh"
 #include "BLI_utildefines.h"
+#include "BLI_vector.hh"
 #include "PIL_time_utildefines.h"
 
 /* Using http://corpora.uni-leipzig.de/downloads/eng_wikipedia_2010_1M-text.tar.gz
@@ -571,3 +578,428 @@ TEST(ghash, MultiRandIntMurmur2a200000)
 
   multi_small_ghash_tests(ghash, "MultiSmall RandIntGHash - Murmur2a - 200000", 200000);
 }
+
+/* Comparison of GHash/GSet with the C++ hash tables: #blender::Map, #blender::Set and their
+ * group probing counterparts. Every container gets the same keys inserted, then looked up
+ * (first the inserted keys, then keys that are most likely missing) and finally removed. */
+
+namespace blender::tests {
+
+static void *key_as_pointer(const uint key)
+{
+  return POINTER_FROM_UINT(key);
+}
+
+static void *key_as_pointer(const void *key)
+{
+  return const_cast<void *>(key);
+}
+
+static void *key_as_pointer(const StringRef key)
+{
+  /* Words are null-terminated, see #text_words. */
+  return const_cast<char *>(key.data());
+}
+
+/** Wraps a GHash in the subset of the #Map interface used by the benchmarks. */
+template<typename Key> class GHashMapWrapper {
+ private:
+  GHash *ghash_;
+
+ public:
+  GHashMapWrapper(GHashHashFP hashfp, GHashCmpFP cmpfp)
+      : ghash_(BLI_ghash_new(hashfp, cmpfp, __func__))
+  {
+  }
+
+  ~GHashMapWrapper()
+  {
+    BLI_ghash_free(ghash_, nullptr, nullptr);
+  }
+
+  bool add(const Key &key, const int value)
+  {
+    void **value_p;
+    if (BLI_ghash_ensure_p(ghash_, key_as_pointer(key), &value_p)) {
+      return false;
+    }
+    *value_p = POINTER_FROM_INT(value);
+    return true;
+  }
+
+  int lookup_default(const Key &key, const int default_value) const
+  {
+    return POINTER_AS_INT(
+        BLI_ghash_lookup_default(ghash_, key_as_pointer(key), POINTER_FROM_INT(default_value)));
+  }
+
+  bool remove(const Key &key)
+  {
+    return BLI_ghash_remove(ghash_, key_as_pointer(key), nullptr, nullptr);
+  }
+
+  int64_t size() const
+  {
+    return BLI_ghash_len(ghash_);
+  }
+};
+
+/** Wraps a GSet in the subset of the #Set interface used by the benchmarks. */
+template<typename Key> class GSetWrapper {
+ private:
+  GSet *gset_;
+
+ public:
+  GSetWrapper(GSetHashFP hashfp, GSetCmpFP cmpfp) : gset_(BLI_gset_new(hashfp, cmpfp, __func__))
+  {
+  }
+
+  ~GSetWrapper()
+  {
+    BLI_gset_free(gset_, nullptr);
+  }
+
+  bool add(const Key &key)
+  {
+    return BLI_gset_add(gset_, key_as_pointer(key));
+  }
+
+  bool contains(const Key &key) const
+  {
+    return BLI_gset_haskey(gset_, key_as_pointer(key));
+  }
+
+  bool remove(const Key &key)
+  {
+    return BLI_gset_remove(gset_, key_as_pointer(key), nullptr);
+  }
+
+  int64_t size() const
+  {
+    return BLI_gset_len(gset_);
+  }
+};
+
+static Vector<uint> random_uints(const int64_t count, const uint seed)
+{
+  Vector<uint> values(count);
+  RNG *rng = BLI_rng_new(seed);
+  for (uint &value : values) {
+    value = BLI_rng_get_uint(rng);
+  }
+  BLI_rng_free(rng);
+  return values;
+}
+
+/**
+ * Split the text into null-terminated words, which are stored in \a r_buffer.
+ */
+static Vector<StringRef> text_words(const char *text, std::string &r_buffer)
+{
+  r_buffer = text;
+  Vector<StringRef> words;
+  int64_t word_start = 0;
+  for (const int64_t i : IndexRange(r_buffer.size())) {
+    if (ELEM(r_buffer[i], ' ', '.', '\n')) {
+      r_buffer[i] = '\0';
+      if (i > word_start) {
+        words.append(StringRef(&r_buffer[word_start], i - word_start));
+      }
+      word_start = i + 1;
+    }
+  }
+  if (word_start < int64_t(r_buffer.size())) {
+    words.append(StringRef(r_buffer).drop_prefix(word_start));
+  }
+  return words;
+}
+
+template<typename MapT, typename Key>
+static void map_compare_tests(MapT &map,
+                              const char *id,
+                              const Span<Key> keys,
+                              const Span<Key> missing_keys)
+{
+  printf("\n========== STARTING %s ==========\n", id);
+
+  int64_t added = 0;
+  {
+    TIMEIT_START(map_insert);
+
+    for (const Key &key : keys) {
+      added += map.add(key, 1);
+    }
+
+    TIMEIT_END(map_insert);
+  }
+  EXPECT_EQ(map.size(), added);
+
+  {
+    int64_t found = 0;
+    TIMEIT_START(map_lookup);
+
+    for (const Key &key : keys) {
+      found += map.lookup_default(key, 0);
+    }
+
+    TIMEIT_END(map_lookup);
+    EXPECT_EQ(found, keys.size());
+  }
+
+  {
+    int64_t found = 0;
+    TIMEIT_START(map_lookup_missing);
+
+    for (const Key &key : missing_keys) {
+      found += map.lookup_default(key, 0);
+    }
+
+    TIMEIT_END(map_lookup_missing);
+    printf("%lld of %lld missing keys were found\n",
+           (long long)found,
+           (long long)missing_keys.size());
+  }
+
+  {
+    int64_t removed = 0;
+    TIMEIT_START(map_remove);
+
+    for (const Key &key : keys) {
+      removed += map.remove(key);
+    }
+
+    TIMEIT_END(map_remove);
+    EXPECT_EQ(removed, added);
+  }
+  EXPECT_EQ(map.size(), 0);
+
+  printf("========== ENDED %s ==========\n\n", id);
+}
+
+template<typename SetT, typename Key>
+static void set_compare_tests(SetT &set,
+                              const char *id,
+                              const Span<Key> keys,
+                              const Span<Key> missing_keys)
+{
+  printf("\n========== STARTING %s ==========\n", id);
+
+  int64_t added = 0;
+  {
+    TIMEIT_START(set_insert);
+
+    for (const Key &key : keys) {
+      added += set.add(key);
+    }
+
+    TIMEIT_END(set_insert);
+  }
+  EXPECT_EQ(set.size(), added);
+
+  {
+    int64_t found = 0;
+    TIMEIT_START(set_lookup);
+
+    for (const Key &key : keys) {
+      found += set.contains(key);
+    }
+
+    TIMEIT_END(set_lookup);
+    EXPECT_EQ(found, keys.size());
+  }
+
+  {
+    int64_t found = 0;
+    TIMEIT_START(set_lookup_missing);
+
+    for (const Key &key : missing_keys) {
+      found += set.contains(key);
+    }
+
+    TIMEIT_END(set_lookup_missing);
+    printf("%lld of %lld missing keys were found\n",
+           (long long)found,
+           (long long)missing_keys.size());
+  }
+
+  {
+    int64_t removed = 0;
+    TIMEIT_START(set_remove);
+
+    for (const Key &key : keys) {
+      removed += set.remove(key);
+    }
+
+    TIMEIT_END(set_remove);
+    EXPECT_EQ(removed, added);
+  }
+  EXPECT_EQ(set.size(), 0);
+
+  printf("========== ENDED %s ==========\n\n", id);
+}
+
+/** Compare the C++ containers only, for key types GHash doesn't support. */
+template<typename Key>
+static void cpp_compare_tests(const std::string &id,
+                              const Span<Key> keys,
+                              const Span<Key> missing_keys)
+{
+  {
+    Map<Key, int> map;
+    map_compare_tests(map, (id + " Map - Map").c_str(), keys, missing_keys);
+  }
+  {
+    GroupProbingMap<Key, int> map;
+    map_compare_tests(map, (id + " Map - GroupProbingMap").c_str(), keys, missing_keys);
+  }
+  {
+    Set<Key> set;
+    set_compare_tests(set, (id + " Set - Set").c_str(), keys, missing_keys);
+  }
+  {
+    GroupProbingSet<Key> set;
+    set_compare_tests(set, (id + " Set - GroupProbingSet").c_str(), keys, missing_keys);
+  }
+}
+
+static void randint_compare_tests(const int64_t count)
+{
+  const Vector<uint> keys = random_uints(count, 1);
+  const Vector<uint> missing_keys = random_uints(count, 2);
+  const Span<uint> keys_span = keys;
+  const Span<uint> missing_span = missing_keys;
+  const std::string suffix = " - " + std::to_string(count);
+
+  {
+    GHashMapWrapper<uint> map(BLI_ghashutil_inthash_p, BLI_ghashutil_intcmp);
+    map_compare_tests(map, ("RandInt Map - GHash" + suffix).c_str(), keys_span, missing_span);
+  }
+  {
+    Map<uint, int> map;
+    map_compare_tests(map, ("RandInt Map - Map" + suffix).c_str(), keys_span, missing_span);
+  }
+  {
+    GroupProbingMap<uint, int> map;
+    map_compare_tests(
+        map, ("RandInt Map - GroupProbingMap" + suffix).c_str(), keys_span, missing_span);
+  }
+  {
+    GSetWrapper<uint> set(BLI_ghashutil_inthash_p, BLI_ghashutil_intcmp);
+    set_compare_tests(set, ("RandInt Set - GSet" + suffix).c_str(), keys_span, missing_span);
+  }
+  {
+    Set<uint> set;
+    set_compare_tests(set, ("RandInt Set - Set" + suffix).c_str(), keys_span, missing_span);
+  }
+  {
+    GroupProbingSet<uint> set;
+    set_compare_tests(
+        set, ("RandInt Set - GroupProbingSet" + suffix).c_str(), keys_span, missing_span);
+  }
+}
+
+TEST(ghash, CompareRandInt12000)
+{
+  randint_compare_tests(12000);
+}
+
+TEST(ghash, CompareRandInt200000)
+{
+  randint_compare_tests(200000);
+}
+
+#ifdef GHASH_RUN_BIG
+TEST(ghash, CompareRandInt50000000)
+{
+  randint_compare_tests(50000000);
+}
+#endif
+
+TEST(ghash, CompareText)
+{
+  std::string words_buffer;
+  const Vector<StringRef> words = text_words(words10k, words_buffer);
+  /* Words from the first half of the text are inserted, so lookups of the second half are a mix
+   * of hits and misses. */
+  const Span<StringRef> keys = words.as_span().take_front(words.size() / 2);
+  const Span<StringRef> missing_keys = words.as_span().drop_front(words.size() / 2);
+
+  {
+    GHashMapWrapper<StringRef> map(BLI_ghashutil_strhash_p, BLI_ghashutil_strcmp);
+    map_compare_tests(map, "Text Map - GHash", keys, missing_keys);
+  }
+  {
+    Map<StringRef, int> map;
+    map_compare_tests(map, "Text Map - Map", keys, missing_keys);
+  }
+  {
+    GroupProbingMap<StringRef, int> map;
+    map_compare_tests(map, "Text Map - GroupProbingMap", keys, missing_keys);
+  }
+  {
+    GSetWrapper<StringRef> set(BLI_ghashutil_strhash_p, BLI_ghashutil_strcmp);
+    set_compare_tests(set, "Text Set - GSet", keys, missing_keys);
+  }
+  {
+    Set<StringRef> set;
+    set_compare_tests(set, "Text Set - Set", keys, missing_keys);
+  }
+  {
+    GroupProbingSet<StringRef> set;
+    set_compare_tests(set, "Text Set - GroupProbingSet", keys, missing_keys);
+  }
+}
+
+/**
+ * Integers that are multiples of a power of two, e.g. offsets or packed indices. The default hash
+ * of integers is the identity, so their low bits are all zero.
+ */
+static void strided_int_compare_tests(const int64_t count, const int shift)
+{
+  Vector<int64_t> keys(count);
+  Vector<int64_t> missing_keys(count);
+  for (const int64_t i : IndexRange(count)) {
+    keys[i] = i << shift;
+    missing_keys[i] = (i + count) << shift;
+  }
+  cpp_compare_tests<int64_t>("StridedInt " + std::to_string(shift) + " - " + std::to_string(count),
+                             keys,
+                             missing_keys);
+}
+
+TEST(ghash, CompareStridedInt)
+{
+  for (const int shift : {4, 8, 12, 16, 24, 32}) {
+    strided_int_compare_tests(200000, shift);
+  }
+}
+
+TEST(ghash, ComparePointers)
+{
+  /* Pointers to elements of an array, the missing keys point to the elements in between. */
+  struct Element {
+    char data[64];
+  };
+  const int64_t count = 200000;
+  Array<Element> elements(count * 2);
+  Vector<const void *> keys(count);
+  Vector<const void *> missing_keys(count);
+  for (const int64_t i : IndexRange(count)) {
+    keys[i] = &elements[i * 2];
+    missing_keys[i] = &elements[i * 2 + 1];
+  }
+  const Span<const void *> keys_span = keys;
+  const Span<const void *> missing_span = missing_keys;
+
+  {
+    GHashMapWrapper<const void *> map(BLI_ghashutil_ptrhash, BLI_ghashutil_ptrcmp);
+    map_compare_tests(map, "Pointer Map - GHash", keys_span, missing_span);
+  }
+  {
+    GSetWrapper<const void *> set(BLI_ghashutil_ptrhash, BLI_ghashutil_ptrcmp);
+    set_compare_tests(set, "Pointer Set - GSet", keys_span, missing_span);
+  }
+  cpp_compare_tests("Pointer", keys_span, missing_span);
+}
+
+}  // namespace blender::tests
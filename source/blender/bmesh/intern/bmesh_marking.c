@@ -466,43 +466,47 @@ void BM_mesh_deselect_flush(BMesh *bm)
   recount_totsels(bm);
 }
 
-void BM_mesh_select_flush(BMesh *bm)
+static void bm_mesh_select_flush_edge_iter_fn(void *UNUSED(userdata),
+                                              MempoolIterData *iter,
+                                              const TaskParallelTLS *__restrict UNUSED(tls))
 {
-  BMEdge *e;
+  BMEdge *e = (BMEdge *)iter;
+  if (BM_elem_flag_test(e->v1, BM_ELEM_SELECT) && BM_elem_flag_test(e->v2, BM_ELEM_SELECT) &&
+      !BM_elem_flag_test(e, BM_ELEM_HIDDEN)) {
+    BM_elem_flag_enable(e, BM_ELEM_SELECT);
+  }
+}
+
+static void bm_mesh_select_flush_face_iter_fn(void *UNUSED(userdata),
+                                              MempoolIterData *iter,
+                                              const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  BMFace *f = (BMFace *)iter;
   BMLoop *l_iter;
   BMLoop *l_first;
-  BMFace *f;
-
-  BMIter eiter;
-  BMIter fiter;
-
-  bool ok;
-
-  BM_ITER_MESH (e, &eiter, bm, BM_EDGES_OF_MESH) {
-    if (BM_elem_flag_test(e->v1, BM_ELEM_SELECT) && BM_elem_flag_test(e->v2, BM_ELEM_SELECT) &&
-        !BM_elem_flag_test(e, BM_ELEM_HIDDEN)) {
-      BM_elem_flag_enable(e, BM_ELEM_SELECT);
-    }
+  if (BM_elem_flag_test(f, BM_ELEM_HIDDEN)) {
+    return;
   }
-  BM_ITER_MESH (f, &fiter, bm, BM_FACES_OF_MESH) {
-    ok = true;
-    if (!BM_elem_flag_test(f, BM_ELEM_HIDDEN)) {
-      l_iter = l_first = BM_FACE_FIRST_LOOP(f);
-      do {
-        if (!BM_elem_flag_test(l_iter->v, BM_ELEM_SELECT)) {
-          ok = false;
-          break;
-        }
-      } while ((l_iter = l_iter->next) != l_first);
-    }
-    else {
-      ok = false;
+  l_iter = l_first = BM_FACE_FIRST_LOOP(f);
+  do {
+    if (!BM_elem_flag_test(l_iter->v, BM_ELEM_SELECT)) {
+      return;
     }
+  } while ((l_iter = l_iter->next) != l_first);
+  BM_elem_flag_enable(f, BM_ELEM_SELECT);
+}
 
-    if (ok) {
-      BM_elem_flag_enable(f, BM_ELEM_SELECT);
-    }
-  }
+void BM_mesh_select_flush(BMesh *bm)
+{
+  /* Each element only writes its own flag, so edges and faces can be handled in parallel. */
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+
+  settings.use_threading = bm->totedge >= BM_OMP_LIMIT;
+  BM_iter_parallel(bm, BM_EDGES_OF_MESH, bm_mesh_select_flush_edge_iter_fn, NULL, &settings);
+
+  settings.use_threading = bm->totface >= BM_OMP_LIMIT;
+  BM_iter_parallel(bm, BM_FACES_OF_MESH, bm_mesh_select_flush_face_iter_fn, NULL, &settings);
 
   recount_totsels(bm);
 }
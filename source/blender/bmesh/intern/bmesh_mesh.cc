@@ -1063,7 +1063,10 @@ void BM_mesh_rebuild(BMesh *bm,
       BMVert *v_dst = static_cast<BMVert *>(BLI_mempool_alloc(vpool_dst));
       memcpy(v_dst, v_src, sizeof(BMVert));
       if (use_toolflags) {
-        ((BMVert_OFlag *)v_dst)->oflags = bm->vtoolflagpool ?
+        /* Keep the existing tool flags when only packing the elements. */
+        ((BMVert_OFlag *)v_dst)->oflags = bm->use_toolflags ?
+                                              ((BMVert_OFlag *)v_src)->oflags :
+                                          bm->vtoolflagpool ?
                                               static_cast<BMFlagLayer *>(
                                                   BLI_mempool_calloc(bm->vtoolflagpool)) :
                                               nullptr;
@@ -1082,7 +1085,10 @@ void BM_mesh_rebuild(BMesh *bm,
       BMEdge *e_dst = static_cast<BMEdge *>(BLI_mempool_alloc(epool_dst));
       memcpy(e_dst, e_src, sizeof(BMEdge));
       if (use_toolflags) {
-        ((BMEdge_OFlag *)e_dst)->oflags = bm->etoolflagpool ?
+        /* Keep the existing tool flags when only packing the elements. */
+        ((BMEdge_OFlag *)e_dst)->oflags = bm->use_toolflags ?
+                                              ((BMEdge_OFlag *)e_src)->oflags :
+                                          bm->etoolflagpool ?
                                               static_cast<BMFlagLayer *>(
                                                   BLI_mempool_calloc(bm->etoolflagpool)) :
                                               nullptr;
@@ -1103,7 +1109,9 @@ void BM_mesh_rebuild(BMesh *bm,
         BMFace *f_dst = static_cast<BMFace *>(BLI_mempool_alloc(fpool_dst));
         memcpy(f_dst, f_src, sizeof(BMFace));
         if (use_toolflags) {
-          ((BMFace_OFlag *)f_dst)->oflags = bm->ftoolflagpool ?
+          ((BMFace_OFlag *)f_dst)->oflags = bm->use_toolflags ?
+                                                ((BMFace_OFlag *)f_src)->oflags :
+                                            bm->ftoolflagpool ?
                                                 static_cast<BMFlagLayer *>(
                                                     BLI_mempool_calloc(bm->ftoolflagpool)) :
                                                 nullptr;
@@ -1319,6 +1327,118 @@ void BM_mesh_toolflags_set(BMesh *bm, bool use_toolflags)
   bm->use_toolflags = use_toolflags;
 }
 
+/**
+ * Move the custom-data blocks of all elements of one type into a new memory pool,
+ * in the same order as the elements.
+ */
+static void bm_mesh_customdata_compact(BMesh *bm, CustomData *data, const char htype)
+{
+  if (data->pool == nullptr) {
+    return;
+  }
+  BLI_mempool *pool_src = data->pool;
+  data->pool = nullptr;
+  CustomData_bmesh_init_pool(data, BLI_mempool_len(pool_src), htype);
+  BLI_mempool *pool_dst = data->pool;
+  const int size = data->totsize;
+
+  auto compact_block = [&](BMHeader *head) {
+    if (head->data) {
+      void *block = BLI_mempool_alloc(pool_dst);
+      memcpy(block, head->data, size);
+      head->data = block;
+    }
+  };
+
+  BMIter iter;
+  switch (htype) {
+    case BM_VERT: {
+      BMVert *v;
+      BM_ITER_MESH (v, &iter, bm, BM_VERTS_OF_MESH) {
+        compact_block(&v->head);
+      }
+      break;
+    }
+    case BM_EDGE: {
+      BMEdge *e;
+      BM_ITER_MESH (e, &iter, bm, BM_EDGES_OF_MESH) {
+        compact_block(&e->head);
+      }
+      break;
+    }
+    case BM_LOOP: {
+      BMFace *f;
+      BM_ITER_MESH (f, &iter, bm, BM_FACES_OF_MESH) {
+        BMLoop *l_iter, *l_first;
+        l_iter = l_first = BM_FACE_FIRST_LOOP(f);
+        do {
+          compact_block(&l_iter->head);
+        } while ((l_iter = l_iter->next) != l_first);
+      }
+      break;
+    }
+    case BM_FACE: {
+      BMFace *f;
+      BM_ITER_MESH (f, &iter, bm, BM_FACES_OF_MESH) {
+        compact_block(&f->head);
+      }
+      break;
+    }
+  }
+
+  /* The blocks were moved, so their contents must not be freed. */
+  BLI_mempool_destroy(pool_src);
+}
+
+void BM_mesh_compact(BMesh *bm)
+{
+  const BMAllocTemplate allocsize = BMALLOC_TEMPLATE_FROM_BM(bm);
+
+  BLI_mempool *vpool_dst = nullptr;
+  BLI_mempool *epool_dst = nullptr;
+  BLI_mempool *lpool_dst = nullptr;
+  BLI_mempool *fpool_dst = nullptr;
+
+  bm_mempool_init_ex(
+      &allocsize, bm->use_toolflags, &vpool_dst, &epool_dst, &lpool_dst, &fpool_dst);
+
+  struct BMeshCreateParams params = {};
+  params.use_toolflags = bm->use_toolflags;
+
+  BM_mesh_rebuild(bm, &params, vpool_dst, epool_dst, lpool_dst, fpool_dst);
+
+  bm_mesh_customdata_compact(bm, &bm->vdata, BM_VERT);
+  bm_mesh_customdata_compact(bm, &bm->edata, BM_EDGE);
+  bm_mesh_customdata_compact(bm, &bm->ldata, BM_LOOP);
+  bm_mesh_customdata_compact(bm, &bm->pdata, BM_FACE);
+
+  /* Elements are still in the same order, but the indices were only set on the old elements. */
+  bm->elem_index_dirty |= BM_ALL;
+  BM_mesh_elem_index_ensure(bm, BM_ALL);
+
+  /* The loop normal spaces reference the old loops. */
+  if (bm->lnor_spacearr) {
+    bm->spacearr_dirty |= BM_SPACEARR_DIRTY_ALL;
+  }
+}
+
+/**
+ * Only compact when there are many unused elements,
+ * some free space at the end of the last chunk is expected.
+ */
+static bool bm_mempool_is_fragmented(const BLI_mempool *pool)
+{
+  const int len = BLI_mempool_len(pool);
+  const int unused = BLI_mempool_len_alloc(pool) - len;
+  return unused > 4096 && unused > len / 4;
+}
+
+bool BM_mesh_is_fragmented(const BMesh *bm)
+{
+  return bm_mempool_is_fragmented(bm->vpool) || bm_mempool_is_fragmented(bm->epool) ||
+         bm_mempool_is_fragmented(bm->lpool) || bm_mempool_is_fragmented(bm->fpool);
+}
+
 /* -------------------------------------------------------------------- */
 /** \name BMesh Coordinate Access
  * \{ */
@@ -170,6 +170,23 @@ void BM_mesh_rebuild(BMesh *bm,
                      struct BLI_mempool *lpool,
                      struct BLI_mempool *fpool);
 
+/**
+ * Pack all elements and their custom-data into new memory pools, in index order.
+ *
+ * After many elements have been added and removed the memory pools have gaps
+ * and elements may be far from their custom-data, which slows down iterating over the mesh.
+ * The element order and indices are unchanged.
+ *
+ * \warning All pointers to elements of the mesh become invalid,
+ * this includes #BMEditMesh.looptris.
+ */
+void BM_mesh_compact(BMesh *bm);
+/**
+ * \return True when enough memory in the element pools is unused
+ * that #BM_mesh_compact is worthwhile.
+ */
+bool BM_mesh_is_fragmented(const BMesh *bm);
+
 typedef struct BMAllocTemplate {
   int totvert, totedge, totloop, totface;
 } BMAllocTemplate;
@@ -1079,20 +1079,68 @@ static Vector<BMeshToMeshLayerInfo> bm_to_mesh_copy_info_calc(const CustomData &
 
 namespace blender {
 
+/**
+ * When the element table and indices of a type are both up to date (from edit-mode operators
+ * or drawing for example), the tables can be filled in parallel from the BMesh tables instead
+ * of iterating over the memory pools, and the BMesh doesn't have to be modified at all.
+ *
+ * \note Indices may be offset when they were ensured for multiple objects at once
+ * (see `EDBM_mesh_elem_index_ensure_multi`), so check the first element too.
+ * Tables without elements are never used, there is no first element to check.
+ */
+static bool bm_elem_table_and_index_valid(const BMesh &bm, const char htype)
+{
+  BLI_assert(ELEM(htype, BM_VERT, BM_EDGE, BM_FACE));
+  const BMElem *const *table = (htype == BM_VERT) ? (const BMElem *const *)bm.vtable :
+                               (htype == BM_EDGE) ? (const BMElem *const *)bm.etable :
+                                                    (const BMElem *const *)bm.ftable;
+  const int totelem = (htype == BM_VERT) ? bm.totvert :
+                      (htype == BM_EDGE) ? bm.totedge :
+                                           bm.totface;
+  if (table == nullptr || totelem == 0 ||
+      ((bm.elem_table_dirty | bm.elem_index_dirty) & htype) != 0) {
+    return false;
+  }
+  return BM_elem_index_get(table[0]) == 0;
+}
+
+/** Fill \a table from a valid BMesh element table and return the combined header flags. */
+template<typename T>
+static char bm_elem_table_copy_and_flags(const Span<T *> src, MutableSpan<const T *> table)
+{
+  return threading::parallel_reduce(
+      src.index_range(),
+      4096,
+      char(0),
+      [&](const IndexRange range, char hflag) {
+        for (const int i : range) {
+          table[i] = src[i];
+          hflag |= src[i]->head.hflag;
+        }
+        return hflag;
+      },
+      [](const char a, const char b) { return char(a | b); });
+}
+
 static void bm_vert_table_build(BMesh &bm,
                                 MutableSpan<const BMVert *> table,
                                 bool &need_select_vert,
                                 bool &need_hide_vert)
 {
   char hflag = 0;
-  BMIter iter;
-  int i;
-  BMVert *vert;
-  BM_ITER_MESH_INDEX (vert, &iter, &bm, BM_VERTS_OF_MESH, i) {
-    BM_elem_index_set(vert, i); /* set_inline */
-    table[i] = vert;
-    hflag |= vert->head.hflag;
-    BM_CHECK_ELEMENT(vert);
+  if (bm_elem_table_and_index_valid(bm, BM_VERT)) {
+    hflag = bm_elem_table_copy_and_flags(Span<BMVert *>(bm.vtable, bm.totvert), table);
+  }
+  else {
+    BMIter iter;
+    int i;
+    BMVert *vert;
+    BM_ITER_MESH_INDEX (vert, &iter, &bm, BM_VERTS_OF_MESH, i) {
+      BM_elem_index_set(vert, i); /* set_inline */
+      table[i] = vert;
+      hflag |= vert->head.hflag;
+      BM_CHECK_ELEMENT(vert);
+    }
   }
   need_select_vert = (hflag & BM_ELEM_SELECT) != 0;
   need_hide_vert = (hflag & BM_ELEM_HIDDEN) != 0;
@@ -1106,14 +1154,19 @@ static void bm_edge_table_build(BMesh &bm,
                                 bool &need_uv_seams)
 {
   char hflag = 0;
-  BMIter iter;
-  int i;
-  BMEdge *edge;
-  BM_ITER_MESH_INDEX (edge, &iter, &bm, BM_EDGES_OF_MESH, i) {
-    BM_elem_index_set(edge, i); /* set_inline */
-    table[i] = edge;
-    hflag |= edge->head.hflag;
-    BM_CHECK_ELEMENT(edge);
+  if (bm_elem_table_and_index_valid(bm, BM_EDGE)) {
+    hflag = bm_elem_table_copy_and_flags(Span<BMEdge *>(bm.etable, bm.totedge), table);
+  }
+  else {
+    BMIter iter;
+    int i;
+    BMEdge *edge;
+    BM_ITER_MESH_INDEX (edge, &iter, &bm, BM_EDGES_OF_MESH, i) {
+      BM_elem_index_set(edge, i); /* set_inline */
+      table[i] = edge;
+      hflag |= edge->head.hflag;
+      BM_CHECK_ELEMENT(edge);
+    }
   }
   need_select_edge = (hflag & BM_ELEM_SELECT) != 0;
   need_hide_edge = (hflag & BM_ELEM_HIDDEN) != 0;
@@ -1153,78 +1206,102 @@ static void bm_face_loop_table_build(BMesh &bm,
     add_bool_layer(edge_sel_layers, BKE_uv_map_edge_select_name_get(layer_name, sub_layer_name));
     add_bool_layer(pin_layers, BKE_uv_map_pin_name_get(layer_name, sub_layer_name));
   }
-  Array<int> vert_sel_offsets(vert_sel_layers.size());
-  Array<int> edge_sel_offsets(edge_sel_layers.size());
-  Array<int> pin_offsets(pin_layers.size());
-  for (const int i : vert_sel_layers.index_range()) {
-    vert_sel_offsets[i] = ldata.layers[vert_sel_layers[i]].offset;
-  }
-  for (const int i : edge_sel_layers.index_range()) {
-    edge_sel_offsets[i] = ldata.layers[edge_sel_layers[i]].offset;
-  }
-  for (const int i : pin_layers.index_range()) {
-    pin_offsets[i] = ldata.layers[pin_layers[i]].offset;
-  }
-
-  Array<bool> need_vert_sel(vert_sel_layers.size(), false);
-  Array<bool> need_edge_sel(edge_sel_layers.size(), false);
-  Array<bool> need_pin(pin_layers.size(), false);
-  char hflag = 0;
-  BMIter iter;
-  int face_i = 0;
-  int loop_i = 0;
-  BMFace *face;
-  BM_ITER_MESH_INDEX (face, &iter, &bm, BM_FACES_OF_MESH, face_i) {
-    BM_elem_index_set(face, face_i); /* set_inline */
-    face_table[face_i] = face;
-    hflag |= face->head.hflag;
-    need_sharp_face |= (face->head.hflag & BM_ELEM_SMOOTH) == 0;
-    need_material_index |= face->mat_nr != 0;
-    BM_CHECK_ELEMENT(face);
-
-    BMLoop *loop = BM_FACE_FIRST_LOOP(face);
-    for ([[maybe_unused]] const int i : IndexRange(face->len)) {
-      BM_elem_index_set(loop, loop_i); /* set_inline */
-      loop_table[loop_i] = loop;
-      for (const int i : vert_sel_offsets.index_range()) {
-        if (BM_ELEM_CD_GET_BOOL(loop, vert_sel_offsets[i])) {
-          need_vert_sel[i] = true;
-        }
-      }
-      for (const int i : edge_sel_offsets.index_range()) {
-        if (BM_ELEM_CD_GET_BOOL(loop, edge_sel_offsets[i])) {
-          need_edge_sel[i] = true;
-        }
-      }
-      for (const int i : pin_offsets.index_range()) {
-        if (BM_ELEM_CD_GET_BOOL(loop, pin_offsets[i])) {
-          need_pin[i] = true;
-        }
+  /* Check all the boolean layers together, storing whether each has a true value in a bit-mask
+   * (there are at most three layers for each of the #MAX_MTFACE UV maps). */
+  Vector<int> bool_layers;
+  bool_layers.extend(vert_sel_layers);
+  bool_layers.extend(edge_sel_layers);
+  bool_layers.extend(pin_layers);
+  BLI_assert(bool_layers.size() <= 32);
+  Array<int> bool_offsets(bool_layers.size());
+  for (const int i : bool_layers.index_range()) {
+    bool_offsets[i] = ldata.layers[bool_layers[i]].offset;
+  }
+  auto loop_bool_layers_used = [&](const BMLoop *loop) {
+    uint32_t used = 0;
+    for (const int i : bool_offsets.index_range()) {
+      if (BM_ELEM_CD_GET_BOOL(loop, bool_offsets[i])) {
+        used |= 1u << i;
       }
-      BM_CHECK_ELEMENT(loop);
-      loop = loop->next;
-      loop_i++;
-    }
-  }
-  need_select_poly = (hflag & BM_ELEM_SELECT) != 0;
-  need_hide_poly = (hflag & BM_ELEM_HIDDEN) != 0;
-
-  for (const int i : vert_sel_layers.index_range()) {
-    if (!need_vert_sel[i]) {
-      ldata.layers[vert_sel_layers[i]].flag |= CD_FLAG_NOCOPY;
-      ldata_layers_marked_nocopy.append(vert_sel_layers[i]);
     }
+    return used;
+  };
+
+  struct FaceLoopFlags {
+    char hflag = 0;
+    bool need_sharp_face = false;
+    bool need_material_index = false;
+    uint32_t bool_layers_used = 0;
+  };
+  FaceLoopFlags flags;
+  if (bm_elem_table_and_index_valid(bm, BM_FACE) && (bm.elem_index_dirty & BM_LOOP) == 0 &&
+      BM_elem_index_get(BM_FACE_FIRST_LOOP(bm.ftable[0])) == 0) {
+    /* The loop indices are valid too, so each face can find its range of the loop table. */
+    const Span<BMFace *> faces(bm.ftable, bm.totface);
+    flags = threading::parallel_reduce(
+        faces.index_range(),
+        1024,
+        FaceLoopFlags(),
+        [&](const IndexRange range, FaceLoopFlags flags) {
+          for (const int face_i : range) {
+            const BMFace *face = faces[face_i];
+            face_table[face_i] = face;
+            flags.hflag |= face->head.hflag;
+            flags.need_sharp_face |= (face->head.hflag & BM_ELEM_SMOOTH) == 0;
+            flags.need_material_index |= face->mat_nr != 0;
+
+            const BMLoop *loop = BM_FACE_FIRST_LOOP(face);
+            const int loop_start = BM_elem_index_get(loop);
+            for (const int loop_i : IndexRange(loop_start, face->len)) {
+              loop_table[loop_i] = loop;
+              flags.bool_layers_used |= loop_bool_layers_used(loop);
+              loop = loop->next;
+            }
+          }
+          return flags;
+        },
+        [](const FaceLoopFlags &a, const FaceLoopFlags &b) {
+          FaceLoopFlags result;
+          result.hflag = a.hflag | b.hflag;
+          result.need_sharp_face = a.need_sharp_face || b.need_sharp_face;
+          result.need_material_index = a.need_material_index || b.need_material_index;
+          result.bool_layers_used = a.bool_layers_used | b.bool_layers_used;
+          return result;
+        });
   }
-  for (const int i : edge_sel_layers.index_range()) {
-    if (!need_edge_sel[i]) {
-      ldata.layers[edge_sel_layers[i]].flag |= CD_FLAG_NOCOPY;
-      ldata_layers_marked_nocopy.append(edge_sel_layers[i]);
+  else {
+    BMIter iter;
+    int face_i = 0;
+    int loop_i = 0;
+    BMFace *face;
+    BM_ITER_MESH_INDEX (face, &iter, &bm, BM_FACES_OF_MESH, face_i) {
+      BM_elem_index_set(face, face_i); /* set_inline */
+      face_table[face_i] = face;
+      flags.hflag |= face->head.hflag;
+      flags.need_sharp_face |= (face->head.hflag & BM_ELEM_SMOOTH) == 0;
+      flags.need_material_index |= face->mat_nr != 0;
+      BM_CHECK_ELEMENT(face);
+
+      BMLoop *loop = BM_FACE_FIRST_LOOP(face);
+      for ([[maybe_unused]] const int i : IndexRange(face->len)) {
+        BM_elem_index_set(loop, loop_i); /* set_inline */
+        loop_table[loop_i] = loop;
+        flags.bool_layers_used |= loop_bool_layers_used(loop);
+        BM_CHECK_ELEMENT(loop);
+        loop = loop->next;
+        loop_i++;
+      }
     }
   }
-  for (const int i : pin_layers.index_range()) {
-    if (!need_pin[i]) {
-      ldata.layers[pin_layers[i]].flag |= CD_FLAG_NOCOPY;
-      ldata_layers_marked_nocopy.append(pin_layers[i]);
+  need_select_poly = (flags.hflag & BM_ELEM_SELECT) != 0;
+  need_hide_poly = (flags.hflag & BM_ELEM_HIDDEN) != 0;
+  need_sharp_face |= flags.need_sharp_face;
+  need_material_index |= flags.need_material_index;
+
+  for (const int i : bool_layers.index_range()) {
+    if ((flags.bool_layers_used & (1u << i)) == 0) {
+      ldata.layers[bool_layers[i]].flag |= CD_FLAG_NOCOPY;
+      ldata_layers_marked_nocopy.append(bool_layers[i]);
     }
   }
 }
@@ -1741,3 +1818,53 @@ void BM_mesh_bm_to_me_for_eval(BMesh *bm, Mesh *me, const CustomData_MeshMasks *
   sharp_face.finish();
   material_index.finish();
 }
+
+void BM_mesh_bm_to_me_partial(BMesh *bm,
+                              Mesh *me,
+                              const blender::Span<BMVert *> verts,
+                              const blender::Span<BMFace *> faces)
+{
+  using namespace blender;
+  BLI_assert(me->totvert == bm->totvert && me->totedge == bm->totedge &&
+             me->totpoly == bm->totface && me->totloop == bm->totloop);
+
+  /* Indices are the same as when the mesh was converted, as long as the topology didn't change. */
+  BM_mesh_elem_index_ensure(bm, BM_VERT | BM_FACE | BM_LOOP);
+
+  threading::parallel_invoke(
+      verts.size() + faces.size() > 1024,
+      [&]() {
+        const Vector<BMeshToMeshLayerInfo> info = bm_to_mesh_copy_info_calc(bm->vdata,
+                                                                            me->vdata);
+        MutableSpan<float3> dst_vert_positions = me->vert_positions_for_write();
+        threading::parallel_for(verts.index_range(), 1024, [&](const IndexRange range) {
+          for (const BMVert *src_vert : verts.slice(range)) {
+            const int vert_i = BM_elem_index_get(src_vert);
+            copy_v3_v3(dst_vert_positions[vert_i], src_vert->co);
+            bmesh_block_copy_to_mesh_attributes(info, vert_i, src_vert->head.data);
+          }
+        });
+      },
+      [&]() {
+        const Vector<BMeshToMeshLayerInfo> poly_info = bm_to_mesh_copy_info_calc(bm->pdata,
+                                                                                 me->pdata);
+        const Vector<BMeshToMeshLayerInfo> loop_info = bm_to_mesh_copy_info_calc(bm->ldata,
+                                                                                 me->ldata);
+        threading::parallel_for(faces.index_range(), 1024, [&](const IndexRange range) {
+          for (const BMFace *src_face : faces.slice(range)) {
+            bmesh_block_copy_to_mesh_attributes(
+                poly_info, BM_elem_index_get(src_face), src_face->head.data);
+            const BMLoop *src_loop = BM_FACE_FIRST_LOOP(src_face);
+            for ([[maybe_unused]] const int i : IndexRange(src_face->len)) {
+              bmesh_block_copy_to_mesh_attributes(
+                  loop_info, BM_elem_index_get(src_loop), src_loop->head.data);
+              src_loop = src_loop->next;
+            }
+          }
+        });
+      });
+
+  if (!verts.is_empty()) {
+    BKE_mesh_tag_positions_changed(me);
+  }
+}
@@ -10,13 +10,28 @@
 #include "bmesh.h"
 
 #ifdef __cplusplus
+#  include "BLI_span.hh"
 #  include "BLI_string_ref.hh"
 
+struct Mesh;
+
 /**
  * \return Whether attributes with the given name are stored in special flags or fields in BMesh
  * rather than in the regular custom data blocks.
  */
 bool BM_attribute_stored_in_bmesh_builtin(const blender::StringRef name);
+
+/**
+ * Update a mesh that was converted from \a bm with #BM_mesh_bm_to_me_for_eval, when only the
+ * positions and custom data of \a verts and the custom data of \a faces and their corners have
+ * changed (while transforming geometry for example).
+ *
+ * \note The topology must not have changed since the mesh was converted.
+ */
+void BM_mesh_bm_to_me_partial(BMesh *bm,
+                              Mesh *me,
+                              blender::Span<BMVert *> verts,
+                              blender::Span<BMFace *> faces);
 #endif
 
 #ifdef __cplusplus
@@ -290,16 +290,23 @@ void BM_mesh_normals_update_with_partial_ex(BMesh * /*bm*/,
   const int verts_len = bmpinfo->verts_len;
   const int faces_len = bmpinfo->faces_len;
 
+  /* Each element takes very little time, so use large enough ranges that the threading overhead
+   * doesn't dominate (the elements are in mesh order, see #BM_mesh_partial_create_from_verts).
+   * Vertex normals are gathered from the surrounding faces, so no synchronization is needed. */
   TaskParallelSettings settings;
   BLI_parallel_range_settings_defaults(&settings);
 
   /* Faces. */
   if (params->face_normals) {
+    settings.use_threading = faces_len >= BM_OMP_LIMIT;
+    settings.min_iter_per_thread = 1024;
     BLI_task_parallel_range(
         0, faces_len, faces, bm_partial_faces_parallel_range_calc_normals_cb, &settings);
   }
 
   /* Verts. */
+  settings.use_threading = verts_len >= BM_OMP_LIMIT;
+  settings.min_iter_per_thread = 512;
   BLI_task_parallel_range(
       0, verts_len, verts, bm_partial_verts_parallel_range_calc_normal_cb, &settings);
 }
@@ -89,6 +89,41 @@ BLI_INLINE bool partial_elem_face_ensure(BMPartialUpdate *bmpinfo,
   return false;
 }
 
+/**
+ * Elements are added in the order they're found from connectivity,
+ * which jumps around the mesh. Store larger selections in the same order as the mesh
+ * so the updates (which run for every change while transforming) access memory in order.
+ */
+#define PARTIAL_SORT_MIN_LEN 1024
+
+static void partial_elems_sort_by_index(BMesh *bm,
+                                        BMPartialUpdate *bmpinfo,
+                                        const BLI_bitmap *verts_tag,
+                                        const BLI_bitmap *faces_tag)
+{
+  BMIter iter;
+  if (verts_tag && bmpinfo->verts_len >= PARTIAL_SORT_MIN_LEN) {
+    BMVert *v;
+    int verts_len = 0;
+    BM_ITER_MESH (v, &iter, bm, BM_VERTS_OF_MESH) {
+      if (BLI_BITMAP_TEST(verts_tag, BM_elem_index_get(v))) {
+        bmpinfo->verts[verts_len++] = v;
+      }
+    }
+    BLI_assert(verts_len == bmpinfo->verts_len);
+  }
+  if (faces_tag && bmpinfo->faces_len >= PARTIAL_SORT_MIN_LEN) {
+    BMFace *f;
+    int faces_len = 0;
+    BM_ITER_MESH (f, &iter, bm, BM_FACES_OF_MESH) {
+      if (BLI_BITMAP_TEST(faces_tag, BM_elem_index_get(f))) {
+        bmpinfo->faces[faces_len++] = f;
+      }
+    }
+    BLI_assert(faces_len == bmpinfo->faces_len);
+  }
+}
+
 BMPartialUpdate *BM_mesh_partial_create_from_verts(BMesh *bm,
                                                    const BMPartialUpdate_Params *params,
                                                    const BLI_bitmap *verts_mask,
@@ -186,6 +221,8 @@ BMPartialUpdate *BM_mesh_partial_create_from_verts(BMesh *bm,
     }
   }
 
+  partial_elems_sort_by_index(bm, bmpinfo, verts_tag, faces_tag);
+
   if (verts_tag) {
     MEM_freeN(verts_tag);
   }
@@ -279,6 +316,9 @@ BMPartialUpdate *BM_mesh_partial_create_from_verts_group_single(
     }
   }
 
+  /* Faces were already added in order. */
+  partial_elems_sort_by_index(bm, bmpinfo, verts_tag, NULL);
+
   if (verts_tag) {
     MEM_freeN(verts_tag);
   }
@@ -380,6 +420,9 @@ BMPartialUpdate *BM_mesh_partial_create_from_verts_group_multi(
     }
   }
 
+  /* Faces were already added in order. */
+  partial_elems_sort_by_index(bm, bmpinfo, verts_tag, NULL);
+
   if (verts_tag) {
     MEM_freeN(verts_tag);
   }
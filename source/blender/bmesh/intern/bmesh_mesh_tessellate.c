@@ -341,6 +341,8 @@ static void bm_mesh_calc_tessellation_with_partial__multi_threaded(
   TaskParallelSettings settings;
   BLI_parallel_range_settings_defaults(&settings);
   settings.use_threading = true;
+  /* Avoid a task per face, most faces are quads which are very fast to tessellate. */
+  settings.min_iter_per_thread = 256;
   settings.userdata_chunk = &tls_dummy;
   settings.userdata_chunk_size = sizeof(tls_dummy);
   settings.func_free = bmesh_calc_tessellation_for_face_partial_free_fn;
@@ -0,0 +1,146 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "testing/testing.h"
+
+#include "BLI_math.h"
+#include "BLI_utildefines.h"
+
+#include "BKE_customdata.h"
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.hh"
+
+#include "DNA_mesh_types.h"
+
+#include "bmesh.h"
+
+namespace blender::bmesh::tests {
+
+class BMeshConvertTest : public testing::Test {
+ public:
+  static void SetUpTestSuite()
+  {
+    BKE_idtype_init();
+  }
+
+  BMesh *bm = nullptr;
+  Mesh *mesh = nullptr;
+
+  void SetUp() override
+  {
+    BMeshCreateParams create_params{};
+    bm = BM_mesh_create(&bm_mesh_allocsize_default, &create_params);
+    mesh = BKE_mesh_new_nomain(0, 0, 0, 0);
+  }
+
+  void TearDown() override
+  {
+    BKE_id_free(nullptr, mesh);
+    BM_mesh_free(bm);
+  }
+
+  /** Make the element tables and indices valid, as edit-mode operators usually leave them. */
+  void ensure_tables_and_indices()
+  {
+    BM_mesh_elem_table_ensure(bm, BM_VERT | BM_EDGE | BM_FACE);
+    BM_mesh_elem_index_ensure(bm, BM_VERT | BM_EDGE | BM_FACE | BM_LOOP);
+  }
+
+  void convert()
+  {
+    BMeshToMeshParams params{};
+    BM_mesh_bm_to_me(nullptr, bm, mesh, &params);
+  }
+};
+
+TEST_F(BMeshConvertTest, Empty)
+{
+  ensure_tables_and_indices();
+  convert();
+  EXPECT_EQ(mesh->totvert, 0);
+  EXPECT_EQ(mesh->totedge, 0);
+  EXPECT_EQ(mesh->totpoly, 0);
+  EXPECT_EQ(mesh->totloop, 0);
+}
+
+TEST_F(BMeshConvertTest, VertsAndEdgesOnly)
+{
+  const float co1[3] = {1.0f, 2.0f, 3.0f};
+  const float co2[3] = {4.0f, 5.0f, 6.0f};
+  BMVert *v1 = BM_vert_create(bm, co1, nullptr, BM_CREATE_NOP);
+  BMVert *v2 = BM_vert_create(bm, co2, nullptr, BM_CREATE_NOP);
+  BM_edge_create(bm, v1, v2, nullptr, BM_CREATE_NOP);
+  ensure_tables_and_indices();
+  convert();
+  ASSERT_EQ(mesh->totvert, 2);
+  EXPECT_EQ(mesh->totedge, 1);
+  EXPECT_EQ(mesh->totpoly, 0);
+  EXPECT_EQ(mesh->totloop, 0);
+  const Span<float3> positions = mesh->vert_positions();
+  EXPECT_EQ(positions[0], float3(co1));
+  EXPECT_EQ(positions[1], float3(co2));
+}
+
+TEST_F(BMeshConvertTest, DeleteAll)
+{
+  const float co[3] = {0.0f, 0.0f, 0.0f};
+  BMVert *v1 = BM_vert_create(bm, co, nullptr, BM_CREATE_NOP);
+  BMVert *v2 = BM_vert_create(bm, co, nullptr, BM_CREATE_NOP);
+  BMVert *v3 = BM_vert_create(bm, co, nullptr, BM_CREATE_NOP);
+  BMVert *verts[3] = {v1, v2, v3};
+  BM_face_create_verts(bm, verts, 3, nullptr, BM_CREATE_NOP, true);
+  ensure_tables_and_indices();
+  convert();
+  EXPECT_EQ(mesh->totpoly, 1);
+
+  BM_vert_kill(bm, v1);
+  BM_vert_kill(bm, v2);
+  BM_vert_kill(bm, v3);
+  ensure_tables_and_indices();
+  convert();
+  EXPECT_EQ(mesh->totvert, 0);
+  EXPECT_EQ(mesh->totedge, 0);
+  EXPECT_EQ(mesh->totpoly, 0);
+  EXPECT_EQ(mesh->totloop, 0);
+}
+
+TEST_F(BMeshConvertTest, Partial)
+{
+  const float co[3] = {0.0f, 0.0f, 0.0f};
+  BMVert *verts[4];
+  for (const int i : IndexRange(4)) {
+    verts[i] = BM_vert_create(bm, co, nullptr, BM_CREATE_NOP);
+  }
+  BMFace *face_a = BM_face_create_verts(bm, verts, 3, nullptr, BM_CREATE_NOP, true);
+  BMVert *verts_b[3] = {verts[0], verts[2], verts[3]};
+  BMFace *face_b = BM_face_create_verts(bm, verts_b, 3, nullptr, BM_CREATE_NOP, true);
+  BM_data_layer_add_named(bm, &bm->ldata, CD_PROP_FLOAT, "corner_value");
+  const int cd_offset = CustomData_get_offset_named(&bm->ldata, CD_PROP_FLOAT, "corner_value");
+  BM_mesh_bm_to_me_for_eval(bm, mesh, nullptr);
+
+  /* Change one vertex and the corners of the face around it only. */
+  const float co_new[3] = {1.0f, 2.0f, 3.0f};
+  copy_v3_v3(verts[1]->co, co_new);
+  BMIter iter;
+  BMLoop *l;
+  BM_ITER_ELEM (l, &iter, face_a, BM_LOOPS_OF_FACE) {
+    BM_ELEM_CD_SET_FLOAT(l, cd_offset, 1.0f);
+  }
+  BM_mesh_bm_to_me_partial(bm, mesh, {verts[1]}, {face_a});
+
+  Mesh *mesh_full = BKE_mesh_new_nomain(0, 0, 0, 0);
+  BM_mesh_bm_to_me_for_eval(bm, mesh_full, nullptr);
+  EXPECT_EQ(mesh->vert_positions(), mesh_full->vert_positions());
+  const Span<float> values(static_cast<const float *>(CustomData_get_layer_named(
+                               &mesh->ldata, CD_PROP_FLOAT, "corner_value")),
+                           mesh->totloop);
+  const Span<float> values_full(static_cast<const float *>(CustomData_get_layer_named(
+                                    &mesh_full->ldata, CD_PROP_FLOAT, "corner_value")),
+                                mesh_full->totloop);
+  EXPECT_EQ(values, values_full);
+  EXPECT_EQ(values[BM_elem_index_get(BM_FACE_FIRST_LOOP(face_a))], 1.0f);
+  EXPECT_EQ(values[BM_elem_index_get(BM_FACE_FIRST_LOOP(face_b))], 0.0f);
+  BKE_id_free(nullptr, mesh_full);
+}
+
+}  // namespace blender::bmesh::tests
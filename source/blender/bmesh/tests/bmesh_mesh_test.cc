@@ -0,0 +1,199 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "testing/testing.h"
+
+#include "BLI_math_vector_types.hh"
+#include "BLI_vector.hh"
+
+#include "BKE_customdata.h"
+
+#include "bmesh.h"
+
+namespace blender::bmesh::tests {
+
+/** The state of a mesh that compacting must not change, elements are stored by index. */
+struct BMeshCompactState {
+  Vector<float3> vert_positions;
+  Vector<float> vert_values;
+  Vector<int2> edge_verts;
+  Vector<float> edge_values;
+  Vector<int> face_values;
+  Vector<float> loop_values;
+  Vector<int> loop_verts;
+  Vector<std::pair<char, int>> select_history;
+  int act_face;
+};
+
+class BMeshCompactTest : public testing::Test {
+ public:
+  BMesh *bm = nullptr;
+  int cd_vert_offset;
+  int cd_edge_offset;
+  int cd_loop_offset;
+  int cd_face_offset;
+
+  void SetUp() override
+  {
+    BMeshCreateParams create_params{};
+    create_params.use_toolflags = true;
+    bm = BM_mesh_create(&bm_mesh_allocsize_default, &create_params);
+    BM_data_layer_add(bm, &bm->vdata, CD_PROP_FLOAT);
+    BM_data_layer_add(bm, &bm->edata, CD_PROP_FLOAT);
+    BM_data_layer_add(bm, &bm->ldata, CD_PROP_FLOAT);
+    BM_data_layer_add(bm, &bm->pdata, CD_PROP_INT32);
+    cd_vert_offset = CustomData_get_offset(&bm->vdata, CD_PROP_FLOAT);
+    cd_edge_offset = CustomData_get_offset(&bm->edata, CD_PROP_FLOAT);
+    cd_loop_offset = CustomData_get_offset(&bm->ldata, CD_PROP_FLOAT);
+    cd_face_offset = CustomData_get_offset(&bm->pdata, CD_PROP_INT32);
+  }
+
+  void TearDown() override
+  {
+    BM_mesh_free(bm);
+  }
+
+  /** A grid of quads with different custom data values for every element. */
+  void grid_create(const int size)
+  {
+    Vector<BMVert *> verts;
+    for (const int y : IndexRange(size + 1)) {
+      for (const int x : IndexRange(size + 1)) {
+        const float co[3] = {float(x), float(y), 0.0f};
+        BMVert *v = BM_vert_create(bm, co, nullptr, BM_CREATE_NOP);
+        BM_ELEM_CD_SET_FLOAT(v, cd_vert_offset, float(verts.size()));
+        verts.append(v);
+      }
+    }
+    int face_index = 0;
+    for (const int y : IndexRange(size)) {
+      for (const int x : IndexRange(size)) {
+        const int v_index = y * (size + 1) + x;
+        BMVert *quad[4] = {verts[v_index],
+                           verts[v_index + 1],
+                           verts[v_index + size + 2],
+                           verts[v_index + size + 1]};
+        BMFace *f = BM_face_create_verts(bm, quad, 4, nullptr, BM_CREATE_NOP, true);
+        BM_ELEM_CD_SET_INT(f, cd_face_offset, face_index);
+        BMLoop *l_iter, *l_first;
+        l_iter = l_first = BM_FACE_FIRST_LOOP(f);
+        int loop_index = 0;
+        do {
+          BM_ELEM_CD_SET_FLOAT(l_iter, cd_loop_offset, float(face_index * 4 + loop_index++));
+        } while ((l_iter = l_iter->next) != l_first);
+        face_index++;
+      }
+    }
+    BMIter iter;
+    BMEdge *e;
+    int edge_index = 0;
+    BM_ITER_MESH (e, &iter, bm, BM_EDGES_OF_MESH) {
+      BM_ELEM_CD_SET_FLOAT(e, cd_edge_offset, float(edge_index++));
+    }
+  }
+
+  /** Remove elements all over the mesh, leaving gaps in the memory pools. */
+  void fragment()
+  {
+    Vector<BMFace *> faces_kill;
+    Vector<BMVert *> verts_kill;
+    BMIter iter;
+    BMFace *f;
+    BMVert *v;
+    int index = 0;
+    BM_ITER_MESH (f, &iter, bm, BM_FACES_OF_MESH) {
+      if (index++ % 3 == 0) {
+        faces_kill.append(f);
+      }
+    }
+    index = 0;
+    BM_ITER_MESH (v, &iter, bm, BM_VERTS_OF_MESH) {
+      if (index++ % 7 == 0) {
+        verts_kill.append(v);
+      }
+    }
+    for (BMFace *f_kill : faces_kill) {
+      BM_face_kill(bm, f_kill);
+    }
+    for (BMVert *v_kill : verts_kill) {
+      BM_vert_kill(bm, v_kill);
+    }
+  }
+
+  BMeshCompactState state_get()
+  {
+    BM_mesh_elem_index_ensure(bm, BM_VERT | BM_EDGE | BM_FACE);
+
+    BMeshCompactState state;
+    BMIter iter;
+    BMVert *v;
+    BMEdge *e;
+    BMFace *f;
+    BM_ITER_MESH (v, &iter, bm, BM_VERTS_OF_MESH) {
+      state.vert_positions.append(v->co);
+      state.vert_values.append(BM_ELEM_CD_GET_FLOAT(v, cd_vert_offset));
+    }
+    BM_ITER_MESH (e, &iter, bm, BM_EDGES_OF_MESH) {
+      state.edge_verts.append({BM_elem_index_get(e->v1), BM_elem_index_get(e->v2)});
+      state.edge_values.append(BM_ELEM_CD_GET_FLOAT(e, cd_edge_offset));
+    }
+    BM_ITER_MESH (f, &iter, bm, BM_FACES_OF_MESH) {
+      state.face_values.append(BM_ELEM_CD_GET_INT(f, cd_face_offset));
+      BMLoop *l_iter, *l_first;
+      l_iter = l_first = BM_FACE_FIRST_LOOP(f);
+      do {
+        state.loop_values.append(BM_ELEM_CD_GET_FLOAT(l_iter, cd_loop_offset));
+        state.loop_verts.append(BM_elem_index_get(l_iter->v));
+      } while ((l_iter = l_iter->next) != l_first);
+    }
+    LISTBASE_FOREACH (BMEditSelection *, ese, &bm->selected) {
+      state.select_history.append({ese->htype, BM_elem_index_get(ese->ele)});
+    }
+    state.act_face = bm->act_face ? BM_elem_index_get(bm->act_face) : -1;
+    return state;
+  }
+};
+
+TEST_F(BMeshCompactTest, Fragmented)
+{
+  grid_create(100);
+  fragment();
+
+  /* Select history with every element type, pointing at elements after gaps. */
+  BM_mesh_elem_table_ensure(bm, BM_VERT | BM_EDGE | BM_FACE);
+  BM_select_history_store(bm, BM_vert_at_index(bm, bm->totvert - 1));
+  BM_select_history_store(bm, BM_edge_at_index(bm, bm->totedge / 2));
+  BM_select_history_store(bm, BM_face_at_index(bm, bm->totface - 1));
+  bm->act_face = BM_face_at_index(bm, bm->totface / 3);
+
+  ASSERT_TRUE(BM_mesh_is_fragmented(bm));
+  const BMeshCompactState state_before = state_get();
+
+  BM_mesh_compact(bm);
+
+  EXPECT_FALSE(BM_mesh_is_fragmented(bm));
+  EXPECT_TRUE(BM_mesh_validate(bm));
+  /* The indices were ensured by the compaction itself. */
+  EXPECT_EQ(bm->elem_index_dirty & (BM_VERT | BM_EDGE | BM_FACE), 0);
+
+  const BMeshCompactState state_after = state_get();
+  EXPECT_EQ(state_before.vert_positions, state_after.vert_positions);
+  EXPECT_EQ(state_before.vert_values, state_after.vert_values);
+  EXPECT_EQ(state_before.edge_verts, state_after.edge_verts);
+  EXPECT_EQ(state_before.edge_values, state_after.edge_values);
+  EXPECT_EQ(state_before.face_values, state_after.face_values);
+  EXPECT_EQ(state_before.loop_values, state_after.loop_values);
+  EXPECT_EQ(state_before.loop_verts, state_after.loop_verts);
+  ASSERT_EQ(state_after.select_history.size(), 3);
+  EXPECT_EQ(state_before.select_history, state_after.select_history);
+  EXPECT_EQ(state_before.act_face, state_after.act_face);
+}
+
+TEST_F(BMeshCompactTest, Empty)
+{
+  BM_mesh_compact(bm);
+  EXPECT_EQ(bm->totvert, 0);
+  EXPECT_EQ(bm->totface, 0);
+  EXPECT_TRUE(BM_mesh_validate(bm));
+}
+
+}  // namespace blender::bmesh::tests
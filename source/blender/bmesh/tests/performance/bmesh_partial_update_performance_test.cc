@@ -0,0 +1,124 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_bitmap.h"
+#include "BLI_math_geom.h"
+#include "BLI_utildefines.h"
+
+#include "bmesh.h"
+
+#include "PIL_time.h"
+
+#include <vector>
+
+/* Number of updates averaged per test, like moving the selection in as many steps. */
+#define UPDATES_NUM 10
+
+/** A grid of `size * size` quads in the XY plane. */
+static BMesh *grid_bmesh_create(const int size)
+{
+  BMeshCreateParams create_params{};
+  BMesh *bm = BM_mesh_create(&bm_mesh_allocsize_default, &create_params);
+
+  std::vector<BMVert *> verts;
+  verts.reserve(size_t(size + 1) * (size + 1));
+  for (int y = 0; y <= size; y++) {
+    for (int x = 0; x <= size; x++) {
+      const float co[3] = {float(x) / size, float(y) / size, 0.0f};
+      verts.push_back(BM_vert_create(bm, co, nullptr, BM_CREATE_NOP));
+    }
+  }
+  for (int y = 0; y < size; y++) {
+    for (int x = 0; x < size; x++) {
+      const int v_index = y * (size + 1) + x;
+      BMVert *quad[4] = {verts[v_index],
+                         verts[v_index + 1],
+                         verts[v_index + size + 2],
+                         verts[v_index + size + 1]};
+      BM_face_create_verts(bm, quad, 4, nullptr, BM_CREATE_NOP, true);
+    }
+  }
+  BM_mesh_elem_index_ensure(bm, BM_VERT | BM_EDGE | BM_FACE);
+  BM_mesh_elem_table_ensure(bm, BM_VERT);
+  return bm;
+}
+
+/**
+ * Move the vertices in the first `selection` fraction of a grid and update normals and
+ * tessellation, once with the partial update used by transform and once for the whole mesh.
+ * Prints the time to create the partial update data and the average time of both updates.
+ */
+static void partial_update_test(const char *id, const int size, const float selection)
+{
+  printf("\n========== STARTING %s ==========\n", id);
+
+  BMesh *bm = grid_bmesh_create(size);
+  const int looptris_num = poly_to_tri_count(bm->totface, bm->totloop);
+  BMLoop *(*looptris)[3] = static_cast<BMLoop *(*)[3]>(
+      MEM_malloc_arrayN(looptris_num, sizeof(*looptris), __func__));
+  BM_mesh_normals_update(bm);
+  BM_mesh_calc_tessellation(bm, looptris);
+
+  BLI_bitmap *verts_mask = BLI_BITMAP_NEW(bm->totvert, __func__);
+  int verts_mask_count = 0;
+  for (int i = 0; i < bm->totvert; i++) {
+    if (bm->vtable[i]->co[0] < selection) {
+      BLI_BITMAP_ENABLE(verts_mask, i);
+      verts_mask_count++;
+    }
+  }
+
+  const double time_create_start = PIL_check_seconds_timer();
+  BMPartialUpdate_Params params{};
+  params.do_normals = true;
+  params.do_tessellate = true;
+  BMPartialUpdate *bmpinfo = BM_mesh_partial_create_from_verts(
+      bm, &params, verts_mask, verts_mask_count);
+  const double time_create = PIL_check_seconds_timer() - time_create_start;
+
+  double time_partial = 0.0;
+  double time_full = 0.0;
+  for (int i = 0; i < UPDATES_NUM; i++) {
+    for (int j = 0; j < bm->totvert; j++) {
+      if (BLI_BITMAP_TEST(verts_mask, j)) {
+        bm->vtable[j]->co[2] += 0.01f;
+      }
+    }
+
+    const double time_partial_start = PIL_check_seconds_timer();
+    BM_mesh_normals_update_with_partial(bm, bmpinfo);
+    BM_mesh_calc_tessellation_with_partial(bm, looptris, bmpinfo);
+    time_partial += PIL_check_seconds_timer() - time_partial_start;
+
+    const double time_full_start = PIL_check_seconds_timer();
+    BM_mesh_normals_update(bm);
+    BM_mesh_calc_tessellation(bm, looptris);
+    time_full += PIL_check_seconds_timer() - time_full_start;
+  }
+
+  printf("Faces: %d, selected vertices: %d\n", bm->totface, verts_mask_count);
+  printf("Create partial update: %.6fs\n", time_create);
+  printf("Partial update: %.6fs on average\n", time_partial / UPDATES_NUM);
+  printf("Full update: %.6fs on average\n", time_full / UPDATES_NUM);
+
+  BM_mesh_partial_destroy(bmpinfo);
+  MEM_freeN(verts_mask);
+  MEM_freeN(looptris);
+  BM_mesh_free(bm);
+
+  printf("========== ENDED %s ==========\n\n", id);
+}
+
+/* Around 2 million faces. */
+TEST(bmesh_partial_update, Grid2M_Selection10)
+{
+  partial_update_test("Grid - 2M faces - 10% selected", 1415, 0.1f);
+}
+
+TEST(bmesh_partial_update, Grid2M_Selection50)
+{
+  partial_update_test("Grid - 2M faces - 50% selected", 1415, 0.5f);
+}
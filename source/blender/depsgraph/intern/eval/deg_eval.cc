@@ -15,6 +15,7 @@
 #include "BLI_function_ref.hh"
 #include "BLI_gsqueue.h"
 #include "BLI_task.h"
+#include "BLI_task_trace.hh"
 #include "BLI_utildefines.h"
 
 #include "BKE_global.h"
@@ -91,6 +92,8 @@ void evaluate_node(const DepsgraphEvalState *state, OperationNode *operation_nod
 
   /* Sanity checks. */
   BLI_assert_msg(!operation_node->is_noop(), "NOOP nodes should not actually be scheduled");
+  blender::threading::trace::TraceRegion trace_region(
+      operationCodeAsString(operation_node->opcode));
   /* Perform operation. */
   if (state->do_stats) {
     const double start_time = PIL_check_seconds_timer();
@@ -386,6 +389,7 @@ void deg_evaluate_on_refresh(Depsgraph *graph)
   }
 
   graph->debug.begin_graph_evaluation();
+  blender::threading::trace::TraceRegion trace_region("Depsgraph Evaluation");
 
 #ifdef WITH_PYTHON
   /* Release the GIL so that Python drivers can be evaluated. See #91046. */
@@ -51,6 +51,8 @@
 
 #  include "BLI_array_store.h"
 #  include "BLI_array_store_utils.h"
+#  include "BLI_multi_value_map.hh"
+#  include "BLI_vector.hh"
 /* check on best size later... */
 #  define ARRAY_CHUNK_SIZE 256
 
@@ -149,6 +151,43 @@ static struct {
 
 } um_arraystore = {{{nullptr}}};
 
+/** A layer that is added to an array store by #um_arraystore_cd_compact. */
+struct UMArrayStoreLayer {
+  BArrayStore *bs;
+  const void *data;
+  size_t data_size;
+  BArrayState *state_reference;
+  BArrayState **r_state;
+};
+
+/**
+ * Add the layers to their array stores. Layers that use different stores are independent,
+ * so they are de-duplicated in parallel. A store can't be used by multiple threads at once,
+ * so layers sharing a store are added by the same task (in order).
+ */
+static void um_arraystore_cd_compact_layers(const blender::Span<UMArrayStoreLayer> layers)
+{
+  using namespace blender;
+  MultiValueMap<BArrayStore *, int> layers_by_store;
+  for (const int i : layers.index_range()) {
+    layers_by_store.add(layers[i].bs, i);
+  }
+  Vector<Span<int>> layer_groups;
+  for (const Vector<int> &group : layers_by_store.values()) {
+    layer_groups.append(group);
+  }
+
+  threading::parallel_for(layer_groups.index_range(), 1, [&](const IndexRange range) {
+    for (const int group_i : range) {
+      for (const int layer_i : layer_groups[group_i]) {
+        const UMArrayStoreLayer &layer = layers[layer_i];
+        *layer.r_state = BLI_array_store_state_add(
+            layer.bs, layer.data, layer.data_size, layer.state_reference);
+      }
+    }
+  });
+}
+
 static void um_arraystore_cd_compact(CustomData *cdata,
                                      const size_t data_len,
                                      const bool create,
@@ -164,6 +203,7 @@ static void um_arraystore_cd_compact(CustomData *cdata,
 
   const BArrayCustomData *bcd_reference_current = bcd_reference;
   BArrayCustomData *bcd = nullptr, *bcd_first = nullptr, *bcd_prev = nullptr;
+  blender::Vector<UMArrayStoreLayer> layers_to_compact;
   for (int layer_start = 0, layer_end; layer_start < cdata->totlayer; layer_start = layer_end) {
     const eCustomDataType type = eCustomDataType(cdata->layers[layer_start].type);
 
@@ -246,18 +286,13 @@ static void um_arraystore_cd_compact(CustomData *cdata,
             state_reference = nullptr;
           }
 
-          bcd->states[i] = BLI_array_store_state_add(
-              bs, layer->data, size_t(data_len) * stride, state_reference);
+          layers_to_compact.append(
+              {bs, layer->data, size_t(data_len) * stride, state_reference, &bcd->states[i]});
         }
         else {
           bcd->states[i] = nullptr;
         }
       }
-
-      if (layer->data) {
-        MEM_freeN(layer->data);
-        layer->data = nullptr;
-      }
     }
 
     if (create) {
@@ -267,6 +302,16 @@ static void um_arraystore_cd_compact(CustomData *cdata,
     }
   }
 
+  um_arraystore_cd_compact_layers(layers_to_compact);
+
+  for (int i = 0; i < cdata->totlayer; i++) {
+    CustomDataLayer *layer = &cdata->layers[i];
+    if (layer->data) {
+      MEM_freeN(layer->data);
+      layer->data = nullptr;
+    }
+  }
+
   if (create) {
     *r_bcd_first = bcd_first;
   }
@@ -327,11 +372,10 @@ static void um_arraystore_compact_ex(UndoMesh *um, const UndoMesh *um_ref, bool
 
   /* Compacting can be time consuming, run in parallel.
    *
-   * NOTE(@ideasman42): this could be further parallelized with every custom-data layer
-   * running in it's own thread. If this is a bottleneck it's worth considering.
-   * At the moment it seems fast enough to split by element type.
+   * Element types are compacted in parallel, within each type layers that use different
+   * array stores are de-duplicated in parallel too (see #um_arraystore_cd_compact_layers).
    * Since this is it's self a background thread, using too many threads here could
-   * interfere with foreground tasks. */
+   * interfere with foreground tasks, all work goes through the shared task scheduler. */
   blender::threading::parallel_invoke(
       4096 < (me->totvert + me->totedge + me->totloop + me->totpoly),
       [&]() {
@@ -869,6 +913,16 @@ static bool mesh_undosys_step_encode(bContext *C, Main *bmain, UndoStep *us_p)
     elem->obedit_ref.ptr = ob;
     Mesh *me = static_cast<Mesh *>(elem->obedit_ref.ptr->data);
     BMEditMesh *em = me->edit_mesh;
+    /* The operator is done with the mesh, so this is a good time to pack the #BMesh when
+     * topology changes left gaps in its memory. Skip this when Python references elements. */
+    if (em->bm->py_handle == nullptr && BM_mesh_is_fragmented(em->bm)) {
+      BM_mesh_compact(em->bm);
+      BKE_editmesh_looptri_calc(em);
+      /* The topology mirror table stores element pointers, which compacting invalidates
+       * without changing the element counts it checks. */
+      ED_mesh_mirror_topo_table_end(nullptr);
+      DEG_id_tag_update(&me->id, ID_RECALC_GEOMETRY);
+    }
     undomesh_from_editmesh(
         &elem->data, me->edit_mesh, me->key, um_references ? um_references[i] : nullptr);
     em->needs_flush_to_id = 1;
@@ -3557,7 +3557,13 @@ static int surfacedeform_bind_exec(bContext *C, wmOperator *op)
     return OPERATOR_CANCELLED;
   }
 
-  if (smd->flags & MOD_SDEF_BIND) {
+  if (RNA_boolean_get(op->ptr, "rebind")) {
+    if (!(smd->flags & MOD_SDEF_BIND) || !smd->target) {
+      return OPERATOR_CANCELLED;
+    }
+    smd->flags |= MOD_SDEF_REBIND;
+  }
+  else if (smd->flags & MOD_SDEF_BIND) {
     smd->flags &= ~MOD_SDEF_BIND;
   }
   else if (smd->target) {
@@ -3600,6 +3606,13 @@ void OBJECT_OT_surfacedeform_bind(wmOperatorType *ot)
   /* flags */
   ot->flag = OPTYPE_REGISTER | OPTYPE_UNDO | OPTYPE_INTERNAL;
   edit_modifier_properties(ot);
+  PropertyRNA *prop = RNA_def_boolean(
+      ot->srna,
+      "rebind",
+      false,
+      "Rebind",
+      "Bind again, only recalculating vertices whose target polygons changed");
+  RNA_def_property_flag(prop, PROP_SKIP_SAVE);
 }
 
 /** \} */
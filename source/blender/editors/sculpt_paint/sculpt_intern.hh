@@ -28,6 +28,7 @@
 
 struct AutomaskingCache;
 struct AutomaskingNodeData;
+struct BArrayState;
 struct Dial;
 struct DistRayAABB_Precalc;
 struct Image;
@@ -217,6 +218,14 @@ struct SculptUndoNode {
   int faces_num;
 
   size_t undo_size;
+
+  /* Once the undo step is finished its arrays are moved into a de-duplicated array store,
+   * the array pointers above are null until they are expanded again to undo or redo. */
+  struct {
+    BArrayState *co, *orig_co, *col, *loop_col, *mask, *face_sets;
+    BArrayState *index, *loop_index, *grids;
+  } store;
+  bool is_compact;
 };
 
 /* Factor of brush to have rake point following behind
@@ -35,6 +35,7 @@
 
 #include "BLI_ghash.h"
 #include "BLI_listbase.h"
+#include "BLI_map.hh"
 #include "BLI_math.h"
 #include "BLI_string.h"
 #include "BLI_task.h"
@@ -84,6 +85,21 @@
 /* Uncomment to print the undo stack in the console on push/undo/redo. */
 //#define SCULPT_UNDO_DEBUG
 
+/* De-duplicate the arrays of finished undo steps, see #sculpt_arraystore. */
+#define USE_ARRAY_STORE
+
+#ifdef USE_ARRAY_STORE
+#  include "BLI_array_store.h"
+#  include "BLI_array_store_utils.h"
+
+#  include "atomic_ops.h"
+
+/* Number of array elements per chunk, changed elements are stored at this granularity. */
+#  define ARRAY_CHUNK_SIZE 128
+
+#  define USE_ARRAY_STORE_THREAD
+#endif
+
 /* Implementation of undo system for objects in sculpt mode.
  *
  * Each undo step in sculpt mode consists of list of nodes, each node contains:
@@ -275,6 +291,305 @@ void sculpt_undo_print_nodes(Object *ob, void *active)
 #  define sculpt_undo_print_nodes(ob, active) while (0)
 #endif
 
+#ifdef USE_ARRAY_STORE
+
+/* -------------------------------------------------------------------- */
+/** \name Array Store
+ *
+ * Strokes mostly touch the same PBVH nodes as the previous ones and only change some of their
+ * elements. Once a step is finished its arrays are moved into an array store, using the arrays
+ * of the same PBVH node in the previous step as reference, so only chunks that differ from the
+ * previous step take extra memory. This runs in the background, the arrays are expanded again
+ * when the step is undone or redone.
+ * \{ */
+
+static struct {
+  BArrayStore_AtSize bs_stride;
+  /** Number of nodes with arrays in the store. */
+  int users;
+
+#  ifdef USE_ARRAY_STORE_THREAD
+  TaskPool *task_pool;
+#  endif
+} sculpt_arraystore = {{nullptr}};
+
+#  define SCULPT_UNDO_ARRAY_NUM 9
+
+struct SculptUndoArray {
+  void **data;
+  BArrayState **state;
+  int stride;
+};
+
+static void sculpt_undo_node_arrays(SculptUndoNode *unode,
+                                    SculptUndoArray r_arrays[SCULPT_UNDO_ARRAY_NUM])
+{
+  int i = 0;
+  auto add = [&](void **data, BArrayState **state, const int stride) {
+    r_arrays[i++] = {data, state, stride};
+  };
+  add(reinterpret_cast<void **>(&unode->co), &unode->store.co, sizeof(*unode->co));
+  add(reinterpret_cast<void **>(&unode->orig_co), &unode->store.orig_co, sizeof(*unode->orig_co));
+  add(reinterpret_cast<void **>(&unode->col), &unode->store.col, sizeof(*unode->col));
+  add(reinterpret_cast<void **>(&unode->loop_col),
+      &unode->store.loop_col,
+      sizeof(*unode->loop_col));
+  add(reinterpret_cast<void **>(&unode->mask), &unode->store.mask, sizeof(*unode->mask));
+  add(reinterpret_cast<void **>(&unode->face_sets),
+      &unode->store.face_sets,
+      sizeof(*unode->face_sets));
+  add(reinterpret_cast<void **>(&unode->index), &unode->store.index, sizeof(*unode->index));
+  add(reinterpret_cast<void **>(&unode->loop_index),
+      &unode->store.loop_index,
+      sizeof(*unode->loop_index));
+  add(reinterpret_cast<void **>(&unode->grids), &unode->store.grids, sizeof(*unode->grids));
+  BLI_assert(i == SCULPT_UNDO_ARRAY_NUM);
+}
+
+static bool sculpt_undo_node_has_store(SculptUndoNode *unode)
+{
+  SculptUndoArray arrays[SCULPT_UNDO_ARRAY_NUM];
+  sculpt_undo_node_arrays(unode, arrays);
+  for (const SculptUndoArray &array : arrays) {
+    if (*array.state) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static size_t sculpt_undo_arraystore_size_compacted()
+{
+  size_t size_expanded, size_compacted;
+  BLI_array_store_at_size_calc_memory_usage(
+      &sculpt_arraystore.bs_stride, &size_expanded, &size_compacted);
+  return size_compacted;
+}
+
+/**
+ * Move the arrays of all nodes marked compact into the store.
+ * Nodes that were expanded before use their own previous state as reference.
+ *
+ * \param r_data_size: When set, the memory used by the nodes after compacting is stored here.
+ */
+static void sculpt_undo_arraystore_compact_nodes(ListBase *nodes,
+                                                 const ListBase *nodes_ref,
+                                                 size_t *r_data_size,
+                                                 size_t data_size)
+{
+  /* Map: (PBVH node, type) -> node from the previous step. */
+  blender::Map<std::pair<const void *, int>, SculptUndoNode *> ref_map;
+  if (nodes_ref) {
+    LISTBASE_FOREACH (SculptUndoNode *, unode_ref, nodes_ref) {
+      if (unode_ref->node) {
+        ref_map.add({unode_ref->node, int(unode_ref->type)}, unode_ref);
+      }
+    }
+  }
+
+  const size_t size_compacted_prev = r_data_size ? sculpt_undo_arraystore_size_compacted() : 0;
+  size_t size_moved = 0;
+
+  LISTBASE_FOREACH (SculptUndoNode *, unode, nodes) {
+    if (!unode->is_compact) {
+      continue;
+    }
+    SculptUndoNode *unode_ref = ref_map.lookup_default({unode->node, int(unode->type)}, nullptr);
+
+    SculptUndoArray arrays[SCULPT_UNDO_ARRAY_NUM], arrays_ref[SCULPT_UNDO_ARRAY_NUM];
+    sculpt_undo_node_arrays(unode, arrays);
+    if (unode_ref) {
+      sculpt_undo_node_arrays(unode_ref, arrays_ref);
+    }
+
+    for (int i = 0; i < SCULPT_UNDO_ARRAY_NUM; i++) {
+      const SculptUndoArray &array = arrays[i];
+      if (*array.data == nullptr) {
+        continue;
+      }
+      BArrayStore *bs = BLI_array_store_at_size_ensure(
+          &sculpt_arraystore.bs_stride, array.stride, ARRAY_CHUNK_SIZE);
+
+      /* When re-compacting, the expanded data only differs where it was swapped. */
+      BArrayState *state_prev = *array.state;
+      const BArrayState *state_reference = state_prev;
+      if (state_reference == nullptr && unode_ref) {
+        state_reference = *arrays_ref[i].state;
+      }
+
+      const size_t data_len = MEM_allocN_len(*array.data);
+      *array.state = BLI_array_store_state_add(bs, *array.data, data_len, state_reference);
+      if (state_prev) {
+        BLI_array_store_state_remove(bs, state_prev);
+      }
+      MEM_freeN(*array.data);
+      *array.data = nullptr;
+      size_moved += data_len;
+    }
+  }
+
+  if (r_data_size) {
+    const size_t size_compacted = sculpt_undo_arraystore_size_compacted();
+    const size_t size_added = size_compacted > size_compacted_prev ?
+                                  size_compacted - size_compacted_prev :
+                                  0;
+    atomic_store_z(r_data_size, data_size - size_moved + size_added);
+  }
+}
+
+#  ifdef USE_ARRAY_STORE_THREAD
+
+struct SculptArrayStoreData {
+  ListBase *nodes;
+  const ListBase *nodes_ref;
+  size_t *r_data_size;
+  size_t data_size;
+};
+
+static void sculpt_undo_arraystore_compact_cb(TaskPool *__restrict /*pool*/, void *taskdata)
+{
+  SculptArrayStoreData *data = static_cast<SculptArrayStoreData *>(taskdata);
+  sculpt_undo_arraystore_compact_nodes(
+      data->nodes, data->nodes_ref, data->r_data_size, data->data_size);
+}
+
+#  endif /* USE_ARRAY_STORE_THREAD */
+
+static void sculpt_undo_arraystore_wait()
+{
+#  ifdef USE_ARRAY_STORE_THREAD
+  if (sculpt_arraystore.task_pool) {
+    BLI_task_pool_work_and_wait(sculpt_arraystore.task_pool);
+  }
+#  endif
+}
+
+/**
+ * Move the arrays of a finished step into the array store.
+ *
+ * \param us_ref: The previous step, to de-duplicate against, can be null.
+ * \param update_data_size: Update the step size once compacted,
+ * otherwise the previously reported size is kept.
+ */
+static void sculpt_undo_arraystore_compact(SculptUndoStep *us,
+                                           SculptUndoStep *us_ref,
+                                           const bool update_data_size)
+{
+  /* Only one step is compacted at a time, as the reference step might still be in progress. */
+  sculpt_undo_arraystore_wait();
+
+  bool any_compact = false;
+  LISTBASE_FOREACH (SculptUndoNode *, unode, &us->data.nodes) {
+    if (unode->is_compact) {
+      continue;
+    }
+    if (ELEM(unode->type,
+             SCULPT_UNDO_GEOMETRY,
+             SCULPT_UNDO_DYNTOPO_BEGIN,
+             SCULPT_UNDO_DYNTOPO_END,
+             SCULPT_UNDO_DYNTOPO_SYMMETRIZE)) {
+      continue;
+    }
+    if (!sculpt_undo_node_has_store(unode)) {
+      sculpt_arraystore.users += 1;
+    }
+    /* Marked here so #SCULPT_undo_get_node never returns nodes while they are being compacted. */
+    unode->is_compact = true;
+    any_compact = true;
+  }
+
+  if (!any_compact) {
+    return;
+  }
+
+  ListBase *nodes = &us->data.nodes;
+  const ListBase *nodes_ref = us_ref ? &us_ref->data.nodes : nullptr;
+  size_t *r_data_size = update_data_size ? &us->step.data_size : nullptr;
+
+#  ifdef USE_ARRAY_STORE_THREAD
+  if (sculpt_arraystore.task_pool == nullptr) {
+    sculpt_arraystore.task_pool = BLI_task_pool_create_background(nullptr, TASK_PRIORITY_LOW);
+  }
+
+  SculptArrayStoreData *data = static_cast<SculptArrayStoreData *>(
+      MEM_mallocN(sizeof(*data), __func__));
+  data->nodes = nodes;
+  data->nodes_ref = nodes_ref;
+  data->r_data_size = r_data_size;
+  data->data_size = us->data.undo_size;
+
+  BLI_task_pool_push(
+      sculpt_arraystore.task_pool, sculpt_undo_arraystore_compact_cb, data, true, nullptr);
+#  else
+  sculpt_undo_arraystore_compact_nodes(nodes, nodes_ref, r_data_size, us->data.undo_size);
+#  endif
+}
+
+/**
+ * Allocate the arrays of the step again, the states are kept as reference for re-compacting.
+ */
+static void sculpt_undo_arraystore_expand(ListBase *nodes)
+{
+  sculpt_undo_arraystore_wait();
+
+  LISTBASE_FOREACH (SculptUndoNode *, unode, nodes) {
+    if (!unode->is_compact) {
+      continue;
+    }
+    SculptUndoArray arrays[SCULPT_UNDO_ARRAY_NUM];
+    sculpt_undo_node_arrays(unode, arrays);
+    for (const SculptUndoArray &array : arrays) {
+      if (*array.state) {
+        BLI_assert(*array.data == nullptr);
+        size_t data_len;
+        *array.data = BLI_array_store_state_data_get_alloc(*array.state, &data_len);
+      }
+    }
+    unode->is_compact = false;
+  }
+}
+
+/**
+ * Remove the states of the nodes, the expanded arrays are freed by the caller.
+ */
+static void sculpt_undo_arraystore_free(ListBase *nodes)
+{
+  sculpt_undo_arraystore_wait();
+
+  LISTBASE_FOREACH (SculptUndoNode *, unode, nodes) {
+    if (!sculpt_undo_node_has_store(unode)) {
+      continue;
+    }
+    SculptUndoArray arrays[SCULPT_UNDO_ARRAY_NUM];
+    sculpt_undo_node_arrays(unode, arrays);
+    for (const SculptUndoArray &array : arrays) {
+      if (*array.state) {
+        BArrayStore *bs = BLI_array_store_at_size_get(&sculpt_arraystore.bs_stride, array.stride);
+        BLI_array_store_state_remove(bs, *array.state);
+        *array.state = nullptr;
+      }
+    }
+    unode->is_compact = false;
+
+    sculpt_arraystore.users -= 1;
+    BLI_assert(sculpt_arraystore.users >= 0);
+  }
+
+  if (sculpt_arraystore.users == 0) {
+    BLI_array_store_at_size_clear(&sculpt_arraystore.bs_stride);
+#  ifdef USE_ARRAY_STORE_THREAD
+    if (sculpt_arraystore.task_pool) {
+      BLI_task_pool_free(sculpt_arraystore.task_pool);
+      sculpt_arraystore.task_pool = nullptr;
+    }
+#  endif
+  }
+}
+
+/** \} */
+
+#endif /* USE_ARRAY_STORE */
+
 static void update_cb(PBVHNode *node, void *rebuild)
 {
   BKE_pbvh_node_mark_update(node);
@@ -1114,6 +1429,10 @@ static void sculpt_undo_restore_list(bContext *C, Depsgraph *depsgraph, ListBase
 
 static void sculpt_undo_free_list(ListBase *lb)
 {
+#ifdef USE_ARRAY_STORE
+  sculpt_undo_arraystore_free(lb);
+#endif
+
   SculptUndoNode *unode = static_cast<SculptUndoNode *>(lb->first);
   while (unode != nullptr) {
     SculptUndoNode *unode_next = unode->next;
@@ -1209,6 +1528,10 @@ SculptUndoNode *SCULPT_undo_get_node(PBVHNode *node, SculptUndoType type)
   }
 
   LISTBASE_FOREACH (SculptUndoNode *, unode, &usculpt->nodes) {
+    /* Compacted nodes belong to a finished step, their arrays aren't available. */
+    if (unode->is_compact) {
+      continue;
+    }
     if (unode->node == node && unode->type == type) {
       return unode;
     }
@@ -1907,6 +2230,16 @@ static bool sculpt_undosys_step_encode(struct bContext * /*C*/, struct Main *bma
   }
   us->step.is_applied = true;
 
+#ifdef USE_ARRAY_STORE
+  {
+    SculptUndoStep *us_ref = nullptr;
+    if (us->step.prev && us->step.prev->type == BKE_UNDOSYS_TYPE_SCULPT) {
+      us_ref = (SculptUndoStep *)us->step.prev;
+    }
+    sculpt_undo_arraystore_compact(us, us_ref, true);
+  }
+#endif
+
   if (!BLI_listbase_is_empty(&us->data.nodes)) {
     bmain->is_memfile_undo_flush_needed = true;
   }
@@ -1920,9 +2253,17 @@ static void sculpt_undosys_step_decode_undo_impl(struct bContext *C,
 {
   BLI_assert(us->step.is_applied == true);
 
+#ifdef USE_ARRAY_STORE
+  sculpt_undo_arraystore_expand(&us->data.nodes);
+#endif
+
   sculpt_undo_restore_list(C, depsgraph, &us->data.nodes);
   us->step.is_applied = false;
 
+#ifdef USE_ARRAY_STORE
+  sculpt_undo_arraystore_compact(us, nullptr, false);
+#endif
+
   sculpt_undo_print_nodes(CTX_data_active_object(C), NULL);
 }
 
@@ -1932,9 +2273,17 @@ static void sculpt_undosys_step_decode_redo_impl(struct bContext *C,
 {
   BLI_assert(us->step.is_applied == false);
 
+#ifdef USE_ARRAY_STORE
+  sculpt_undo_arraystore_expand(&us->data.nodes);
+#endif
+
   sculpt_undo_restore_list(C, depsgraph, &us->data.nodes);
   us->step.is_applied = true;
 
+#ifdef USE_ARRAY_STORE
+  sculpt_undo_arraystore_compact(us, nullptr, false);
+#endif
+
   sculpt_undo_print_nodes(CTX_data_active_object(C), NULL);
 }
 
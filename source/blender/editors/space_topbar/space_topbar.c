@@ -10,6 +10,8 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "atomic_ops.h"
+
 #include "BLI_blenlib.h"
 #include "BLI_utildefines.h"
 
@@ -262,8 +264,21 @@ static void undo_history_draw_menu(const bContext *C, Menu *menu)
     const bool is_active = (us == wm->undo_stack->step_active);
     uiLayout *row = uiLayoutRow(column, false);
     uiLayoutSetEnabled(row, !is_active);
+
+    /* Show how much memory each step uses, to help tuning the undo memory limit. */
+    char name[UI_MAX_NAME_STR];
+    const size_t data_size = atomic_load_z(&us->data_size);
+    if (data_size) {
+      char size_str[BLI_STR_FORMAT_INT64_BYTE_UNIT_SIZE];
+      BLI_str_format_byte_unit(size_str, (long long int)data_size, false);
+      BLI_snprintf(name, sizeof(name), "%s (%s)", IFACE_(us->name), size_str);
+    }
+    else {
+      STRNCPY(name, IFACE_(us->name));
+    }
+
     uiItemIntO(row,
-               IFACE_(us->name),
+               name,
                is_active ? ICON_LAYER_ACTIVE : ICON_NONE,
                "ED_OT_undo_history",
                "item",
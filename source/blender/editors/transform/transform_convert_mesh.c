@@ -90,6 +90,13 @@ struct TransCustomDataMesh {
   struct TransCustomDataLayer *cd_layer_correct;
   struct TransCustomData_PartialUpdate partial_update[PARTIAL_TYPE_MAX];
   struct PartialTypeState partial_update_state_prev;
+
+  /**
+   * All vertices that can be transformed (including mirrored ones), tagged as changed in the
+   * edit-mesh conversion cache on every update, see #BKE_editmesh_convert_cache_begin.
+   */
+  BMVert **convert_cache_verts;
+  int convert_cache_verts_len;
 };
 
 static struct TransCustomDataMesh *tc_mesh_customdata_ensure(TransDataContainer *tc)
@@ -123,10 +130,14 @@ static void tc_mesh_customdata_free(struct TransCustomDataMesh *tcmd)
 }
 
 static void tc_mesh_customdata_free_fn(struct TransInfo *UNUSED(t),
-                                       struct TransDataContainer *UNUSED(tc),
+                                       struct TransDataContainer *tc,
                                        struct TransCustomData *custom_data)
 {
   struct TransCustomDataMesh *tcmd = custom_data->data;
+  if (tcmd->convert_cache_verts != NULL) {
+    BKE_editmesh_convert_cache_end(BKE_editmesh_from_object(tc->obedit));
+    MEM_freeN(tcmd->convert_cache_verts);
+  }
   tc_mesh_customdata_free(tcmd);
   custom_data->data = NULL;
 }
@@ -1996,6 +2007,37 @@ static void tc_mesh_partial_update(TransInfo *t,
   tcmd->partial_update_state_prev = *partial_state;
 }
 
+/**
+ * Only the transformed vertices and the custom data around them change while transforming, so
+ * converting the edit-mesh for evaluation only needs to update those.
+ */
+static void tc_mesh_convert_cache_update(TransDataContainer *tc)
+{
+  BMEditMesh *em = BKE_editmesh_from_object(tc->obedit);
+
+  struct TransCustomDataMesh *tcmd = tc_mesh_customdata_ensure(tc);
+
+  if (tcmd->convert_cache_verts == NULL) {
+    tcmd->convert_cache_verts_len = tc->data_len + tc->data_mirror_len;
+    tcmd->convert_cache_verts = MEM_mallocN(
+        sizeof(*tcmd->convert_cache_verts) * max_ii(tcmd->convert_cache_verts_len, 1), __func__);
+    int i;
+    TransData *td;
+    for (i = 0, td = tc->data; i < tc->data_len; i++, td++) {
+      tcmd->convert_cache_verts[i] = (BMVert *)td->extra;
+    }
+    TransDataMirror *td_mirror;
+    for (i = 0, td_mirror = tc->data_mirror; i < tc->data_mirror_len; i++, td_mirror++) {
+      tcmd->convert_cache_verts[tc->data_len + i] = (BMVert *)td_mirror->extra;
+    }
+
+    BKE_editmesh_convert_cache_begin(em);
+  }
+
+  BKE_editmesh_convert_cache_tag_verts(
+      em, tcmd->convert_cache_verts, tcmd->convert_cache_verts_len);
+}
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -2067,6 +2109,8 @@ static void recalcData_mesh(TransInfo *t)
     DEG_id_tag_update(tc->obedit->data, ID_RECALC_GEOMETRY);
 
     tc_mesh_partial_update(t, tc, &partial_state);
+
+    tc_mesh_convert_cache_update(tc);
   }
 }
 
@@ -2081,6 +2125,11 @@ static void special_aftertrans_update__mesh(bContext *UNUSED(C), TransInfo *t)
   const bool is_canceling = (t->state == TRANS_CANCEL);
   const bool use_automerge = !is_canceling && (t->flag & (T_AUTOMERGE | T_AUTOSPLIT)) != 0;
 
+  /* Merging changes the topology, the cached conversion can't be updated anymore. */
+  FOREACH_TRANS_DATA_CONTAINER (t, tc) {
+    BKE_editmesh_convert_cache_end(BKE_editmesh_from_object(tc->obedit));
+  }
+
   if (!is_canceling && ELEM(t->mode, TFM_EDGE_SLIDE, TFM_VERT_SLIDE)) {
     /* NOTE(joeedh): Handle multi-res re-projection,
      * done on transform completion since it's really slow. */
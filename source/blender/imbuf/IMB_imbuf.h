@@ -442,6 +442,13 @@ void IMB_mask_clear(struct ImBuf *ibuf, const char *mask, int val);
  * will be used for the average. The mask will be set to one for the pixels which were written.
  */
 void IMB_filter_extend(struct ImBuf *ibuf, char *mask, int filter);
+/**
+ * Like #IMB_filter_extend, but fills unassigned pixels within a euclidean distance of `filter`
+ * pixels from an assigned pixel. Pixels are filled in order of their distance, each with the
+ * weighted average of its neighbors that are closer, so colors are blended the same way.
+ * Uses a distance transform and runs multi-threaded.
+ */
+void IMB_filter_extend_nearest(struct ImBuf *ibuf, char *mask, int filter);
 /**
  * Frees too (if there) and recreates new data.
  */
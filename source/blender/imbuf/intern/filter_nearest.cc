@@ -0,0 +1,158 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup imbuf
+ */
+
+#include "BLI_array.hh"
+#include "BLI_distance_transform.hh"
+#include "BLI_math_base.h"
+#include "BLI_math_vector.h"
+#include "BLI_sort.hh"
+#include "BLI_task.hh"
+#include "BLI_vector.hh"
+
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+
+namespace blender::imbuf {
+
+static bool pixel_is_assigned(const ImBuf *ibuf, const char *mask, const int64_t index)
+{
+  if (mask != nullptr) {
+    return mask[index] != FILTER_MASK_NULL;
+  }
+  if (ibuf->rect_float) {
+    return ibuf->rect_float[index * 4 + 3] != 0.0f;
+  }
+  return reinterpret_cast<const uchar *>(ibuf->rect)[index * 4 + 3] != 0;
+}
+
+/** Weights of the 8 neighbors, like #IMB_filter_extend. */
+static const struct {
+  int x, y;
+  float weight;
+} neighbor_weights[8] = {
+    {-1, -1, 1.0f},
+    {0, -1, 2.0f},
+    {1, -1, 1.0f},
+    {-1, 0, 2.0f},
+    {1, 0, 2.0f},
+    {-1, 1, 1.0f},
+    {0, 1, 2.0f},
+    {1, 1, 1.0f},
+};
+
+static void filter_extend_nearest(ImBuf *ibuf, char *mask, const int filter)
+{
+  const int2 size(ibuf->x, ibuf->y);
+  const int64_t pixels_num = int64_t(size.x) * size.y;
+  /* No pixel is further from an assigned pixel than the diagonal of the image. */
+  const int64_t filter_clamped = std::min<int64_t>(filter, int64_t(size.x) + size.y);
+  const int64_t filter_sq = filter_clamped * filter_clamped;
+
+  /* Squared distance to the closest assigned pixel, -1 for pixels outside of the margin. */
+  Array<int> dist_sq(pixels_num);
+  distance_transform::nearest_pixels(
+      size, [&](const int64_t index) { return pixel_is_assigned(ibuf, mask, index); }, dist_sq);
+  threading::parallel_for(IndexRange(size.y), 16, [&](const IndexRange rows) {
+    for (const int y : rows) {
+      for (const int x : IndexRange(size.x)) {
+        const int64_t index = int64_t(y) * size.x + x;
+        const int source = dist_sq[index];
+        if (source == -1) {
+          continue;
+        }
+        const int64_t dx = source % size.x - x;
+        const int64_t dy = source / size.x - y;
+        const int64_t d_sq = dx * dx + dy * dy;
+        dist_sq[index] = d_sq <= filter_sq ? int(d_sq) : -1;
+      }
+    }
+  });
+
+  /* Sort the margin pixels by distance. Only the pixels in the margin are stored, so memory
+   * doesn't depend on the size of the margin. */
+  Vector<int64_t> sorted_pixels;
+  for (const int64_t index : IndexRange(pixels_num)) {
+    if (dist_sq[index] > 0) {
+      sorted_pixels.append(index);
+    }
+  }
+  parallel_sort(sorted_pixels.begin(), sorted_pixels.end(), [&](const int64_t a, const int64_t b) {
+    return dist_sq[a] < dist_sq[b] || (dist_sq[a] == dist_sq[b] && a < b);
+  });
+
+  /* Like #IMB_filter_extend, every pixel gets the weighted average of the neighbors that were
+   * filled before it, but pixels are filled in the order of their euclidean distance instead of
+   * one ring of neighbors per pass. Pixels at the same distance only read pixels that are closer,
+   * so they are filled in parallel. */
+  for (int64_t start = 0; start < sorted_pixels.size();) {
+    const int d_sq = dist_sq[sorted_pixels[start]];
+    int64_t end = start + 1;
+    while (end < sorted_pixels.size() && dist_sq[sorted_pixels[end]] == d_sq) {
+      end++;
+    }
+    const Span<int64_t> pixels = sorted_pixels.as_span().slice(start, end - start);
+    start = end;
+
+    threading::parallel_for(pixels.index_range(), 1024, [&](const IndexRange range) {
+      for (const int64_t index : pixels.slice(range)) {
+        const int x = int(index % size.x);
+        const int y = int(index / size.x);
+        float acc[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        float weight_sum = 0.0f;
+        for (const auto &neighbor : neighbor_weights) {
+          const int nx = x + neighbor.x;
+          const int ny = y + neighbor.y;
+          if (nx < 0 || nx >= size.x || ny < 0 || ny >= size.y) {
+            continue;
+          }
+          const int64_t neighbor_index = int64_t(ny) * size.x + nx;
+          const int neighbor_dist_sq = dist_sq[neighbor_index];
+          if (neighbor_dist_sq == -1 || neighbor_dist_sq >= d_sq) {
+            continue;
+          }
+          float color[4];
+          if (ibuf->rect_float) {
+            copy_v4_v4(color, &ibuf->rect_float[neighbor_index * 4]);
+          }
+          else {
+            const uchar *color_byte = reinterpret_cast<const uchar *>(&ibuf->rect[neighbor_index]);
+            for (const int c : IndexRange(4)) {
+              color[c] = float(color_byte[c]);
+            }
+          }
+          madd_v4_v4fl(acc, color, neighbor.weight);
+          weight_sum += neighbor.weight;
+        }
+
+        /* The neighbor towards the closest assigned pixel is always closer. */
+        BLI_assert(weight_sum > 0.0f);
+        mul_v4_fl(acc, 1.0f / weight_sum);
+        if (ibuf->rect_float) {
+          copy_v4_v4(&ibuf->rect_float[index * 4], acc);
+        }
+        else {
+          uchar *color_byte = reinterpret_cast<uchar *>(&ibuf->rect[index]);
+          for (const int c : IndexRange(4)) {
+            color_byte[c] = uchar(clamp_f(roundf(acc[c]), 0.0f, 255.0f));
+          }
+        }
+        if (mask != nullptr) {
+          mask[index] = FILTER_MASK_MARGIN;
+        }
+      }
+    });
+  }
+}
+
+}  // namespace blender::imbuf
+
+void IMB_filter_extend_nearest(ImBuf *ibuf, char *mask, int filter)
+{
+  if (filter <= 0) {
+    return;
+  }
+  blender::imbuf::filter_extend_nearest(ibuf, mask, filter);
+}
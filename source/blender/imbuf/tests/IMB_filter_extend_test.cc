@@ -0,0 +1,117 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include "BLI_array.hh"
+#include "BLI_index_range.hh"
+
+#include "MEM_guardedalloc.h"
+
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+
+#include <cmath>
+
+namespace blender::imbuf::tests {
+
+static constexpr int size = 32;
+
+/** A disk with smoothly changing colors, the rest is unassigned in the returned mask. */
+static ImBuf *disk_image_create(Array<char> &r_mask)
+{
+  ImBuf *ibuf = MEM_cnew<ImBuf>(__func__);
+  ibuf->x = size;
+  ibuf->y = size;
+  ibuf->rect_float = MEM_cnew_array<float>(size * size * 4, __func__);
+  r_mask.reinitialize(size * size);
+  r_mask.fill(FILTER_MASK_NULL);
+  for (const int y : IndexRange(size)) {
+    for (const int x : IndexRange(size)) {
+      if ((x - 16) * (x - 16) + (y - 14) * (y - 14) > 7 * 7) {
+        continue;
+      }
+      const int index = y * size + x;
+      float *color = &ibuf->rect_float[index * 4];
+      color[0] = float(x) / size;
+      color[1] = float(y) / size;
+      color[2] = 0.5f + 0.5f * std::sin(x * 0.3f);
+      color[3] = 1.0f;
+      r_mask[index] = FILTER_MASK_USED;
+    }
+  }
+  return ibuf;
+}
+
+static void image_free(ImBuf *ibuf)
+{
+  MEM_freeN(ibuf->rect_float);
+  MEM_freeN(ibuf);
+}
+
+TEST(imbuf_filter, ExtendNearestMatchesExtend)
+{
+  /* The nearest filter blends in distance order instead of in rings of neighbors, colors of the
+   * same pixel differ slightly further away from the island. */
+  const int margin = 4;
+  const float tolerance = 0.05f;
+
+  Array<char> mask_extend;
+  ImBuf *ibuf_extend = disk_image_create(mask_extend);
+  IMB_filter_extend(ibuf_extend, mask_extend.data(), margin);
+
+  Array<char> mask_nearest;
+  ImBuf *ibuf_nearest = disk_image_create(mask_nearest);
+  IMB_filter_extend_nearest(ibuf_nearest, mask_nearest.data(), margin);
+
+  int margin_pixels_num = 0;
+  for (const int index : IndexRange(size * size)) {
+    if (mask_extend[index] == FILTER_MASK_USED) {
+      EXPECT_EQ(mask_nearest[index], FILTER_MASK_USED);
+      continue;
+    }
+    if (mask_extend[index] == FILTER_MASK_NULL) {
+      continue;
+    }
+    /* Pixels in the margin of the 4-connected rings are within the euclidean distance. */
+    ASSERT_EQ(mask_nearest[index], FILTER_MASK_MARGIN);
+    margin_pixels_num++;
+    for (const int c : IndexRange(4)) {
+      EXPECT_NEAR(ibuf_extend->rect_float[index * 4 + c],
+                  ibuf_nearest->rect_float[index * 4 + c],
+                  tolerance);
+    }
+  }
+  EXPECT_GT(margin_pixels_num, 0);
+
+  image_free(ibuf_extend);
+  image_free(ibuf_nearest);
+}
+
+TEST(imbuf_filter, ExtendNearestMargin)
+{
+  const int margin = 3;
+
+  Array<char> mask;
+  ImBuf *ibuf = disk_image_create(mask);
+  IMB_filter_extend_nearest(ibuf, mask.data(), margin);
+
+  for (const int y : IndexRange(size)) {
+    for (const int x : IndexRange(size)) {
+      const float dist = std::sqrt(float((x - 16) * (x - 16) + (y - 14) * (y - 14)));
+      const char value = mask[y * size + x];
+      if (dist <= 7.0f) {
+        EXPECT_EQ(value, FILTER_MASK_USED);
+      }
+      else if (dist > 7.0f + margin + 1.0f) {
+        EXPECT_EQ(value, FILTER_MASK_NULL);
+      }
+      else if (dist <= 7.0f + margin - 1.0f) {
+        EXPECT_EQ(value, FILTER_MASK_MARGIN);
+      }
+    }
+  }
+
+  image_free(ibuf);
+}
+
+}  // namespace blender::imbuf::tests
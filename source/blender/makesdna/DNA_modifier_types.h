@@ -2230,6 +2230,10 @@ typedef struct SDefVert {
   SDefBind *binds;
   unsigned int binds_num;
   unsigned int vertex_idx;
+  /** Target polygon nearest to the vertex upon bind. */
+  unsigned int target_poly;
+  /** Hash of everything the binds of this vertex depend on, zero when unknown. */
+  unsigned int bind_hash;
 } SDefVert;
 
 typedef struct SurfaceDeformModifierData {
@@ -2252,7 +2256,8 @@ typedef struct SurfaceDeformModifierData {
   float mat[4][4];
   float strength;
   char defgrp_name[64];
-  int _pad2;
+  /* Hash of the target mesh topology upon bind, zero when unknown. */
+  unsigned int target_topology_hash;
 } SurfaceDeformModifierData;
 
 /** Surface Deform modifier flags. */
@@ -2262,6 +2267,9 @@ enum {
   MOD_SDEF_INVERT_VGROUP = (1 << 1),
   /* Only store bind data for nonzero vgroup weights at the time of bind. */
   MOD_SDEF_SPARSE_BIND = (1 << 2),
+  /* Bind again on next modifier evaluation, keeping the binds of vertices whose target
+   * polygons didn't change. */
+  MOD_SDEF_REBIND = (1 << 3),
 };
 
 /** Surface Deform vertex bind modes. */
@@ -18,6 +18,7 @@
 #ifdef RNA_RUNTIME
 
 #  include "BKE_global.h"
+#  include "BKE_lib_id.h"
 #  include "BKE_main.h"
 #  include "BKE_mesh.h"
 
@@ -80,11 +81,36 @@ static void rna_Main_filepath_set(PointerRNA *ptr, const char *value)
 }
 #  endif
 
+/* Name lookup using the Main name maps when possible, much faster than the default lookup
+ * function with many IDs. */
+static int rna_Main_id_lookup_string(PointerRNA *ptr,
+                                     ListBase *lb,
+                                     const char *key,
+                                     PointerRNA *r_ptr)
+{
+  const ID *id_first = lb->first;
+  if (id_first == NULL) {
+    return false;
+  }
+  ID *id = BKE_libblock_find_name((Main *)ptr->data, GS(id_first->name), key);
+  if (id == NULL) {
+    return false;
+  }
+  RNA_id_pointer_create(id, r_ptr);
+  return true;
+}
+
 #  define RNA_MAIN_LISTBASE_FUNCS_DEF(_listbase_name) \
     static void rna_Main_##_listbase_name##_begin(CollectionPropertyIterator *iter, \
                                                   PointerRNA *ptr) \
     { \
       rna_iterator_listbase_begin(iter, &((Main *)ptr->data)->_listbase_name, NULL); \
+    } \
+    static int rna_Main_##_listbase_name##_lookup_string( \
+        PointerRNA *ptr, const char *key, PointerRNA *r_ptr) \
+    { \
+      return rna_Main_id_lookup_string( \
+          ptr, &((Main *)ptr->data)->_listbase_name, key, r_ptr); \
     }
 
 RNA_MAIN_LISTBASE_FUNCS_DEF(actions)
@@ -160,6 +186,7 @@ typedef struct MainCollectionDef {
   const char *identifier;
   const char *type;
   const char *iter_begin;
+  const char *iter_lookup_string;
   const char *name;
   const char *description;
   CollectionDefFunc *func;
@@ -175,200 +202,245 @@ void RNA_def_main(BlenderRNA *brna)
       {"cameras",
        "Camera",
        "rna_Main_cameras_begin",
+       "rna_Main_cameras_lookup_string",
        "Cameras",
        "Camera data-blocks",
        RNA_def_main_cameras},
       {"scenes",
        "Scene",
        "rna_Main_scenes_begin",
+       "rna_Main_scenes_lookup_string",
        "Scenes",
        "Scene data-blocks",
        RNA_def_main_scenes},
       {"objects",
        "Object",
        "rna_Main_objects_begin",
+       "rna_Main_objects_lookup_string",
        "Objects",
        "Object data-blocks",
        RNA_def_main_objects},
       {"materials",
        "Material",
        "rna_Main_materials_begin",
+       "rna_Main_materials_lookup_string",
        "Materials",
        "Material data-blocks",
        RNA_def_main_materials},
       {"node_groups",
        "NodeTree",
        "rna_Main_nodetrees_begin",
+       "rna_Main_nodetrees_lookup_string",
        "Node Groups",
        "Node group data-blocks",
        RNA_def_main_node_groups},
       {"meshes",
        "Mesh",
        "rna_Main_meshes_begin",
+       "rna_Main_meshes_lookup_string",
        "Meshes",
        "Mesh data-blocks",
        RNA_def_main_meshes},
       {"lights",
        "Light",
        "rna_Main_lights_begin",
+       "rna_Main_lights_lookup_string",
        "Lights",
        "Light data-blocks",
        RNA_def_main_lights},
       {"libraries",
        "Library",
        "rna_Main_libraries_begin",
+       "rna_Main_libraries_lookup_string",
        "Libraries",
        "Library data-blocks",
        RNA_def_main_libraries},
       {"screens",
        "Screen",
        "rna_Main_screens_begin",
+       "rna_Main_screens_lookup_string",
        "Screens",
        "Screen data-blocks",
        RNA_def_main_screens},
       {"window_managers",
        "WindowManager",
        "rna_Main_wm_begin",
+       "rna_Main_wm_lookup_string",
        "Window Managers",
        "Window manager data-blocks",
        RNA_def_main_window_managers},
       {"images",
        "Image",
        "rna_Main_images_begin",
+       "rna_Main_images_lookup_string",
        "Images",
        "Image data-blocks",
        RNA_def_main_images},
       {"lattices",
        "Lattice",
        "rna_Main_lattices_begin",
+       "rna_Main_lattices_lookup_string",
        "Lattices",
        "Lattice data-blocks",
        RNA_def_main_lattices},
       {"curves",
        "Curve",
        "rna_Main_curves_begin",
+       "rna_Main_curves_lookup_string",
        "Curves",
        "Curve data-blocks",
        RNA_def_main_curves},
       {"metaballs",
        "MetaBall",
        "rna_Main_metaballs_begin",
+       "rna_Main_metaballs_lookup_string",
        "Metaballs",
        "Metaball data-blocks",
        RNA_def_main_metaballs},
       {"fonts",
        "VectorFont",
        "rna_Main_fonts_begin",
+       "rna_Main_fonts_lookup_string",
        "Vector Fonts",
        "Vector font data-blocks",
        RNA_def_main_fonts},
       {"textures",
        "Texture",
        "rna_Main_textures_begin",
+       "rna_Main_textures_lookup_string",
        "Textures",
        "Texture data-blocks",
        RNA_def_main_textures},
       {"brushes",
        "Brush",
        "rna_Main_brushes_begin",
+       "rna_Main_brushes_lookup_string",
        "Brushes",
        "Brush data-blocks",
        RNA_def_main_brushes},
       {"worlds",
        "World",
        "rna_Main_worlds_begin",
+       "rna_Main_worlds_lookup_string",
        "Worlds",
        "World data-blocks",
        RNA_def_main_worlds},
       {"collections",
        "Collection",
        "rna_Main_collections_begin",
+       "rna_Main_collections_lookup_string",
        "Collections",
        "Collection data-blocks",
        RNA_def_main_collections},
       {"shape_keys",
        "Key",
        "rna_Main_shapekeys_begin",
+       "rna_Main_shapekeys_lookup_string",
        "Shape Keys",
        "Shape Key data-blocks",
        NULL},
-      {"texts", "Text", "rna_Main_texts_begin", "Texts", "Text data-blocks", RNA_def_main_texts},
+      {"texts",
+       "Text",
+       "rna_Main_texts_begin",
+       "rna_Main_texts_lookup_string",
+       "Texts",
+       "Text data-blocks",
+       RNA_def_main_texts},
       {"speakers",
        "Speaker",
        "rna_Main_speakers_begin",
+       "rna_Main_speakers_lookup_string",
        "Speakers",
        "Speaker data-blocks",
        RNA_def_main_speakers},
       {"sounds",
        "Sound",
        "rna_Main_sounds_begin",
+       "rna_Main_sounds_lookup_string",
        "Sounds",
        "Sound data-blocks",
        RNA_def_main_sounds},
       {"armatures",
        "Armature",
        "rna_Main_armatures_begin",
+       "rna_Main_armatures_lookup_string",
        "Armatures",
        "Armature data-blocks",
        RNA_def_main_armatures},
       {"actions",
        "Action",
        "rna_Main_actions_begin",
+       "rna_Main_actions_lookup_string",
        "Actions",
        "Action data-blocks",
        RNA_def_main_actions},
       {"particles",
        "ParticleSettings",
        "rna_Main_particles_begin",
+       "rna_Main_particles_lookup_string",
        "Particles",
        "Particle data-blocks",
        RNA_def_main_particles},
       {"palettes",
        "Palette",
        "rna_Main_palettes_begin",
+       "rna_Main_palettes_lookup_string",
        "Palettes",
        "Palette data-blocks",
        RNA_def_main_palettes},
       {"grease_pencils",
        "GreasePencil",
        "rna_Main_gpencils_begin",
+       "rna_Main_gpencils_lookup_string",
        "Grease Pencil",
        "Grease Pencil data-blocks",
        RNA_def_main_gpencil},
       {"movieclips",
        "MovieClip",
        "rna_Main_movieclips_begin",
+       "rna_Main_movieclips_lookup_string",
        "Movie Clips",
        "Movie Clip data-blocks",
        RNA_def_main_movieclips},
-      {"masks", "Mask", "rna_Main_masks_begin", "Masks", "Masks data-blocks", RNA_def_main_masks},
+      {"masks",
+       "Mask",
+       "rna_Main_masks_begin",
+       "rna_Main_masks_lookup_string",
+       "Masks",
+       "Masks data-blocks",
+       RNA_def_main_masks},
       {"linestyles",
        "FreestyleLineStyle",
        "rna_Main_linestyles_begin",
+       "rna_Main_linestyles_lookup_string",
        "Line Styles",
        "Line Style data-blocks",
        RNA_def_main_linestyles},
       {"cache_files",
        "CacheFile",
        "rna_Main_cachefiles_begin",
+       "rna_Main_cachefiles_lookup_string",
        "Cache Files",
        "Cache Files data-blocks",
        RNA_def_main_cachefiles},
       {"paint_curves",
        "PaintCurve",
        "rna_Main_paintcurves_begin",
+       "rna_Main_paintcurves_lookup_string",
        "Paint Curves",
        "Paint Curves data-blocks",
        RNA_def_main_paintcurves},
       {"workspaces",
        "WorkSpace",
        "rna_Main_workspaces_begin",
+       "rna_Main_workspaces_lookup_string",
        "Workspaces",
        "Workspace data-blocks",
        RNA_def_main_workspaces},
       {"lightprobes",
        "LightProbe",
        "rna_Main_lightprobes_begin",
+       "rna_Main_lightprobes_lookup_string",
        "Light Probes",
        "Light Probe data-blocks",
        RNA_def_main_lightprobes},
@@ -379,18 +451,21 @@ void RNA_def_main(BlenderRNA *brna)
       {"hair_curves",
        "Curves",
        "rna_Main_hair_curves_begin",
+       "rna_Main_hair_curves_lookup_string",
        "Hair Curves",
        "Hair curve data-blocks",
        RNA_def_main_hair_curves},
       {"pointclouds",
        "PointCloud",
        "rna_Main_pointclouds_begin",
+       "rna_Main_pointclouds_lookup_string",
        "Point Clouds",
        "Point cloud data-blocks",
        RNA_def_main_pointclouds},
       {"volumes",
        "Volume",
        "rna_Main_volumes_begin",
+       "rna_Main_volumes_lookup_string",
        "Volumes",
        "Volume data-blocks",
        RNA_def_main_volumes},
@@ -398,11 +473,12 @@ void RNA_def_main(BlenderRNA *brna)
       {"simulations",
        "Simulation",
        "rna_Main_simulations_begin",
+       "rna_Main_simulations_lookup_string",
        "Simulations",
        "Simulation data-blocks",
        RNA_def_main_simulations},
 #  endif
-      {NULL, NULL, NULL, NULL, NULL, NULL},
+      {NULL, NULL, NULL, NULL, NULL, NULL, NULL},
   };
 
   int i;
@@ -461,7 +537,7 @@ void RNA_def_main(BlenderRNA *brna)
                                       "rna_iterator_listbase_get",
                                       NULL,
                                       NULL,
-                                      NULL,
+                                      lists[i].iter_lookup_string,
                                       NULL);
     RNA_def_property_ui_text(prop, lists[i].name, lists[i].description);
 
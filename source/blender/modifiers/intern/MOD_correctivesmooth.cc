@@ -9,7 +9,10 @@
 
 #include "BLI_utildefines.h"
 
+#include "BLI_array.hh"
 #include "BLI_math.h"
+#include "BLI_math_vector.hh"
+#include "BLI_task.hh"
 
 #include "BLT_translation.h"
 
@@ -154,182 +157,151 @@ static void mesh_get_boundaries(Mesh *mesh, float *smooth_weights)
   MEM_freeN(boundaries);
 }
 
+/* -------------------------------------------------------------------- */
+/* Vertex Adjacency
+ *
+ * Compressed sparse rows of the vertices connected to every vertex by an edge,
+ * so each smoothing iteration can gather from neighbors in parallel
+ * instead of scattering edge contributions serially.
+ */
+struct SmoothAdjacency {
+  /** `neighbors` of vertex `i` are in the range `offsets[i]` to `offsets[i + 1]`. */
+  blender::Array<int> offsets;
+  blender::Array<int> neighbors;
+};
+
+static void smooth_adjacency_build(const blender::Span<MEdge> edges,
+                                   const uint verts_num,
+                                   SmoothAdjacency &adjacency)
+{
+  adjacency.offsets.reinitialize(int64_t(verts_num) + 1);
+  adjacency.offsets.fill(0);
+  for (const MEdge &edge : edges) {
+    adjacency.offsets[int64_t(edge.v1)]++;
+    adjacency.offsets[int64_t(edge.v2)]++;
+  }
+  int offset = 0;
+  for (const int64_t i : blender::IndexRange(verts_num)) {
+    const int count = adjacency.offsets[i];
+    adjacency.offsets[i] = offset;
+    offset += count;
+  }
+  adjacency.offsets.last() = offset;
+
+  /* Keep the edge order for each vertex, so results don't depend on threading. */
+  blender::Array<int> fill_offsets(adjacency.offsets.as_span().drop_back(1));
+  adjacency.neighbors.reinitialize(offset);
+  for (const MEdge &edge : edges) {
+    adjacency.neighbors[fill_offsets[int64_t(edge.v1)]++] = int(edge.v2);
+    adjacency.neighbors[fill_offsets[int64_t(edge.v2)]++] = int(edge.v1);
+  }
+}
+
 /* -------------------------------------------------------------------- */
 /* Simple Weighted Smoothing
  *
  * (average of surrounding verts)
  */
 static void smooth_iter__simple(CorrectiveSmoothModifierData *csmd,
-                                Mesh *mesh,
+                                const SmoothAdjacency &adjacency,
                                 float (*vertexCos)[3],
                                 uint verts_num,
                                 const float *smooth_weights,
                                 uint iterations)
 {
+  using namespace blender;
   const float lambda = csmd->lambda;
-  uint i;
-
-  const uint edges_num = uint(mesh->totedge);
-  const blender::Span<MEdge> edges = mesh->edges();
-
-  struct SmoothingData_Simple {
-    float delta[3];
-  };
-  SmoothingData_Simple *smooth_data = MEM_cnew_array<SmoothingData_Simple>(verts_num, __func__);
 
-  float *vertex_edge_count_div = static_cast<float *>(
-      MEM_calloc_arrayN(verts_num, sizeof(float), __func__));
-
-  /* calculate as floats to avoid int->float conversion in #smooth_iter */
-  for (i = 0; i < edges_num; i++) {
-    vertex_edge_count_div[edges[i].v1] += 1.0f;
-    vertex_edge_count_div[edges[i].v2] += 1.0f;
-  }
-
-  /* a little confusing, but we can include 'lambda' and smoothing weight
-   * here to avoid multiplying for every iteration */
-  if (smooth_weights == nullptr) {
-    for (i = 0; i < verts_num; i++) {
-      vertex_edge_count_div[i] = lambda * (vertex_edge_count_div[i] ?
-                                               (1.0f / vertex_edge_count_div[i]) :
-                                               1.0f);
+  /* Include 'lambda' and smoothing weight here to avoid multiplying for every iteration. */
+  Array<float> vertex_edge_count_div(verts_num);
+  threading::parallel_for(IndexRange(verts_num), 4096, [&](const IndexRange range) {
+    for (const int64_t i : range) {
+      const int count = adjacency.offsets[i + 1] - adjacency.offsets[i];
+      const float weight = smooth_weights ? smooth_weights[i] * lambda : lambda;
+      vertex_edge_count_div[i] = weight * (count ? (1.0f / float(count)) : 1.0f);
     }
-  }
-  else {
-    for (i = 0; i < verts_num; i++) {
-      vertex_edge_count_div[i] = smooth_weights[i] * lambda *
-                                 (vertex_edge_count_div[i] ? (1.0f / vertex_edge_count_div[i]) :
-                                                             1.0f);
-    }
-  }
+  });
 
   /* -------------------------------------------------------------------- */
   /* Main Smoothing Loop */
 
-  while (iterations--) {
-    for (i = 0; i < edges_num; i++) {
-      SmoothingData_Simple *sd_v1;
-      SmoothingData_Simple *sd_v2;
-      float edge_dir[3];
-
-      sub_v3_v3v3(edge_dir, vertexCos[edges[i].v2], vertexCos[edges[i].v1]);
-
-      sd_v1 = &smooth_data[edges[i].v1];
-      sd_v2 = &smooth_data[edges[i].v2];
-
-      add_v3_v3(sd_v1->delta, edge_dir);
-      sub_v3_v3(sd_v2->delta, edge_dir);
-    }
-
-    for (i = 0; i < verts_num; i++) {
-      SmoothingData_Simple *sd = &smooth_data[i];
-      madd_v3_v3fl(vertexCos[i], sd->delta, vertex_edge_count_div[i]);
-      /* zero for the next iteration (saves memset on entire array) */
-      memset(sd, 0, sizeof(*sd));
-    }
+  Array<float3> positions_next(verts_num);
+  MutableSpan<float3> src(reinterpret_cast<float3 *>(vertexCos), verts_num);
+  MutableSpan<float3> dst = positions_next;
+
+  for (uint iteration = 0; iteration < iterations; iteration++) {
+    threading::parallel_for(IndexRange(verts_num), 2048, [&](const IndexRange range) {
+      for (const int64_t i : range) {
+        float3 delta(0.0f);
+        for (const int64_t j : IndexRange(adjacency.offsets[i],
+                                          adjacency.offsets[i + 1] - adjacency.offsets[i])) {
+          delta += src[adjacency.neighbors[j]] - src[i];
+        }
+        dst[i] = src[i] + delta * vertex_edge_count_div[i];
+      }
+    });
+    std::swap(src, dst);
   }
 
-  MEM_freeN(vertex_edge_count_div);
-  MEM_freeN(smooth_data);
+  if (src.data() != reinterpret_cast<float3 *>(vertexCos)) {
+    dst.copy_from(src);
+  }
 }
 
 /* -------------------------------------------------------------------- */
 /* Edge-Length Weighted Smoothing
  */
 static void smooth_iter__length_weight(CorrectiveSmoothModifierData *csmd,
-                                       Mesh *mesh,
+                                       const SmoothAdjacency &adjacency,
                                        float (*vertexCos)[3],
                                        uint verts_num,
                                        const float *smooth_weights,
                                        uint iterations)
 {
+  using namespace blender;
   const float eps = FLT_EPSILON * 10.0f;
-  const uint edges_num = uint(mesh->totedge);
   /* NOTE: the way this smoothing method works, its approx half as strong as the simple-smooth,
    * and 2.0 rarely spikes, double the value for consistent behavior. */
   const float lambda = csmd->lambda * 2.0f;
-  const blender::Span<MEdge> edges = mesh->edges();
-  uint i;
-
-  struct SmoothingData_Weighted {
-    float delta[3];
-    float edge_length_sum;
-  };
-  SmoothingData_Weighted *smooth_data = MEM_cnew_array<SmoothingData_Weighted>(verts_num,
-                                                                               __func__);
-
-  /* calculate as floats to avoid int->float conversion in #smooth_iter */
-  float *vertex_edge_count = static_cast<float *>(
-      MEM_calloc_arrayN(verts_num, sizeof(float), __func__));
-  for (i = 0; i < edges_num; i++) {
-    vertex_edge_count[edges[i].v1] += 1.0f;
-    vertex_edge_count[edges[i].v2] += 1.0f;
-  }
 
   /* -------------------------------------------------------------------- */
   /* Main Smoothing Loop */
 
-  while (iterations--) {
-    for (i = 0; i < edges_num; i++) {
-      SmoothingData_Weighted *sd_v1;
-      SmoothingData_Weighted *sd_v2;
-      float edge_dir[3];
-      float edge_dist;
-
-      sub_v3_v3v3(edge_dir, vertexCos[edges[i].v2], vertexCos[edges[i].v1]);
-      edge_dist = len_v3(edge_dir);
-
-      /* weight by distance */
-      mul_v3_fl(edge_dir, edge_dist);
-
-      sd_v1 = &smooth_data[edges[i].v1];
-      sd_v2 = &smooth_data[edges[i].v2];
-
-      add_v3_v3(sd_v1->delta, edge_dir);
-      sub_v3_v3(sd_v2->delta, edge_dir);
-
-      sd_v1->edge_length_sum += edge_dist;
-      sd_v2->edge_length_sum += edge_dist;
-    }
+  Array<float3> positions_next(verts_num);
+  MutableSpan<float3> src(reinterpret_cast<float3 *>(vertexCos), verts_num);
+  MutableSpan<float3> dst = positions_next;
+
+  for (uint iteration = 0; iteration < iterations; iteration++) {
+    threading::parallel_for(IndexRange(verts_num), 2048, [&](const IndexRange range) {
+      for (const int64_t i : range) {
+        const IndexRange neighbors(adjacency.offsets[i],
+                                   adjacency.offsets[i + 1] - adjacency.offsets[i]);
+        float3 delta(0.0f);
+        float edge_length_sum = 0.0f;
+        for (const int64_t j : neighbors) {
+          const float3 edge_dir = src[adjacency.neighbors[j]] - src[i];
+          const float edge_dist = math::length(edge_dir);
+          /* weight by distance */
+          delta += edge_dir * edge_dist;
+          edge_length_sum += edge_dist;
+        }
 
-    if (smooth_weights == nullptr) {
-      /* fast-path */
-      for (i = 0; i < verts_num; i++) {
-        SmoothingData_Weighted *sd = &smooth_data[i];
         /* Divide by sum of all neighbor distances (weighted) and amount of neighbors,
          * (mean average). */
-        const float div = sd->edge_length_sum * vertex_edge_count[i];
+        const float div = edge_length_sum * float(neighbors.size());
+        dst[i] = src[i];
         if (div > eps) {
-#if 0
-          /* first calculate the new location */
-          mul_v3_fl(sd->delta, 1.0f / div);
-          /* then interpolate */
-          madd_v3_v3fl(vertexCos[i], sd->delta, lambda);
-#else
-          /* do this in one step */
-          madd_v3_v3fl(vertexCos[i], sd->delta, lambda / div);
-#endif
+          const float lambda_w = smooth_weights ? lambda * smooth_weights[i] : lambda;
+          dst[i] += delta * (lambda_w / div);
         }
-        /* zero for the next iteration (saves memset on entire array) */
-        memset(sd, 0, sizeof(*sd));
       }
-    }
-    else {
-      for (i = 0; i < verts_num; i++) {
-        SmoothingData_Weighted *sd = &smooth_data[i];
-        const float div = sd->edge_length_sum * vertex_edge_count[i];
-        if (div > eps) {
-          const float lambda_w = lambda * smooth_weights[i];
-          madd_v3_v3fl(vertexCos[i], sd->delta, lambda_w / div);
-        }
-
-        memset(sd, 0, sizeof(*sd));
-      }
-    }
+    });
+    std::swap(src, dst);
   }
 
-  MEM_freeN(vertex_edge_count);
-  MEM_freeN(smooth_data);
+  if (src.data() != reinterpret_cast<float3 *>(vertexCos)) {
+    dst.copy_from(src);
+  }
 }
 
 static void smooth_iter(CorrectiveSmoothModifierData *csmd,
@@ -339,14 +311,18 @@ static void smooth_iter(CorrectiveSmoothModifierData *csmd,
                         const float *smooth_weights,
                         uint iterations)
 {
+  SmoothAdjacency adjacency;
+  smooth_adjacency_build(mesh->edges(), verts_num, adjacency);
+
   switch (csmd->smooth_type) {
     case MOD_CORRECTIVESMOOTH_SMOOTH_LENGTH_WEIGHT:
-      smooth_iter__length_weight(csmd, mesh, vertexCos, verts_num, smooth_weights, iterations);
+      smooth_iter__length_weight(
+          csmd, adjacency, vertexCos, verts_num, smooth_weights, iterations);
       break;
 
     /* case MOD_CORRECTIVESMOOTH_SMOOTH_SIMPLE: */
     default:
-      smooth_iter__simple(csmd, mesh, vertexCos, verts_num, smooth_weights, iterations);
+      smooth_iter__simple(csmd, adjacency, vertexCos, verts_num, smooth_weights, iterations);
       break;
   }
 }
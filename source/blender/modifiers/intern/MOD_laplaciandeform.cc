@@ -9,6 +9,7 @@
 
 #include "BLI_math.h"
 #include "BLI_string.h"
+#include "BLI_task.hh"
 #include "BLI_utildefines_stack.h"
 
 #include "MEM_guardedalloc.h"
@@ -322,70 +323,75 @@ static void computeImplictRotations(LaplacianSystem *sys)
 
 static void rotateDifferentialCoordinates(LaplacianSystem *sys)
 {
-  float alpha, beta, gamma;
-  float pj[3], ni[3], di[3];
-  float uij[3], dun[3], e2[3], pi[3], fni[3], vn[3][3];
-  int i, j, fidn_num, k, fi;
-  int *fidn;
-
-  for (i = 0; i < sys->verts_num; i++) {
-    copy_v3_v3(pi, sys->co[i]);
-    copy_v3_v3(ni, sys->no[i]);
-    k = sys->unit_verts[i];
-    copy_v3_v3(pj, sys->co[k]);
-    sub_v3_v3v3(uij, pj, pi);
-    mul_v3_v3fl(dun, ni, dot_v3v3(uij, ni));
-    sub_v3_v3(uij, dun);
-    normalize_v3(uij);
-    cross_v3_v3v3(e2, ni, uij);
-    copy_v3_v3(di, sys->delta[i]);
-    alpha = dot_v3v3(ni, di);
-    beta = dot_v3v3(uij, di);
-    gamma = dot_v3v3(e2, di);
-
-    pi[0] = EIG_linear_solver_variable_get(sys->context, 0, i);
-    pi[1] = EIG_linear_solver_variable_get(sys->context, 1, i);
-    pi[2] = EIG_linear_solver_variable_get(sys->context, 2, i);
-    zero_v3(ni);
-    fidn_num = sys->ringf_map[i].count;
-    for (fi = 0; fi < fidn_num; fi++) {
-      const uint *vin;
-      fidn = sys->ringf_map[i].indices;
-      vin = sys->tris[fidn[fi]];
-      for (j = 0; j < 3; j++) {
-        vn[j][0] = EIG_linear_solver_variable_get(sys->context, 0, vin[j]);
-        vn[j][1] = EIG_linear_solver_variable_get(sys->context, 1, vin[j]);
-        vn[j][2] = EIG_linear_solver_variable_get(sys->context, 2, vin[j]);
-        if (vin[j] == sys->unit_verts[i]) {
-          copy_v3_v3(pj, vn[j]);
+  /* Every vertex only writes its own row of the right hand side, and only reads the solved
+   * variables, so the vertices can be processed in parallel. */
+  blender::threading::parallel_for(
+      blender::IndexRange(sys->verts_num), 1024, [&](const blender::IndexRange range) {
+        float alpha, beta, gamma;
+        float pj[3], ni[3], di[3];
+        float uij[3], dun[3], e2[3], pi[3], fni[3], vn[3][3];
+        int j, fidn_num, k, fi;
+        int *fidn;
+
+        for (const int i : range) {
+          copy_v3_v3(pi, sys->co[i]);
+          copy_v3_v3(ni, sys->no[i]);
+          k = sys->unit_verts[i];
+          copy_v3_v3(pj, sys->co[k]);
+          sub_v3_v3v3(uij, pj, pi);
+          mul_v3_v3fl(dun, ni, dot_v3v3(uij, ni));
+          sub_v3_v3(uij, dun);
+          normalize_v3(uij);
+          cross_v3_v3v3(e2, ni, uij);
+          copy_v3_v3(di, sys->delta[i]);
+          alpha = dot_v3v3(ni, di);
+          beta = dot_v3v3(uij, di);
+          gamma = dot_v3v3(e2, di);
+
+          pi[0] = EIG_linear_solver_variable_get(sys->context, 0, i);
+          pi[1] = EIG_linear_solver_variable_get(sys->context, 1, i);
+          pi[2] = EIG_linear_solver_variable_get(sys->context, 2, i);
+          zero_v3(ni);
+          fidn_num = sys->ringf_map[i].count;
+          for (fi = 0; fi < fidn_num; fi++) {
+            const uint *vin;
+            fidn = sys->ringf_map[i].indices;
+            vin = sys->tris[fidn[fi]];
+            for (j = 0; j < 3; j++) {
+              vn[j][0] = EIG_linear_solver_variable_get(sys->context, 0, vin[j]);
+              vn[j][1] = EIG_linear_solver_variable_get(sys->context, 1, vin[j]);
+              vn[j][2] = EIG_linear_solver_variable_get(sys->context, 2, vin[j]);
+              if (vin[j] == sys->unit_verts[i]) {
+                copy_v3_v3(pj, vn[j]);
+              }
+            }
+
+            normal_tri_v3(fni, UNPACK3(vn));
+            add_v3_v3(ni, fni);
+          }
+
+          normalize_v3(ni);
+          sub_v3_v3v3(uij, pj, pi);
+          mul_v3_v3fl(dun, ni, dot_v3v3(uij, ni));
+          sub_v3_v3(uij, dun);
+          normalize_v3(uij);
+          cross_v3_v3v3(e2, ni, uij);
+          fni[0] = alpha * ni[0] + beta * uij[0] + gamma * e2[0];
+          fni[1] = alpha * ni[1] + beta * uij[1] + gamma * e2[1];
+          fni[2] = alpha * ni[2] + beta * uij[2] + gamma * e2[2];
+
+          if (len_squared_v3(fni) > FLT_EPSILON) {
+            EIG_linear_solver_right_hand_side_add(sys->context, 0, i, fni[0]);
+            EIG_linear_solver_right_hand_side_add(sys->context, 1, i, fni[1]);
+            EIG_linear_solver_right_hand_side_add(sys->context, 2, i, fni[2]);
+          }
+          else {
+            EIG_linear_solver_right_hand_side_add(sys->context, 0, i, sys->delta[i][0]);
+            EIG_linear_solver_right_hand_side_add(sys->context, 1, i, sys->delta[i][1]);
+            EIG_linear_solver_right_hand_side_add(sys->context, 2, i, sys->delta[i][2]);
+          }
         }
-      }
-
-      normal_tri_v3(fni, UNPACK3(vn));
-      add_v3_v3(ni, fni);
-    }
-
-    normalize_v3(ni);
-    sub_v3_v3v3(uij, pj, pi);
-    mul_v3_v3fl(dun, ni, dot_v3v3(uij, ni));
-    sub_v3_v3(uij, dun);
-    normalize_v3(uij);
-    cross_v3_v3v3(e2, ni, uij);
-    fni[0] = alpha * ni[0] + beta * uij[0] + gamma * e2[0];
-    fni[1] = alpha * ni[1] + beta * uij[1] + gamma * e2[1];
-    fni[2] = alpha * ni[2] + beta * uij[2] + gamma * e2[2];
-
-    if (len_squared_v3(fni) > FLT_EPSILON) {
-      EIG_linear_solver_right_hand_side_add(sys->context, 0, i, fni[0]);
-      EIG_linear_solver_right_hand_side_add(sys->context, 1, i, fni[1]);
-      EIG_linear_solver_right_hand_side_add(sys->context, 2, i, fni[2]);
-    }
-    else {
-      EIG_linear_solver_right_hand_side_add(sys->context, 0, i, sys->delta[i][0]);
-      EIG_linear_solver_right_hand_side_add(sys->context, 1, i, sys->delta[i][1]);
-      EIG_linear_solver_right_hand_side_add(sys->context, 2, i, sys->delta[i][2]);
-    }
-  }
+      });
 }
 
 static void laplacianDeformPreview(LaplacianSystem *sys, float (*vertexCos)[3])
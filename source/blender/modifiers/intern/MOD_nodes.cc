@@ -18,6 +18,7 @@
 #include "BLI_set.hh"
 #include "BLI_string.h"
 #include "BLI_string_search.h"
+#include "BLI_task_trace.hh"
 #include "BLI_utildefines.h"
 
 #include "DNA_collection_types.h"
@@ -1332,8 +1333,11 @@ static void modifyGeometry(ModifierData *md,
     return;
   }
 
-  const blender::nodes::GeometryNodesLazyFunctionGraphInfo *lf_graph_info =
-      blender::nodes::ensure_geometry_nodes_lazy_function_graph(tree);
+  const blender::nodes::GeometryNodesLazyFunctionGraphInfo *lf_graph_info = nullptr;
+  {
+    blender::threading::trace::TraceRegion trace_region("Geometry Nodes: Build Graph");
+    lf_graph_info = blender::nodes::ensure_geometry_nodes_lazy_function_graph(tree);
+  }
   if (lf_graph_info == nullptr) {
     BKE_modifier_set_error(ctx->object, md, "Cannot evaluate node group");
     geometry_set.clear();
@@ -1349,8 +1353,11 @@ static void modifyGeometry(ModifierData *md,
     use_orig_index_polys = CustomData_has_layer(&mesh->pdata, CD_ORIGINDEX);
   }
 
-  geometry_set = compute_geometry(
-      tree, *lf_graph_info, *output_node, std::move(geometry_set), nmd, ctx);
+  {
+    blender::threading::trace::TraceRegion trace_region("Geometry Nodes: Evaluate");
+    geometry_set = compute_geometry(
+        tree, *lf_graph_info, *output_node, std::move(geometry_set), nmd, ctx);
+  }
 
   if (use_orig_index_verts || use_orig_index_edges || use_orig_index_polys) {
     if (Mesh *mesh = geometry_set.get_mesh_for_write()) {
@@ -5,9 +5,15 @@
  * \ingroup modifiers
  */
 
+#include "BLI_array.hh"
+#include "BLI_enumerable_thread_specific.hh"
+#include "BLI_hash_mm2a.h"
 #include "BLI_math.h"
 #include "BLI_math_geom.h"
+#include "BLI_math_vector_types.hh"
 #include "BLI_task.h"
+#include "BLI_task.hh"
+#include "BLI_vector.hh"
 
 #include "BLT_translation.h"
 
@@ -26,6 +32,7 @@
 #include "BKE_lib_query.h"
 #include "BKE_mesh.hh"
 #include "BKE_mesh_runtime.h"
+#include "BKE_mesh_types.h"
 #include "BKE_mesh_wrapper.h"
 #include "BKE_modifier.h"
 #include "BKE_screen.h"
@@ -41,6 +48,8 @@
 #include "DEG_depsgraph.h"
 #include "DEG_depsgraph_query.h"
 
+#include "WM_types.h" /* For rebind operator UI. */
+
 #include "MEM_guardedalloc.h"
 
 #include "MOD_ui_common.h"
@@ -68,6 +77,11 @@ struct SDefBindCalcData {
   const SDefAdjacencyArray *vert_edges;
   const SDefEdgePolys *edge_polys;
   SDefVert *bind_verts;
+  /**
+   * Bind data from before rebinding (see #MOD_SDEF_REBIND) indexed by vertex,
+   * null for vertices that weren't bound.
+   */
+  SDefVert **old_bind_verts;
   blender::Span<MEdge> edges;
   blender::Span<MPoly> polys;
   blender::Span<MLoop> loops;
@@ -160,8 +174,15 @@ struct SDefBindPoly {
   bool inside;
 };
 
+/**
+ * Weights of the vertex currently being bound. One of these is kept per thread and re-used for
+ * every vertex bound by that thread, so the hot loop doesn't need to allocate.
+ */
 struct SDefBindWeightData {
-  SDefBindPoly *bind_polys;
+  blender::Vector<SDefBindPoly> bind_polys;
+  /** Storage for #SDefBindPoly.coords and #SDefBindPoly.coords_v2 of all `bind_polys`. */
+  blender::Vector<blender::float3> coords;
+  blender::Vector<blender::float2> coords_v2;
   uint polys_num;
   uint binds_num;
 };
@@ -176,6 +197,16 @@ struct SDefDeformData {
   float strength;
 };
 
+/**
+ * Stored in #ModifierData.runtime of the evaluated modifier. The target topology hash is only
+ * computed again when the topology version of the target changed, so animated targets don't hash
+ * their topology every evaluation.
+ */
+struct SDefRuntimeData {
+  uint64_t target_topology_version;
+  uint target_topology_hash;
+};
+
 /* Bind result values */
 enum {
   MOD_SDEF_BIND_RESULT_SUCCESS = 1,
@@ -212,23 +243,39 @@ static void requiredDataMask(ModifierData *md, CustomData_MeshMasks *r_cddata_ma
   }
 }
 
+static void freeBindVerts(SDefVert *verts, const uint verts_num)
+{
+  for (int i = 0; i < verts_num; i++) {
+    if (verts[i].binds) {
+      for (int j = 0; j < verts[i].binds_num; j++) {
+        MEM_SAFE_FREE(verts[i].binds[j].vert_inds);
+        MEM_SAFE_FREE(verts[i].binds[j].vert_weights);
+      }
+      MEM_freeN(verts[i].binds);
+    }
+  }
+
+  MEM_freeN(verts);
+}
+
+static void freeRuntimeData(void *runtime_data_v)
+{
+  if (runtime_data_v == nullptr) {
+    return;
+  }
+  MEM_freeN(runtime_data_v);
+}
+
 static void freeData(ModifierData *md)
 {
   SurfaceDeformModifierData *smd = (SurfaceDeformModifierData *)md;
 
   if (smd->verts) {
-    for (int i = 0; i < smd->bind_verts_num; i++) {
-      if (smd->verts[i].binds) {
-        for (int j = 0; j < smd->verts[i].binds_num; j++) {
-          MEM_SAFE_FREE(smd->verts[i].binds[j].vert_inds);
-          MEM_SAFE_FREE(smd->verts[i].binds[j].vert_weights);
-        }
-        MEM_freeN(smd->verts[i].binds);
-      }
-    }
-
-    MEM_SAFE_FREE(smd->verts);
+    freeBindVerts(smd->verts, smd->bind_verts_num);
+    smd->verts = nullptr;
   }
+  freeRuntimeData(smd->modifier.runtime);
+  smd->modifier.runtime = nullptr;
 }
 
 static void copyData(const ModifierData *md, ModifierData *target, const int flag)
@@ -377,7 +424,9 @@ BLI_INLINE void sortPolyVertsTri(uint *indices,
   }
 }
 
-BLI_INLINE uint nearestVert(SDefBindCalcData *const data, const float point_co[3])
+BLI_INLINE uint nearestVert(SDefBindCalcData *const data,
+                            const float point_co[3],
+                            uint *r_target_poly)
 {
   BVHTreeNearest nearest{};
   nearest.dist_sq = FLT_MAX;
@@ -395,7 +444,8 @@ BLI_INLINE uint nearestVert(SDefBindCalcData *const data, const float point_co[3
   BLI_bvhtree_find_nearest(
       data->treeData->tree, t_point, &nearest, data->treeData->nearest_callback, data->treeData);
 
-  const MPoly &poly = data->polys[data->looptris[nearest.index].poly];
+  *r_target_poly = data->looptris[nearest.index].poly;
+  const MPoly &poly = data->polys[*r_target_poly];
   loop = &data->loops[poly.loopstart];
 
   for (int i = 0; i < poly.totloop; i++, loop++) {
@@ -459,38 +509,27 @@ BLI_INLINE int isPolyValid(const float coords[][2], const uint nr)
   return MOD_SDEF_BIND_RESULT_SUCCESS;
 }
 
-static void freeBindData(SDefBindWeightData *const bwdata)
-{
-  SDefBindPoly *bpoly = bwdata->bind_polys;
-
-  if (bwdata->bind_polys) {
-    for (int i = 0; i < bwdata->polys_num; bpoly++, i++) {
-      MEM_SAFE_FREE(bpoly->coords);
-      MEM_SAFE_FREE(bpoly->coords_v2);
-    }
-
-    MEM_freeN(bwdata->bind_polys);
-  }
-
-  MEM_freeN(bwdata);
-}
-
 BLI_INLINE float computeAngularWeight(const float point_angle, const float edgemid_angle)
 {
   return sinf(min_ff(point_angle / edgemid_angle, 1) * M_PI_2);
 }
 
-BLI_INLINE SDefBindWeightData *computeBindWeights(SDefBindCalcData *const data,
-                                                  const float point_co[3])
+/**
+ * Fill `bwdata` with the weights of `point_co`, bound around the `nearest` target vertex.
+ *
+ * \return false on failure, in which case `data->success` is set to the error.
+ */
+BLI_INLINE bool computeBindWeights(SDefBindCalcData *const data,
+                                   const float point_co[3],
+                                   const uint nearest,
+                                   SDefBindWeightData *bwdata)
 {
-  const uint nearest = nearestVert(data, point_co);
   const SDefAdjacency *const vert_edges = data->vert_edges[nearest].first;
   const SDefEdgePolys *const edge_polys = data->edge_polys;
 
   const SDefAdjacency *vedge;
   const MLoop *loop;
 
-  SDefBindWeightData *bwdata;
   SDefBindPoly *bpoly;
 
   const float world[3] = {0.0f, 0.0f, 1.0f};
@@ -498,23 +537,26 @@ BLI_INLINE SDefBindWeightData *computeBindWeights(SDefBindCalcData *const data,
   float tot_weight = 0.0f;
   int inf_weight_flags = 0;
 
-  bwdata = static_cast<SDefBindWeightData *>(MEM_callocN(sizeof(*bwdata), "SDefBindWeightData"));
-  if (bwdata == nullptr) {
-    data->success = MOD_SDEF_BIND_RESULT_MEM_ERR;
-    return nullptr;
-  }
-
   bwdata->polys_num = data->vert_edges[nearest].num / 2;
+  bwdata->binds_num = 0;
 
-  bpoly = static_cast<SDefBindPoly *>(
-      MEM_calloc_arrayN(bwdata->polys_num, sizeof(*bpoly), "SDefBindPoly"));
-  if (bpoly == nullptr) {
-    freeBindData(bwdata);
-    data->success = MOD_SDEF_BIND_RESULT_MEM_ERR;
-    return nullptr;
-  }
+  bwdata->bind_polys.clear();
+  bwdata->bind_polys.resize(bwdata->polys_num, SDefBindPoly{});
 
-  bwdata->bind_polys = bpoly;
+  /* Reserve coordinate storage for all adjacent polygons up-front (polygons shared by two edges
+   * are counted twice), so the pointers stored in the #SDefBindPoly stay valid. */
+  {
+    int coords_num = 0;
+    for (vedge = vert_edges; vedge; vedge = vedge->next) {
+      const SDefEdgePolys &epolys = edge_polys[vedge->index];
+      for (int i = 0; i < epolys.num; i++) {
+        coords_num += data->polys[epolys.polys[i]].totloop;
+      }
+    }
+    bwdata->coords.reinitialize(coords_num);
+    bwdata->coords_v2.reinitialize(coords_num);
+  }
+  int coords_offset = 0;
 
   /* Loop over all adjacent edges,
    * and build the #SDefBindPoly data for each poly adjacent to those. */
@@ -523,7 +565,7 @@ BLI_INLINE SDefBindWeightData *computeBindWeights(SDefBindCalcData *const data,
 
     for (int i = 0; i < edge_polys[edge_ind].num; i++) {
       {
-        bpoly = bwdata->bind_polys;
+        bpoly = bwdata->bind_polys.data();
 
         for (int j = 0; j < bwdata->polys_num; bpoly++, j++) {
           /* If coords isn't allocated, we have reached the first uninitialized `bpoly`. */
@@ -551,21 +593,9 @@ BLI_INLINE SDefBindWeightData *computeBindWeights(SDefBindCalcData *const data,
         bpoly->verts_num = poly.totloop;
         bpoly->loopstart = poly.loopstart;
 
-        bpoly->coords = static_cast<float(*)[3]>(
-            MEM_malloc_arrayN(poly.totloop, sizeof(*bpoly->coords), "SDefBindPolyCoords"));
-        if (bpoly->coords == nullptr) {
-          freeBindData(bwdata);
-          data->success = MOD_SDEF_BIND_RESULT_MEM_ERR;
-          return nullptr;
-        }
-
-        bpoly->coords_v2 = static_cast<float(*)[2]>(
-            MEM_malloc_arrayN(poly.totloop, sizeof(*bpoly->coords_v2), "SDefBindPolyCoords_v2"));
-        if (bpoly->coords_v2 == nullptr) {
-          freeBindData(bwdata);
-          data->success = MOD_SDEF_BIND_RESULT_MEM_ERR;
-          return nullptr;
-        }
+        bpoly->coords = reinterpret_cast<float(*)[3]>(&bwdata->coords[coords_offset]);
+        bpoly->coords_v2 = reinterpret_cast<float(*)[2]>(&bwdata->coords_v2[coords_offset]);
+        coords_offset += poly.totloop;
 
         for (int j = 0; j < poly.totloop; j++, loop++) {
           copy_v3_v3(bpoly->coords[j], data->targetCos[loop->v]);
@@ -603,9 +633,8 @@ BLI_INLINE SDefBindWeightData *computeBindWeights(SDefBindCalcData *const data,
         is_poly_valid = isPolyValid(bpoly->coords_v2, poly.totloop);
 
         if (is_poly_valid != MOD_SDEF_BIND_RESULT_SUCCESS) {
-          freeBindData(bwdata);
           data->success = is_poly_valid;
-          return nullptr;
+          return false;
         }
 
         bpoly->inside = isect_point_poly_v2(
@@ -659,9 +688,8 @@ BLI_INLINE SDefBindWeightData *computeBindWeights(SDefBindCalcData *const data,
         if (bpoly->scales[0] < FLT_EPSILON || bpoly->scales[1] < FLT_EPSILON ||
             bpoly->edgemid_angle < FLT_EPSILON || bpoly->corner_edgemid_angles[0] < FLT_EPSILON ||
             bpoly->corner_edgemid_angles[1] < FLT_EPSILON) {
-          freeBindData(bwdata);
           data->success = MOD_SDEF_BIND_RESULT_GENERIC_ERR;
-          return nullptr;
+          return false;
         }
 
         /* Check for infinite weights, and compute angular data otherwise. */
@@ -717,9 +745,8 @@ BLI_INLINE SDefBindWeightData *computeBindWeights(SDefBindCalcData *const data,
           /* Verify that the additional computed values are valid. */
           if (bpoly->scale_mid < FLT_EPSILON ||
               bpoly->point_edgemid_angles[0] + bpoly->point_edgemid_angles[1] < FLT_EPSILON) {
-            freeBindData(bwdata);
             data->success = MOD_SDEF_BIND_RESULT_GENERIC_ERR;
-            return nullptr;
+            return false;
           }
         }
       }
@@ -741,7 +768,7 @@ BLI_INLINE SDefBindWeightData *computeBindWeights(SDefBindCalcData *const data,
       epolys = &edge_polys[edge_ind];
 
       /* Find bind polys corresponding to the edge's adjacent polys */
-      bpoly = bwdata->bind_polys;
+      bpoly = bwdata->bind_polys.data();
 
       for (int i = 0, j = 0; (i < bwdata->polys_num) && (j < epolys->num); bpoly++, i++) {
         if (ELEM(bpoly->index, epolys->polys[0], epolys->polys[1])) {
@@ -781,7 +808,7 @@ BLI_INLINE SDefBindWeightData *computeBindWeights(SDefBindCalcData *const data,
    * - Scale only un-projected weight if projected weight is infinite.
    * - Scale none if both are infinite. */
   if (!inf_weight_flags) {
-    bpoly = bwdata->bind_polys;
+    bpoly = bwdata->bind_polys.data();
 
     for (int i = 0; i < bwdata->polys_num; bpoly++, i++) {
       float corner_angle_weights[2];
@@ -791,9 +818,8 @@ BLI_INLINE SDefBindWeightData *computeBindWeights(SDefBindCalcData *const data,
       corner_angle_weights[1] = bpoly->point_edgemid_angles[1] / bpoly->corner_edgemid_angles[1];
 
       if (isnan(corner_angle_weights[0]) || isnan(corner_angle_weights[1])) {
-        freeBindData(bwdata);
         data->success = MOD_SDEF_BIND_RESULT_GENERIC_ERR;
-        return nullptr;
+        return false;
       }
 
       /* Find which edge the point is closer to */
@@ -808,9 +834,8 @@ BLI_INLINE SDefBindWeightData *computeBindWeights(SDefBindCalcData *const data,
 
       /* Check for invalid weights just in case computations fail. */
       if (bpoly->dominant_angle_weight < 0 || bpoly->dominant_angle_weight > 1) {
-        freeBindData(bwdata);
         data->success = MOD_SDEF_BIND_RESULT_GENERIC_ERR;
-        return nullptr;
+        return false;
       }
 
       bpoly->dominant_angle_weight = sinf(bpoly->dominant_angle_weight * M_PI_2);
@@ -861,7 +886,7 @@ BLI_INLINE SDefBindWeightData *computeBindWeights(SDefBindCalcData *const data,
     }
   }
   else if (!(inf_weight_flags & MOD_SDEF_INFINITE_WEIGHT_DIST)) {
-    bpoly = bwdata->bind_polys;
+    bpoly = bwdata->bind_polys.data();
 
     for (int i = 0; i < bwdata->polys_num; bpoly++, i++) {
       /* Scale the point distance weight by average point distance, and introduce falloff */
@@ -876,7 +901,7 @@ BLI_INLINE SDefBindWeightData *computeBindWeights(SDefBindCalcData *const data,
   }
 
   /* Final loop, to compute actual weights */
-  bpoly = bwdata->bind_polys;
+  bpoly = bwdata->bind_polys.data();
 
   for (int i = 0; i < bwdata->polys_num; bpoly++, i++) {
     /* Weight computation from components */
@@ -903,7 +928,7 @@ BLI_INLINE SDefBindWeightData *computeBindWeights(SDefBindCalcData *const data,
     tot_weight += bpoly->weight;
   }
 
-  bpoly = bwdata->bind_polys;
+  bpoly = bwdata->bind_polys.data();
 
   for (int i = 0; i < bwdata->polys_num; bpoly++, i++) {
     bpoly->weight /= tot_weight;
@@ -928,7 +953,7 @@ BLI_INLINE SDefBindWeightData *computeBindWeights(SDefBindCalcData *const data,
     }
   }
 
-  return bwdata;
+  return true;
 }
 
 BLI_INLINE float computeNormalDisplacement(const float point_co[3],
@@ -948,20 +973,89 @@ BLI_INLINE float computeNormalDisplacement(const float point_co[3],
   return normal_dist;
 }
 
-static void bindVert(void *__restrict userdata,
-                     const int index,
-                     const TaskParallelTLS *__restrict /*tls*/)
+/**
+ * Hash everything the binds of a point depend on: its position, the falloff and the polygons
+ * around the nearest target vertex, including their coordinates.
+ */
+static uint bindVertHash(const SDefBindCalcData *data, const float point_co[3], const uint nearest)
+{
+  BLI_HashMurmur2A mm2;
+  BLI_hash_mm2a_init(&mm2, 0);
+  BLI_hash_mm2a_add(&mm2, (const uchar *)point_co, sizeof(float[3]));
+  BLI_hash_mm2a_add(&mm2, (const uchar *)&data->falloff, sizeof(data->falloff));
+  BLI_hash_mm2a_add_int(&mm2, int(nearest));
+
+  for (const SDefAdjacency *vedge = data->vert_edges[nearest].first; vedge; vedge = vedge->next) {
+    const SDefEdgePolys &epolys = data->edge_polys[vedge->index];
+    BLI_hash_mm2a_add_int(&mm2, int(vedge->index));
+
+    for (int i = 0; i < epolys.num; i++) {
+      const MPoly &poly = data->polys[epolys.polys[i]];
+      BLI_hash_mm2a_add_int(&mm2, int(epolys.polys[i]));
+
+      for (const MLoop &loop : data->loops.slice(poly.loopstart, poly.totloop)) {
+        BLI_hash_mm2a_add_int(&mm2, int(loop.v));
+        BLI_hash_mm2a_add_int(&mm2, int(loop.e));
+        BLI_hash_mm2a_add(&mm2, (const uchar *)data->targetCos[loop.v], sizeof(float[3]));
+      }
+    }
+  }
+
+  /* Zero means unknown. */
+  return max_uu(BLI_hash_mm2a_end(&mm2), 1);
+}
+
+/** Hash the target topology, to detect changes that keep the number of elements. */
+static uint targetTopologyHash(const Mesh *target)
+{
+  const blender::Span<MPoly> polys = target->polys();
+  const blender::Span<MLoop> loops = target->loops();
+
+  BLI_HashMurmur2A mm2;
+  BLI_hash_mm2a_init(&mm2, 0);
+  for (const MPoly &poly : polys) {
+    BLI_hash_mm2a_add_int(&mm2, poly.loopstart);
+    BLI_hash_mm2a_add_int(&mm2, poly.totloop);
+  }
+  BLI_hash_mm2a_add(&mm2, (const uchar *)loops.data(), size_t(loops.size_in_bytes()));
+
+  /* Zero means unknown. */
+  return max_uu(BLI_hash_mm2a_end(&mm2), 1);
+}
+
+/** Same as #targetTopologyHash, but only hash again when the target topology may have changed. */
+static uint targetTopologyHashCached(SurfaceDeformModifierData *smd, const Mesh *target)
+{
+  const uint64_t topology_version = target->runtime->topology_version;
+
+  SDefRuntimeData *runtime = static_cast<SDefRuntimeData *>(smd->modifier.runtime);
+  if (runtime == nullptr) {
+    runtime = MEM_cnew<SDefRuntimeData>(__func__);
+    smd->modifier.runtime = runtime;
+  }
+  else if (runtime->target_topology_version == topology_version) {
+    return runtime->target_topology_hash;
+  }
+
+  runtime->target_topology_version = topology_version;
+  runtime->target_topology_hash = targetTopologyHash(target);
+  return runtime->target_topology_hash;
+}
+
+static void bindVert(SDefBindCalcData *const data,
+                     SDefBindWeightData *bwdata,
+                     const int index)
 {
-  SDefBindCalcData *const data = (SDefBindCalcData *)userdata;
   float point_co[3];
   float point_co_proj[3];
 
-  SDefBindWeightData *bwdata;
   SDefVert *sdvert = data->bind_verts + index;
   SDefBindPoly *bpoly;
   SDefBind *sdbind;
 
   sdvert->vertex_idx = index;
+  sdvert->target_poly = 0;
+  sdvert->bind_hash = 0;
 
   if (data->success != MOD_SDEF_BIND_RESULT_SUCCESS) {
     sdvert->binds = nullptr;
@@ -988,9 +1082,23 @@ static void bindVert(void *__restrict userdata,
   }
 
   copy_v3_v3(point_co, data->vertexCos[index]);
-  bwdata = computeBindWeights(data, point_co);
+  const uint nearest = nearestVert(data, point_co, &sdvert->target_poly);
+  sdvert->bind_hash = bindVertHash(data, point_co, nearest);
+
+  /* When rebinding, keep the previous binds if nothing they depend on changed. */
+  if (data->old_bind_verts) {
+    SDefVert *old_sdvert = data->old_bind_verts[index];
+    if (old_sdvert && old_sdvert->binds && old_sdvert->target_poly == sdvert->target_poly &&
+        old_sdvert->bind_hash == sdvert->bind_hash) {
+      sdvert->binds = old_sdvert->binds;
+      sdvert->binds_num = old_sdvert->binds_num;
+      old_sdvert->binds = nullptr;
+      old_sdvert->binds_num = 0;
+      return;
+    }
+  }
 
-  if (bwdata == nullptr) {
+  if (!computeBindWeights(data, point_co, nearest, bwdata)) {
     sdvert->binds = nullptr;
     sdvert->binds_num = 0;
     return;
@@ -1008,7 +1116,7 @@ static void bindVert(void *__restrict userdata,
 
   sdbind = sdvert->binds;
 
-  bpoly = bwdata->bind_polys;
+  bpoly = bwdata->bind_polys.data();
 
   for (int i = 0; i < bwdata->binds_num; bpoly++) {
     if (bpoly->weight >= FLT_EPSILON) {
@@ -1150,8 +1258,6 @@ static void bindVert(void *__restrict userdata,
       }
     }
   }
-
-  freeBindData(bwdata);
 }
 
 /* Remove vertices without bind data from the bind array. */
@@ -1169,6 +1275,10 @@ static void compactSparseBinds(SurfaceDeformModifierData *smd)
       smd->verts, sizeof(*smd->verts) * smd->bind_verts_num, "SDefBindVerts (sparse)"));
 }
 
+/**
+ * \param old_verts: Bind data from before rebinding, binds that are still valid are moved
+ * from it instead of being calculated again. Null for a full bind.
+ */
 static bool surfacedeformBind(Object *ob,
                               SurfaceDeformModifierData *smd_orig,
                               SurfaceDeformModifierData *smd_eval,
@@ -1177,7 +1287,9 @@ static bool surfacedeformBind(Object *ob,
                               uint target_polys_num,
                               uint target_verts_num,
                               Mesh *target,
-                              Mesh *mesh)
+                              Mesh *mesh,
+                              SDefVert *old_verts,
+                              const uint old_verts_num)
 {
   BVHTreeFromMesh treeData = {nullptr};
   const float(*positions)[3] = BKE_mesh_vert_positions(target);
@@ -1243,6 +1355,7 @@ static bool surfacedeformBind(Object *ob,
   smd_orig->mesh_verts_num = verts_num;
   smd_orig->target_verts_num = target_verts_num;
   smd_orig->target_polys_num = target_polys_num;
+  smd_orig->target_topology_hash = targetTopologyHash(target);
 
   int defgrp_index;
   const MDeformVert *dvert;
@@ -1269,6 +1382,18 @@ static bool surfacedeformBind(Object *ob,
   data.invert_vgroup = invert_vgroup;
   data.sparse_bind = sparse_bind;
 
+  blender::Array<SDefVert *> old_bind_verts;
+  if (old_verts) {
+    old_bind_verts.reinitialize(verts_num);
+    old_bind_verts.fill(nullptr);
+    for (uint i = 0; i < old_verts_num; i++) {
+      if (old_verts[i].vertex_idx < verts_num) {
+        old_bind_verts[old_verts[i].vertex_idx] = &old_verts[i];
+      }
+    }
+    data.old_bind_verts = old_bind_verts.data();
+  }
+
   if (data.targetCos == nullptr) {
     BKE_modifier_set_error(ob, (ModifierData *)smd_eval, "Out of memory");
     freeData((ModifierData *)smd_orig);
@@ -1277,14 +1402,21 @@ static bool surfacedeformBind(Object *ob,
 
   invert_m4_m4(data.imat, smd_orig->mat);
 
-  for (int i = 0; i < target_verts_num; i++) {
-    mul_v3_m4v3(data.targetCos[i], smd_orig->mat, positions[i]);
-  }
-
-  TaskParallelSettings settings;
-  BLI_parallel_range_settings_defaults(&settings);
-  settings.use_threading = (verts_num > 10000);
-  BLI_task_parallel_range(0, verts_num, &data, bindVert, &settings);
+  blender::threading::parallel_for(
+      blender::IndexRange(target_verts_num), 4096, [&](const blender::IndexRange range) {
+        for (const int i : range) {
+          mul_v3_m4v3(data.targetCos[i], smd_orig->mat, positions[i]);
+        }
+      });
+
+  blender::threading::EnumerableThreadSpecific<SDefBindWeightData> bind_weights_tls;
+  blender::threading::parallel_for(
+      blender::IndexRange(verts_num), 256, [&](const blender::IndexRange range) {
+        SDefBindWeightData &bwdata = bind_weights_tls.local();
+        for (const int i : range) {
+          bindVert(&data, &bwdata, i);
+        }
+      });
 
   MEM_freeN(data.targetCos);
 
@@ -1455,8 +1587,9 @@ static void surfacedeformModifier_do(ModifierData *md,
   target_verts_num = BKE_mesh_wrapper_vert_len(target);
   target_polys_num = BKE_mesh_wrapper_poly_len(target);
 
-  /* If not bound, execute bind. */
-  if (smd->verts == nullptr) {
+  /* If not bound (or asked to bind again), execute bind. */
+  const bool do_rebind = (smd->flags & MOD_SDEF_REBIND) && smd->verts != nullptr;
+  if (smd->verts == nullptr || do_rebind) {
     if (!DEG_is_active(ctx->depsgraph)) {
       BKE_modifier_set_error(ob, md, "Attempt to unbind from inactive dependency graph");
       return;
@@ -1466,6 +1599,23 @@ static void surfacedeformModifier_do(ModifierData *md,
         ob, md);
     float tmp_mat[4][4];
 
+    SDefVert *old_verts = nullptr;
+    uint old_verts_num = 0;
+    if (do_rebind) {
+      smd->flags &= ~MOD_SDEF_REBIND;
+      smd_orig->flags &= ~MOD_SDEF_REBIND;
+      /* Binds can only be kept while the deforming mesh has the same vertices. */
+      if (smd_orig->mesh_verts_num == verts_num) {
+        old_verts = smd_orig->verts;
+        old_verts_num = smd_orig->bind_verts_num;
+        smd_orig->verts = nullptr;
+        smd_orig->bind_verts_num = 0;
+      }
+      else {
+        freeData((ModifierData *)smd_orig);
+      }
+    }
+
     invert_m4_m4(tmp_mat, ob->object_to_world);
     mul_m4_m4m4(smd_orig->mat, tmp_mat, ob_target->object_to_world);
 
@@ -1480,9 +1630,14 @@ static void surfacedeformModifier_do(ModifierData *md,
                            target_polys_num,
                            target_verts_num,
                            target,
-                           mesh)) {
+                           mesh,
+                           old_verts,
+                           old_verts_num)) {
       smd->flags &= ~MOD_SDEF_BIND;
     }
+    if (old_verts) {
+      freeBindVerts(old_verts, old_verts_num);
+    }
     /* Early abort, this is binding 'call', no need to perform whole evaluation. */
     return;
   }
@@ -1529,6 +1684,16 @@ static void surfacedeformModifier_do(ModifierData *md,
      * caller needs coordinates of all vertices and asserts for it. */
   }
 
+  /* The same number of elements can still be a different topology, which the binds don't match.
+   * Edit-mode targets aren't converted, they are checked once they are. */
+  if (smd->target_topology_hash != 0 && smd->target_verts_num == target_verts_num &&
+      smd->target_polys_num == target_polys_num &&
+      target->runtime->wrapper_type == ME_WRAPPER_TYPE_MDATA &&
+      targetTopologyHashCached(smd, target) != smd->target_topology_hash) {
+    BKE_modifier_set_error(ob, md, "Target topology changed, rebind to update");
+    return;
+  }
+
   /* Early out if modifier would not affect input at all - still *after* the sanity checks
    * (and potential binding) above. */
   if (smd->strength == 0.0f) {
@@ -1657,7 +1822,18 @@ static void panel_draw(const bContext * /*C*/, Panel *panel)
 
   col = uiLayoutColumn(layout, false);
   if (is_bound) {
-    uiItemO(col, IFACE_("Unbind"), ICON_NONE, "OBJECT_OT_surfacedeform_bind");
+    uiLayout *row = uiLayoutRow(col, true);
+    uiItemO(row, IFACE_("Unbind"), ICON_NONE, "OBJECT_OT_surfacedeform_bind");
+    PointerRNA op_ptr;
+    uiItemFullO(row,
+                "OBJECT_OT_surfacedeform_bind",
+                IFACE_("Rebind"),
+                ICON_NONE,
+                nullptr,
+                WM_OP_INVOKE_DEFAULT,
+                0,
+                &op_ptr);
+    RNA_boolean_set(&op_ptr, "rebind", true);
   }
   else {
     uiLayoutSetActive(col, !RNA_pointer_is_null(&target_ptr));
@@ -1769,7 +1945,7 @@ ModifierTypeInfo modifierType_SurfaceDeform = {
     /*dependsOnNormals*/ nullptr,
     /*foreachIDLink*/ foreachIDLink,
     /*foreachTexLink*/ nullptr,
-    /*freeRuntimeData*/ nullptr,
+    /*freeRuntimeData*/ freeRuntimeData,
     /*panelRegister*/ panelRegister,
     /*blendWrite*/ blendWrite,
     /*blendRead*/ blendRead,
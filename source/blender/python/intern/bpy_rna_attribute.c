@@ -0,0 +1,544 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup pythonintern
+ *
+ * This file extends geometry attributes with a C/Python API that exposes their arrays
+ * through the buffer protocol, so they can be shared with NumPy without copying.
+ */
+
+#define PY_SSIZE_T_CLEAN
+
+#include <Python.h>
+
+#include "DNA_ID.h"
+#include "DNA_customdata_types.h"
+#include "DNA_mesh_types.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_listbase.h"
+#include "BLI_string.h"
+#include "BLI_utildefines.h"
+
+#include "BKE_attribute.h"
+#include "BKE_customdata.h"
+#include "BKE_global.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+
+#include "DEG_depsgraph.h"
+
+#include "RNA_access.h"
+#include "RNA_prototypes.h"
+
+#include "WM_api.h"
+#include "WM_types.h"
+
+#include "bpy_rna.h"
+#include "bpy_rna_attribute.h"
+
+#include "../generic/py_capi_utils.h"
+
+/* -------------------------------------------------------------------- */
+/** \name Attribute Buffer Type
+ *
+ * The buffer only stores how to find the attribute, the owner and the layer are looked up again
+ * every time a buffer is requested. This means a removed ID or attribute raises an exception
+ * instead of exposing freed memory. Every export pins its array (see #CustomData_layer_data_pin),
+ * so removing or reallocating the layer while a `memoryview` or NumPy array still uses it leaves
+ * the old array to the export instead of freeing it.
+ *
+ * Writes to such an orphaned array can't reach the attribute anymore. A writable buffer that had
+ * one of its exports orphaned becomes stale, requesting it again raises a #PyExc_BufferError so
+ * the lost changes don't go unnoticed.
+ * \{ */
+
+typedef struct BPyAttributeBuffer {
+  PyObject_HEAD
+  uint32_t id_session_uuid;
+  short id_type;
+  /**
+   * Owners outside of #Main (such as the result of #Object.to_mesh) can't be found again.
+   * Their array is pinned when the buffer is created and the owner is never accessed again.
+   */
+  bool id_in_main;
+  void *pinned_data;
+  int pinned_len;
+
+  char name[MAX_CUSTOMDATA_LAYER_NAME];
+  eCustomDataType type;
+  eAttrDomain domain;
+  bool writable;
+  /** Writes through an export have been lost, see #attribute_buffer_stale_check. */
+  bool is_stale;
+  /** #BPyAttributeBufferExport items currently in use. */
+  ListBase exports;
+} BPyAttributeBuffer;
+
+/** Every export keeps its own layout, the length may change in between. */
+typedef struct BPyAttributeBufferExport {
+  struct BPyAttributeBufferExport *next, *prev;
+  Py_ssize_t shape[2];
+  Py_ssize_t strides[2];
+  /** Pinned while exported, may be null for empty attributes. */
+  void *data;
+} BPyAttributeBufferExport;
+
+static bool attribute_buffer_format(const eCustomDataType type,
+                                    const char **r_format,
+                                    int *r_itemsize,
+                                    int *r_components)
+{
+  switch (type) {
+    case CD_PROP_FLOAT:
+      *r_format = "f";
+      *r_itemsize = sizeof(float);
+      *r_components = 1;
+      return true;
+    case CD_PROP_FLOAT2:
+      *r_format = "f";
+      *r_itemsize = sizeof(float);
+      *r_components = 2;
+      return true;
+    case CD_PROP_FLOAT3:
+      *r_format = "f";
+      *r_itemsize = sizeof(float);
+      *r_components = 3;
+      return true;
+    case CD_PROP_COLOR:
+      *r_format = "f";
+      *r_itemsize = sizeof(float);
+      *r_components = 4;
+      return true;
+    case CD_PROP_BYTE_COLOR:
+      *r_format = "B";
+      *r_itemsize = sizeof(uchar);
+      *r_components = 4;
+      return true;
+    case CD_PROP_INT32:
+      *r_format = "i";
+      *r_itemsize = sizeof(int);
+      *r_components = 1;
+      return true;
+    case CD_PROP_INT8:
+      *r_format = "b";
+      *r_itemsize = sizeof(int8_t);
+      *r_components = 1;
+      return true;
+    case CD_PROP_BOOL:
+      *r_format = "?";
+      *r_itemsize = sizeof(bool);
+      *r_components = 1;
+      return true;
+    default:
+      return false;
+  }
+}
+
+static ID *attribute_buffer_id_get(BPyAttributeBuffer *self)
+{
+  BLI_assert(self->id_in_main);
+  ID *id = BKE_libblock_find_session_uuid(G_MAIN, self->id_type, self->id_session_uuid);
+  if (id == NULL) {
+    PyErr_Format(PyExc_ReferenceError,
+                 "Attribute buffer \"%s\": the owner data-block has been removed",
+                 self->name);
+  }
+  return id;
+}
+
+static bool attribute_buffer_edit_mode_check(const ID *id, const char *name)
+{
+  if (GS(id->name) == ID_ME && ((const Mesh *)id)->edit_mesh != NULL) {
+    PyErr_Format(PyExc_RuntimeError, "Attribute buffer \"%s\": not available in edit-mode", name);
+    return false;
+  }
+  return true;
+}
+
+static CustomDataLayer *attribute_buffer_layer_get(BPyAttributeBuffer *self,
+                                                   ID *id,
+                                                   CustomData **r_cdata)
+{
+  if (!attribute_buffer_edit_mode_check(id, self->name)) {
+    return NULL;
+  }
+
+  CustomDataLayer *layer = BKE_id_attribute_find(id, self->name, self->type, self->domain);
+  if (layer == NULL) {
+    PyErr_Format(PyExc_ReferenceError,
+                 "Attribute buffer \"%s\": the attribute has been removed",
+                 self->name);
+    return NULL;
+  }
+
+  for (CustomData *cdata = BKE_id_attributes_iterator_next_domain(id, NULL); cdata;
+       cdata = BKE_id_attributes_iterator_next_domain(id, cdata->layers)) {
+    if (ARRAY_HAS_ITEM(layer, cdata->layers, cdata->totlayer)) {
+      *r_cdata = cdata;
+      return layer;
+    }
+  }
+
+  BLI_assert_unreachable();
+  return NULL;
+}
+
+static void attribute_buffer_update_tag(ID *id, const char *name)
+{
+  if (GS(id->name) == ID_ME && STREQ(name, "position")) {
+    BKE_mesh_tag_positions_changed((Mesh *)id);
+  }
+  DEG_id_tag_update(id, ID_RECALC_GEOMETRY);
+  WM_main_add_notifier(NC_GEOM | ND_DATA, id);
+}
+
+/**
+ * Writable exports are only useful as long as they use the array of the attribute,
+ * once their layer has been reallocated the buffer can't be used anymore.
+ */
+static bool attribute_buffer_stale_check(BPyAttributeBuffer *self)
+{
+  if (!self->writable) {
+    return true;
+  }
+  LISTBASE_FOREACH (BPyAttributeBufferExport *, export, &self->exports) {
+    if (export->data && CustomData_layer_data_is_orphan(export->data)) {
+      self->is_stale = true;
+    }
+  }
+  if (self->is_stale) {
+    PyErr_Format(PyExc_BufferError,
+                 "Attribute buffer \"%s\": the attribute has been reallocated while the buffer "
+                 "was in use, writes through it were lost, use as_buffer() again",
+                 self->name);
+    return false;
+  }
+  return true;
+}
+
+static int attribute_buffer_getbuffer(BPyAttributeBuffer *self, Py_buffer *view, int flags)
+{
+  if ((flags & PyBUF_WRITABLE) && !self->writable) {
+    PyErr_Format(PyExc_BufferError,
+                 "Attribute buffer \"%s\": read-only, use as_buffer(writable=True) to modify it",
+                 self->name);
+    return -1;
+  }
+  if (!attribute_buffer_stale_check(self)) {
+    return -1;
+  }
+
+  void *data;
+  int len;
+  if (self->id_in_main) {
+    ID *id = attribute_buffer_id_get(self);
+    if (id == NULL) {
+      return -1;
+    }
+    CustomData *cdata;
+    CustomDataLayer *layer = attribute_buffer_layer_get(self, id, &cdata);
+    if (layer == NULL) {
+      return -1;
+    }
+    len = BKE_id_attribute_data_length(id, layer);
+    /* Referenced layers are copied before they are exposed for writing. */
+    data = self->writable ?
+               CustomData_get_layer_named_for_write(cdata, self->type, self->name, len) :
+               layer->data;
+  }
+  else {
+    data = self->pinned_data;
+    len = self->pinned_len;
+  }
+
+  const char *format;
+  int itemsize, components;
+  attribute_buffer_format(self->type, &format, &itemsize, &components);
+
+  static char data_empty[1];
+  if (PyBuffer_FillInfo(view,
+                        (PyObject *)self,
+                        data ? data : data_empty,
+                        (Py_ssize_t)len * components * itemsize,
+                        !self->writable,
+                        flags) == -1) {
+    return -1;
+  }
+
+  BPyAttributeBufferExport *export = MEM_mallocN(sizeof(*export), __func__);
+  export->shape[0] = len;
+  export->shape[1] = components;
+  export->strides[0] = (Py_ssize_t)components * itemsize;
+  export->strides[1] = itemsize;
+  export->data = data;
+  if (data) {
+    CustomData_layer_data_pin(data);
+  }
+  BLI_addtail(&self->exports, export);
+
+  view->itemsize = itemsize;
+  view->format = (flags & PyBUF_FORMAT) ? (char *)format : NULL;
+  if (flags & PyBUF_ND) {
+    view->ndim = (components == 1) ? 1 : 2;
+    view->shape = export->shape;
+  }
+  if ((flags & PyBUF_STRIDES) == PyBUF_STRIDES) {
+    view->strides = export->strides;
+  }
+  view->internal = export;
+
+  return 0;
+}
+
+static void attribute_buffer_releasebuffer(BPyAttributeBuffer *self, Py_buffer *view)
+{
+  BPyAttributeBufferExport *export = view->internal;
+  BLI_remlink(&self->exports, export);
+  bool is_orphan = false;
+  if (export->data) {
+    is_orphan = CustomData_layer_data_is_orphan(export->data);
+    CustomData_layer_data_unpin(export->data);
+  }
+  MEM_freeN(export);
+
+  if (view->readonly) {
+    return;
+  }
+  if (is_orphan) {
+    /* Nothing to update, the owner doesn't use the modified array anymore. */
+    self->is_stale = true;
+    return;
+  }
+
+  /* The data may have been modified through the buffer, tag the owner if it still exists. */
+  PyObject *error_type, *error_value, *error_traceback;
+  PyErr_Fetch(&error_type, &error_value, &error_traceback);
+  ID *id = attribute_buffer_id_get(self);
+  if (id != NULL) {
+    attribute_buffer_update_tag(id, self->name);
+  }
+  PyErr_Restore(error_type, error_value, error_traceback);
+}
+
+static PyBufferProcs attribute_buffer_as_buffer = {
+    /*bf_getbuffer*/ (getbufferproc)attribute_buffer_getbuffer,
+    /*bf_releasebuffer*/ (releasebufferproc)attribute_buffer_releasebuffer,
+};
+
+static void attribute_buffer_dealloc(BPyAttributeBuffer *self)
+{
+  /* Exports keep a reference to the buffer. */
+  BLI_assert(BLI_listbase_is_empty(&self->exports));
+  if (self->pinned_data) {
+    CustomData_layer_data_unpin(self->pinned_data);
+  }
+  PyObject_Del(self);
+}
+
+static PyObject *attribute_buffer_repr(BPyAttributeBuffer *self)
+{
+  return PyUnicode_FromFormat("<AttributeBuffer \"%s\"%s>",
+                              self->name,
+                              self->writable ? "" : " read-only");
+}
+
+PyDoc_STRVAR(attribute_buffer_update_tag_doc,
+             ".. method:: update_tag()\n"
+             "\n"
+             "   Tag the owner data-block for an update after its data has been modified\n"
+             "   through a buffer that is still in use.\n");
+static PyObject *attribute_buffer_update_tag_py(BPyAttributeBuffer *self)
+{
+  if (!self->id_in_main) {
+    /* Read-only, there is nothing to update. */
+    Py_RETURN_NONE;
+  }
+  if (!attribute_buffer_stale_check(self)) {
+    return NULL;
+  }
+  ID *id = attribute_buffer_id_get(self);
+  if (id == NULL) {
+    return NULL;
+  }
+  attribute_buffer_update_tag(id, self->name);
+  Py_RETURN_NONE;
+}
+
+static PyMethodDef attribute_buffer_methods[] = {
+    {"update_tag",
+     (PyCFunction)attribute_buffer_update_tag_py,
+     METH_NOARGS,
+     attribute_buffer_update_tag_doc},
+    {NULL, NULL, 0, NULL},
+};
+
+static PyTypeObject BPyAttributeBuffer_Type = {
+    PyVarObject_HEAD_INIT(NULL, 0).tp_name = "AttributeBuffer",
+    .tp_basicsize = sizeof(BPyAttributeBuffer),
+    .tp_dealloc = (destructor)attribute_buffer_dealloc,
+    .tp_repr = (reprfunc)attribute_buffer_repr,
+    .tp_as_buffer = &attribute_buffer_as_buffer,
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_methods = attribute_buffer_methods,
+};
+
+static PyObject *attribute_buffer_create(ID *id,
+                                         CustomDataLayer *layer,
+                                         const eAttrDomain domain,
+                                         const bool writable)
+{
+  const char *format;
+  int itemsize, components;
+  if (!attribute_buffer_format(layer->type, &format, &itemsize, &components)) {
+    PyErr_Format(PyExc_TypeError,
+                 "Attribute \"%s\": the data type doesn't support buffer access",
+                 layer->name);
+    return NULL;
+  }
+  const bool id_in_main = (id->tag & LIB_TAG_NO_MAIN) == 0;
+  if (writable && !(id_in_main && BKE_id_is_editable(G_MAIN, id))) {
+    PyErr_Format(
+        PyExc_TypeError, "Attribute \"%s\": the data-block can't be modified", layer->name);
+    return NULL;
+  }
+  if (!id_in_main && !attribute_buffer_edit_mode_check(id, layer->name)) {
+    return NULL;
+  }
+
+  BPyAttributeBuffer *ret = PyObject_New(BPyAttributeBuffer, &BPyAttributeBuffer_Type);
+  ret->id_session_uuid = id->session_uuid;
+  ret->id_type = GS(id->name);
+  ret->id_in_main = id_in_main;
+  ret->pinned_data = NULL;
+  ret->pinned_len = 0;
+  if (!id_in_main && layer->data) {
+    ret->pinned_data = layer->data;
+    ret->pinned_len = BKE_id_attribute_data_length(id, layer);
+    CustomData_layer_data_pin(ret->pinned_data);
+  }
+  STRNCPY(ret->name, layer->name);
+  ret->type = layer->type;
+  ret->domain = domain;
+  ret->writable = writable;
+  ret->is_stale = false;
+  BLI_listbase_clear(&ret->exports);
+  return (PyObject *)ret;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Attribute Methods
+ * \{ */
+
+PyDoc_STRVAR(bpy_rna_attribute_as_buffer_doc,
+             ".. method:: as_buffer(*, writable=False)\n"
+             "\n"
+             "   Access the attribute values without copying them, through the buffer protocol\n"
+             "   (``numpy.asarray(attribute.as_buffer())`` for example).\n"
+             "   Vector and color types have a second dimension for their components,\n"
+             "   byte colors are exposed as stored (sRGB).\n"
+             "\n"
+             "   :arg writable: Allow modifying the values, the owner data-block is tagged\n"
+             "      for an update when a writable buffer is released.\n"
+             "      Only supported for data-blocks in :mod:`bpy.data`.\n"
+             "      Changing the size of the attribute while it's in use discards the writes,\n"
+             "      the buffer raises a :class:`BufferError` from then on.\n"
+             "   :type writable: bool\n"
+             "   :return: An object supporting the buffer protocol, which raises a\n"
+             "      :class:`ReferenceError` once the attribute or its owner have been removed.\n"
+             "   :rtype: AttributeBuffer\n");
+static PyObject *bpy_rna_attribute_as_buffer(PyObject *self, PyObject *args, PyObject *kwds)
+{
+  const PointerRNA *ptr = pyrna_struct_as_ptr(self, &RNA_Attribute);
+  if (ptr == NULL) {
+    return NULL;
+  }
+
+  bool writable = false;
+  static const char *_keywords[] = {"writable", NULL};
+  static _PyArg_Parser _parser = {
+      "|$" /* Optional keyword only arguments. */
+      "O&" /* `writable` */
+      ":as_buffer",
+      _keywords,
+      0,
+  };
+  if (!_PyArg_ParseTupleAndKeywordsFast(args, kwds, &_parser, PyC_ParseBool, &writable)) {
+    return NULL;
+  }
+
+  ID *id = ptr->owner_id;
+  CustomDataLayer *layer = ptr->data;
+  return attribute_buffer_create(id, layer, BKE_id_attribute_domain(id, layer), writable);
+}
+
+PyDoc_STRVAR(bpy_rna_mesh_vertices_as_buffer_doc,
+             ".. method:: as_buffer(attribute=\"position\", *, writable=False)\n"
+             "\n"
+             "   Access a vertex attribute without copying it, see :meth:`Attribute.as_buffer`.\n"
+             "\n"
+             "   :arg attribute: Name of the point domain attribute, the vertex positions\n"
+             "      by default.\n"
+             "   :type attribute: str\n"
+             "   :arg writable: Allow modifying the values.\n"
+             "   :type writable: bool\n"
+             "   :rtype: AttributeBuffer\n");
+static PyObject *bpy_rna_mesh_vertices_as_buffer(PyObject *self, PyObject *args, PyObject *kwds)
+{
+  ID *id = BPy_PropertyRNA_Check(self) ? ((BPy_PropertyRNA *)self)->ptr.owner_id : NULL;
+  if (id == NULL || GS(id->name) != ID_ME) {
+    PyErr_SetString(PyExc_TypeError, "as_buffer(): expected a mesh vertices collection");
+    return NULL;
+  }
+
+  const char *name = "position";
+  bool writable = false;
+  static const char *_keywords[] = {"attribute", "writable", NULL};
+  static _PyArg_Parser _parser = {
+      "|"  /* Optional arguments. */
+      "s"  /* `attribute` */
+      "$"  /* Keyword only arguments. */
+      "O&" /* `writable` */
+      ":as_buffer",
+      _keywords,
+      0,
+  };
+  if (!_PyArg_ParseTupleAndKeywordsFast(args, kwds, &_parser, &name, PyC_ParseBool, &writable)) {
+    return NULL;
+  }
+
+  CustomDataLayer *layer = BKE_id_attribute_search(
+      id, name, CD_MASK_PROP_ALL, ATTR_DOMAIN_MASK_POINT);
+  if (layer == NULL) {
+    PyErr_Format(PyExc_KeyError, "as_buffer(): no vertex attribute named \"%s\"", name);
+    return NULL;
+  }
+  return attribute_buffer_create(id, layer, ATTR_DOMAIN_POINT, writable);
+}
+
+/** \} */
+
+PyMethodDef BPY_rna_attribute_as_buffer_method_def = {
+    "as_buffer",
+    (PyCFunction)bpy_rna_attribute_as_buffer,
+    METH_VARARGS | METH_KEYWORDS,
+    bpy_rna_attribute_as_buffer_doc,
+};
+
+PyMethodDef BPY_rna_mesh_vertices_as_buffer_method_def = {
+    "as_buffer",
+    (PyCFunction)bpy_rna_mesh_vertices_as_buffer,
+    METH_VARARGS | METH_KEYWORDS,
+    bpy_rna_mesh_vertices_as_buffer_doc,
+};
+
+void bpy_rna_attribute_types_init(void)
+{
+  if (PyType_Ready(&BPyAttributeBuffer_Type) < 0) {
+    BLI_assert_unreachable();
+    return;
+  }
+}
@@ -0,0 +1,20 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup pythonintern
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern PyMethodDef BPY_rna_attribute_as_buffer_method_def;
+extern PyMethodDef BPY_rna_mesh_vertices_as_buffer_method_def;
+
+void bpy_rna_attribute_types_init(void);
+
+#ifdef __cplusplus
+}
+#endif
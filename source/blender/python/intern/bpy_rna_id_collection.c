@@ -12,14 +12,23 @@
 #include "MEM_guardedalloc.h"
 
 #include "BLI_bitmap.h"
+#include "BLI_string.h"
+#include "BLI_string_utf8.h"
 #include "BLI_utildefines.h"
 
+#include "BKE_collection.h"
 #include "BKE_global.h"
 #include "BKE_lib_id.h"
 #include "BKE_lib_query.h"
 #include "BKE_main.h"
+#include "BKE_material.h"
+#include "BKE_object.h"
+
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_query.h"
 
 #include "DNA_ID.h"
+#include "DNA_collection_types.h"
 /* Those following are only to support hack of not listing some internal
  * 'backward' pointers in generated user_map. */
 #include "DNA_key_types.h"
@@ -37,6 +46,7 @@
 
 #include "RNA_access.h"
 #include "RNA_enum_types.h"
+#include "RNA_prototypes.h"
 #include "RNA_types.h"
 
 #include "bpy_rna.h"
@@ -413,6 +423,220 @@ static PyObject *bpy_orphans_purge(PyObject *UNUSED(self), PyObject *args, PyObj
   return PyLong_FromSize_t(num_datablocks_deleted);
 }
 
+PyDoc_STRVAR(bpy_objects_batch_new_doc,
+             ".. method:: batch_new(names, object_data=None)\n"
+             "\n"
+             "   Add several new objects to the main database at once.\n"
+             "\n"
+             "   This is much quicker than individual calls to :func:`new()` when creating "
+             "many objects,\n"
+             "   unique names are ensured for all of them, but objects are sorted in the "
+             "database only once.\n"
+             "\n"
+             "   :arg names: Names for the new objects.\n"
+             "   :type names: sequence of strings\n"
+             "   :arg object_data: Object data shared by all new objects, or None for empties.\n"
+             "   :type object_data: :class:`bpy.types.ID`\n"
+             "   :return: The new objects, in the same order as the names.\n"
+             "   :rtype: list of :class:`bpy.types.Object`\n");
+static PyObject *bpy_objects_batch_new(PyObject *self, PyObject *args, PyObject *kwds)
+{
+  if (!BPy_PropertyRNA_Check(self) || ((BPy_PropertyRNA *)self)->ptr.type != &RNA_BlendData) {
+    PyErr_SetString(PyExc_TypeError, "batch_new(): expected a main objects collection");
+    return NULL;
+  }
+  Main *bmain = ((BPy_PropertyRNA *)self)->ptr.data;
+
+  PyObject *names = NULL;
+  PyObject *py_data = Py_None;
+
+  static const char *_keywords[] = {"names", "object_data", NULL};
+  static _PyArg_Parser _parser = {
+      "O" /* `names` */
+      "|" /* Optional arguments. */
+      "O" /* `object_data` */
+      ":batch_new",
+      _keywords,
+      0,
+  };
+  if (!_PyArg_ParseTupleAndKeywordsFast(args, kwds, &_parser, &names, &py_data)) {
+    return NULL;
+  }
+
+  ID *data = NULL;
+  int type = OB_EMPTY;
+  if (py_data != Py_None) {
+    if (!pyrna_id_FromPyObject(py_data, &data)) {
+      PyErr_Format(PyExc_TypeError,
+                   "batch_new(): expected an ID type or None for object_data, not %.200s",
+                   Py_TYPE(py_data)->tp_name);
+      return NULL;
+    }
+    if (data->tag & LIB_TAG_NO_MAIN) {
+      PyErr_SetString(PyExc_RuntimeError,
+                      "batch_new(): can not create objects in main database with an evaluated "
+                      "data data-block");
+      return NULL;
+    }
+    type = BKE_object_obdata_to_type(data);
+    if (type == -1) {
+      PyErr_Format(PyExc_TypeError,
+                   "batch_new(): ID '%s' is not valid as object data",
+                   data->name + 2);
+      return NULL;
+    }
+  }
+
+  PyObject *names_fast = PySequence_Fast(names, "batch_new");
+  if (names_fast == NULL) {
+    return NULL;
+  }
+  PyObject **names_array = PySequence_Fast_ITEMS(names_fast);
+  const int names_len = (int)PySequence_Fast_GET_SIZE(names_fast);
+
+  /* Check all names first, so that no object is created on error. */
+  for (int i = 0; i < names_len; i++) {
+    if (!PyUnicode_Check(names_array[i])) {
+      PyErr_Format(PyExc_TypeError,
+                   "batch_new(): expected a string for names, not %.200s",
+                   Py_TYPE(names_array[i])->tp_name);
+      Py_DECREF(names_fast);
+      return NULL;
+    }
+  }
+
+  Object **objects = MEM_malloc_arrayN((size_t)names_len, sizeof(*objects), __func__);
+  for (int i = 0; i < names_len; i++) {
+    const char *name = PyUnicode_AsUTF8(names_array[i]);
+    if (name == NULL) {
+      /* Only happens with invalid surrogates, use the default name. */
+      PyErr_Clear();
+      name = "";
+    }
+    char safe_name[MAX_ID_NAME - 2];
+    BLI_strncpy(safe_name, name, sizeof(safe_name));
+    BLI_str_utf8_invalid_strip(safe_name, strlen(safe_name));
+
+    /* Objects are created outside of Main, to only sort them once when adding them below. */
+    Object *ob = BKE_object_add_only_object(NULL, type, safe_name);
+    ob->data = data;
+    if (data != NULL) {
+      id_us_plus(data);
+    }
+    objects[i] = ob;
+  }
+  Py_DECREF(names_fast);
+
+  BKE_libblock_management_main_add_multiple(bmain, (ID **)objects, names_len);
+
+  PyObject *ret = PyList_New(names_len);
+  for (int i = 0; i < names_len; i++) {
+    Object *ob = objects[i];
+    if (data != NULL) {
+      BKE_object_materials_test(bmain, ob, ob->data);
+    }
+    PyList_SET_ITEM(ret, i, pyrna_id_CreatePyObject(&ob->id));
+  }
+  MEM_freeN(objects);
+
+  WM_main_add_notifier(NC_ID | NA_ADDED, NULL);
+
+  return ret;
+}
+
+PyDoc_STRVAR(bpy_collection_objects_batch_link_doc,
+             ".. method:: batch_link(objects)\n"
+             "\n"
+             "   Add several objects to this collection at once.\n"
+             "\n"
+             "   This is much quicker than individual calls to :func:`link()`, view layers and "
+             "dependency graph\n"
+             "   relations are only updated once. Objects already in the collection are "
+             "skipped.\n"
+             "\n"
+             "   :arg objects: Objects to add to the collection.\n"
+             "   :type objects: sequence of :class:`bpy.types.Object`\n"
+             "   :return: The number of objects added to the collection.\n"
+             "   :rtype: int\n");
+static PyObject *bpy_collection_objects_batch_link(PyObject *self, PyObject *args, PyObject *kwds)
+{
+  ID *owner_id = BPy_PropertyRNA_Check(self) ? ((BPy_PropertyRNA *)self)->ptr.owner_id : NULL;
+  if (owner_id == NULL || GS(owner_id->name) != ID_GR) {
+    PyErr_SetString(PyExc_TypeError, "batch_link(): expected a collection objects collection");
+    return NULL;
+  }
+  Main *bmain = G_MAIN; /* XXX Ugly, but should work! */
+  Collection *collection = (Collection *)((BPy_PropertyRNA *)self)->ptr.data;
+
+  PyObject *objects = NULL;
+
+  static const char *_keywords[] = {"objects", NULL};
+  static _PyArg_Parser _parser = {
+      "O" /* `objects` */
+      ":batch_link",
+      _keywords,
+      0,
+  };
+  if (!_PyArg_ParseTupleAndKeywordsFast(args, kwds, &_parser, &objects)) {
+    return NULL;
+  }
+
+  /* Same checks as `CollectionObjects.link`. */
+  if (!DEG_is_original_id(&collection->id)) {
+    PyErr_Format(PyExc_RuntimeError,
+                 "batch_link(): collection '%s' is not an original ID",
+                 collection->id.name + 2);
+    return NULL;
+  }
+  if (ID_IS_OVERRIDE_LIBRARY(&collection->id) || ID_IS_LINKED(&collection->id)) {
+    PyErr_Format(PyExc_RuntimeError,
+                 "batch_link(): could not link objects because the collection '%s' is %s",
+                 collection->id.name + 2,
+                 ID_IS_LINKED(&collection->id) ? "linked" : "overridden");
+    return NULL;
+  }
+
+  PyObject *objects_fast = PySequence_Fast(objects, "batch_link");
+  if (objects_fast == NULL) {
+    return NULL;
+  }
+  PyObject **objects_array = PySequence_Fast_ITEMS(objects_fast);
+  const int objects_len = (int)PySequence_Fast_GET_SIZE(objects_fast);
+
+  Object **obs = MEM_malloc_arrayN((size_t)objects_len, sizeof(*obs), __func__);
+  for (int i = 0; i < objects_len; i++) {
+    ID *id;
+    if (!pyrna_id_FromPyObject(objects_array[i], &id) || GS(id->name) != ID_OB) {
+      PyErr_Format(PyExc_TypeError,
+                   "batch_link(): expected an Object, not %.200s",
+                   Py_TYPE(objects_array[i])->tp_name);
+      MEM_freeN(obs);
+      Py_DECREF(objects_fast);
+      return NULL;
+    }
+    if (!DEG_is_original_id(id)) {
+      PyErr_Format(
+          PyExc_RuntimeError, "batch_link(): object '%s' is not an original ID", id->name + 2);
+      MEM_freeN(obs);
+      Py_DECREF(objects_fast);
+      return NULL;
+    }
+    obs[i] = (Object *)id;
+  }
+  Py_DECREF(objects_fast);
+
+  const int added_len = BKE_collection_object_add_multiple(bmain, collection, obs, objects_len);
+  MEM_freeN(obs);
+
+  if (added_len != 0) {
+    DEG_id_tag_update(&collection->id, ID_RECALC_COPY_ON_WRITE);
+    DEG_relations_tag_update(bmain);
+    WM_main_add_notifier(NC_OBJECT | ND_DRAW, NULL);
+  }
+
+  return PyLong_FromLong(added_len);
+}
+
 PyMethodDef BPY_rna_id_collection_user_map_method_def = {
     "user_map",
     (PyCFunction)bpy_user_map,
@@ -431,3 +655,15 @@ PyMethodDef BPY_rna_id_collection_orphans_purge_method_def = {
     METH_STATIC | METH_VARARGS | METH_KEYWORDS,
     bpy_orphans_purge_doc,
 };
+PyMethodDef BPY_rna_id_collection_objects_batch_new_method_def = {
+    "batch_new",
+    (PyCFunction)bpy_objects_batch_new,
+    METH_VARARGS | METH_KEYWORDS,
+    bpy_objects_batch_new_doc,
+};
+PyMethodDef BPY_rna_collection_objects_batch_link_method_def = {
+    "batch_link",
+    (PyCFunction)bpy_collection_objects_batch_link,
+    METH_VARARGS | METH_KEYWORDS,
+    bpy_collection_objects_batch_link_doc,
+};
@@ -13,6 +13,8 @@ extern "C" {
 extern PyMethodDef BPY_rna_id_collection_user_map_method_def;
 extern PyMethodDef BPY_rna_id_collection_batch_remove_method_def;
 extern PyMethodDef BPY_rna_id_collection_orphans_purge_method_def;
+extern PyMethodDef BPY_rna_id_collection_objects_batch_new_method_def;
+extern PyMethodDef BPY_rna_collection_objects_batch_link_method_def;
 
 #ifdef __cplusplus
 }
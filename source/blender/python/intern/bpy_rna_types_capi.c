@@ -21,6 +21,7 @@
 
 #include "bpy_library.h"
 #include "bpy_rna.h"
+#include "bpy_rna_attribute.h"
 #include "bpy_rna_callback.h"
 #include "bpy_rna_context.h"
 #include "bpy_rna_data.h"
@@ -54,6 +55,28 @@ static struct PyMethodDef pyrna_blenddata_methods[] = {
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Blend Data Objects
+ * \{ */
+
+static struct PyMethodDef pyrna_blenddataobjects_methods[] = {
+    {NULL, NULL, 0, NULL}, /* #BPY_rna_id_collection_objects_batch_new_method_def */
+    {NULL, NULL, 0, NULL},
+};
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Collection Objects
+ * \{ */
+
+static struct PyMethodDef pyrna_collectionobjects_methods[] = {
+    {NULL, NULL, 0, NULL}, /* #BPY_rna_collection_objects_batch_link_method_def */
+    {NULL, NULL, 0, NULL},
+};
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name Blend Data Libraries
  * \{ */
@@ -88,6 +111,22 @@ static struct PyMethodDef pyrna_operator_methods[] = {
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Attribute
+ * \{ */
+
+static struct PyMethodDef pyrna_attribute_methods[] = {
+    {NULL, NULL, 0, NULL}, /* #BPY_rna_attribute_as_buffer_method_def */
+    {NULL, NULL, 0, NULL},
+};
+
+static struct PyMethodDef pyrna_mesh_vertices_methods[] = {
+    {NULL, NULL, 0, NULL}, /* #BPY_rna_mesh_vertices_as_buffer_method_def */
+    {NULL, NULL, 0, NULL},
+};
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name Text Editor
  * \{ */
@@ -273,6 +312,18 @@ void BPY_rna_types_extend_capi(void)
   BLI_assert(ARRAY_SIZE(pyrna_blenddata_methods) == 5);
   pyrna_struct_type_extend_capi(&RNA_BlendData, pyrna_blenddata_methods, NULL);
 
+  /* BlendDataObjects */
+  ARRAY_SET_ITEMS(pyrna_blenddataobjects_methods,
+                  BPY_rna_id_collection_objects_batch_new_method_def);
+  BLI_assert(ARRAY_SIZE(pyrna_blenddataobjects_methods) == 2);
+  pyrna_struct_type_extend_capi(&RNA_BlendDataObjects, pyrna_blenddataobjects_methods, NULL);
+
+  /* CollectionObjects */
+  ARRAY_SET_ITEMS(pyrna_collectionobjects_methods,
+                  BPY_rna_collection_objects_batch_link_method_def);
+  BLI_assert(ARRAY_SIZE(pyrna_collectionobjects_methods) == 2);
+  pyrna_struct_type_extend_capi(&RNA_CollectionObjects, pyrna_collectionobjects_methods, NULL);
+
   /* BlendDataLibraries */
   ARRAY_SET_ITEMS(
       pyrna_blenddatalibraries_methods, BPY_library_load_method_def, BPY_library_write_method_def);
@@ -287,6 +338,17 @@ void BPY_rna_types_extend_capi(void)
   /* Space */
   pyrna_struct_type_extend_capi(&RNA_Space, pyrna_space_methods, NULL);
 
+  /* Attribute */
+  bpy_rna_attribute_types_init();
+
+  ARRAY_SET_ITEMS(pyrna_attribute_methods, BPY_rna_attribute_as_buffer_method_def);
+  BLI_assert(ARRAY_SIZE(pyrna_attribute_methods) == 2);
+  pyrna_struct_type_extend_capi(&RNA_Attribute, pyrna_attribute_methods, NULL);
+
+  ARRAY_SET_ITEMS(pyrna_mesh_vertices_methods, BPY_rna_mesh_vertices_as_buffer_method_def);
+  BLI_assert(ARRAY_SIZE(pyrna_mesh_vertices_methods) == 2);
+  pyrna_struct_type_extend_capi(&RNA_MeshVertices, pyrna_mesh_vertices_methods, NULL);
+
   /* Text Editor */
   ARRAY_SET_ITEMS(pyrna_text_methods,
                   BPY_rna_region_as_string_method_def,
@@ -51,7 +51,10 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "BLI_array.hh"
 #include "BLI_math.h"
+#include "BLI_task.hh"
+#include "BLI_vector.hh"
 
 #include "DNA_mesh_types.h"
 #include "DNA_meshdata_types.h"
@@ -157,7 +160,7 @@ void RE_bake_margin(ImBuf *ibuf,
     default:
     /* fall through */
     case R_BAKE_EXTEND:
-      IMB_filter_extend(ibuf, mask, margin);
+      IMB_filter_extend_nearest(ibuf, mask, margin);
       break;
   }
 
@@ -314,6 +317,7 @@ static void barycentric_differentials_from_position(const float co[3],
 
 /**
  * This function populates pixel_array and returns TRUE if things are correct
+ * \param hits: Scratch buffer with one element per `highpoly` object.
  */
 static bool cast_ray_highpoly(BVHTreeFromMesh *treeData,
                               TriTessFace *triangle_low,
@@ -326,7 +330,8 @@ static bool cast_ray_highpoly(BVHTreeFromMesh *treeData,
                               const float dir[3],
                               const int pixel_id,
                               const int tot_highpoly,
-                              const float max_ray_distance)
+                              const float max_ray_distance,
+                              BVHTreeRayHit *hits)
 {
   int i;
   int hit_mesh = -1;
@@ -336,10 +341,6 @@ static bool cast_ray_highpoly(BVHTreeFromMesh *treeData,
     hit_distance_squared = FLT_MAX;
   }
 
-  BVHTreeRayHit *hits;
-  hits = static_cast<BVHTreeRayHit *>(
-      MEM_mallocN(sizeof(BVHTreeRayHit) * tot_highpoly, "Bake Highpoly to Lowpoly: BVH Rays"));
-
   for (i = 0; i < tot_highpoly; i++) {
     float co_high[3], dir_high[3];
 
@@ -441,7 +442,6 @@ static bool cast_ray_highpoly(BVHTreeFromMesh *treeData,
     pixel_array[pixel_id].seed = 0;
   }
 
-  MEM_freeN(hits);
   return hit_mesh != -1;
 }
 
@@ -557,8 +557,6 @@ bool RE_bake_pixels_populate_from_objects(Mesh *me_low,
                                           Mesh *me_cage)
 {
   size_t i;
-  int primitive_id;
-  float u, v;
   float imat_low[4][4];
   bool is_cage = me_cage != nullptr;
   bool result = true;
@@ -612,55 +610,63 @@ bool RE_bake_pixels_populate_from_objects(Mesh *me_low,
     }
   }
 
-  for (i = 0; i < pixels_num; i++) {
-    float co[3];
-    float dir[3];
-    TriTessFace *tri_low;
-
-    primitive_id = pixel_array_from[i].primitive_id;
-
-    if (primitive_id == -1) {
-      pixel_array_to[i].primitive_id = -1;
-      continue;
-    }
-
-    u = pixel_array_from[i].uv[0];
-    v = pixel_array_from[i].uv[1];
-
-    /* calculate from low poly mesh cage */
-    if (is_custom_cage) {
-      calc_point_from_barycentric_cage(
-          tris_low, tris_cage, mat_low, mat_cage, primitive_id, u, v, co, dir);
-      tri_low = &tris_cage[primitive_id];
-    }
-    else if (is_cage) {
-      calc_point_from_barycentric_extrusion(
-          tris_cage, mat_low, imat_low, primitive_id, u, v, cage_extrusion, co, dir, true);
-      tri_low = &tris_cage[primitive_id];
-    }
-    else {
-      calc_point_from_barycentric_extrusion(
-          tris_low, mat_low, imat_low, primitive_id, u, v, cage_extrusion, co, dir, false);
-      tri_low = &tris_low[primitive_id];
-    }
-
-    /* cast ray */
-    if (!cast_ray_highpoly(treeData,
-                           tri_low,
-                           tris_high,
-                           pixel_array_from,
-                           pixel_array_to,
-                           mat_low,
-                           highpoly,
-                           co,
-                           dir,
-                           i,
-                           tot_highpoly,
-                           max_ray_distance)) {
-      /* if it fails mask out the original pixel array */
-      pixel_array_from[i].primitive_id = -1;
-    }
-  }
+  /* Pixels are cast in contiguous ranges, neighboring pixels of a triangle are stored next to each
+   * other and their rays tend to traverse the same parts of the BVH trees. */
+  blender::threading::parallel_for(
+      blender::IndexRange(pixels_num), 1024, [&](const blender::IndexRange range) {
+        blender::Array<BVHTreeRayHit> hits(tot_highpoly);
+
+        for (const int64_t i : range) {
+          float co[3];
+          float dir[3];
+          TriTessFace *tri_low;
+
+          const int primitive_id = pixel_array_from[i].primitive_id;
+
+          if (primitive_id == -1) {
+            pixel_array_to[i].primitive_id = -1;
+            continue;
+          }
+
+          const float u = pixel_array_from[i].uv[0];
+          const float v = pixel_array_from[i].uv[1];
+
+          /* calculate from low poly mesh cage */
+          if (is_custom_cage) {
+            calc_point_from_barycentric_cage(
+                tris_low, tris_cage, mat_low, mat_cage, primitive_id, u, v, co, dir);
+            tri_low = &tris_cage[primitive_id];
+          }
+          else if (is_cage) {
+            calc_point_from_barycentric_extrusion(
+                tris_cage, mat_low, imat_low, primitive_id, u, v, cage_extrusion, co, dir, true);
+            tri_low = &tris_cage[primitive_id];
+          }
+          else {
+            calc_point_from_barycentric_extrusion(
+                tris_low, mat_low, imat_low, primitive_id, u, v, cage_extrusion, co, dir, false);
+            tri_low = &tris_low[primitive_id];
+          }
+
+          /* cast ray */
+          if (!cast_ray_highpoly(treeData,
+                                 tri_low,
+                                 tris_high,
+                                 pixel_array_from,
+                                 pixel_array_to,
+                                 mat_low,
+                                 highpoly,
+                                 co,
+                                 dir,
+                                 int(i),
+                                 tot_highpoly,
+                                 max_ray_distance,
+                                 hits.data())) {
+            /* if it fails mask out the original pixel array */
+            pixel_array_from[i].primitive_id = -1;
+          }
+        }
+      });
 
   /* garbage collection */
 cleanup:
@@ -714,12 +720,35 @@ static void bake_differentials(BakeDataZSpan *bd,
   }
 }
 
+/** Number of image rows rasterized by one task. */
+#define BAKE_RASTER_BAND_SIZE 64
+
+/** Compute triangle vertex coordinates in the pixel space of the image. */
+static void bake_triangle_pixel_coords(const BakeImage *bk_image,
+                                       const float (*mloopuv)[2],
+                                       const MLoopTri *lt,
+                                       float r_vec[3][2])
+{
+  for (int a = 0; a < 3; a++) {
+    const float *uv = mloopuv[lt->tri[a]];
+
+    /* NOTE(@ideasman42): workaround for pixel aligned UVs which are common and can screw up our
+     * intersection tests where a pixel gets in between 2 faces or the middle of a quad,
+     * camera aligned quads also have this problem but they are less common.
+     * Add a small offset to the UVs, fixes bug #18685. */
+    r_vec[a][0] = (uv[0] - bk_image->uv_offset[0]) * float(bk_image->width) - (0.5f + 0.001f);
+    r_vec[a][1] = (uv[1] - bk_image->uv_offset[1]) * float(bk_image->height) - (0.5f + 0.002f);
+  }
+}
+
 void RE_bake_pixels_populate(Mesh *me,
                              BakePixel pixel_array[],
                              const size_t pixels_num,
                              const BakeTargets *targets,
                              const char *uv_layer)
 {
+  using namespace blender;
+
   const float(*mloopuv)[2];
   if ((uv_layer == nullptr) || (uv_layer[0] == '\0')) {
     mloopuv = static_cast<const float(*)[2]>(CustomData_get_layer(&me->ldata, CD_PROP_FLOAT2));
@@ -734,19 +763,13 @@ void RE_bake_pixels_populate(Mesh *me,
     return;
   }
 
-  BakeDataZSpan bd;
-  bd.pixel_array = pixel_array;
-  bd.zspan = MEM_cnew_array<ZSpan>(targets->images_num, "bake zspan");
-
   /* initialize all pixel arrays so we know which ones are 'blank' */
-  for (int i = 0; i < pixels_num; i++) {
-    pixel_array[i].primitive_id = -1;
-    pixel_array[i].object_id = 0;
-  }
-
-  for (int i = 0; i < targets->images_num; i++) {
-    zbuf_alloc_span(&bd.zspan[i], targets->images[i].width, targets->images[i].height);
-  }
+  threading::parallel_for(IndexRange(pixels_num), 4096, [&](const IndexRange range) {
+    for (const int64_t i : range) {
+      pixel_array[i].primitive_id = -1;
+      pixel_array[i].object_id = 0;
+    }
+  });
 
   const int tottri = poly_to_tri_count(me->totpoly, me->totloop);
   MLoopTri *looptri = static_cast<MLoopTri *>(MEM_mallocN(sizeof(*looptri) * tottri, __func__));
@@ -757,49 +780,86 @@ void RE_bake_pixels_populate(Mesh *me,
   const int *material_indices = BKE_mesh_material_indices(me);
   const int materials_num = targets->materials_num;
 
+  /* Every image is split into bands of rows that are rasterized in parallel, each with its own
+   * span buffers. Triangles are added to the bands they overlap in order, so when triangles
+   * overlap in UV space the last one still wins, as when rasterizing the whole image at once. */
+  Array<int> band_offsets(targets->images_num + 1);
+  band_offsets[0] = 0;
+  for (int image_id = 0; image_id < targets->images_num; image_id++) {
+    const int bands_num = divide_ceil_u(targets->images[image_id].height, BAKE_RASTER_BAND_SIZE);
+    band_offsets[image_id + 1] = band_offsets[image_id] + bands_num;
+  }
+  Array<Vector<int>> band_tris(band_offsets.last());
+
   for (int i = 0; i < tottri; i++) {
     const MLoopTri *lt = &looptri[i];
 
-    bd.primitive_id = i;
-
     /* Find images matching this material. */
     const int material_index = (material_indices && materials_num) ?
                                    clamp_i(material_indices[lt->poly], 0, materials_num - 1) :
                                    0;
     Image *image = targets->material_to_image[material_index];
     for (int image_id = 0; image_id < targets->images_num; image_id++) {
-      BakeImage *bk_image = &targets->images[image_id];
+      const BakeImage *bk_image = &targets->images[image_id];
       if (bk_image->image != image) {
         continue;
       }
 
-      /* Compute triangle vertex UV coordinates. */
       float vec[3][2];
-      for (int a = 0; a < 3; a++) {
-        const float *uv = mloopuv[lt->tri[a]];
-
-        /* NOTE(@ideasman42): workaround for pixel aligned UVs which are common and can screw
-         * up our intersection tests where a pixel gets in between 2 faces or the middle of a quad,
-         * camera aligned quads also have this problem but they are less common.
-         * Add a small offset to the UVs, fixes bug #18685. */
-        vec[a][0] = (uv[0] - bk_image->uv_offset[0]) * float(bk_image->width) - (0.5f + 0.001f);
-        vec[a][1] = (uv[1] - bk_image->uv_offset[1]) * float(bk_image->height) - (0.5f + 0.002f);
-      }
+      bake_triangle_pixel_coords(bk_image, mloopuv, lt, vec);
 
-      /* Rasterize triangle. */
-      bd.bk_image = bk_image;
-      bake_differentials(&bd, vec[0], vec[1], vec[2]);
-      zspan_scanconvert(
-          &bd.zspan[image_id], (void *)&bd, vec[0], vec[1], vec[2], store_bake_pixel);
+      const float miny = min_fff(vec[0][1], vec[1][1], vec[2][1]);
+      const float maxy = max_fff(vec[0][1], vec[1][1], vec[2][1]);
+      if (maxy < 0.0f || miny >= float(bk_image->height)) {
+        continue;
+      }
+      const int band_min = int(floorf(max_ff(miny, 0.0f))) / BAKE_RASTER_BAND_SIZE;
+      const int band_max = int(ceilf(min_ff(maxy, float(bk_image->height - 1)))) /
+                           BAKE_RASTER_BAND_SIZE;
+      for (int band = band_min; band <= band_max; band++) {
+        band_tris[band_offsets[image_id] + band].append(i);
+      }
     }
   }
 
-  for (int i = 0; i < targets->images_num; i++) {
-    zbuf_free_span(&bd.zspan[i]);
-  }
+  threading::parallel_for(band_tris.index_range(), 1, [&](const IndexRange range) {
+    for (const int64_t band_index : range) {
+      const Span<int> tris = band_tris[band_index];
+      if (tris.is_empty()) {
+        continue;
+      }
+
+      int image_id = 0;
+      while (band_offsets[image_id + 1] <= band_index) {
+        image_id++;
+      }
+      BakeImage *bk_image = &targets->images[image_id];
+      const int band_miny = int(band_index - band_offsets[image_id]) * BAKE_RASTER_BAND_SIZE;
+
+      ZSpan zspan;
+      zbuf_alloc_span(&zspan, bk_image->width, bk_image->height);
+      zbuf_clip_span_rows(&zspan, band_miny, band_miny + BAKE_RASTER_BAND_SIZE - 1);
+
+      BakeDataZSpan bd;
+      bd.pixel_array = pixel_array;
+      bd.bk_image = bk_image;
+      bd.zspan = &zspan;
+
+      for (const int i : tris) {
+        float vec[3][2];
+        bake_triangle_pixel_coords(bk_image, mloopuv, &looptri[i], vec);
+
+        /* Rasterize triangle. */
+        bd.primitive_id = i;
+        bake_differentials(&bd, vec[0], vec[1], vec[2]);
+        zspan_scanconvert(&zspan, (void *)&bd, vec[0], vec[1], vec[2], store_bake_pixel);
+      }
+
+      zbuf_free_span(&zspan);
+    }
+  });
 
   MEM_freeN(looptri);
-  MEM_freeN(bd.zspan);
 }
 
 /* ******************** NORMALS ************************ */
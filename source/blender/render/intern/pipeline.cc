@@ -5,6 +5,7 @@
  * \ingroup render
  */
 
+#include <atomic>
 #include <cerrno>
 #include <climits>
 #include <cmath>
@@ -31,6 +32,9 @@
 #include "BLI_path_util.h"
 #include "BLI_rect.h"
 #include "BLI_string.h"
+#include "BLI_system.h"
+#include "BLI_task.h"
+#include "BLI_task.hh"
 #include "BLI_threads.h"
 #include "BLI_timecode.h"
 #include "BLI_vector.hh"
@@ -155,12 +159,15 @@ static void render_callback_exec_id(Render *re, Main *bmain, ID *id, eCbEvent ev
 /** \name Allocation & Free
  * \{ */
 
+struct RenderWriteQueue;
+
 static bool do_write_image_or_movie(Render *re,
                                     Main *bmain,
                                     Scene *scene,
                                     bMovieHandle *mh,
                                     const int totvideos,
-                                    const char *name_override);
+                                    const char *name_override,
+                                    RenderWriteQueue *write_queue);
 
 /* default callbacks, set in each new render */
 static void result_nothing(void * /*arg*/, RenderResult * /*rr*/)
@@ -1793,7 +1800,7 @@ void RE_RenderFrame(Render *re,
                                      nullptr);
 
         /* reports only used for Movie */
-        do_write_image_or_movie(re, bmain, scene, nullptr, 0, name);
+        do_write_image_or_movie(re, bmain, scene, nullptr, 0, name, nullptr);
       }
     }
 
@@ -1884,6 +1891,291 @@ void RE_RenderFreestyleExternal(Render *re)
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Write Queue
+ *
+ * Animation renders hand finished frames to a queue, which writes them while the next frame
+ * renders. Frames are written one after the other on a dedicated thread, which keeps movie frames
+ * in order and doesn't compete with the renderer for task scheduler threads. The number of queued
+ * frames and their memory usage are limited, when the queue is full rendering waits for frames to
+ * be written.
+ * \{ */
+
+/**
+ * Remove the empty files created by #R_TOUCH for a frame that was not written, `name` is the
+ * file path of the frame without the view suffix.
+ */
+static void render_remove_touched_files(RenderData *rd, const char *name)
+{
+  const bool is_multiview_name = ((rd->scemode & R_MULTIVIEW) != 0 &&
+                                  (rd->im_format.views_format == R_IMF_VIEWS_INDIVIDUAL));
+
+  if (!is_multiview_name) {
+    if (BLI_file_size(name) == 0) {
+      /* BLI_exists(name) is implicit */
+      BLI_delete(name, false, false);
+    }
+    return;
+  }
+
+  char filepath[FILE_MAX];
+
+  LISTBASE_FOREACH (SceneRenderView *, srv, &rd->views) {
+    if (!BKE_scene_multiview_is_render_view_active(rd, srv)) {
+      continue;
+    }
+
+    BKE_scene_multiview_filepath_get(srv, name, filepath);
+
+    if (BLI_file_size(filepath) == 0) {
+      /* BLI_exists(filepath) is implicit */
+      BLI_delete(filepath, false, false);
+    }
+  }
+}
+
+/** Maximum number of frames that are queued or being written. */
+#define RENDER_WRITE_QUEUE_MAX_FRAMES 4
+/** Queued frames use at most this fraction of the system memory, at least one frame is queued. */
+#define RENDER_WRITE_QUEUE_MEMORY_FRACTION 8
+
+struct RenderWriteJob {
+  RenderResult *rr;
+  /**
+   * Copy of the scene and render settings for the frame, they change while the next frame is
+   * being rendered. Only used to read output settings.
+   */
+  Scene scene;
+  RenderData rd;
+  char filepath[FILE_MAX];
+  size_t memory;
+
+  /** Reports of the writing thread, moved to the render reports on the main thread. */
+  ReportList reports;
+  /** Set when writing finished, protected by the queue mutex. */
+  bool done;
+  bool ok;
+};
+
+struct RenderWriteQueue {
+  TaskPool *task_pool;
+  ThreadMutex mutex;
+  ThreadCondition condition;
+
+  /** Jobs in the order they were scheduled, only accessed from the main thread. */
+  blender::Vector<RenderWriteJob *> jobs;
+
+  /** Jobs that have not finished writing and their memory usage, protected by the mutex. */
+  int scheduled_frames;
+  size_t scheduled_memory;
+  size_t max_memory;
+
+  /** Set to false when writing a frame failed, remaining frames are skipped. */
+  std::atomic<bool> ok;
+
+  bool is_movie;
+  bMovieHandle *mh;
+  void **movie_ctx_arr;
+  int totvideos;
+};
+
+static RenderWriteQueue *render_write_queue_create(Render *re,
+                                                   const bool is_movie,
+                                                   bMovieHandle *mh,
+                                                   const int totvideos)
+{
+  RenderWriteQueue *queue = MEM_new<RenderWriteQueue>(__func__);
+  queue->task_pool = BLI_task_pool_create_background_serial(queue, TASK_PRIORITY_LOW);
+  BLI_mutex_init(&queue->mutex);
+  BLI_condition_init(&queue->condition);
+  queue->scheduled_frames = 0;
+  queue->scheduled_memory = 0;
+  queue->max_memory = BLI_system_memory_max_in_megabytes() * 1024 * 1024 /
+                      RENDER_WRITE_QUEUE_MEMORY_FRACTION;
+  queue->ok = true;
+  queue->is_movie = is_movie;
+  queue->mh = mh;
+  queue->movie_ctx_arr = re->movie_ctx_arr;
+  queue->totvideos = totvideos;
+  return queue;
+}
+
+/** Memory used by the pixels of a render result. */
+static size_t render_result_pixels_memory(const RenderResult *rr)
+{
+  const size_t pixels_num = size_t(rr->rectx) * size_t(rr->recty);
+  size_t memory = 0;
+  LISTBASE_FOREACH (const RenderView *, rv, &rr->views) {
+    memory += rv->rectf ? pixels_num * sizeof(float[4]) : 0;
+    memory += rv->rectz ? pixels_num * sizeof(float) : 0;
+    memory += rv->rect32 ? pixels_num * sizeof(int) : 0;
+  }
+  LISTBASE_FOREACH (const RenderLayer *, rl, &rr->layers) {
+    LISTBASE_FOREACH (const RenderPass *, rpass, &rl->passes) {
+      if (rpass->rect) {
+        memory += size_t(rpass->rectx) * size_t(rpass->recty) * rpass->channels * sizeof(float);
+      }
+    }
+  }
+  return memory;
+}
+
+static void render_write_job_run(TaskPool *__restrict pool, void *taskdata)
+{
+  RenderWriteQueue *queue = static_cast<RenderWriteQueue *>(BLI_task_pool_user_data(pool));
+  RenderWriteJob *job = static_cast<RenderWriteJob *>(taskdata);
+
+  /* Isolate, so that multi-threaded image operations don't make this thread run unrelated tasks,
+   * like those of the renderer. */
+  bool ok = false;
+  if (queue->ok) {
+    blender::threading::isolate_task([&]() {
+      if (queue->is_movie) {
+        /* Errors appending to the movie don't stop the render, same as when writing directly. */
+        RE_WriteRenderViewsMovie(&job->reports,
+                                 job->rr,
+                                 &job->scene,
+                                 &job->rd,
+                                 queue->mh,
+                                 queue->movie_ctx_arr,
+                                 queue->totvideos,
+                                 false);
+        ok = true;
+      }
+      else {
+        ok = BKE_image_render_write(&job->reports, job->rr, &job->scene, true, job->filepath);
+      }
+    });
+  }
+
+  RE_FreeRenderResult(job->rr);
+  job->rr = nullptr;
+
+  BLI_mutex_lock(&queue->mutex);
+  job->done = true;
+  job->ok = ok;
+  if (!ok) {
+    queue->ok = false;
+  }
+  queue->scheduled_frames--;
+  queue->scheduled_memory -= job->memory;
+  BLI_condition_notify_all(&queue->condition);
+  BLI_mutex_unlock(&queue->mutex);
+}
+
+/**
+ * Copy the render result and settings of the current frame and schedule writing them. Waits when
+ * the queue is full.
+ */
+static void render_write_queue_push(RenderWriteQueue *queue,
+                                    Render *re,
+                                    Scene *scene,
+                                    RenderResult *rres,
+                                    const char *filepath)
+{
+  /* Layers are only written to OpenEXR files, avoid copying all passes otherwise. */
+  if (!ELEM(scene->r.im_format.imtype, R_IMF_IMTYPE_OPENEXR, R_IMF_IMTYPE_MULTILAYER)) {
+    BLI_listbase_clear(&rres->layers);
+  }
+  const size_t memory = render_result_pixels_memory(rres);
+
+  BLI_mutex_lock(&queue->mutex);
+  while (queue->scheduled_frames > 0 &&
+         (queue->scheduled_frames >= RENDER_WRITE_QUEUE_MAX_FRAMES ||
+          queue->scheduled_memory + memory > queue->max_memory)) {
+    BLI_condition_wait(&queue->condition, &queue->mutex);
+  }
+  queue->scheduled_frames++;
+  queue->scheduled_memory += memory;
+  BLI_mutex_unlock(&queue->mutex);
+
+  RenderWriteJob *job = MEM_new<RenderWriteJob>(__func__);
+  job->rr = RE_DuplicateRenderResult(rres);
+  memcpy(&job->scene, scene, sizeof(job->scene));
+  memcpy(&job->rd, &re->r, sizeof(job->rd));
+  STRNCPY(job->filepath, filepath);
+  job->memory = memory;
+  BKE_reports_init(&job->reports, RPT_STORE);
+  job->done = false;
+  job->ok = false;
+
+  queue->jobs.append(job);
+  BLI_task_pool_push(queue->task_pool, render_write_job_run, job, false, nullptr);
+}
+
+/**
+ * Handle jobs that finished writing, in the order they were scheduled: pass on their reports and
+ * run the write callbacks, which must happen on the main thread. When `wait` is true, wait for
+ * all jobs to finish. Returns false when writing any of the frames failed.
+ */
+static bool render_write_queue_flush(RenderWriteQueue *queue,
+                                     Render *re,
+                                     Scene *scene,
+                                     const bool wait)
+{
+  bool ok = true;
+
+  while (!queue->jobs.is_empty()) {
+    RenderWriteJob *job = queue->jobs.first();
+
+    BLI_mutex_lock(&queue->mutex);
+    while (wait && !job->done) {
+      BLI_condition_wait(&queue->condition, &queue->mutex);
+    }
+    const bool done = job->done;
+    BLI_mutex_unlock(&queue->mutex);
+
+    if (!done) {
+      break;
+    }
+    queue->jobs.remove(0);
+
+    LISTBASE_FOREACH (Report *, report, &job->reports.list) {
+      BKE_report(re->reports, eReportType(report->type), report->message);
+    }
+    BKE_reports_clear(&job->reports);
+
+    if (job->ok) {
+      /* Callbacks expect the scene to be at the frame that was written, while the scene may
+       * already be at a later frame. */
+      const int cfra = scene->r.cfra;
+      const float subframe = scene->r.subframe;
+      scene->r.cfra = job->scene.r.cfra;
+      scene->r.subframe = job->scene.r.subframe;
+      render_callback_exec_id(re, re->main, &scene->id, BKE_CB_EVT_RENDER_WRITE);
+      scene->r.cfra = cfra;
+      scene->r.subframe = subframe;
+    }
+    else {
+      /* Frames that failed or were skipped after an earlier failure leave no empty files. */
+      if (!queue->is_movie && (job->rd.mode & R_TOUCH)) {
+        render_remove_touched_files(&job->rd, job->filepath);
+      }
+      ok = false;
+    }
+
+    MEM_delete(job);
+  }
+
+  return ok;
+}
+
+/** Wait for all frames to be written and free the queue. */
+static bool render_write_queue_free(RenderWriteQueue *queue, Render *re, Scene *scene)
+{
+  const bool ok = render_write_queue_flush(queue, re, scene, true);
+
+  BLI_task_pool_work_and_wait(queue->task_pool);
+  BLI_task_pool_free(queue->task_pool);
+  BLI_mutex_end(&queue->mutex);
+  BLI_condition_end(&queue->condition);
+  MEM_delete(queue);
+
+  return ok;
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name Read/Write Render Result (Images & Movies)
  * \{ */
@@ -1978,7 +2270,8 @@ static bool do_write_image_or_movie(Render *re,
                                     Scene *scene,
                                     bMovieHandle *mh,
                                     const int totvideos,
-                                    const char *name_override)
+                                    const char *name_override,
+                                    RenderWriteQueue *write_queue)
 {
   char name[FILE_MAX];
   RenderResult rres;
@@ -1993,12 +2286,8 @@ static bool do_write_image_or_movie(Render *re,
   if (do_write_file) {
     RE_AcquireResultImageViews(re, &rres);
 
-    /* write movie or image */
-    if (BKE_imtype_is_movie(scene->r.im_format.imtype)) {
-      RE_WriteRenderViewsMovie(
-          re->reports, &rres, scene, &re->r, mh, re->movie_ctx_arr, totvideos, false);
-    }
-    else {
+    const bool is_movie = BKE_imtype_is_movie(scene->r.im_format.imtype);
+    if (!is_movie) {
       if (name_override) {
         BLI_strncpy(name, name_override, sizeof(name));
       }
@@ -2012,7 +2301,18 @@ static bool do_write_image_or_movie(Render *re,
                                      true,
                                      nullptr);
       }
+    }
 
+    if (write_queue) {
+      /* Errors of earlier frames are reported when they finish writing. */
+      render_write_queue_push(write_queue, re, scene, &rres, is_movie ? "" : name);
+    }
+    /* write movie or image */
+    else if (is_movie) {
+      RE_WriteRenderViewsMovie(
+          re->reports, &rres, scene, &re->r, mh, re->movie_ctx_arr, totvideos, false);
+    }
+    else {
       /* write images as individual images or stereo */
       ok = BKE_image_render_write(re->reports, &rres, scene, true, name);
     }
@@ -2159,6 +2459,11 @@ void RE_RenderAnim(Render *re,
     }
   }
 
+  /* Write frames in the background while the next frame renders. */
+  RenderWriteQueue *write_queue = do_write_file ?
+                                      render_write_queue_create(re, is_movie, mh, totvideos) :
+                                      nullptr;
+
   /* Ugly global still... is to prevent renderwin events and signal subdivision-surface etc
    * to make full resolution is also set by caller renderwin.c */
   G.is_rendering = true;
@@ -2283,7 +2588,7 @@ void RE_RenderAnim(Render *re,
 
       if (re->test_break(re->tbh) == 0) {
         if (!G.is_break) {
-          if (!do_write_image_or_movie(re, bmain, scene, mh, totvideos, nullptr)) {
+          if (!do_write_image_or_movie(re, bmain, scene, mh, totvideos, nullptr, write_queue)) {
             G.is_break = true;
           }
         }
@@ -2296,28 +2601,7 @@ void RE_RenderAnim(Render *re,
         /* remove touched file */
         if (is_movie == false && do_write_file) {
           if (rd.mode & R_TOUCH) {
-            if (!is_multiview_name) {
-              if (BLI_file_size(name) == 0) {
-                /* BLI_exists(name) is implicit */
-                BLI_delete(name, false, false);
-              }
-            }
-            else {
-              char filepath[FILE_MAX];
-
-              LISTBASE_FOREACH (SceneRenderView *, srv, &scene->r.views) {
-                if (!BKE_scene_multiview_is_render_view_active(&scene->r, srv)) {
-                  continue;
-                }
-
-                BKE_scene_multiview_filepath_get(srv, name, filepath);
-
-                if (BLI_file_size(filepath) == 0) {
-                  /* BLI_exists(filepath) is implicit */
-                  BLI_delete(filepath, false, false);
-                }
-              }
-            }
+            render_remove_touched_files(&scene->r, name);
           }
         }
 
@@ -2327,11 +2611,26 @@ void RE_RenderAnim(Render *re,
       if (G.is_break == false) {
         /* keep after file save */
         render_callback_exec_id(re, re->main, &scene->id, BKE_CB_EVT_RENDER_POST);
-        render_callback_exec_id(re, re->main, &scene->id, BKE_CB_EVT_RENDER_WRITE);
+        if (write_queue == nullptr) {
+          render_callback_exec_id(re, re->main, &scene->id, BKE_CB_EVT_RENDER_WRITE);
+        }
+      }
+
+      /* Write callbacks of frames that finished writing in the meantime. */
+      if (write_queue && !render_write_queue_flush(write_queue, re, scene, false)) {
+        G.is_break = true;
+        break;
       }
     }
   }
 
+  /* All frames must be written before the movie ends. */
+  if (write_queue) {
+    if (!render_write_queue_free(write_queue, re, scene)) {
+      G.is_break = true;
+    }
+  }
+
   /* end movie */
   if (is_movie && do_write_file) {
     re_movie_free_all(re, mh, totvideos);
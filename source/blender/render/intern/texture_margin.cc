@@ -5,10 +5,13 @@
  * \ingroup render
  */
 
+#include "BLI_array.hh"
 #include "BLI_assert.h"
+#include "BLI_distance_transform.hh"
 #include "BLI_math_geom.h"
 #include "BLI_math_vector.hh"
 #include "BLI_math_vector_types.hh"
+#include "BLI_task.hh"
 #include "BLI_vector.hh"
 
 #include "BKE_DerivedMesh.h"
@@ -39,9 +42,6 @@ namespace blender::render::texturemargin {
  * adjacency tables.
  */
 class TextureMarginMap {
-  static const int directions[8][2];
-  static const int distances[8];
-
   /** Maps UV-edges to their corresponding UV-edge. */
   Vector<int> loop_adjacency_map_;
   /** Maps UV-edges to their corresponding polygon. */
@@ -50,6 +50,8 @@ class TextureMarginMap {
   int w_, h_;
   float uv_offset_[2];
   Vector<uint32_t> pixel_data_;
+  /** Index of the closest polygon pixel for every pixel, see #compute_nearest_pixels. */
+  Array<int> nearest_pixel_;
   ZSpan zspan_;
   uint32_t value_to_store_;
   char *mask_;
@@ -131,152 +133,115 @@ class TextureMarginMap {
     }
   }
 
-/* The map contains 2 kinds of pixels: DijkstraPixels and polygon indices. The top bit determines
- * what kind it is. With the top bit set, it is a 'dijkstra' pixel. The bottom 4 bits encode the
- * direction of the shortest path and the remaining 27 bits are used to store the distance. If
- * the top bit  is not set, the rest of the bits is used to store the polygon index.
- */
-#define PackDijkstraPixel(dist, dir) (0x80000000 + ((dist) << 4) + (dir))
-#define DijkstraPixelGetDistance(dp) (((dp) ^ 0x80000000) >> 4)
-#define DijkstraPixelGetDirection(dp) ((dp)&0xF)
-#define IsDijkstraPixel(dp) ((dp)&0x80000000)
-#define DijkstraPixelIsUnset(dp) ((dp) == 0xFFFFFFFF)
-
   /**
-   * Use dijkstra's algorithm to 'grow' a border around the polygons marked in the map.
-   * For each pixel mark which direction is the shortest way to a polygon.
+   * Find the closest polygon pixel of every pixel in the map, using a distance transform.
    */
-  void grow_dijkstra(int margin)
+  void compute_nearest_pixels()
   {
-    class DijkstraActivePixel {
-     public:
-      DijkstraActivePixel(int dist, int _x, int _y) : distance(dist), x(_x), y(_y)
-      {
-      }
-      int distance;
-      int x, y;
-    };
-    auto cmp_dijkstrapixel_fun = [](DijkstraActivePixel const &a1, DijkstraActivePixel const &a2) {
-      return a1.distance > a2.distance;
-    };
-
-    Vector<DijkstraActivePixel> active_pixels;
-    for (int y = 0; y < h_; y++) {
-      for (int x = 0; x < w_; x++) {
-        if (DijkstraPixelIsUnset(get_pixel(x, y))) {
-          for (int i = 0; i < 8; i++) {
-            int xx = x - directions[i][0];
-            int yy = y - directions[i][1];
-
-            if (xx >= 0 && xx < w_ && yy >= 0 && yy < w_ && !IsDijkstraPixel(get_pixel(xx, yy))) {
-              set_pixel(x, y, PackDijkstraPixel(distances[i], i));
-              active_pixels.append(DijkstraActivePixel(distances[i], x, y));
-              break;
-            }
-          }
-        }
-      }
-    }
-
-    /* Not strictly needed because at this point it already is a heap. */
-#if 0
-    std::make_heap(active_pixels.begin(), active_pixels.end(), cmp_dijkstrapixel_fun);
-#endif
-
-    while (active_pixels.size()) {
-      std::pop_heap(active_pixels.begin(), active_pixels.end(), cmp_dijkstrapixel_fun);
-      DijkstraActivePixel p = active_pixels.pop_last();
-
-      int dist = p.distance;
-
-      if (dist < 2 * (margin + 1)) {
-        for (int i = 0; i < 8; i++) {
-          int x = p.x + directions[i][0];
-          int y = p.y + directions[i][1];
-          if (x >= 0 && x < w_ && y >= 0 && y < h_) {
-            uint32_t dp = get_pixel(x, y);
-            if (IsDijkstraPixel(dp) && (DijkstraPixelGetDistance(dp) > dist + distances[i])) {
-              BLI_assert(DijkstraPixelGetDirection(dp) != i);
-              set_pixel(x, y, PackDijkstraPixel(dist + distances[i], i));
-              active_pixels.append(DijkstraActivePixel(dist + distances[i], x, y));
-              std::push_heap(active_pixels.begin(), active_pixels.end(), cmp_dijkstrapixel_fun);
-            }
-          }
-        }
-      }
-    }
+    nearest_pixel_.reinitialize(pixel_data_.size());
+    distance_transform::nearest_pixels(
+        int2(w_, h_),
+        [&](const int64_t index) { return pixel_data_[index] != 0xFFFFFFFF; },
+        nearest_pixel_);
   }
 
   /**
-   * Walk over the map and for margin pixels follow the direction stored in the bottom 3
-   * bits back to the polygon.
-   * Then look up the pixel from the next polygon.
+   * For margin pixels, take the polygon of the closest polygon pixel. Then look up the pixel from
+   * the next polygon.
    */
-  void lookup_pixels(ImBuf *ibuf, char *mask, int maxPolygonSteps)
+  void lookup_pixels(ImBuf *ibuf, char *mask, int margin, int maxPolygonSteps)
   {
-    for (int y = 0; y < h_; y++) {
-      for (int x = 0; x < w_; x++) {
-        uint32_t dp = get_pixel(x, y);
-        if (IsDijkstraPixel(dp) && !DijkstraPixelIsUnset(dp)) {
-          int dist = DijkstraPixelGetDistance(dp);
-          int direction = DijkstraPixelGetDirection(dp);
-
-          int xx = x;
-          int yy = y;
-
-          /* Follow the dijkstra directions to find the polygon this margin pixels belongs to. */
-          while (dist > 0) {
-            xx -= directions[direction][0];
-            yy -= directions[direction][1];
-            dp = get_pixel(xx, yy);
-            dist -= distances[direction];
-            BLI_assert(!dist || (dist == DijkstraPixelGetDistance(dp)));
-            direction = DijkstraPixelGetDirection(dp);
-          }
-
-          uint32_t poly = get_pixel(xx, yy);
-
-          BLI_assert(!IsDijkstraPixel(poly));
-
-          float destX, destY;
+    struct MarginPixel {
+      int index;
+      float color[4];
+      uchar color_byte[4];
+    };
 
-          int other_poly;
-          bool found_pixel_in_polygon = false;
-          if (lookup_pixel_polygon_neighbourhood(x, y, &poly, &destX, &destY, &other_poly)) {
+    /* The interpolation can read pixels close to polygon borders, which can be margin pixels
+     * themselves. So all pixels are looked up first, and only written afterwards. */
+    const int rows_per_task = 16;
+    Array<Vector<MarginPixel>> found_pixels(divide_ceil_u(h_, rows_per_task));
+    const int64_t margin_sq = int64_t(margin) * margin;
+
+    threading::parallel_for(found_pixels.index_range(), 1, [&](const IndexRange tasks) {
+      for (const int64_t task : tasks) {
+        const int y_start = int(task) * rows_per_task;
+        const int y_end = std::min(y_start + rows_per_task, h_);
+        for (int y = y_start; y < y_end; y++) {
+          for (int x = 0; x < w_; x++) {
+            const int index = y * w_ + x;
+            const int nearest = nearest_pixel_[index];
+            if (get_pixel(x, y) != 0xFFFFFFFF || nearest == -1) {
+              /* These are not margin pixels, make sure the extend filter which is run after this
+               * step leaves them alone. */
+              mask[index] = 1;
+              continue;
+            }
+            const int64_t dx = nearest % w_ - x;
+            const int64_t dy = nearest / w_ - y;
+            if (dx * dx + dy * dy > margin_sq) {
+              mask[index] = 1;
+              continue;
+            }
 
-            for (int i = 0; i < maxPolygonSteps; i++) {
-              /* Force to pixel grid. */
-              int nx = int(round(destX));
-              int ny = int(round(destY));
-              uint32_t polygon_from_map = get_pixel(nx, ny);
-              if (other_poly == polygon_from_map) {
-                found_pixel_in_polygon = true;
-                break;
+            uint32_t poly = pixel_data_[nearest];
+
+            float destX, destY;
+
+            int other_poly;
+            bool found_pixel_in_polygon = false;
+            if (lookup_pixel_polygon_neighbourhood(x, y, &poly, &destX, &destY, &other_poly)) {
+
+              for (int i = 0; i < maxPolygonSteps; i++) {
+                /* Force to pixel grid. */
+                int nx = int(round(destX));
+                int ny = int(round(destY));
+                uint32_t polygon_from_map = get_pixel(nx, ny);
+                if (other_poly == polygon_from_map) {
+                  found_pixel_in_polygon = true;
+                  break;
+                }
+
+                float dist_to_edge;
+                /* Look up again, but starting from the polygon we were expected to land in. */
+                if (!lookup_pixel(
+                        nx, ny, other_poly, &destX, &destY, &other_poly, &dist_to_edge)) {
+                  found_pixel_in_polygon = false;
+                  break;
+                }
               }
 
-              float dist_to_edge;
-              /* Look up again, but starting from the polygon we were expected to land in. */
-              if (!lookup_pixel(nx, ny, other_poly, &destX, &destY, &other_poly, &dist_to_edge)) {
-                found_pixel_in_polygon = false;
-                break;
+              if (found_pixel_in_polygon) {
+                MarginPixel pixel;
+                pixel.index = index;
+                bilinear_interpolation_color(ibuf,
+                                             pixel.color_byte,
+                                             ibuf->rect_float ? pixel.color : nullptr,
+                                             destX,
+                                             destY);
+                found_pixels[task].append(pixel);
               }
             }
-
-            if (found_pixel_in_polygon) {
-              bilinear_interpolation(ibuf, ibuf, destX, destY, x, y);
-              /* Add our new pixels to the assigned pixel map. */
-              mask[y * w_ + x] = 1;
-            }
           }
         }
-        else if (DijkstraPixelIsUnset(dp) || !IsDijkstraPixel(dp)) {
-          /* These are not margin pixels, make sure the extend filter which is run after this step
-           * leaves them alone.
-           */
-          mask[y * w_ + x] = 1;
+      }
+    });
+
+    threading::parallel_for(found_pixels.index_range(), 1, [&](const IndexRange tasks) {
+      for (const int64_t task : tasks) {
+        for (const MarginPixel &pixel : found_pixels[task]) {
+          if (ibuf->rect_float) {
+            copy_v4_v4(&ibuf->rect_float[int64_t(pixel.index) * 4], pixel.color);
+          }
+          else {
+            copy_v4_v4_uchar(reinterpret_cast<uchar *>(&ibuf->rect[pixel.index]),
+                             pixel.color_byte);
+          }
+          /* Add our new pixels to the assigned pixel map. */
+          mask[pixel.index] = 1;
         }
       }
-    }
+    });
   }
 
  private:
@@ -314,12 +279,16 @@ class TextureMarginMap {
 
   /**
    * Call lookup_pixel for the start_poly. If that fails, try the adjacent polygons as well.
-   * Because the Dijkstra is not very exact in determining which polygon is the closest, the
-   * polygon we need can be the one next to the one the Dijkstra map provides. To prevent missing
+   * Because the closest polygon pixel doesn't always belong to the polygon with the closest edge,
+   * the polygon we need can be the one next to the one the map provides. To prevent missing
    * pixels also check the neighboring polygons.
    */
-  bool lookup_pixel_polygon_neighbourhood(
-      float x, float y, uint32_t *r_start_poly, float *r_destx, float *r_desty, int *r_other_poly)
+  bool lookup_pixel_polygon_neighbourhood(float x,
+                                          float y,
+                                          uint32_t *r_start_poly,
+                                          float *r_destx,
+                                          float *r_desty,
+                                          int *r_other_poly) const
   {
     float found_dist;
     if (lookup_pixel(x, y, *r_start_poly, r_destx, r_desty, r_other_poly, &found_dist)) {
@@ -372,7 +341,7 @@ class TextureMarginMap {
                     float *r_destx,
                     float *r_desty,
                     int *r_other_poly,
-                    float *r_dist_to_edge)
+                    float *r_dist_to_edge) const
   {
     float2 point(x, y);
 
@@ -474,10 +443,6 @@ class TextureMarginMap {
   }
 };  // class TextureMarginMap
 
-const int TextureMarginMap::directions[8][2] = {
-    {-1, 0}, {-1, -1}, {0, -1}, {1, -1}, {1, 0}, {1, 1}, {0, 1}, {-1, 1}};
-const int TextureMarginMap::distances[8] = {2, 3, 2, 3, 2, 3, 2, 3};
-
 static void generate_margin(ImBuf *ibuf,
                             char *mask,
                             const int margin,
@@ -537,8 +502,8 @@ static void generate_margin(ImBuf *ibuf,
       ibuf->x, ibuf->y, uv_offset, polys, mloop, mloopuv, totpoly, totloop, totedge);
 
   bool draw_new_mask = false;
-  /* Now the map contains 3 sorts of values: 0xFFFFFFFF for empty pixels, `0x80000000 + polyindex`
-   * for margin pixels, just `polyindex` for poly pixels. */
+  /* Now the map contains 2 sorts of values: 0xFFFFFFFF for empty pixels, just `polyindex` for
+   * poly pixels. */
   if (mask) {
     mask = (char *)MEM_dupallocN(mask);
   }
@@ -562,29 +527,29 @@ static void generate_margin(ImBuf *ibuf,
       vec[a][1] = (uv[1] - uv_offset[1]) * float(ibuf->y) - (0.5f + 0.002f);
     }
 
-    /* NOTE: we need the top bit for the dijkstra distance map. */
-    BLI_assert(lt->poly < 0x80000000);
+    /* NOTE: 0xFFFFFFFF is used for empty pixels in the map. */
+    BLI_assert(lt->poly < 0xFFFFFFFF);
 
     map.rasterize_tri(vec[0], vec[1], vec[2], lt->poly, draw_new_mask ? mask : nullptr);
   }
 
   char *tmpmask = (char *)MEM_dupallocN(mask);
-  /* Extend (with averaging) by 2 pixels. Those will be overwritten, but it
+  /* Extend by 2 pixels. Those will be overwritten, but it
    * helps linear interpolations on the edges of polygons. */
-  IMB_filter_extend(ibuf, tmpmask, 2);
+  IMB_filter_extend_nearest(ibuf, tmpmask, 2);
   MEM_freeN(tmpmask);
 
-  map.grow_dijkstra(margin);
+  map.compute_nearest_pixels();
 
   /* Looking further than 3 polygons away leads to so much cumulative rounding
    * that it isn't worth it. So hard-code it to 3. */
-  map.lookup_pixels(ibuf, mask, 3);
+  map.lookup_pixels(ibuf, mask, margin, 3);
 
   /* Use the extend filter to fill in the missing pixels at the corners, not strictly correct, but
    * the visual difference seems very minimal. This also catches pixels we missed because of very
    * narrow polygons.
    */
-  IMB_filter_extend(ibuf, mask, margin);
+  IMB_filter_extend_nearest(ibuf, mask, margin);
 
   MEM_freeN(mask);
 
@@ -34,6 +34,8 @@ void zbuf_alloc_span(ZSpan *zspan, int rectx, int recty)
 
   zspan->rectx = rectx;
   zspan->recty = recty;
+  zspan->clip_miny = 0;
+  zspan->clip_maxy = recty - 1;
 
   zspan->span1 = MEM_mallocN(recty * sizeof(float), "zspan");
   zspan->span2 = MEM_mallocN(recty * sizeof(float), "zspan");
@@ -47,6 +49,12 @@ void zbuf_free_span(ZSpan *zspan)
   }
 }
 
+void zbuf_clip_span_rows(ZSpan *zspan, int miny, int maxy)
+{
+  zspan->clip_miny = max_ii(miny, 0);
+  zspan->clip_maxy = min_ii(maxy, zspan->recty - 1);
+}
+
 /* reset range for clipping */
 static void zbuf_init_span(ZSpan *zspan)
 {
@@ -166,7 +174,7 @@ void zspan_scanconvert(ZSpan *zspan,
   float x0, y0, x1, y1, x2, y2, z0, z1, z2;
   float u, v, uxd, uyd, vxd, vyd, uy0, vy0, xx1;
   const float *span1, *span2;
-  int i, j, x, y, sn1, sn2, rectx = zspan->rectx, my0, my2;
+  int i, j, x, y, sn1, sn2, rectx = zspan->rectx, my0, my2, clip_my0, clip_my2;
 
   /* init */
   zbuf_init_span(zspan);
@@ -189,6 +197,14 @@ void zspan_scanconvert(ZSpan *zspan,
     return;
   }
 
+  /* Rows outside the clip range are skipped, the interpolation below still starts at `my2` so
+   * the filled in values don't depend on the clip range. */
+  clip_my0 = max_ii(my0, zspan->clip_miny);
+  clip_my2 = min_ii(my2, zspan->clip_maxy);
+  if (clip_my2 < clip_my0) {
+    return;
+  }
+
   /* ZBUF DX DY, in floats still */
   x1 = v1[0] - v2[0];
   x2 = v2[0] - v3[0];
@@ -223,10 +239,10 @@ void zspan_scanconvert(ZSpan *zspan,
   vy0 = ((double)my2) * vyd + (double)xx1;
 
   /* correct span */
-  span1 = zspan->span1 + my2;
-  span2 = zspan->span2 + my2;
+  span1 = zspan->span1 + clip_my2;
+  span2 = zspan->span2 + clip_my2;
 
-  for (i = 0, y = my2; y >= my0; i++, y--, span1--, span2--) {
+  for (i = my2 - clip_my2, y = clip_my2; y >= clip_my0; i++, y--, span1--, span2--) {
 
     sn1 = floor(min_ff(*span1, *span2));
     sn2 = floor(max_ff(*span1, *span2));
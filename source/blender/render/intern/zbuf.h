@@ -12,7 +12,8 @@ extern "C" {
 
 /** Span fill in method, is also used to localize data for Z-buffering. */
 typedef struct ZSpan {
-  int rectx, recty; /* range for clipping */
+  int rectx, recty;         /* range for clipping */
+  int clip_miny, clip_maxy; /* rows filled in by scan conversion */
 
   int miny1, maxy1, miny2, maxy2;             /* actual filled in range */
   const float *minp1, *maxp1, *minp2, *maxp2; /* vertex pointers detect min/max range in */
@@ -24,6 +25,12 @@ typedef struct ZSpan {
  */
 void zbuf_alloc_span(struct ZSpan *zspan, int rectx, int recty);
 void zbuf_free_span(struct ZSpan *zspan);
+/**
+ * Only fill in rows in the `[miny, maxy]` range, so multiple threads can each scan-convert the
+ * same triangles into their own part of the image. Spans are still computed over the full image
+ * height, so the result is identical to scan-converting without clipping.
+ */
+void zbuf_clip_span_rows(struct ZSpan *zspan, int miny, int maxy);
 
 /**
  * Scan-convert for strand triangles, calls function for each x, y coordinate
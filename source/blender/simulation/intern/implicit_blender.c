@@ -18,6 +18,7 @@
 #  include "DNA_texture_types.h"
 
 #  include "BLI_math.h"
+#  include "BLI_task.h"
 #  include "BLI_utildefines.h"
 
 #  include "BKE_cloth.h"
@@ -34,6 +35,13 @@
 #    define CLOTH_OPENMP_LIMIT 512
 #  endif
 
+/* Minimum number of vertices for the solver to use multiple threads. */
+#  define CLOTH_PARALLEL_LIMIT 1024
+/* Number of vertices handled by one task of the parallel solver loops.
+ * Reductions sum the partial results of these ranges in order, so the result
+ * doesn't depend on the number of threads. */
+#  define CLOTH_PARALLEL_CHUNK 512
+
 //#define DEBUG_TIME
 
 #  ifdef DEBUG_TIME
@@ -628,6 +636,285 @@ DO_INLINE void subadd_bfmatrixS_bfmatrixS(
   }
 }
 
+/* Row-wise (CSR) index of the blocks of a sparse symmetric big matrix,
+ * so rows of a matrix-vector product can be computed independently.
+ * Off-diagonal blocks are referenced twice: from their row, and transposed from their column. */
+typedef struct bfmatrixRows {
+  uint *offsets; /* start of every row in blocks, vcount + 1 items */
+  uint *blocks;  /* block index, with BFMATRIX_ROWS_TRANSPOSED set for transposed blocks */
+} bfmatrixRows;
+
+#  define BFMATRIX_ROWS_TRANSPOSED (1u << 31)
+
+DO_INLINE void create_bfmatrix_rows(bfmatrixRows *rows, uint verts, uint springs)
+{
+  rows->offsets = (uint *)MEM_mallocN(sizeof(uint) * (verts + 1), "cloth_implicit_rows_offsets");
+  rows->blocks = (uint *)MEM_mallocN(sizeof(uint) * (verts + 2 * springs),
+                                     "cloth_implicit_rows_blocks");
+}
+
+DO_INLINE void del_bfmatrix_rows(bfmatrixRows *rows)
+{
+  MEM_SAFE_FREE(rows->offsets);
+  MEM_SAFE_FREE(rows->blocks);
+}
+
+/* Build the row index for the first vcount + num_blocks blocks of the matrix,
+ * the remaining spring blocks are unused in this step. */
+static void build_bfmatrix_rows(bfmatrixRows *rows, fmatrix3x3 *matrix, uint num_blocks)
+{
+  const uint vcount = matrix[0].vcount;
+  uint *offsets = rows->offsets;
+  uint i;
+
+  /* Count blocks per row, every row has its diagonal block. */
+  for (i = 0; i <= vcount; i++) {
+    offsets[i] = 1;
+  }
+  for (i = vcount; i < vcount + num_blocks; i++) {
+    offsets[matrix[i].r]++;
+    offsets[matrix[i].c]++;
+  }
+
+  /* Exclusive prefix sum, offsets[i + 1] is used as insertion point of row i below. */
+  uint total = 0;
+  for (i = 0; i < vcount; i++) {
+    const uint count = offsets[i];
+    offsets[i] = total;
+    total += count;
+  }
+  offsets[vcount] = total;
+  memmove(offsets + 1, offsets, sizeof(uint) * vcount);
+
+  for (i = 0; i < vcount; i++) {
+    rows->blocks[offsets[i + 1]++] = i;
+  }
+  for (i = vcount; i < vcount + num_blocks; i++) {
+    rows->blocks[offsets[matrix[i].r + 1]++] = i;
+    rows->blocks[offsets[matrix[i].c + 1]++] = i | BFMATRIX_ROWS_TRANSPOSED;
+  }
+  offsets[0] = 0;
+}
+
+/* Sum the partial results of the parallel chunks in a fixed order. */
+DO_INLINE float sum_chunk_partials(const float *partials, int chunks)
+{
+  float sum = 0.0f;
+  for (int i = 0; i < chunks; i++) {
+    sum += partials[i];
+  }
+  return sum;
+}
+
+DO_INLINE int parallel_chunks_num(uint verts)
+{
+  return (int)((verts + CLOTH_PARALLEL_CHUNK - 1) / CLOTH_PARALLEL_CHUNK);
+}
+
+DO_INLINE void parallel_chunks_run(uint verts, void *userdata, TaskParallelRangeFunc func)
+{
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = verts > CLOTH_PARALLEL_LIMIT;
+  BLI_task_parallel_range(0, parallel_chunks_num(verts), userdata, func, &settings);
+}
+
+typedef struct MulRowsData {
+  float (*to)[3];
+  fmatrix3x3 *from;
+  const bfmatrixRows *rows;
+  lfVector *fLongVector;
+  fmatrix3x3 *S;     /* optional filter applied to the result */
+  lfVector *dot_rhs; /* optional vector to compute the dot product with the result */
+  float *partials;
+  uint verts;
+} MulRowsData;
+
+static void mul_bfmatrix_rows_lfvector_task(void *__restrict userdata,
+                                            const int chunk,
+                                            const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  MulRowsData *data = userdata;
+  const uint *offsets = data->rows->offsets;
+  const uint *blocks = data->rows->blocks;
+  fmatrix3x3 *from = data->from;
+  const uint start = (uint)chunk * CLOTH_PARALLEL_CHUNK;
+  const uint end = min_uu(start + CLOTH_PARALLEL_CHUNK, data->verts);
+  float dot = 0.0f;
+
+  for (uint i = start; i < end; i++) {
+    float *to = data->to[i];
+    zero_v3(to);
+
+    for (uint k = offsets[i]; k < offsets[i + 1]; k++) {
+      const uint block = blocks[k] & ~BFMATRIX_ROWS_TRANSPOSED;
+      if (blocks[k] & BFMATRIX_ROWS_TRANSPOSED) {
+        /* This is the lower triangle of the sparse matrix,
+         * therefore multiplication occurs with transposed submatrices. */
+        muladd_fmatrixT_fvector(to, from[block].m, data->fLongVector[from[block].r]);
+      }
+      else {
+        muladd_fmatrix_fvector(to, from[block].m, data->fLongVector[from[block].c]);
+      }
+    }
+
+    if (data->S) {
+      mul_m3_v3(data->S[i].m, to);
+    }
+    if (data->dot_rhs) {
+      dot += dot_v3v3(to, data->dot_rhs[i]);
+    }
+  }
+
+  if (data->dot_rhs) {
+    data->partials[chunk] = dot;
+  }
+}
+
+/* SPARSE SYMMETRIC multiply big matrix with long vector, using the row index of the matrix.
+ * The result is optionally filtered by S, and when dot_rhs is given the dot product of the
+ * result with it is returned. */
+static float mul_bfmatrix_rows_lfvector(float (*to)[3],
+                                        fmatrix3x3 *from,
+                                        const bfmatrixRows *rows,
+                                        lfVector *fLongVector,
+                                        fmatrix3x3 *S,
+                                        lfVector *dot_rhs)
+{
+  const uint verts = from[0].vcount;
+  MulRowsData data = {
+      .to = to,
+      .from = from,
+      .rows = rows,
+      .fLongVector = fLongVector,
+      .S = S,
+      .dot_rhs = dot_rhs,
+      .partials = NULL,
+      .verts = verts,
+  };
+
+  if (dot_rhs) {
+    data.partials = MEM_malloc_arrayN(parallel_chunks_num(verts), sizeof(float), __func__);
+  }
+
+  parallel_chunks_run(verts, &data, mul_bfmatrix_rows_lfvector_task);
+
+  if (!dot_rhs) {
+    return 0.0f;
+  }
+
+  const float dot = sum_chunk_partials(data.partials, parallel_chunks_num(verts));
+  MEM_freeN(data.partials);
+  return dot;
+}
+
+typedef struct AssembleSystemData {
+  fmatrix3x3 *A, *M, *dFdV, *dFdX;
+  float dt;
+  uint blocks;
+} AssembleSystemData;
+
+static void assemble_system_matrix_task(void *__restrict userdata,
+                                        const int chunk,
+                                        const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  AssembleSystemData *data = userdata;
+  const uint start = (uint)chunk * CLOTH_PARALLEL_CHUNK;
+  const uint end = min_uu(start + CLOTH_PARALLEL_CHUNK, data->blocks);
+
+  for (uint i = start; i < end; i++) {
+    data->A[i] = data->M[i];
+    subadd_fmatrixS_fmatrixS(
+        data->A[i].m, data->dFdV[i].m, data->dt, data->dFdX[i].m, data->dt * data->dt);
+  }
+}
+
+/* `A = M - dFdV * dt - dFdX * dt^2` */
+static void assemble_system_matrix(
+    fmatrix3x3 *A, fmatrix3x3 *M, fmatrix3x3 *dFdV, fmatrix3x3 *dFdX, float dt)
+{
+  AssembleSystemData data = {
+      .A = A,
+      .M = M,
+      .dFdV = dFdV,
+      .dFdX = dFdX,
+      .dt = dt,
+      .blocks = M[0].vcount + M[0].scount,
+  };
+  parallel_chunks_run(data.blocks, &data, assemble_system_matrix_task);
+}
+
+typedef struct CGUpdateData {
+  lfVector *ldV, *r, *c, *q;
+  fmatrix3x3 *S;
+  float alpha, beta;
+  float *partials;
+  uint verts;
+} CGUpdateData;
+
+static void cg_update_solution_task(void *__restrict userdata,
+                                    const int chunk,
+                                    const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  CGUpdateData *data = userdata;
+  const uint start = (uint)chunk * CLOTH_PARALLEL_CHUNK;
+  const uint end = min_uu(start + CLOTH_PARALLEL_CHUNK, data->verts);
+  float dot = 0.0f;
+
+  for (uint i = start; i < end; i++) {
+    madd_v3_v3fl(data->ldV[i], data->c[i], data->alpha);
+    madd_v3_v3fl(data->r[i], data->q[i], -data->alpha);
+    dot += dot_v3v3(data->r[i], data->r[i]);
+  }
+
+  data->partials[chunk] = dot;
+}
+
+/* `dV += c * alpha`, `r -= q * alpha`, returns `r^T * r`. */
+static float cg_update_solution(
+    lfVector *ldV, lfVector *r, lfVector *c, lfVector *q, float alpha, float *partials, uint verts)
+{
+  CGUpdateData data = {
+      .ldV = ldV,
+      .r = r,
+      .c = c,
+      .q = q,
+      .alpha = alpha,
+      .partials = partials,
+      .verts = verts,
+  };
+  parallel_chunks_run(verts, &data, cg_update_solution_task);
+  return sum_chunk_partials(partials, parallel_chunks_num(verts));
+}
+
+static void cg_update_direction_task(void *__restrict userdata,
+                                     const int chunk,
+                                     const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  CGUpdateData *data = userdata;
+  const uint start = (uint)chunk * CLOTH_PARALLEL_CHUNK;
+  const uint end = min_uu(start + CLOTH_PARALLEL_CHUNK, data->verts);
+
+  for (uint i = start; i < end; i++) {
+    float *c = data->c[i];
+    VECADDS(c, data->r[i], c, data->beta);
+    mul_m3_v3(data->S[i].m, c);
+  }
+}
+
+/* `c = filter(r + c * beta)` */
+static void cg_update_direction(lfVector *c, lfVector *r, fmatrix3x3 *S, float beta, uint verts)
+{
+  CGUpdateData data = {
+      .r = r,
+      .c = c,
+      .S = S,
+      .beta = beta,
+      .verts = verts,
+  };
+  parallel_chunks_run(verts, &data, cg_update_direction_task);
+}
+
 ///////////////////////////////////////////////////////////////////
 /* simulator start */
 ///////////////////////////////////////////////////////////////////
@@ -653,6 +940,8 @@ typedef struct Implicit_Data {
   lfVector *z;          /* target velocity in constrained directions */
   fmatrix3x3 *S;        /* filtering matrix for constraints */
   fmatrix3x3 *P, *Pinv; /* pre-conditioning matrix */
+
+  bfmatrixRows rows; /* row index of A, dFdV and dFdX, which share their blocks layout */
 } Implicit_Data;
 
 Implicit_Data *SIM_mass_spring_solver_create(int numverts, int numsprings)
@@ -677,6 +966,7 @@ Implicit_Data *SIM_mass_spring_solver_create(int numverts, int numsprings)
   id->B = create_lfvector(numverts);
   id->dV = create_lfvector(numverts);
   id->z = create_lfvector(numverts);
+  create_bfmatrix_rows(&id->rows, numverts, numsprings);
 
   initdiag_bfmatrix(id->bigI, I);
 
@@ -703,6 +993,7 @@ void SIM_mass_spring_solver_free(Implicit_Data *id)
   del_lfvector(id->B);
   del_lfvector(id->dV);
   del_lfvector(id->z);
+  del_bfmatrix_rows(&id->rows);
 
   MEM_freeN(id);
 }
@@ -822,6 +1113,7 @@ static int cg_filtered(lfVector *ldV, fmatrix3x3 *lA, lfVector *lB, lfVector *z,
 
 static int cg_filtered(lfVector *ldV,
                        fmatrix3x3 *lA,
+                       const bfmatrixRows *rows,
                        lfVector *lB,
                        lfVector *z,
                        fmatrix3x3 *S,
@@ -837,7 +1129,7 @@ static int cg_filtered(lfVector *ldV,
   lfVector *r = create_lfvector(numverts);
   lfVector *c = create_lfvector(numverts);
   lfVector *q = create_lfvector(numverts);
-  lfVector *s = create_lfvector(numverts);
+  float *partials = MEM_malloc_arrayN(parallel_chunks_num(numverts), sizeof(float), __func__);
   float bnorm2, delta_new, delta_old, delta_target, alpha;
 
   cp_lfvector(ldV, z, numverts);
@@ -849,7 +1141,7 @@ static int cg_filtered(lfVector *ldV,
   delta_target = conjgrad_epsilon * conjgrad_epsilon * bnorm2;
 
   /* r = filter(B - A * dV) */
-  mul_bfmatrix_lfvector(AdV, lA, ldV);
+  mul_bfmatrix_rows_lfvector(AdV, lA, rows, ldV, NULL, NULL);
   sub_lfvector_lfvector(r, lB, AdV, numverts);
   filter(r, S);
 
@@ -871,23 +1163,18 @@ static int cg_filtered(lfVector *ldV,
   print_bfmatrix(S);
 #  endif
 
+  /* The vector operations of every iteration are fused into three parallel passes,
+   * the pre-conditioner is the identity so `s = P^-1 * r` is `r` itself. */
   while (delta_new > delta_target && conjgrad_loopcount < conjgrad_looplimit) {
-    mul_bfmatrix_lfvector(q, lA, c);
-    filter(q, S);
-
-    alpha = delta_new / dot_lfvector(c, q, numverts);
-
-    add_lfvector_lfvectorS(ldV, ldV, c, alpha, numverts);
+    /* q = filter(A * c) */
+    alpha = delta_new / mul_bfmatrix_rows_lfvector(q, lA, rows, c, S, c);
 
-    add_lfvector_lfvectorS(r, r, q, -alpha, numverts);
-
-    /* s = P^-1 * r */
-    cp_lfvector(s, r, numverts);
+    /* dV += c * alpha, r -= q * alpha */
     delta_old = delta_new;
-    delta_new = dot_lfvector(r, s, numverts);
+    delta_new = cg_update_solution(ldV, r, c, q, alpha, partials, numverts);
 
-    add_lfvector_lfvectorS(c, s, c, delta_new / delta_old, numverts);
-    filter(c, S);
+    /* c = filter(r + c * beta) */
+    cg_update_direction(c, r, S, delta_new / delta_old, numverts);
 
     conjgrad_loopcount++;
   }
@@ -903,7 +1190,7 @@ static int cg_filtered(lfVector *ldV,
   del_lfvector(r);
   del_lfvector(c);
   del_lfvector(q);
-  del_lfvector(s);
+  MEM_freeN(partials);
   // printf("W/O conjgrad_loopcount: %d\n", conjgrad_loopcount);
 
   result->status = conjgrad_loopcount < conjgrad_looplimit ? SIM_SOLVER_SUCCESS :
@@ -1128,11 +1415,11 @@ bool SIM_mass_spring_solve_velocities(Implicit_Data *data, float dt, ImplicitSol
   lfVector *dFdXmV = create_lfvector(numverts);
   zero_lfvector(data->dV, numverts);
 
-  cp_bfmatrix(data->A, data->M);
+  assemble_system_matrix(data->A, data->M, data->dFdV, data->dFdX, dt);
 
-  subadd_bfmatrixS_bfmatrixS(data->A, data->dFdV, dt, data->dFdX, (dt * dt));
+  build_bfmatrix_rows(&data->rows, data->A, (uint)data->num_blocks);
 
-  mul_bfmatrix_lfvector(dFdXmV, data->dFdX, data->V);
+  mul_bfmatrix_rows_lfvector(dFdXmV, data->dFdX, &data->rows, data->V, NULL, NULL);
 
   add_lfvectorS_lfvectorS(data->B, data->F, dt, dFdXmV, (dt * dt), numverts);
 
@@ -1141,7 +1428,7 @@ bool SIM_mass_spring_solve_velocities(Implicit_Data *data, float dt, ImplicitSol
 #  endif
 
   /* Conjugate gradient algorithm to solve Ax=b. */
-  cg_filtered(data->dV, data->A, data->B, data->z, data->S, result);
+  cg_filtered(data->dV, data->A, &data->rows, data->B, data->z, data->S, result);
 
   // cg_filtered_pre(id->dV, id->A, id->B, id->z, id->S, id->P, id->Pinv, id->bigI);
 
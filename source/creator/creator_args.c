@@ -26,9 +26,11 @@
 #  include "BLI_string.h"
 #  include "BLI_string_utf8.h"
 #  include "BLI_system.h"
+#  include "BLI_task.h"
 #  include "BLI_threads.h"
 #  include "BLI_utildefines.h"
 
+#  include "BKE_blender.h"
 #  include "BKE_blender_version.h"
 #  include "BKE_blendfile.h"
 #  include "BKE_context.h"
@@ -567,6 +569,8 @@ static int arg_handle_print_help(int UNUSED(argc), const char **UNUSED(argv), vo
   BLI_args_print_arg_doc(ba, "--debug-cycles");
 #  endif
   BLI_args_print_arg_doc(ba, "--debug-memory");
+  BLI_args_print_arg_doc(ba, "--debug-memory-thread-cache");
+  BLI_args_print_arg_doc(ba, "--debug-task-trace");
   BLI_args_print_arg_doc(ba, "--debug-jobs");
   BLI_args_print_arg_doc(ba, "--debug-python");
   BLI_args_print_arg_doc(ba, "--debug-depsgraph");
@@ -1082,6 +1086,52 @@ static int arg_handle_debug_mode_memory_set(int UNUSED(argc),
   return 0;
 }
 
+static const char arg_handle_debug_mode_memory_thread_cache_set_doc[] =
+    "\n\t"
+    "Allocate small memory blocks from thread-local caches (not used with '--debug-memory').\n"
+    "\tFaster for many small allocations, but freed memory is kept for reuse\n"
+    "\tinstead of being returned to the system.";
+static int arg_handle_debug_mode_memory_thread_cache_set(int UNUSED(argc),
+                                                         const char **UNUSED(argv),
+                                                         void *UNUSED(data))
+{
+  MEM_use_lockfree_thread_cache(true);
+  return 0;
+}
+
+static char task_trace_filepath[FILE_MAX];
+
+static void task_trace_write_on_exit(void *UNUSED(user_data))
+{
+  BLI_task_trace_end();
+  if (BLI_task_trace_write_json(task_trace_filepath)) {
+    printf("Task trace written to '%s'\n", task_trace_filepath);
+  }
+  else {
+    fprintf(stderr, "Error: unable to write task trace '%s'\n", task_trace_filepath);
+  }
+}
+
+static const char arg_handle_debug_task_trace_set_doc[] =
+    "<filepath>\n"
+    "\tRecord the parallel loops and tasks executed on each thread,\n"
+    "\tand write them to <filepath> on exit, in the Chrome trace event format (for Perfetto).";
+static int arg_handle_debug_task_trace_set(int argc, const char **argv, void *UNUSED(data))
+{
+  const char *arg_id = "--debug-task-trace";
+  if (argc > 1) {
+    BLI_strncpy(task_trace_filepath, argv[1], sizeof(task_trace_filepath));
+    BLI_path_abs_from_cwd(task_trace_filepath, sizeof(task_trace_filepath));
+    if (!BLI_task_trace_is_enabled()) {
+      BKE_blender_atexit_register(task_trace_write_on_exit, NULL);
+    }
+    BLI_task_trace_begin();
+    return 1;
+  }
+  fprintf(stderr, "\nError: '%s' no args given.\n", arg_id);
+  return 0;
+}
+
 static const char arg_handle_debug_value_set_doc[] =
     "<value>\n"
     "\tSet debug value of <value> on startup.";
@@ -2237,6 +2287,12 @@ void main_args_setup(bContext *C, bArgs *ba)
   BLI_args_add(ba, NULL, "--debug-cycles", CB(arg_handle_debug_mode_cycles), NULL);
 #  endif
   BLI_args_add(ba, NULL, "--debug-memory", CB(arg_handle_debug_mode_memory_set), NULL);
+  BLI_args_add(ba,
+               NULL,
+               "--debug-memory-thread-cache",
+               CB(arg_handle_debug_mode_memory_thread_cache_set),
+               NULL);
+  BLI_args_add(ba, NULL, "--debug-task-trace", CB(arg_handle_debug_task_trace_set), NULL);
 
   BLI_args_add(ba, NULL, "--debug-value", CB(arg_handle_debug_value_set), NULL);
   BLI_args_add(ba,
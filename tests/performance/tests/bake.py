@@ -0,0 +1,82 @@
+# SPDX-License-Identifier: Apache-2.0
+
+import api
+
+
+def _run(args):
+    import bpy
+    import time
+
+    # Bake normals of a subdivided ico-sphere onto a UV sphere, using selected to active.
+    bpy.ops.wm.read_factory_settings(use_empty=True)
+    scene = bpy.context.scene
+    scene.render.engine = 'CYCLES'
+    scene.cycles.device = 'CPU'
+    scene.cycles.samples = 1
+
+    bpy.ops.mesh.primitive_ico_sphere_add(subdivisions=args['subdivisions'], radius=1.0)
+    ob_high = bpy.context.object
+
+    bpy.ops.mesh.primitive_uv_sphere_add(segments=64, ring_count=32, radius=1.0)
+    ob_low = bpy.context.object
+
+    image = bpy.data.images.new("Bake", args['resolution'], args['resolution'], float_buffer=True)
+    material = bpy.data.materials.new("Bake")
+    material.use_nodes = True
+    node = material.node_tree.nodes.new('ShaderNodeTexImage')
+    node.image = image
+    material.node_tree.nodes.active = node
+    ob_low.data.materials.append(material)
+
+    ob_high.select_set(True)
+    ob_low.select_set(True)
+    bpy.context.view_layer.objects.active = ob_low
+
+    start_time = time.time()
+    bpy.ops.object.bake(type='NORMAL',
+                        use_selected_to_active=True,
+                        cage_extrusion=0.05,
+                        margin=args['margin'],
+                        margin_type=args['margin_type'])
+    elapsed_time = time.time() - start_time
+
+    result = {'time': elapsed_time}
+    return result
+
+
+class BakeTest(api.Test):
+    def __init__(self, resolution, subdivisions, margin=16, margin_type='ADJACENT_FACES'):
+        self.resolution = resolution
+        self.subdivisions = subdivisions
+        self.margin = margin
+        self.margin_type = margin_type
+
+    def name(self):
+        name = f"normal_selected_to_active_{self.resolution}_subdiv_{self.subdivisions}"
+        if self.margin != 16:
+            name += f"_margin_{self.margin_type.lower()}_{self.margin}"
+        return name
+
+    def category(self):
+        return "bake"
+
+    def run(self, env, device_id):
+        args = {
+            'resolution': self.resolution,
+            'subdivisions': self.subdivisions,
+            'margin': self.margin,
+            'margin_type': self.margin_type,
+        }
+        result, _ = env.run_in_blender(_run, args)
+        return result
+
+
+def generate(env):
+    # An ico sphere with subdivisions N has 20 * 4^(N - 1) triangles,
+    # 20,480 for 6 and about 1.3M high-poly triangles for 9.
+    return [
+        BakeTest(2048, 6),
+        BakeTest(4096, 9),
+        BakeTest(4096, 4, margin=256, margin_type='EXTEND'),
+        BakeTest(4096, 4, margin=256, margin_type='ADJACENT_FACES'),
+    ]
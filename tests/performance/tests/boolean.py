@@ -0,0 +1,70 @@
+# SPDX-License-Identifier: Apache-2.0
+
+import api
+
+
+def _run(args):
+    import bpy
+    import time
+
+    # Union of a grid of overlapping spheres, using the exact solver.
+    bpy.ops.wm.read_factory_settings(use_empty=True)
+    scene = bpy.context.scene
+
+    operands = bpy.data.collections.new("Operands")
+    scene.collection.children.link(operands)
+
+    bpy.ops.mesh.primitive_uv_sphere_add(segments=args['segments'], ring_count=args['segments'] // 2)
+    sphere = bpy.context.object
+    sphere_mesh = sphere.data
+    bpy.data.objects.remove(sphere)
+
+    grid = args['grid']
+    for i in range(grid):
+        for j in range(grid):
+            ob = bpy.data.objects.new(f"Sphere_{i}_{j}", sphere_mesh)
+            ob.location = (i * 1.5, j * 1.5, 0.0)
+            ob.hide_viewport = True
+            operands.objects.link(ob)
+
+    bpy.ops.mesh.primitive_cube_add(size=2.0, location=(-1.0, -1.0, 0.0))
+    ob = bpy.context.object
+    boolean = ob.modifiers.new("Boolean", 'BOOLEAN')
+    boolean.operation = 'UNION'
+    boolean.operand_type = 'COLLECTION'
+    boolean.collection = operands
+    boolean.solver = 'EXACT'
+
+    num_evaluations = 3
+    start_time = time.time()
+    for i in range(num_evaluations):
+        ob.update_tag()
+        bpy.context.view_layer.update()
+    elapsed_time = time.time() - start_time
+
+    result = {'time': elapsed_time / num_evaluations}
+    return result
+
+
+class BooleanTest(api.Test):
+    def __init__(self, grid, segments):
+        self.grid = grid
+        self.segments = segments
+
+    def name(self):
+        return f"union_spheres_{self.grid * self.grid}_{self.segments}"
+
+    def category(self):
+        return "boolean"
+
+    def run(self, env, device_id):
+        args = {
+            'grid': self.grid,
+            'segments': self.segments,
+        }
+        result, _ = env.run_in_blender(_run, args)
+        return result
+
+
+def generate(env):
+    return [BooleanTest(grid, segments) for grid, segments in ((4, 32), (8, 32), (8, 64))]
@@ -0,0 +1,72 @@
+# SPDX-License-Identifier: Apache-2.0
+
+import api
+
+
+def _run(args):
+    import bpy
+    import time
+
+    if args['filepath'] is None:
+        # Generate a cloth grid pinned along one edge.
+        bpy.ops.wm.read_factory_settings(use_empty=True)
+        bpy.ops.mesh.primitive_grid_add(
+            x_subdivisions=args['subdivisions'],
+            y_subdivisions=args['subdivisions'],
+            size=2.0)
+        ob = bpy.context.object
+
+        group = ob.vertex_groups.new(name="Pin")
+        pinned = [vert.index for vert in ob.data.vertices if vert.co.y > 0.999]
+        group.add(pinned, 1.0, 'REPLACE')
+
+        cloth = ob.modifiers.new("Cloth", 'CLOTH')
+        cloth.settings.vertex_group_mass = group.name
+
+        scene = bpy.context.scene
+        scene.frame_start = 1
+        scene.frame_end = 20
+    else:
+        bpy.ops.wm.open_mainfile(filepath=args['filepath'])
+
+    scene = bpy.context.scene
+
+    # Step through all frames, the first frame only initializes the simulation.
+    start_time = time.time()
+    for i in range(scene.frame_start, scene.frame_end + 1):
+        scene.frame_set(i)
+    elapsed_time = time.time() - start_time
+
+    time_per_frame = elapsed_time / (scene.frame_end + 1 - scene.frame_start)
+
+    result = {'time': time_per_frame}
+    return result
+
+
+class ClothTest(api.Test):
+    def __init__(self, subdivisions=0, filepath=None):
+        self.subdivisions = subdivisions
+        self.filepath = filepath
+
+    def name(self):
+        if self.filepath:
+            return self.filepath.stem
+        return f"grid_{self.subdivisions}"
+
+    def category(self):
+        return "cloth"
+
+    def run(self, env, device_id):
+        args = {
+            'subdivisions': self.subdivisions,
+            'filepath': str(self.filepath) if self.filepath else None,
+        }
+        result, _ = env.run_in_blender(_run, args)
+        return result
+
+
+def generate(env):
+    tests = [ClothTest(subdivisions=subdivisions) for subdivisions in (64, 128, 320)]
+    filepaths = env.find_blend_files('cloth/*')
+    tests += [ClothTest(filepath=filepath) for filepath in filepaths]
+    return tests
@@ -0,0 +1,62 @@
+# SPDX-License-Identifier: Apache-2.0
+
+import api
+
+
+def _run(args):
+    import bpy
+    import time
+
+    # Edit a grid after deleting faces at random, which leaves gaps in the BMesh memory.
+    bpy.ops.wm.read_factory_settings(use_empty=True)
+    bpy.ops.mesh.primitive_grid_add(
+        x_subdivisions=args['subdivisions'],
+        y_subdivisions=args['subdivisions'],
+        size=2.0)
+    bpy.ops.object.mode_set(mode='EDIT')
+    bpy.ops.mesh.select_all(action='DESELECT')
+    bpy.ops.mesh.select_random(ratio=0.5, seed=1)
+    bpy.ops.mesh.delete(type='FACE')
+
+    if args['compact']:
+        # Edit-mode undo steps compact the BMesh when it is fragmented.
+        bpy.ops.ed.undo_push(message="Compact")
+
+    num_iterations = 5
+    start_time = time.time()
+    for i in range(num_iterations):
+        bpy.ops.mesh.select_all(action='SELECT')
+        bpy.ops.mesh.flip_normals()
+        bpy.ops.mesh.normals_make_consistent()
+        bpy.ops.mesh.select_all(action='DESELECT')
+    elapsed_time = time.time() - start_time
+
+    result = {'time': elapsed_time / num_iterations}
+    return result
+
+
+class EditMeshTest(api.Test):
+    def __init__(self, subdivisions, compact):
+        self.subdivisions = subdivisions
+        self.compact = compact
+
+    def name(self):
+        return f"grid_{self.subdivisions}_{'compact' if self.compact else 'fragmented'}"
+
+    def category(self):
+        return "editmesh"
+
+    def run(self, env, device_id):
+        args = {
+            'subdivisions': self.subdivisions,
+            'compact': self.compact,
+        }
+        result, _ = env.run_in_blender(_run, args)
+        return result
+
+
+def generate(env):
+    tests = [EditMeshTest(subdivisions, compact)
+             for subdivisions in (512, 1024)
+             for compact in (False, True)]
+    return tests
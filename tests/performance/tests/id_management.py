@@ -0,0 +1,109 @@
+# SPDX-License-Identifier: Apache-2.0
+
+import api
+
+
+def _run(args):
+    import bpy
+    import time
+
+    bpy.ops.wm.read_factory_settings(use_empty=True)
+
+    collection = getattr(bpy.data, args['collection'])
+    count = args['count']
+    names = [f"{args['collection']}_{i:06d}" for i in range(count)]
+
+    start_time = time.time()
+    if args['collection'] == 'objects':
+        for name in names:
+            collection.new(name, None)
+    else:
+        for name in names:
+            collection.new(name)
+    create_time = time.time() - start_time
+
+    # Look up all IDs by name, plus the same amount of missing names.
+    start_time = time.time()
+    for name in names:
+        collection[name]
+    for name in names:
+        collection.get(name + "_missing")
+    lookup_time = time.time() - start_time
+
+    elapsed_time = create_time if args['mode'] == 'CREATE' else lookup_time
+    result = {'time': elapsed_time}
+    return result
+
+
+def _run_link(args):
+    import bpy
+    import time
+
+    bpy.ops.wm.read_factory_settings(use_empty=True)
+
+    collection = bpy.context.scene.collection
+    names = [f"object_{i:06d}" for i in range(args['count'])]
+
+    # Create empties and link them to the scene.
+    start_time = time.time()
+    if args['batch']:
+        objects = bpy.data.objects.batch_new(names)
+        collection.objects.batch_link(objects)
+    else:
+        for name in names:
+            collection.objects.link(bpy.data.objects.new(name, None))
+    bpy.context.view_layer.update()
+    elapsed_time = time.time() - start_time
+
+    result = {'time': elapsed_time}
+    return result
+
+
+class IDManagementTest(api.Test):
+    def __init__(self, collection, count, mode):
+        self.collection = collection
+        self.count = count
+        self.mode = mode
+
+    def name(self):
+        return f"{self.collection}_{self.count}_{self.mode.lower()}"
+
+    def category(self):
+        return "id_management"
+
+    def run(self, env, device_id):
+        args = {
+            'collection': self.collection,
+            'count': self.count,
+            'mode': self.mode,
+        }
+        result, _ = env.run_in_blender(_run, args)
+        return result
+
+
+class IDLinkTest(api.Test):
+    def __init__(self, count, batch):
+        self.count = count
+        self.batch = batch
+
+    def name(self):
+        return f"objects_{self.count}_link" + ("_batch" if self.batch else "")
+
+    def category(self):
+        return "id_management"
+
+    def run(self, env, device_id):
+        args = {
+            'count': self.count,
+            'batch': self.batch,
+        }
+        result, _ = env.run_in_blender(_run_link, args)
+        return result
+
+
+def generate(env):
+    tests = [IDManagementTest(collection, 200000, mode)
+             for collection in ('objects', 'meshes', 'materials')
+             for mode in ('CREATE', 'LOOKUP')]
+    tests += [IDLinkTest(100000, batch) for batch in (False, True)]
+    return tests
@@ -0,0 +1,85 @@
+# SPDX-License-Identifier: Apache-2.0
+
+import api
+
+
+def _run(args):
+    import bpy
+    import time
+
+    # Particles emitted on a grid inside a cube on the first frame, falling onto a collider plane.
+    bpy.ops.wm.read_factory_settings(use_empty=True)
+    bpy.ops.mesh.primitive_plane_add(size=8.0, location=(0.0, 0.0, -2.0))
+    ob = bpy.context.object
+    ob.modifiers.new("Collision", 'COLLISION')
+
+    bpy.ops.mesh.primitive_cube_add(size=2.0)
+    ob = bpy.context.object
+
+    ob.modifiers.new("Particles", 'PARTICLE_SYSTEM')
+    settings = ob.particle_systems[0].settings
+    settings.emit_from = 'VOLUME'
+    settings.distribution = 'GRID'
+    settings.grid_resolution = args['resolution']
+    settings.frame_start = 1
+    settings.frame_end = 1
+    settings.lifetime = 1000
+    settings.normal_factor = 0.0
+    settings.display_method = 'NONE'
+    settings.physics_type = args['physics_type']
+
+    if args['physics_type'] == 'FLUID':
+        # Keep the number of neighbors per particle in a realistic range for the grid spacing.
+        settings.particle_size = 1.0 / args['resolution']
+        settings.fluid.solver = args['solver']
+
+    scene = bpy.context.scene
+    scene.frame_start = 1
+    scene.frame_end = args['frames']
+
+    # Step through all frames, the first frame only initializes the simulation.
+    start_time = time.time()
+    for i in range(scene.frame_start, scene.frame_end + 1):
+        scene.frame_set(i)
+    elapsed_time = time.time() - start_time
+
+    result = {'time': elapsed_time / (scene.frame_end + 1 - scene.frame_start)}
+    return result
+
+
+class ParticlesTest(api.Test):
+    def __init__(self, resolution, physics_type, solver='DDR', frames=10):
+        self.resolution = resolution
+        self.physics_type = physics_type
+        self.solver = solver
+        self.frames = frames
+
+    def name(self):
+        count = self.resolution ** 3
+        if self.physics_type == 'FLUID':
+            return f"fluid_{self.solver.lower()}_{count}"
+        return f"{self.physics_type.lower()}_{count}"
+
+    def category(self):
+        return "particles"
+
+    def run(self, env, device_id):
+        args = {
+            'resolution': self.resolution,
+            'physics_type': self.physics_type,
+            'solver': self.solver,
+            'frames': self.frames,
+        }
+        result, _ = env.run_in_blender(_run, args)
+        return result
+
+
+def generate(env):
+    # 100^3 = 1M particles.
+    return [
+        ParticlesTest(100, 'NEWTON'),
+        ParticlesTest(50, 'FLUID', 'DDR'),
+        ParticlesTest(50, 'FLUID', 'CLASSICAL'),
+        ParticlesTest(100, 'FLUID', 'DDR', frames=4),
+        ParticlesTest(100, 'FLUID', 'CLASSICAL', frames=4),
+    ]
@@ -0,0 +1,86 @@
+# SPDX-License-Identifier: Apache-2.0
+
+import api
+import os
+
+
+def _run(args):
+    import bpy
+    import tempfile
+    import time
+
+    # Emit all particles on the first frame so every cached frame holds the full count.
+    bpy.ops.wm.read_factory_settings(use_empty=True)
+    bpy.ops.mesh.primitive_plane_add(size=2.0)
+    ob = bpy.context.object
+
+    ob.modifiers.new("Particles", 'PARTICLE_SYSTEM')
+    psys = ob.particle_systems[0]
+    settings = psys.settings
+    settings.count = args['count']
+    settings.frame_start = 1
+    settings.frame_end = 1
+    settings.lifetime = 1000
+    settings.normal_factor = 1.0
+    settings.display_method = 'NONE'
+
+    scene = bpy.context.scene
+    scene.frame_start = 1
+    scene.frame_end = 20
+
+    cache = psys.point_cache
+    cache.frame_start = scene.frame_start
+    cache.frame_end = scene.frame_end
+    cache.use_disk_cache = True
+    cache.compression = args['compression']
+
+    # Disk caches are stored next to the blend file.
+    with tempfile.TemporaryDirectory() as tmpdir:
+        bpy.ops.wm.save_as_mainfile(filepath=os.path.join(tmpdir, "pointcache.blend"))
+
+        with bpy.context.temp_override(point_cache=cache):
+            start_time = time.time()
+            bpy.ops.ptcache.bake(bake=True)
+            bake_time = time.time() - start_time
+
+        num_frames = scene.frame_end + 1 - scene.frame_start
+
+        if args['mode'] == 'PLAYBACK':
+            # Read back all baked frames.
+            start_time = time.time()
+            for i in range(scene.frame_start, scene.frame_end + 1):
+                scene.frame_set(i)
+            elapsed_time = time.time() - start_time
+        else:
+            elapsed_time = bake_time
+
+    result = {'time': elapsed_time / num_frames}
+    return result
+
+
+class PointCacheTest(api.Test):
+    def __init__(self, count, compression, mode):
+        self.count = count
+        self.compression = compression
+        self.mode = mode
+
+    def name(self):
+        return f"particles_{self.count}_{self.compression.lower()}_{self.mode.lower()}"
+
+    def category(self):
+        return "pointcache"
+
+    def run(self, env, device_id):
+        args = {
+            'count': self.count,
+            'compression': self.compression,
+            'mode': self.mode,
+        }
+        result, _ = env.run_in_blender(_run, args)
+        return result
+
+
+def generate(env):
+    return [PointCacheTest(1000000, compression, mode)
+            for compression in ('NO', 'LIGHT', 'ZSTD')
+            for mode in ('BAKE', 'PLAYBACK')]
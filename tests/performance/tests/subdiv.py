@@ -0,0 +1,72 @@
+# SPDX-License-Identifier: Apache-2.0
+
+import api
+
+
+def _run(args):
+    import bpy
+    import time
+
+    bpy.ops.wm.read_factory_settings(use_empty=True)
+    bpy.ops.mesh.primitive_grid_add(
+        x_subdivisions=args['subdivisions'],
+        y_subdivisions=args['subdivisions'],
+        size=2.0)
+    ob = bpy.context.object
+    me = ob.data
+
+    modifier = ob.modifiers.new("Subdivision", 'SUBSURF')
+    modifier.levels = args['levels']
+
+    # Evaluate once first, this builds the topology refiner and the evaluator.
+    bpy.context.view_layer.update()
+
+    # Alternate between two deformations of the same topology, like an animated mesh.
+    # Only positions change, so every update refines and evaluates the existing topology.
+    coords = [0.0] * (len(me.vertices) * 3)
+    me.vertices.foreach_get('co', coords)
+    coords_wave = coords.copy()
+    for i in range(0, len(coords), 3):
+        coords_wave[i + 2] = 0.1 * ((i // 3) % 7)
+
+    num_iterations = 10
+    elapsed_time = 0.0
+    for i in range(num_iterations):
+        me.vertices.foreach_set('co', coords_wave if i % 2 == 0 else coords)
+        me.update()
+
+        start_time = time.time()
+        bpy.context.view_layer.update()
+        elapsed_time += time.time() - start_time
+
+    result = {'time': elapsed_time / num_iterations}
+    return result
+
+
+class SubdivTest(api.Test):
+    def __init__(self, subdivisions, levels):
+        self.subdivisions = subdivisions
+        self.levels = levels
+
+    def name(self):
+        return f"grid_{self.subdivisions}_level_{self.levels}"
+
+    def category(self):
+        return "subdiv"
+
+    def run(self, env, device_id):
+        args = {
+            'subdivisions': self.subdivisions,
+            'levels': self.levels,
+        }
+        result, _ = env.run_in_blender(_run, args)
+        return result
+
+
+def generate(env):
+    # Around 1 and 4 million faces after subdivision.
+    tests = [SubdivTest(512, 1), SubdivTest(512, 2)]
+    # Level 3, also around 1 million faces after subdivision. A 1 million face input at level 3
+    # gives 64 million faces, more memory than benchmark machines can be expected to have.
+    tests += [SubdivTest(128, 3)]
+    return tests
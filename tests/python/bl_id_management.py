@@ -178,6 +178,50 @@ class TestIdRename(TestHelper, unittest.TestCase):
         self.ensure_proper_order()
 
 
+class TestIdBatchAdd(TestHelper, unittest.TestCase):
+    data_container_id = 'objects'
+    default_name = "Object"
+
+    def test_batch_new(self):
+        self.clear_container()
+        self.data_container.new("Object_B", None)
+        names = ["Object_C", "Object_A", "Object_B", "", "Object_A"]
+        objects = self.data_container.batch_new(names)
+        self.assertEqual(len(objects), len(names))
+        self.assertEqual(len(self.data_container), len(names) + 1)
+        self.assertEqual([ob.name for ob in objects],
+                         ["Object_C", "Object_A", "Object_B.001", "Object", "Object_A.001"])
+        for ob in objects:
+            self.assertEqual(self.data_container[ob.name], ob)
+            self.assertEqual(ob.type, 'EMPTY')
+            self.assertEqual(ob.users, 0)
+        self.ensure_proper_order()
+
+    def test_batch_new_data(self):
+        self.clear_container()
+        mesh = bpy.data.meshes.new("Mesh")
+        objects = self.data_container.batch_new(["Object"] * 3, object_data=mesh)
+        self.assertEqual([ob.data for ob in objects], [mesh] * 3)
+        self.assertEqual(mesh.users, 3)
+        with self.assertRaises(TypeError):
+            self.data_container.batch_new(["Object", 1])
+        self.assertEqual(len(self.data_container), 3)
+
+    def test_batch_link(self):
+        self.clear_container()
+        collection = bpy.data.collections.new("Collection")
+        bpy.context.scene.collection.children.link(collection)
+        objects = self.data_container.batch_new(["Object"] * 10)
+        collection.objects.link(objects[0])
+        self.assertEqual(collection.objects.batch_link(objects), 9)
+        self.assertEqual(len(collection.objects), 10)
+        self.assertEqual(collection.objects.batch_link(objects), 0)
+        for ob in objects:
+            self.assertEqual(ob.users, 1)
+            self.assertIn(ob.name, bpy.context.view_layer.objects)
+        bpy.data.collections.remove(collection)
+
+
 if __name__ == '__main__':
     import sys
     sys.argv = [__file__] + (sys.argv[sys.argv.index("--") + 1:] if "--" in sys.argv else [])
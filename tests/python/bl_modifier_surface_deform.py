@@ -0,0 +1,69 @@
+# SPDX-License-Identifier: Apache-2.0
+
+# ./blender.bin --background -noaudio --python tests/python/bl_modifier_surface_deform.py -- --verbose
+import bpy
+import unittest
+
+
+def grid_object(name, size, z):
+    mesh = bpy.data.meshes.new(name)
+    verts = [(x, y, z) for y in range(size + 1) for x in range(size + 1)]
+    faces = []
+    for y in range(size):
+        for x in range(size):
+            i = y * (size + 1) + x
+            faces.append((i, i + 1, i + size + 2, i + size + 1))
+    mesh.from_pydata(verts, [], faces)
+    mesh.update()
+    obj = bpy.data.objects.new(name, mesh)
+    bpy.context.scene.collection.objects.link(obj)
+    return obj
+
+
+class TestSurfaceDeformTopology(unittest.TestCase):
+
+    def setUp(self):
+        bpy.ops.wm.read_factory_settings(use_empty=True)
+        self.target = grid_object("target", 3, 0.0)
+        self.obj = grid_object("deform", 3, 0.5)
+        self.modifier = self.obj.modifiers.new("SurfaceDeform", 'SURFACE_DEFORM')
+        self.modifier.target = self.target
+        bpy.context.view_layer.objects.active = self.obj
+        with bpy.context.temp_override(object=self.obj, active_object=self.obj):
+            bpy.ops.object.surfacedeform_bind(modifier=self.modifier.name)
+        self.assertTrue(self.modifier.is_bound)
+
+    def evaluated_z(self):
+        depsgraph = bpy.context.evaluated_depsgraph_get()
+        mesh = self.obj.evaluated_get(depsgraph).data
+        return [v.co.z for v in mesh.vertices]
+
+    def move_target(self, offset):
+        for v in self.target.data.vertices:
+            v.co.z += offset
+        self.target.data.update()
+
+    def test_deform(self):
+        self.move_target(1.0)
+        for z in self.evaluated_z():
+            self.assertAlmostEqual(z, 1.5, places=5)
+
+    def test_topology_changed_same_counts(self):
+        # Evaluate once, so the target topology hash is cached.
+        self.move_target(1.0)
+        for z in self.evaluated_z():
+            self.assertAlmostEqual(z, 1.5, places=5)
+
+        # Same number of vertices, edges, polygons and loops, different loops.
+        self.target.data.polygons[0].flip()
+        self.move_target(1.0)
+
+        # Binds don't match the target anymore, the modifier must not deform.
+        for z in self.evaluated_z():
+            self.assertAlmostEqual(z, 0.5, places=5)
+
+
+if __name__ == '__main__':
+    import sys
+    sys.argv = [__file__] + (sys.argv[sys.argv.index("--") + 1:] if "--" in sys.argv else [])
+    unittest.main()
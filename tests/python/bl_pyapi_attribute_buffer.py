@@ -0,0 +1,134 @@
+# SPDX-License-Identifier: Apache-2.0
+
+# ./blender.bin --background -noaudio --python tests/python/bl_pyapi_attribute_buffer.py -- --verbose
+import bpy
+import unittest
+
+
+class TestAttributeBuffer(unittest.TestCase):
+
+    def setUp(self):
+        self.mesh = bpy.data.meshes.new("test_mesh")
+        self.mesh.vertices.add(4)
+
+    def tearDown(self):
+        if self.mesh is not None:
+            bpy.data.meshes.remove(self.mesh)
+        del self.mesh
+
+    def test_positions_read(self):
+        self.mesh.vertices[2].co = (1.0, 2.0, 3.0)
+        view = memoryview(self.mesh.vertices.as_buffer())
+        self.assertEqual(view.format, "f")
+        self.assertEqual(view.shape, (4, 3))
+        self.assertTrue(view.readonly)
+        self.assertEqual(view.tolist()[2], [1.0, 2.0, 3.0])
+
+    def test_positions_write(self):
+        buffer = self.mesh.vertices.as_buffer(writable=True)
+        view = memoryview(buffer)
+        view[1, 0] = 5.0
+        view.release()
+        self.assertEqual(self.mesh.vertices[1].co.x, 5.0)
+
+    def test_read_only(self):
+        view = memoryview(self.mesh.attributes["position"].as_buffer())
+        with self.assertRaises(TypeError):
+            view[0, 0] = 1.0
+
+    def test_types(self):
+        for data_type, format, shape in (
+                ('FLOAT', "f", (4,)),
+                ('INT', "i", (4,)),
+                ('FLOAT_VECTOR', "f", (4, 3)),
+                ('FLOAT_COLOR', "f", (4, 4)),
+                ('BYTE_COLOR', "B", (4, 4)),
+                ('BOOLEAN', "?", (4,)),
+                ('FLOAT2', "f", (4, 2)),
+                ('INT8', "b", (4,)),
+        ):
+            attribute = self.mesh.attributes.new("test_" + data_type, data_type, 'POINT')
+            view = memoryview(attribute.as_buffer())
+            self.assertEqual(view.format, format)
+            self.assertEqual(view.shape, shape)
+
+    def test_string_unsupported(self):
+        attribute = self.mesh.attributes.new("test", 'STRING', 'POINT')
+        with self.assertRaises(TypeError):
+            attribute.as_buffer()
+
+    def test_attribute_removed(self):
+        attribute = self.mesh.attributes.new("test", 'FLOAT', 'POINT')
+        buffer = attribute.as_buffer()
+        self.mesh.attributes.remove(attribute)
+        with self.assertRaises(ReferenceError):
+            memoryview(buffer)
+
+    def test_mesh_removed(self):
+        buffer = self.mesh.vertices.as_buffer()
+        bpy.data.meshes.remove(self.mesh)
+        self.mesh = None
+        with self.assertRaises(ReferenceError):
+            memoryview(buffer)
+
+    def test_view_alive_after_attribute_removed(self):
+        attribute = self.mesh.attributes.new("test", 'FLOAT', 'POINT')
+        attribute.data[1].value = 2.0
+        view = memoryview(attribute.as_buffer())
+        self.mesh.attributes.remove(attribute)
+        # The view keeps the array of the removed attribute.
+        self.assertEqual(view.tolist(), [0.0, 2.0, 0.0, 0.0])
+        view.release()
+
+    def test_view_alive_after_mesh_removed(self):
+        self.mesh.vertices[3].co = (1.0, 2.0, 3.0)
+        view = memoryview(self.mesh.vertices.as_buffer())
+        bpy.data.meshes.remove(self.mesh)
+        self.mesh = None
+        self.assertEqual(view.tolist()[3], [1.0, 2.0, 3.0])
+        view.release()
+
+    def test_view_alive_after_realloc(self):
+        view = memoryview(self.mesh.vertices.as_buffer(writable=True))
+        self.mesh.vertices.add(1000)
+        # The view still uses the array from before adding vertices.
+        view[3, 0] = 1.0
+        self.assertEqual(view.shape, (4, 3))
+        self.assertEqual(memoryview(self.mesh.vertices.as_buffer()).shape, (1004, 3))
+        view.release()
+
+    def test_write_after_realloc(self):
+        buffer = self.mesh.vertices.as_buffer(writable=True)
+        view = memoryview(buffer)
+        self.mesh.vertices.add(1)
+        # The write only reaches the orphaned array, the buffer must not be usable anymore.
+        view[3, 0] = 1.0
+        with self.assertRaises(BufferError):
+            buffer.update_tag()
+        view.release()
+        self.assertEqual(self.mesh.vertices[3].co.x, 0.0)
+        with self.assertRaises(BufferError):
+            memoryview(buffer)
+        # A new buffer uses the reallocated array.
+        view = memoryview(self.mesh.vertices.as_buffer(writable=True))
+        view[3, 0] = 1.0
+        view.release()
+        self.assertEqual(self.mesh.vertices[3].co.x, 1.0)
+
+    def test_to_mesh_cleared(self):
+        ob = bpy.data.objects.new("test_object", self.mesh)
+        bpy.context.scene.collection.objects.link(ob)
+        ob_eval = ob.evaluated_get(bpy.context.evaluated_depsgraph_get())
+        buffer = ob_eval.to_mesh().vertices.as_buffer()
+        ob_eval.to_mesh_clear()
+        # Data-blocks outside of the main database are only readable, their array is kept.
+        view = memoryview(buffer)
+        self.assertEqual(view.shape, (4, 3))
+        view.release()
+        bpy.data.objects.remove(ob)
+
+
+if __name__ == '__main__':
+    import sys
+    sys.argv = [__file__] + (sys.argv[sys.argv.index("--") + 1:] if "--" in sys.argv else [])
+    unittest.main()